@@ -4,12 +4,43 @@
 #include <glad/glad.h>
 
 #include <stdexcept>
+#include <string>
 #include <cstdio>
 
+#include "MemoryResource.h"
+#include "BufferPool.h"
+#include "BufferBindingCache.h"
+#include "VertexArray.h"
+#include "IndexContainer.h"
+#include "GLResource.h"
+#include "GLExtensions.h"
+#include "Logger.h"
+#include "GLDebug.h"
+#include "Profiler.h"
+
 namespace ProjectName {
 
 class AttributeContainer {
  public:
+  AttributeContainer() : AttributeContainer( getHeapResource() ) {
+
+  }
+
+  explicit AttributeContainer(MemoryResource * resource) :
+    attributeTypes( ResourceAllocator<AttributeInfo>(resource) ),
+    attributeBuffer( ResourceAllocator<char>(resource) )
+  {
+    //The resource can be the current arena of a FrameArena for geometry that only lives for a
+    //frame. It has to outlive this container.
+  }
+
+  ~AttributeContainer() {
+    //The buffer object itself is deleted later by the render thread, see DeletionQueue. A range
+    //in a BufferPool is released immediately, so the pool has to outlive this container.
+    if( range.isValid() ) {
+      range.pool->free(range);
+    }
+  }
 
   enum Type : GLenum {
     BYTE = GL_BYTE,
@@ -17,7 +48,8 @@ class AttributeContainer {
     SHORT = GL_SHORT,
     UNSIGNED_SHORT = GL_UNSIGNED_SHORT,
     FIXED = GL_FIXED,
-    FLOAT = GL_FLOAT
+    FLOAT = GL_FLOAT,
+    HALF_FLOAT = 0x8D61 //GL_HALF_FLOAT_OES, requires GL_OES_vertex_half_float.
   };
 
   enum AttributeLength : unsigned char {
@@ -31,15 +63,23 @@ class AttributeContainer {
     unsigned char typeSize, attributeSize;
     typeSize = getTypeSize(type);
     attributeSize = typeSize*length;
-    checkDivisibleBy4(attributeSize);
 
-    GLsizeiptr offset = (GLsizeiptr) vertexSize;
-    vertexSize += attributeSize;
+    GLsizeiptr offset = (GLsizeiptr) alignUp(attributeEnd,typeSize);
+    attributeEnd = (unsigned short) (offset + attributeSize);
+    vertexSize = alignUp(attributeEnd,4);
     
     
     attributeTypes.emplace_back(type,typeSize,normalized,length,offset);
   }
 
+  unsigned short getVertexSize() const {
+    return vertexSize;
+  }
+
+  size_t getAttributeOffset(unsigned char index) const {
+    return (size_t) attributeTypes[index].offset;
+  }
+
   void reserve(size_t numberOfVertices) {
     if(vertexSize == 0) {
       throw std::runtime_error(
@@ -68,46 +108,125 @@ class AttributeContainer {
   }
 
   void printData() {
-    std::printf("attribute bytes:\n  ");
-    for(auto c : attributeBuffer) {
-      std::printf("(%hhu)",c);
+    //One message per row of BYTES_PER_ROW bytes, so that no row exceeds the string limit of the
+    //Logger.
+    const size_t BYTES_PER_ROW = 16;
+    LOG_INFO("attribute bytes:\n");
+    std::string row;
+    char number[8];
+    for(size_t i = 0; i < attributeBuffer.size(); ++i) {
+      unsigned int byte = (unsigned char) attributeBuffer[i];
+      std::snprintf( number,sizeof(number),"(%u)",byte );
+      row += number;
+      if( (i + 1) % BYTES_PER_ROW == 0 || i + 1 == attributeBuffer.size() ) {
+        LOG_INFO("  %s\n",row);
+        row.clear();
+      }
     }
-    std::printf("\n");
   }
 
 
   void initialize() { //Requires an OpenGL context;
-    if( attributeBuffer.empty() ) {
-      throw std::runtime_error(
-        "AttributeContainer::initialize() was called, but no attributes have been added."
-      );
-    }
+    checkAttributeCounts();
+    checkHalfFloatSupport();
     
-    size_t numberOfVertices = attributeTypes[0].counter;
-    for(const auto & a : attributeTypes) {
-      if(a.counter != numberOfVertices) {
-        throw std::runtime_error("The vertex attribute arrays have different lengths.");
-      }
-    }
-    
-    glGenBuffers(1,&attributeBufferName);
-    glBindBuffer(GL_ARRAY_BUFFER,attributeBufferName);
+    attributeBufferName.create();
+    attributeBufferName.setSize( attributeBuffer.size() );
+    BufferBindingCache::bind( GL_ARRAY_BUFFER,attributeBufferName.get() );
 
     sendAttributesToGPU();
     
-    for(unsigned char i = 0; i < attributeTypes.size(); ++i) {
-      setVertexAttributePointer(i,attributeTypes[i]);
+    updateVertexArray();
+    BufferBindingCache::bind(GL_ARRAY_BUFFER,0);
+  }
+
+  void initialize(BufferPool& pool) { //Requires an OpenGL context;
+    //Stores the vertices in a range of a shared buffer object instead of in a buffer of their
+    //own, so that meshes in the same page of the pool can be drawn without binding a buffer.
+    checkAttributeCounts();
+    checkHalfFloatSupport();
+    if( pool.getTarget() != GL_ARRAY_BUFFER ) {
+      throw std::runtime_error("AttributeContainer requires a pool of GL_ARRAY_BUFFER buffers.");
+    }
+
+    PROFILE_SCOPE("AttributeContainer::upload");
+    range = pool.allocate(attributeBuffer.size(),4);
+    pool.upload( range,(const GLvoid *) attributeBuffer.data(),attributeBuffer.size() );
+
+    updateVertexArray();
+  }
+
+  void initializeStreaming() { //Requires an OpenGL context;
+    //For vertices that change every frame. The buffer object has room for the reserved number of
+    //vertices; the vertices are written to getVertexData() and sent with stream().
+    if(maxVertices == 0) {
+      throw std::runtime_error("AttributeContainer::initializeStreaming() requires reserve().");
+    }
+    checkHalfFloatSupport();
+
+    attributeBufferName.create();
+    attributeBufferName.setSize( attributeBuffer.size() );
+    BufferBindingCache::bind( GL_ARRAY_BUFFER,attributeBufferName.get() );
+    GL_CHECK( glBufferData(GL_ARRAY_BUFFER,attributeBuffer.size(),nullptr,GL_STREAM_DRAW) );
+    updateVertexArray();
+  }
+
+  char * getVertexData() {
+    //The interleaved vertices, vertexSize bytes each, for writing them directly instead of with
+    //addAttribute.
+    return attributeBuffer.data();
+  }
+
+  void stream(size_t numberOfVertices) { //Requires an OpenGL context;
+    //Sends the first numberOfVertices vertices of getVertexData(). The old storage is orphaned
+    //first, so the driver can hand out new memory while the GPU still reads the previous frame,
+    //instead of waiting for it.
+    if(numberOfVertices > maxVertices) {
+      throw std::runtime_error("AttributeContainer::stream() with more vertices than reserved.");
+    }
+    PROFILE_SCOPE("AttributeContainer::stream");
+    BufferBindingCache::bind( GL_ARRAY_BUFFER,attributeBufferName.get() );
+    GL_CHECK( glBufferData(GL_ARRAY_BUFFER,attributeBuffer.size(),nullptr,GL_STREAM_DRAW) );
+    if(numberOfVertices > 0) {
+      GL_CHECK( glBufferSubData(GL_ARRAY_BUFFER,0,numberOfVertices*vertexSize,
+        (const GLvoid *) attributeBuffer.data()
+      ) );
+    }
+    streamedVertices = numberOfVertices;
+  }
+
+  size_t getCapacity() const { //The number of vertices of reserve().
+    return maxVertices;
+  }
+
+  size_t getStreamedVertexCount() const {
+    return streamedVertices;
+  }
+
+  void setIndexContainer(const IndexContainer& indices) {
+    //The indices are bound by bind() too, so a mesh is switched with one call. They have to be
+    //initialized already.
+    vertexArray.setIndexBuffer( indices.getBuffer() );
+  }
+
+  void bind() { //Requires an OpenGL context;
+    //Binds the vertex array of the container: attribute i at location i, and the indices of
+    //setIndexContainer(). The attribute pointers are specified again only after the pool has
+    //been defragmented.
+    if( range.isValid() && range.pool->getGeneration() != poolGeneration ) {
+      updateVertexArray();
     }
-    glBindBuffer(GL_ARRAY_BUFFER,0);
+    vertexArray.bind();
   }
 
 
    
  
  private:
-  unsigned short vertexSize{0};
+  unsigned short vertexSize{0}, attributeEnd{0};
 
   size_t maxVertices{0};
+  size_t streamedVertices{0};
 
   class AttributeInfo {
    public: 
@@ -128,10 +247,13 @@ class AttributeContainer {
     }
   };
 
-  std::vector<AttributeInfo> attributeTypes;
+  ResourceVector<AttributeInfo> attributeTypes;
   
-  std::vector<char> attributeBuffer;
-  GLuint attributeBufferName;
+  ResourceVector<char> attributeBuffer;
+  BufferHandle attributeBufferName;
+  BufferRange range;
+  unsigned long poolGeneration{0}; //Of the pool when the attribute pointers were specified.
+  VertexArray vertexArray;
   
   static unsigned char getTypeSize(Type t) {
     //These values can be found in the OpenGL ES specification. 
@@ -144,23 +266,35 @@ class AttributeContainer {
       case UNSIGNED_SHORT : return 2;
       case FIXED          : return 4;
       case FLOAT          : return 4;
+      case HALF_FLOAT     : return 2;
     }
+    return 4;
   }
 
-  void checkDivisibleBy4(unsigned char attributeSize) {
-    if(attributeSize%4 != 0) {
-      throw std::runtime_error("typeSize*length should be a multiple of 4");
-      //This may not be required for all video drivers, but I have read the following at
-      //https://www.khronos.org/opengl/wiki/Common_Mistakes :
-      //``if you are interested, most GPUs like chunks of 4 bytes.''
-      //However, this was in a section about texture alignment, so it may not hold for vertex
-      //attributes, but to be safe, I still want to restrict the attribute sizes to multiples of 4.
+  static unsigned short alignUp(unsigned short value, unsigned short alignment) {
+    //Every attribute starts at a multiple of its type size, and the vertex size is padded to a
+    //multiple of 4. I have read the following at
+    //https://www.khronos.org/opengl/wiki/Common_Mistakes :
+    //``if you are interested, most GPUs like chunks of 4 bytes.''
+    //This used to be enforced by requiring typeSize*length to be a multiple of 4 for every
+    //attribute, but that ruled out compact formats such as two bytes for a normal (see
+    //VertexQuantization.h). Padding the vertex keeps every vertex 4-byte aligned.
+    return (unsigned short) ( (value + alignment - 1)/alignment*alignment );
+  }
+
+  void checkHalfFloatSupport() {
+    for(const auto& a : attributeTypes) {
+      if( a.type == HALF_FLOAT && !GLExtensions::has("GL_OES_vertex_half_float") ) {
+        throw std::runtime_error(
+          "AttributeContainer: HALF_FLOAT attributes require GL_OES_vertex_half_float"
+        );
+      }
     }
   }
 
   void additionCheck(const AttributeInfo& a,size_t typeSize, size_t length) {
     if( length != a.length ) {
-      std::printf("Expected an attribute array of length %u, but received %zu\n",a.length,length);
+      LOG_ERROR("Expected an attribute array of length %u, but received %zu\n",a.length,length);
       throw std::runtime_error("AttributeContainer length mismatch");
     }
 
@@ -168,26 +302,56 @@ class AttributeContainer {
       throw std::runtime_error("AttributeContainer has received too many attributes.\n");
     }
     if( typeSize != a.typeSize ) {
-      std::printf("The type size should be %u bytes, but it was %zu\n",a.typeSize,typeSize);
+      LOG_ERROR("The type size should be %u bytes, but it was %zu\n",a.typeSize,typeSize);
       throw std::runtime_error("AttributeContainer type size mismatch");
     }
   }
 
   void sendAttributesToGPU() {
-    
-    glBufferData(
+    PROFILE_SCOPE("AttributeContainer::upload");
+    GL_CHECK( glBufferData(
       GL_ARRAY_BUFFER,
       attributeBuffer.size(),
       (void *) attributeBuffer.data(),
       GL_STATIC_DRAW
-    );
+    ) );
     
   }
 
-  void setVertexAttributePointer(unsigned char index,const AttributeInfo& a) {
-    glVertexAttribPointer(
-      index,a.length,a.type,a.normalized,vertexSize,(const GLvoid *) a.offset
-    );
+  void checkAttributeCounts() {
+    if( attributeBuffer.empty() ) {
+      throw std::runtime_error(
+        "AttributeContainer::initialize() was called, but no attributes have been added."
+      );
+    }
+    
+    size_t numberOfVertices = attributeTypes[0].counter;
+    for(const auto & a : attributeTypes) {
+      if(a.counter != numberOfVertices) {
+        throw std::runtime_error("The vertex attribute arrays have different lengths.");
+      }
+    }
+  }
+
+  void updateVertexArray() {
+    GLsizeiptr base = 0;
+    GLuint buffer = attributeBufferName.get();
+    if( range.isValid() ) {
+      base = (GLsizeiptr) range.pool->getOffset(range);
+      buffer = range.pool->getBuffer(range);
+      poolGeneration = range.pool->getGeneration();
+    }
+    for(unsigned char i = 0; i < attributeTypes.size(); ++i) {
+      const AttributeInfo& a = attributeTypes[i];
+      VertexAttributePointer p;
+      p.buffer = buffer;
+      p.size = a.length;
+      p.type = a.type;
+      p.normalized = a.normalized;
+      p.stride = vertexSize;
+      p.offset = base + a.offset;
+      vertexArray.setAttribute(i,p);
+    }
   }
 };
 
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <limits>
+
+namespace ProjectName {
+
+class BoundingBox2D {
+ public:
+  float minX{ std::numeric_limits<float>::max() };
+  float minY{ std::numeric_limits<float>::max() };
+  float maxX{ std::numeric_limits<float>::lowest() };
+  float maxY{ std::numeric_limits<float>::lowest() };
+
+  BoundingBox2D() {
+
+  }
+
+  BoundingBox2D(float minX, float minY, float maxX, float maxY) :
+    minX(minX), minY(minY), maxX(maxX), maxY(maxY)
+  {
+
+  }
+
+  void add(float x, float y) {
+    minX = x < minX ? x : minX;
+    minY = y < minY ? y : minY;
+    maxX = x > maxX ? x : maxX;
+    maxY = y > maxY ? y : maxY;
+  }
+
+  bool isEmpty() const {
+    return minX > maxX;
+  }
+
+  bool intersects(const BoundingBox2D& b) const {
+    //Boxes that only touch intersect, like the SIMD tests of SpatialGrid.
+    return maxX >= b.minX && minX <= b.maxX && maxY >= b.minY && minY <= b.maxY;
+  }
+
+  bool contains(const BoundingBox2D& b) const {
+    return minX <= b.minX && b.maxX <= maxX && minY <= b.minY && b.maxY <= maxY;
+  }
+
+  BoundingBox2D translated(float x, float y) const {
+    return BoundingBox2D(minX + x,minY + y,maxX + x,maxY + y);
+  }
+};
+
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <stdexcept>
+
+#include "GLDebug.h"
+
+namespace ProjectName {
+
+class BufferBindingCache {
+  //Remembers which buffer is bound to GL_ARRAY_BUFFER and GL_ELEMENT_ARRAY_BUFFER, so binding
+  //the same buffer again costs nothing. Every buffer bind in this program should go through this
+  //class, otherwise the cache gets out of date. The state belongs to the (single) render thread.
+ public:
+  static void bind(GLenum target, GLuint buffer) {
+    GLuint& bound = getBoundBuffer(target);
+    ++getCounters().requested;
+    if(bound == buffer) {
+      return;
+    }
+    GL_CHECK( glBindBuffer(target,buffer) );
+    bound = buffer;
+    ++getCounters().issued;
+  }
+
+  static void forget(GLuint buffer) {
+    //Deleting a bound buffer resets the binding to 0.
+    for(GLenum target : {(GLenum) GL_ARRAY_BUFFER,(GLenum) GL_ELEMENT_ARRAY_BUFFER}) {
+      if(getBoundBuffer(target) == buffer) {
+        getBoundBuffer(target) = 0;
+      }
+    }
+  }
+
+  static void invalidate() {
+    getBoundBuffer(GL_ARRAY_BUFFER) = INVALID;
+    getBoundBuffer(GL_ELEMENT_ARRAY_BUFFER) = INVALID;
+  }
+
+  static void assume(GLenum target, GLuint buffer) {
+    //For a binding that has changed without bind(): the GL_ELEMENT_ARRAY_BUFFER binding is
+    //part of a vertex array object, so binding one also binds its index buffer.
+    getBoundBuffer(target) = buffer;
+  }
+
+  static void invalidate(GLenum target) {
+    getBoundBuffer(target) = INVALID;
+  }
+
+  static unsigned long getIssuedBinds() {
+    return getCounters().issued;
+  }
+
+  static unsigned long getRequestedBinds() {
+    return getCounters().requested;
+  }
+
+  static void resetCounters() {
+    getCounters() = Counters();
+  }
+
+ private:
+  static constexpr GLuint INVALID = ~0u;
+
+  class Counters {
+   public:
+    unsigned long requested{0}, issued{0};
+  };
+
+  static Counters& getCounters() {
+    static Counters counters;
+    return counters;
+  }
+
+  static GLuint& getBoundBuffer(GLenum target) {
+    static GLuint arrayBuffer{INVALID}, elementArrayBuffer{INVALID};
+    if(target == GL_ARRAY_BUFFER) {
+      return arrayBuffer;
+    }
+    else if(target == GL_ELEMENT_ARRAY_BUFFER) {
+      return elementArrayBuffer;
+    }
+    throw std::runtime_error("BufferBindingCache: unsupported buffer target");
+  }
+};
+
+}
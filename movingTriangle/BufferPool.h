@@ -0,0 +1,199 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <vector>
+#include <cstring>
+#include <stdexcept>
+
+#include "RangeAllocator.h"
+#include "GLResource.h"
+#include "BufferBindingCache.h"
+#include "VertexArray.h"
+#include "GLDebug.h"
+
+namespace ProjectName {
+
+class BufferPool;
+
+class BufferRange {
+ public:
+  BufferPool * pool{nullptr};
+  unsigned int page{0};
+  RangeAllocator::Handle handle{RangeAllocator::INVALID_HANDLE};
+
+  bool isValid() const {
+    return pool != nullptr;
+  }
+};
+
+class BufferPoolStatistics {
+ public:
+  size_t pages{0}, capacity{0}, bytesUsed{0}, freeRanges{0};
+  double fragmentation{0.0};
+};
+
+class BufferPool {
+  //Packs many small meshes into a few large buffer objects ("pages"), so that meshes in the
+  //same page can be drawn without binding another buffer. Ranges are handed out on the CPU by
+  //a RangeAllocator; a page only gets its buffer object when data is uploaded to it. Every page
+  //keeps a copy of its contents, because OpenGL ES 2.0 has no glCopyBufferSubData, which is
+  //needed to move ranges during defragmentation.
+ public:
+  explicit BufferPool(GLenum target, size_t pageSize = DEFAULT_PAGE_SIZE) :
+    target(target), pageSize(pageSize)
+  {
+
+  }
+
+  BufferPool(const BufferPool&) = delete;
+  BufferPool& operator=(const BufferPool&) = delete;
+
+  BufferRange allocate(size_t bytes, size_t alignment = 4) {
+    for(unsigned int i = 0; i < pages.size(); ++i) {
+      RangeAllocator::Handle h = pages[i].allocator.allocate(bytes,alignment);
+      if(h != RangeAllocator::INVALID_HANDLE) {
+        return BufferRange{this,i,h};
+      }
+    }
+
+    size_t size = bytes > pageSize ? bytes : pageSize;
+    pages.emplace_back(size);
+    unsigned int i = (unsigned int) pages.size() - 1;
+    return BufferRange{this,i,pages[i].allocator.allocate(bytes,alignment)};
+  }
+
+  void free(BufferRange& r) {
+    getPage(r).allocator.free(r.handle);
+    r = BufferRange();
+  }
+
+  size_t getOffset(const BufferRange& r) const {
+    return getPage(r).allocator.getOffset(r.handle);
+  }
+
+  size_t getSize(const BufferRange& r) const {
+    return getPage(r).allocator.getSize(r.handle);
+  }
+
+  void upload(const BufferRange& r, const void * data, size_t bytes) { //Requires an OpenGL context.
+    Page& p = getPage(r);
+    size_t offset = p.allocator.getOffset(r.handle);
+    if( bytes > p.allocator.getSize(r.handle) ) {
+      throw std::runtime_error("BufferPool: the uploaded data does not fit in its range");
+    }
+    std::memcpy(&p.contents[offset],data,bytes);
+
+    createBufferObject(p);
+    bindBuffer( p.buffer.get() );
+    GL_CHECK( glBufferSubData(target,(GLintptr) offset,(GLsizeiptr) bytes,data) );
+  }
+
+  GLuint getBuffer(const BufferRange& r) const {
+    //Zero until data has been uploaded to the page of the range.
+    return getPage(r).buffer.get();
+  }
+
+  void bind(const BufferRange& r) { //Requires an OpenGL context.
+    bindBuffer( getPage(r).buffer.get() );
+  }
+
+  void defragment() {
+    //Compacts every page that has become fragmented. The offsets of the ranges change, so
+    //vertex attribute pointers have to be specified again afterwards; getGeneration() tells
+    //when.
+    for(auto& p : pages) {
+      if(p.allocator.getFragmentation() < DEFRAGMENTATION_THRESHOLD) {
+        continue;
+      }
+      auto moves = p.allocator.defragment();
+      if( !moves.empty() ) {
+        ++generation;
+      }
+      for(const auto& m : moves) {
+        std::memmove(&p.contents[m.to],&p.contents[m.from],m.size);
+      }
+      if(p.buffer && !moves.empty()) {
+        size_t end = moves.back().to + moves.back().size;
+        bindBuffer( p.buffer.get() );
+        GL_CHECK( glBufferSubData( target,0,(GLsizeiptr) end,(const GLvoid *) p.contents.data() ) );
+      }
+    }
+  }
+
+  BufferPoolStatistics getStatistics() const {
+    BufferPoolStatistics s;
+    s.pages = pages.size();
+    size_t freeBytes = 0, largestFreeRangeSum = 0;
+    for(const auto& p : pages) {
+      s.capacity += p.allocator.getCapacity();
+      s.bytesUsed += p.allocator.getBytesUsed();
+      s.freeRanges += p.allocator.getFreeRangeCount();
+      freeBytes += p.allocator.getCapacity() - p.allocator.getBytesUsed();
+      largestFreeRangeSum += p.allocator.getLargestFreeRange();
+    }
+    if(freeBytes > 0) {
+      s.fragmentation = 1.0 - (double) largestFreeRangeSum/(double) freeBytes;
+    }
+    return s;
+  }
+
+  GLenum getTarget() const {
+    return target;
+  }
+
+  unsigned long getGeneration() const { //Changes whenever defragment() has moved a range.
+    return generation;
+  }
+
+ private:
+  static constexpr size_t DEFAULT_PAGE_SIZE = 1 << 20;
+  static constexpr double DEFRAGMENTATION_THRESHOLD = 0.5;
+
+  class Page {
+   public:
+    RangeAllocator allocator;
+    std::vector<char> contents;
+    BufferHandle buffer;
+
+    explicit Page(size_t size) : allocator(size), contents(size) {
+
+    }
+  };
+
+  GLenum target;
+  size_t pageSize;
+  std::vector<Page> pages;
+  unsigned long generation{0};
+
+  Page& getPage(const BufferRange& r) {
+    if(r.pool != this || r.page >= pages.size() ) {
+      throw std::runtime_error("BufferPool: the range does not belong to this pool");
+    }
+    return pages[r.page];
+  }
+
+  const Page& getPage(const BufferRange& r) const {
+    return const_cast<BufferPool*>(this)->getPage(r);
+  }
+
+  void bindBuffer(GLuint buffer) {
+    if(target == GL_ELEMENT_ARRAY_BUFFER) {
+      VertexArray::unbind(); //Otherwise the index buffer of a vertex array object would change.
+    }
+    BufferBindingCache::bind(target,buffer);
+  }
+
+  void createBufferObject(Page& p) {
+    if(p.buffer) {
+      return;
+    }
+    p.buffer.create();
+    p.buffer.setSize( p.contents.size() );
+    bindBuffer( p.buffer.get() );
+    GL_CHECK( glBufferData( target,(GLsizeiptr) p.contents.size(),
+      (const GLvoid *) p.contents.data(),GL_STATIC_DRAW ) );
+  }
+};
+
+}
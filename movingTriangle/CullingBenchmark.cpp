@@ -0,0 +1,146 @@
+#include "SpatialGrid.h"
+#include "JobSystem.h"
+
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+//Measures view culling of many small moving boxes: a loop over all boxes with the scalar test,
+//BoxCuller over all boxes, and SpatialGrid on one thread and with the JobSystem. Every frame a
+//part of the boxes moves and the grid is updated, which is measured separately. The viewport
+//covers a quarter of the world, like a camera that looks at a part of a large scene.
+//
+//  cullingBenchmark [frames]
+
+namespace {
+
+using namespace ProjectName;
+using Clock = std::chrono::steady_clock;
+
+const float WORLD = 100.0f;
+const float OBJECT_SIZE = 0.2f;
+const float CELL_SIZE = 1.0f;
+
+class Scene {
+ public:
+  std::vector<float> x, y, velocityX, velocityY;
+
+  Scene(size_t n, std::mt19937& random) {
+    std::uniform_real_distribution<float> position(0,WORLD), velocity(-0.05f,0.05f);
+    for(size_t i = 0; i < n; ++i) {
+      x.push_back( position(random) );
+      y.push_back( position(random) );
+      velocityX.push_back( velocity(random) );
+      velocityY.push_back( velocity(random) );
+    }
+  }
+
+  BoundingBox2D getBox(size_t i) const {
+    return BoundingBox2D(x[i],y[i],x[i] + OBJECT_SIZE,y[i] + OBJECT_SIZE);
+  }
+
+  void step(size_t i) {
+    x[i] += velocityX[i];
+    y[i] += velocityY[i];
+    if(x[i] < 0 || x[i] > WORLD) {
+      velocityX[i] = -velocityX[i];
+    }
+    if(y[i] < 0 || y[i] > WORLD) {
+      velocityY[i] = -velocityY[i];
+    }
+  }
+};
+
+double toMicroseconds(Clock::duration d, int frames) {
+  return std::chrono::duration<double,std::micro>(d).count()/frames;
+}
+
+void run(size_t n, double movingFraction, int frames, JobSystem& jobs) {
+  std::mt19937 random(1);
+  Scene scene(n,random);
+  SpatialGrid grid( BoundingBox2D(0,0,WORLD,WORLD),CELL_SIZE );
+  std::vector<float> minX(n), minY(n), maxX(n), maxY(n);
+  std::vector<uint32_t> handles(n), visible(n);
+  for(size_t i = 0; i < n; ++i) {
+    handles[i] = grid.insert( scene.getBox(i) );
+  }
+
+  BoundingBox2D viewport(25,25,75,75);
+  size_t moving = (size_t) (n*movingFraction);
+  Clock::duration update{0}, scalar{0}, simd{0}, gridTime{0}, parallel{0};
+  size_t visibleCount = 0;
+  std::vector<uint32_t> gridVisible;
+
+  for(int f = 0; f < frames; ++f) {
+    //A different part of the boxes moves every frame.
+    size_t first = moving > 0 ? (size_t) f*moving % n : 0;
+    Clock::time_point start = Clock::now();
+    for(size_t k = 0; k < moving; ++k) {
+      size_t i = (first + k) % n;
+      scene.step(i);
+      grid.move( handles[i],scene.getBox(i) );
+    }
+    update += Clock::now() - start;
+
+    for(size_t i = 0; i < n; ++i) {
+      BoundingBox2D b = scene.getBox(i);
+      minX[i] = b.minX;
+      minY[i] = b.minY;
+      maxX[i] = b.maxX;
+      maxY[i] = b.maxY;
+    }
+
+    start = Clock::now();
+    size_t count = 0;
+    for(size_t i = 0; i < n; ++i) {
+      if( viewport.intersects( scene.getBox(i) ) ) {
+        visible[count++] = handles[i];
+      }
+    }
+    scalar += Clock::now() - start;
+
+    start = Clock::now();
+    visibleCount = BoxCuller::cull(viewport,minX.data(),minY.data(),maxX.data(),maxY.data(),
+      handles.data(),n,visible.data()
+    );
+    simd += Clock::now() - start;
+
+    start = Clock::now();
+    grid.cull(viewport,gridVisible);
+    gridTime += Clock::now() - start;
+
+    start = Clock::now();
+    grid.cull(viewport,gridVisible,&jobs);
+    parallel += Clock::now() - start;
+
+    if(gridVisible.size() != visibleCount || count != visibleCount) {
+      std::fprintf(stderr,"Mismatch: %zu %zu %zu\n",count,visibleCount,gridVisible.size());
+      std::exit(1);
+    }
+  }
+
+  std::printf("%9zu %7.0f%% %9zu %10.1f %10.1f %10.1f %10.1f %10.1f\n",n,movingFraction*100,
+    visibleCount,toMicroseconds(update,frames),toMicroseconds(scalar,frames),
+    toMicroseconds(simd,frames),toMicroseconds(gridTime,frames),toMicroseconds(parallel,frames)
+  );
+}
+
+}
+
+int main(int n, char ** arguments) {
+  int frames = n > 1 ? std::atoi(arguments[1]) : 50;
+  JobSystem jobs;
+
+  std::printf("Microseconds per frame, %u worker threads.\n",jobs.getThreadCount());
+  std::printf("%9s %8s %9s %10s %10s %10s %10s %10s\n","objects","moving","visible","update",
+    "scalar","simd","grid","grid+jobs"
+  );
+  for(size_t objects : {1000,10000,100000,1000000}) {
+    for(double moving : {0.0,0.1,1.0}) {
+      run(objects,moving,frames,jobs);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+#include "BoundingBox2D.h"
+
+namespace ProjectName {
+
+class DamageRectangle {
+  //In pixels of the drawable, from its bottom left corner, like glScissor and the rectangles of
+  //EGL_KHR_swap_buffers_with_damage.
+ public:
+  int x{0}, y{0};
+  int width{0}, height{0};
+
+  size_t getArea() const {
+    return (size_t) width*height;
+  }
+
+  bool contains(const DamageRectangle& r) const {
+    return x <= r.x && y <= r.y && r.x + r.width <= x + width && r.y + r.height <= y + height;
+  }
+};
+
+class DamageRegion {
+  //The parts of a view that have changed, as rectangles clipped to the view. Beyond
+  //MAX_RECTANGLES, a new rectangle is merged with the one whose bounding box with it grows the
+  //least, which keeps the swap cheap and costs some pixels that did not change.
+ public:
+  static constexpr size_t MAX_RECTANGLES = 8;
+
+  void reset(int width, int height) { //The size of the view; the region becomes empty.
+    viewWidth = width;
+    viewHeight = height;
+    rectangles.clear();
+  }
+
+  int getViewWidth() const {
+    return viewWidth;
+  }
+
+  int getViewHeight() const {
+    return viewHeight;
+  }
+
+  void addAll() {
+    rectangles.clear();
+    rectangles.push_back( DamageRectangle{0,0,viewWidth,viewHeight} );
+  }
+
+  void add(DamageRectangle r) {
+    int right = std::min(r.x + r.width,viewWidth), top = std::min(r.y + r.height,viewHeight);
+    r.x = std::max(r.x,0);
+    r.y = std::max(r.y,0);
+    r.width = right - r.x;
+    r.height = top - r.y;
+    if(r.width <= 0 || r.height <= 0) {
+      return;
+    }
+    for(const DamageRectangle& e : rectangles) {
+      if( e.contains(r) ) {
+        return;
+      }
+    }
+    rectangles.erase( std::remove_if( rectangles.begin(),rectangles.end(),
+      [&r](const DamageRectangle& e) { return r.contains(e); }
+    ),rectangles.end() );
+    if(rectangles.size() < MAX_RECTANGLES) {
+      rectangles.push_back(r);
+      return;
+    }
+    size_t best = 0;
+    size_t bestGrowth = (size_t) -1;
+    for(size_t i = 0; i < rectangles.size(); ++i) {
+      size_t growth = unite(rectangles[i],r).getArea() - rectangles[i].getArea();
+      if(growth < bestGrowth) {
+        best = i;
+        bestGrowth = growth;
+      }
+    }
+    DamageRectangle merged = unite(rectangles[best],r);
+    rectangles.erase(rectangles.begin() + best);
+    add(merged); //It may contain other rectangles now.
+  }
+
+  void add(const DamageRegion& region) {
+    for(const DamageRectangle& r : region.rectangles) {
+      add(r);
+    }
+  }
+
+  void addClipSpace(const BoundingBox2D& box, float marginPixels = 1) {
+    //A box in clip space, widened by marginPixels for edges that are smoothed, lines and points.
+    if( box.isEmpty() ) {
+      return;
+    }
+    float sx = viewWidth*0.5f, sy = viewHeight*0.5f;
+    int x0 = (int) std::floor( (box.minX + 1)*sx - marginPixels );
+    int y0 = (int) std::floor( (box.minY + 1)*sy - marginPixels );
+    int x1 = (int) std::ceil( (box.maxX + 1)*sx + marginPixels );
+    int y1 = (int) std::ceil( (box.maxY + 1)*sy + marginPixels );
+    //Far outside the view, the conversion to int would overflow.
+    const int LIMIT = 1 << 24;
+    add( DamageRectangle{ std::max(x0,-LIMIT),std::max(y0,-LIMIT),
+      std::min(x1,LIMIT) - std::max(x0,-LIMIT),std::min(y1,LIMIT) - std::max(y0,-LIMIT)
+    } );
+  }
+
+  bool isEmpty() const {
+    return rectangles.empty();
+  }
+
+  bool isFull() const {
+    return rectangles.size() == 1 && rectangles[0].getArea() == (size_t) viewWidth*viewHeight;
+  }
+
+  const std::vector<DamageRectangle>& getRectangles() const {
+    return rectangles;
+  }
+
+  DamageRectangle getBounds() const {
+    if( rectangles.empty() ) {
+      return DamageRectangle();
+    }
+    int x0 = viewWidth, y0 = viewHeight, x1 = 0, y1 = 0;
+    for(const DamageRectangle& r : rectangles) {
+      x0 = std::min(x0,r.x);
+      y0 = std::min(y0,r.y);
+      x1 = std::max(x1,r.x + r.width);
+      y1 = std::max(y1,r.y + r.height);
+    }
+    return DamageRectangle{x0,y0,x1 - x0,y1 - y0};
+  }
+
+ private:
+  int viewWidth{0}, viewHeight{0};
+  std::vector<DamageRectangle> rectangles;
+
+  static DamageRectangle unite(const DamageRectangle& a, const DamageRectangle& b) {
+    int x0 = std::min(a.x,b.x), y0 = std::min(a.y,b.y);
+    int x1 = std::max(a.x + a.width,b.x + b.width), y1 = std::max(a.y + a.height,b.y + b.height);
+    return DamageRectangle{x0,y0,x1 - x0,y1 - y0};
+  }
+};
+
+class DamageHistory {
+  //The damage of the last frames of a window. A back buffer that was presented age frames ago
+  //lacks the damage of the age - 1 frames since then, besides the damage of the new frame.
+ public:
+  static constexpr int MAX_AGE = 4; //Older buffers are repainted completely.
+
+  void getRepaintRegion(const DamageRegion& damage, int bufferAge, DamageRegion& result) const {
+    //A buffer age of 0 means that the content of the back buffer is unknown.
+    result.reset( damage.getViewWidth(),damage.getViewHeight() );
+    if(bufferAge <= 0 || bufferAge > count + 1 || bufferAge > MAX_AGE) {
+      result.addAll();
+      return;
+    }
+    result.add(damage);
+    for(int a = 1; a < bufferAge; ++a) {
+      result.add( frames[ (newest + MAX_AGE - (a - 1)) % MAX_AGE ] );
+    }
+  }
+
+  void push(const DamageRegion& damage) {
+    newest = (newest + 1) % MAX_AGE;
+    frames[newest] = damage;
+    count = std::min(count + 1,(int) MAX_AGE);
+  }
+
+  void clear() {
+    count = 0;
+  }
+
+ private:
+  DamageRegion frames[MAX_AGE];
+  int newest{0}, count{0};
+};
+
+}
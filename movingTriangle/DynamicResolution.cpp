@@ -0,0 +1,160 @@
+#include "DynamicResolution.h"
+#include "ShaderProgram.h"
+#include "GLResource.h"
+#include "BufferBindingCache.h"
+#include "VertexArray.h"
+#include "RenderPass.h"
+#include "GLDebug.h"
+#include "Logger.h"
+
+#include <glad/glad.h>
+
+namespace ProjectName {
+
+namespace {
+
+const char * const UPSCALE_VERTEX_SHADER =
+  "attribute vec2 position;\n"
+  "uniform vec2 textureScale;\n"
+  "varying vec2 textureCoordinate;\n"
+  "void main() {\n"
+  "  textureCoordinate = (position*0.5 + 0.5)*textureScale;\n"
+  "  gl_Position = vec4(position,0.0,1.0);\n"
+  "}\n";
+
+const char * const UPSCALE_FRAGMENT_SHADER =
+  "precision mediump float;\n"
+  "uniform sampler2D image;\n"
+  "uniform vec2 textureLimit;\n"
+  "varying vec2 textureCoordinate;\n"
+  "void main() {\n"
+  "  gl_FragColor = texture2D(image,min(textureCoordinate,textureLimit));\n"
+  "}\n";
+
+}
+
+class DynamicResolution::I {
+ public:
+  ResolutionController controller;
+
+  void initialize() {
+    program.getName() = "DynamicResolution";
+    program.compile(UPSCALE_VERTEX_SHADER,UPSCALE_FRAGMENT_SHADER);
+    program.bindAttributeLocation(POSITION_LOCATION,"position");
+    program.link();
+    textureScaleUniform = program.getUniformLocation("textureScale");
+    textureLimitUniform = program.getUniformLocation("textureLimit");
+    GLint imageUniform = program.getUniformLocation("image");
+
+    GLint previousProgram = 0;
+    GL_CHECK( glGetIntegerv(GL_CURRENT_PROGRAM,&previousProgram) );
+    program.activate();
+    GL_CHECK( glUniform1i(imageUniform,0) );
+    GL_CHECK( glUseProgram( (GLuint) previousProgram ) );
+
+    //One triangle that covers the whole window.
+    const GLfloat triangle[6] = { -1,-1, 3,-1, -1,3 };
+    vertexBuffer.create();
+    BufferBindingCache::bind(GL_ARRAY_BUFFER,vertexBuffer.get());
+    GL_CHECK( glBufferData(GL_ARRAY_BUFFER,sizeof(triangle),triangle,GL_STATIC_DRAW) );
+    vertexBuffer.setSize( sizeof(triangle) );
+
+    VertexAttributePointer position;
+    position.buffer = vertexBuffer.get();
+    position.size = 2;
+    vertexArray.setAttribute(POSITION_LOCATION,position);
+  }
+
+  void releaseGPUResources() {
+    program.destroyProgram();
+    vertexArray.releaseGPUResources();
+    vertexBuffer.reset();
+  }
+
+  void buildGraph(RenderGraph& graph, const RenderView& view) {
+    double scale = controller.getScale();
+    RenderView scaled = view;
+    scaled.width = std::max( 1,(int) (view.width*scale + 0.5) );
+    scaled.height = std::max( 1,(int) (view.height*scale + 0.5) );
+
+    TargetDescription windowSize{view.width,view.height,TargetFormat::RGBA8};
+    //The upscale draws every pixel of the window, so its old content is not loaded.
+    RenderGraph::Resource window = graph.importTarget("window",windowSize,false);
+    RenderGraph::Resource image = graph.createTarget("scaled image",windowSize);
+
+    RenderGraph::Pass scene = graph.addPass("DynamicResolution scene",
+      [this,scaled](const RenderGraph::Context&) {
+        RenderPass::setViewport(0,0,scaled.width,scaled.height);
+        renderer->renderView(scaled);
+      }
+    );
+    graph.write(scene,image);
+
+    RenderGraph::Pass upscalePass = graph.addPass("DynamicResolution upscale",
+      [this,image,scaled,windowSize](const RenderGraph::Context& context) {
+        upscale(context.getTexture(image),scaled.width,scaled.height,windowSize);
+      }
+    );
+    graph.read(upscalePass,image);
+    graph.write(upscalePass,window);
+  }
+
+  void setRenderer(Renderer * r) {
+    renderer = r;
+  }
+
+ private:
+  ShaderProgram program;
+  static constexpr GLuint POSITION_LOCATION = 0;
+  GLint textureScaleUniform{-1}, textureLimitUniform{-1};
+  BufferHandle vertexBuffer;
+  VertexArray vertexArray;
+  Renderer * renderer{nullptr};
+
+  void upscale(GLuint texture, int scaledWidth, int scaledHeight, const TargetDescription& size) {
+    program.activate();
+    GL_CHECK( glUniform2f(textureScaleUniform,
+      (GLfloat) scaledWidth/size.width,(GLfloat) scaledHeight/size.height
+    ) );
+    //Linear filtering at the border of the scaled image would blend in texels outside of it.
+    GL_CHECK( glUniform2f(textureLimitUniform,
+      (scaledWidth - 0.5f)/size.width,(scaledHeight - 0.5f)/size.height
+    ) );
+
+    GL_CHECK( glActiveTexture(GL_TEXTURE0) );
+    GL_CHECK( glBindTexture(GL_TEXTURE_2D,texture) );
+    vertexArray.bind();
+    GL_CHECK( glDrawArrays(GL_TRIANGLES,0,3) );
+  }
+};
+
+constexpr GLuint DynamicResolution::I::POSITION_LOCATION;
+
+DynamicResolution::DynamicResolution() {
+  imp = std::unique_ptr<I>( new I() );
+}
+
+DynamicResolution::~DynamicResolution() = default;
+
+ResolutionController& DynamicResolution::getController() {
+  return imp->controller;
+}
+
+void DynamicResolution::initialize() {
+  imp->initialize();
+}
+
+void DynamicResolution::setRenderer(Renderer * r) {
+  imp->setRenderer(r);
+}
+
+void DynamicResolution::releaseGPUResources() {
+  imp->releaseGPUResources();
+  getExecutor().releaseGPUResources();
+}
+
+void DynamicResolution::buildGraph(RenderGraph& graph, const RenderView& view) {
+  imp->buildGraph(graph,view);
+}
+
+}
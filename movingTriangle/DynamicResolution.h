@@ -0,0 +1,156 @@
+#pragma once
+
+#include <memory>
+#include <cmath>
+#include <algorithm>
+
+#include "RenderGraphRenderer.h"
+
+namespace ProjectName {
+
+class ResolutionController {
+  //Chooses the resolution scale from the measured load, the frame time divided by the deadline
+  //of one vertical blank. Above highLoad for decreaseFrames frames, the scale drops; below
+  //lowLoad for increaseFrames frames, it rises one step. Between the two nothing changes, and
+  //lowering is much quicker than raising, so a missed deadline is fixed at once while the scale
+  //does not follow every small change of the load. If a raise is undone within increaseFrames
+  //frames, the scale oscillates between two steps; then the wait before the next raise doubles,
+  //up to maximumIncreaseFrames.
+ public:
+  class Settings {
+   public:
+    double minimumScale{0.5};
+    double maximumScale{1.0};
+    double step{0.05};
+    double lowLoad{0.7};
+    double highLoad{0.9};
+    unsigned int decreaseFrames{3};
+    unsigned int increaseFrames{60};
+    unsigned int maximumIncreaseFrames{960};
+  };
+
+  ResolutionController() {
+
+  }
+
+  explicit ResolutionController(const Settings& settings) : settings(settings) {
+    scale = settings.maximumScale;
+    increaseFrames = settings.increaseFrames;
+  }
+
+  void setDeadline(double milliseconds) {
+    deadline = milliseconds;
+  }
+
+  double getDeadline() const {
+    return deadline;
+  }
+
+  double getScale() const {
+    return scale;
+  }
+
+  bool addGPUTime(double milliseconds) {
+    //The GPU time of a frame is the best measure: it says by how much the frame is too slow.
+    return observe(milliseconds/deadline,true);
+  }
+
+  bool addFrameInterval(double milliseconds) {
+    //Without GPU timers only missed vertical blanks can be seen, because a frame that is in time
+    //waits for the vertical blank. Frames in time therefore count as low load: after
+    //increaseFrames of them the next step is tried, and taken back if frames are missed again.
+    bool missed = milliseconds > MISSED_DEADLINE*deadline;
+    return observe(missed ? milliseconds/deadline : 0.0,false);
+  }
+  //Both return true when the scale has changed.
+
+ private:
+  static constexpr double MISSED_DEADLINE = 1.5;
+
+  Settings settings;
+  double deadline{1000.0/60};
+  double scale{1.0};
+  unsigned int over{0}, under{0};
+  unsigned int increaseFrames{60};
+  unsigned long framesSinceChange{0};
+  bool lastChangeWasIncrease{false};
+
+  bool observe(double load, bool proportional) {
+    ++framesSinceChange;
+    if(framesSinceChange > settings.maximumIncreaseFrames) {
+      increaseFrames = settings.increaseFrames; //Stable for a long time: forget the oscillation.
+    }
+
+    if(load > settings.highLoad) {
+      under = 0;
+      return ++over >= settings.decreaseFrames && decrease(load,proportional);
+    }
+    if(load < settings.lowLoad) {
+      over = 0;
+      return ++under >= increaseFrames && increase();
+    }
+    over = under = 0;
+    return false;
+  }
+
+  bool decrease(double load, bool proportional) {
+    //The cost of a frame grows with the number of pixels, the square of the scale.
+    double s = scale - settings.step;
+    if(proportional) {
+      double target = (settings.lowLoad + settings.highLoad)/2;
+      s = std::min( s,scale*std::sqrt(target/load) );
+    }
+    if(lastChangeWasIncrease && framesSinceChange <= increaseFrames) {
+      increaseFrames = std::min(2*increaseFrames,settings.maximumIncreaseFrames);
+    }
+    return change(s,false);
+  }
+
+  bool increase() {
+    return change(scale + settings.step,true);
+  }
+
+  bool change(double s, bool isIncrease) {
+    over = under = 0;
+    s = std::max( settings.minimumScale,std::min(s,settings.maximumScale) );
+    if(s == scale) {
+      return false;
+    }
+    scale = s;
+    framesSinceChange = 0;
+    lastChangeWasIncrease = isIncrease;
+    return true;
+  }
+};
+
+class DynamicResolution : public RenderGraphRenderer {
+  //Renders the views of the renderer of setRenderer() into an offscreen target at a fraction of
+  //their size and scales the result up to the window with linear filtering, to save fill rate.
+  //renderView() builds a RenderGraph with two passes: the scene, drawn into a transient target
+  //in a viewport of the scaled size, and the upscale, which reads that target and draws every
+  //pixel of the window. The target has the size of the window, so a new scale only changes the
+  //viewport and the executor never reallocates it. Call renderView() with the framebuffer of the
+  //window bound with RenderPass::bind() and the viewport set to it, and with blending, the depth
+  //test and face culling disabled, as the renderers leave them. The upscale leaves its program,
+  //texture unit 0 with the scaled image and its vertex array bound. All methods except the
+  //controller access need the render thread with a current context.
+ public:
+  DynamicResolution();
+  ~DynamicResolution();
+
+  ResolutionController& getController();
+
+  void setRenderer(Renderer * r);
+
+  void initialize();
+  void releaseGPUResources();
+
+ protected:
+  void buildGraph(RenderGraph& graph, const RenderView& view) override;
+
+ private:
+  class I;
+  std::unique_ptr<I> imp;
+};
+
+}
@@ -0,0 +1,224 @@
+#include "EGLDamage.h"
+#include "Logger.h"
+
+#include <SDL.h>
+
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdint>
+
+#if defined(__unix__)
+  #include <dlfcn.h>
+  #define PROJECTNAME_EGL_FROM_SDL
+#endif
+
+namespace ProjectName {
+
+namespace {
+
+//The few types and constants of EGL that are needed; the tree has no EGL headers.
+using EGLDisplay = void *;
+using EGLSurface = void *;
+using EGLContext = void *;
+using EGLint = int32_t;
+using EGLBoolean = unsigned int;
+
+const EGLint EXTENSIONS = 0x3055;
+const EGLint DRAW = 0x3059;
+const EGLint BUFFER_AGE = 0x313D; //EGL_BUFFER_AGE_EXT, the same as EGL_BUFFER_AGE_KHR.
+
+using GetCurrentDisplay = EGLDisplay (*)();
+using GetCurrentSurface = EGLSurface (*)(EGLint readDraw);
+using GetCurrentContext = EGLContext (*)();
+using QueryString = const char * (*)(EGLDisplay display, EGLint name);
+using QuerySurface = EGLBoolean (*)(EGLDisplay display, EGLSurface surface, EGLint attribute,
+  EGLint * value
+);
+using GetProcAddress = void * (*)(const char * name);
+using DamageFunction = EGLBoolean (*)(EGLDisplay display, EGLSurface surface,
+  const EGLint * rectangles, EGLint count
+); //eglSwapBuffersWithDamageKHR and eglSetDamageRegionKHR.
+
+bool hasExtension(const char * extensions, const char * name) {
+  //The list is separated by spaces; a prefix of a longer name does not count.
+  std::string list = std::string(" ") + extensions + " ";
+  return list.find( std::string(" ") + name + " " ) != std::string::npos;
+}
+
+}
+
+class EGLDamage::I {
+ public:
+  ~I() {
+#ifdef PROJECTNAME_EGL_FROM_SDL
+    if(library != nullptr) {
+      dlclose(library);
+    }
+#endif
+  }
+
+  void initialize() {
+#ifdef PROJECTNAME_EGL_FROM_SDL
+    //RTLD_NOLOAD only finds a library that is loaded already, which it is if SDL uses EGL.
+    library = dlopen("libEGL.so.1",RTLD_NOW|RTLD_NOLOAD);
+    if(library == nullptr) {
+      library = dlopen("libEGL.so",RTLD_NOW|RTLD_NOLOAD);
+    }
+    if(library == nullptr) {
+      LOG_INFO("EGL is not in use; windows are always redrawn and swapped completely.\n");
+      return;
+    }
+    bool loaded = load(getCurrentDisplay,"eglGetCurrentDisplay")
+      && load(getCurrentSurface,"eglGetCurrentSurface")
+      && load(getCurrentContext,"eglGetCurrentContext")
+      && load(queryString,"eglQueryString")
+      && load(querySurface,"eglQuerySurface")
+      && load(getProcAddress,"eglGetProcAddress");
+    if(!loaded || getCurrentContext() == nullptr) {
+      LOG_INFO("The context is not an EGL context; windows are always redrawn completely.\n");
+      return;
+    }
+    display = getCurrentDisplay();
+    const char * extensions = queryString(display,EXTENSIONS);
+    if(extensions == nullptr) {
+      return;
+    }
+
+    bool partialUpdate = hasExtension(extensions,"EGL_KHR_partial_update");
+    bufferAge = partialUpdate || hasExtension(extensions,"EGL_EXT_buffer_age");
+    if(partialUpdate) {
+      setDamageRegionFunction = (DamageFunction) getProcAddress("eglSetDamageRegionKHR");
+    }
+    if( swapBelongsToEGL() ) {
+      if( hasExtension(extensions,"EGL_KHR_swap_buffers_with_damage") ) {
+        swapFunction = (DamageFunction) getProcAddress("eglSwapBuffersWithDamageKHR");
+      }
+      else if( hasExtension(extensions,"EGL_EXT_swap_buffers_with_damage") ) {
+        swapFunction = (DamageFunction) getProcAddress("eglSwapBuffersWithDamageEXT");
+      }
+    }
+#endif
+    LOG_INFO("EGL damage: buffer age %s, partial update %s, swap with damage %s.\n",
+      bufferAge ? "yes" : "no",setDamageRegionFunction != nullptr ? "yes" : "no",
+      swapFunction != nullptr ? "yes" : "no"
+    );
+  }
+
+  bool hasBufferAge() const {
+    return bufferAge;
+  }
+
+  bool canSwapWithDamage() const {
+    return swapFunction != nullptr;
+  }
+
+  int queryBufferAge() {
+    if(!bufferAge) {
+      return 0;
+    }
+    EGLint age = 0;
+    if( !querySurface(display,getCurrentSurface(DRAW),BUFFER_AGE,&age) ) {
+      return 0;
+    }
+    return (int) age;
+  }
+
+  void setDamageRegion(const DamageRegion& repaint) {
+    if(setDamageRegionFunction == nullptr) {
+      return;
+    }
+    toEGLRectangles(repaint);
+    setDamageRegionFunction( display,getCurrentSurface(DRAW),rectangles.data(),
+      (EGLint) (rectangles.size()/4)
+    );
+  }
+
+  bool swapWithDamage(const DamageRegion& damage) {
+    if(swapFunction == nullptr) {
+      return false;
+    }
+    toEGLRectangles(damage);
+    return swapFunction( display,getCurrentSurface(DRAW),rectangles.data(),
+      (EGLint) (rectangles.size()/4)
+    ) != 0;
+  }
+
+ private:
+  void * library{nullptr};
+  EGLDisplay display{nullptr};
+  bool bufferAge{false};
+
+  GetCurrentDisplay getCurrentDisplay{nullptr};
+  GetCurrentSurface getCurrentSurface{nullptr};
+  GetCurrentContext getCurrentContext{nullptr};
+  QueryString queryString{nullptr};
+  QuerySurface querySurface{nullptr};
+  GetProcAddress getProcAddress{nullptr};
+  DamageFunction setDamageRegionFunction{nullptr};
+  DamageFunction swapFunction{nullptr};
+
+  std::vector<EGLint> rectangles; //x, y, width and height, from the bottom left corner.
+
+  template<class FunctionPointer>
+  bool load(FunctionPointer& f, const char * name) {
+#ifdef PROJECTNAME_EGL_FROM_SDL
+    f = reinterpret_cast<FunctionPointer>( dlsym(library,name) );
+#endif
+    return f != nullptr;
+  }
+
+  static bool swapBelongsToEGL() {
+    //Where SDL_GL_SwapWindow does more than eglSwapBuffers, the swap stays with SDL: KMSDRM
+    //flips the page itself, and Wayland waits for the frame callback itself.
+    const char * driver = SDL_GetCurrentVideoDriver();
+    if(driver == nullptr) {
+      return false;
+    }
+    for(const char * d : {"x11","RPI","vivante"}) {
+      if(std::strcmp(driver,d) == 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void toEGLRectangles(const DamageRegion& region) {
+    rectangles.clear();
+    for(const DamageRectangle& r : region.getRectangles()) {
+      rectangles.insert( rectangles.end(),{r.x,r.y,r.width,r.height} );
+    }
+  }
+};
+
+EGLDamage::EGLDamage() {
+  imp = std::unique_ptr<I>( new I() );
+}
+
+EGLDamage::~EGLDamage() = default;
+
+void EGLDamage::initialize() {
+  imp->initialize();
+}
+
+bool EGLDamage::hasBufferAge() const {
+  return imp->hasBufferAge();
+}
+
+bool EGLDamage::canSwapWithDamage() const {
+  return imp->canSwapWithDamage();
+}
+
+int EGLDamage::queryBufferAge() {
+  return imp->queryBufferAge();
+}
+
+void EGLDamage::setDamageRegion(const DamageRegion& repaint) {
+  imp->setDamageRegion(repaint);
+}
+
+bool EGLDamage::swapWithDamage(const DamageRegion& damage) {
+  return imp->swapWithDamage(damage);
+}
+
+}
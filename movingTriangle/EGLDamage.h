@@ -0,0 +1,42 @@
+#pragma once
+
+#include <memory>
+
+#include "DamageRegion.h"
+
+namespace ProjectName {
+
+class EGLDamage {
+  //The parts of EGL that make partial redraws possible. EGL_EXT_buffer_age, or the buffer age of
+  //EGL_KHR_partial_update, tells how many frames old the content of the back buffer is;
+  //EGL_KHR_partial_update tells a tiling GPU which part of it will be drawn; and
+  //EGL_KHR_swap_buffers_with_damage, or its EXT version, tells the compositor which part has
+  //changed. SDL2 does not expose its EGL display, so the functions come from the libEGL that SDL
+  //has loaded already. With GLX, or where an extension is missing, the methods report that it
+  //is not available, and GLWindow redraws and swaps the whole window instead.
+  //All methods need the render thread with a current context.
+ public:
+  EGLDamage();
+  ~EGLDamage();
+
+  void initialize(); //Logs what is available.
+
+  bool hasBufferAge() const;
+  bool canSwapWithDamage() const;
+
+  int queryBufferAge();
+  //Of the current draw surface; 0 when its content is unknown.
+
+  void setDamageRegion(const DamageRegion& repaint);
+  //The part that will be drawn in this frame, after queryBufferAge and before drawing. Does
+  //nothing without EGL_KHR_partial_update.
+
+  bool swapWithDamage(const DamageRegion& damage);
+  //False if the swap is not available or failed; then the window has to be swapped with SDL.
+
+ private:
+  class I;
+  std::unique_ptr<I> imp;
+};
+
+}
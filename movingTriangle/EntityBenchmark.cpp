@@ -0,0 +1,126 @@
+#include "EntityStore.h"
+#include "SceneComponents.h"
+
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+//Compares the update of moving objects in an EntityStore with the same update on an array of
+//structures, where every object also carries data that the update does not need, as objects
+//of a scene usually do. The update reads Transform2D and Velocity2D and writes Transform2D.
+//Creating and destroying the entities in batches is measured too.
+//
+//  entityBenchmark [repetitions]
+
+namespace {
+
+using namespace ProjectName;
+using Clock = std::chrono::steady_clock;
+
+const float TIME_STEP = 1.0f/60;
+volatile float sink;
+
+class GameObject {
+ public:
+  Transform2D transform;
+  Velocity2D velocity;
+  Color color;
+  char name[32]{};
+  float health{100};
+  uint32_t flags{0};
+  void * userData{nullptr};
+};
+
+void integrate(Transform2D& t, const Velocity2D& v) {
+  t.x += v.x*TIME_STEP;
+  t.y += v.y*TIME_STEP;
+  t.rotation += v.angular*TIME_STEP;
+}
+
+double toNanoseconds(Clock::duration d, double count) {
+  return std::chrono::duration<double,std::nano>(d).count()/count;
+}
+
+void run(size_t n, int repetitions) {
+  std::vector<GameObject> objects(n);
+  for(size_t i = 0; i < n; ++i) {
+    objects[i].velocity.x = (float) (i % 7);
+    objects[i].velocity.y = (float) (i % 5);
+  }
+
+  EntityStore store;
+  std::vector<Entity> entities;
+  Clock::time_point start = Clock::now();
+  store.createMany<Transform2D,Velocity2D,Color>(n,entities);
+  Clock::duration create = Clock::now() - start;
+  size_t i = 0;
+  store.forEach<Velocity2D>( [&i](Velocity2D& v) {
+    v.x = (float) (i % 7);
+    v.y = (float) (i % 5);
+    ++i;
+  });
+
+  start = Clock::now();
+  for(int r = 0; r < repetitions; ++r) {
+    for(GameObject& o : objects) {
+      integrate(o.transform,o.velocity);
+    }
+  }
+  Clock::duration arrayOfStructures = Clock::now() - start;
+
+  start = Clock::now();
+  for(int r = 0; r < repetitions; ++r) {
+    store.forEach<Transform2D,Velocity2D>(integrate);
+  }
+  Clock::duration entityStore = Clock::now() - start;
+
+  start = Clock::now();
+  for(int r = 0; r < repetitions; ++r) {
+    store.forEachChunk<Transform2D,Velocity2D>(
+      [](size_t count, Transform2D * t, Velocity2D * v) {
+        for(size_t k = 0; k < count; ++k) {
+          integrate(t[k],v[k]);
+        }
+      }
+    );
+  }
+  Clock::duration chunks = Clock::now() - start;
+
+  //Destroy every second entity, which moves entities from the end into the holes.
+  std::vector<Entity> destroyed;
+  for(size_t k = 0; k < n; k += 2) {
+    destroyed.push_back(entities[k]);
+  }
+  start = Clock::now();
+  store.destroyMany(destroyed);
+  Clock::duration destroy = Clock::now() - start;
+
+  //Keeps the compiler from removing the loops.
+  float check = objects[n/2].transform.x;
+  store.forEach<Transform2D>( [&check](Transform2D& t) { check += t.x; } );
+  sink = check;
+
+  double updates = (double) n*repetitions;
+  std::printf("%9zu %10.2f %10.2f %10.2f %10.1f %10.1f\n",n,
+    toNanoseconds(arrayOfStructures,updates),toNanoseconds(entityStore,updates),
+    toNanoseconds(chunks,updates),toNanoseconds(create,(double) n),
+    toNanoseconds(destroy,(double) destroyed.size())
+  );
+}
+
+}
+
+int main(int n, char ** arguments) {
+  int repetitions = n > 1 ? std::atoi(arguments[1]) : 20;
+  std::printf("Nanoseconds per entity. The array of structures holds %zu bytes per object.\n",
+    sizeof(GameObject)
+  );
+  std::printf("%9s %10s %10s %10s %10s %10s\n","entities","array","forEach","chunks","create",
+    "destroy"
+  );
+  for(size_t entities : {10000,100000,1000000,4000000}) {
+    run(entities,repetitions);
+  }
+  return 0;
+}
@@ -0,0 +1,342 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <algorithm>
+#include <type_traits>
+#include <stdexcept>
+#include <new>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+
+namespace ProjectName {
+
+class Entity {
+  //A handle to an entity of an EntityStore. The generation makes a handle of a destroyed entity
+  //invalid, also after its index has been reused.
+ public:
+  uint32_t index{~0u};
+  uint32_t generation{0};
+
+  bool operator==(const Entity& e) const {
+    return index == e.index && generation == e.generation;
+  }
+
+  bool operator!=(const Entity& e) const {
+    return !(*this == e);
+  }
+};
+
+class EntityStore {
+  //Stores entities grouped by archetype, the set of component types they have. The entities of an
+  //archetype are packed in chunks of CHUNK_BYTES bytes, and within a chunk every component type
+  //has its own array, so a loop over some of the components only reads those. Destroying an
+  //entity moves the last entity of its archetype into the hole, which keeps the chunks packed;
+  //the chunks themselves are kept for later entities.
+  //Components must be trivially copyable, because they are moved with memcpy. There can be up to
+  //MAX_COMPONENT_TYPES component types. The store belongs to one thread at a time; forEach and
+  //forEachChunk must not create or destroy entities.
+ public:
+  static constexpr size_t CHUNK_BYTES = 16384;
+  static constexpr unsigned int MAX_COMPONENT_TYPES = 64;
+
+  EntityStore() {
+
+  }
+
+  EntityStore(const EntityStore&) = delete;
+  EntityStore& operator=(const EntityStore&) = delete;
+
+  template<class... C>
+  Entity create(const C&... components) {
+    Archetype& a = getArchetype<C...>();
+    Entity e = allocateEntity(a);
+    size_t position = records[e.index].position;
+    int unused[] = { 0,( new ( a.getComponent<C>(position) ) C(components), 0 )... };
+    (void) unused;
+    return e;
+  }
+
+  template<class... C>
+  void createMany(size_t count, std::vector<Entity>& entities) {
+    //Appends count new entities to entities. Their components are value-initialized.
+    Archetype& a = getArchetype<C...>();
+    a.reserve(a.count + count);
+    entities.reserve(entities.size() + count);
+    if( freeIndices.size() < count ) {
+      records.reserve(records.size() + count - freeIndices.size());
+    }
+    for(size_t i = 0; i < count; ++i) {
+      Entity e = allocateEntity(a);
+      size_t position = records[e.index].position;
+      int unused[] = { 0,( new ( a.getComponent<C>(position) ) C(), 0 )... };
+      (void) unused;
+      entities.push_back(e);
+    }
+  }
+
+  void destroy(Entity e) {
+    if( !isAlive(e) ) {
+      throw std::invalid_argument("EntityStore::destroy with a handle of a destroyed entity");
+    }
+    Record& r = records[e.index];
+    Entity moved = r.archetype->remove(r.position);
+    if(moved.index != e.index) {
+      records[moved.index].position = r.position;
+    }
+    r.archetype = nullptr;
+    ++r.generation;
+    freeIndices.push_back(e.index);
+    --entityCount;
+  }
+
+  void destroyMany(const std::vector<Entity>& entities) {
+    for(const Entity& e : entities) {
+      destroy(e);
+    }
+  }
+
+  bool isAlive(Entity e) const {
+    return e.index < records.size() && records[e.index].generation == e.generation &&
+      records[e.index].archetype != nullptr;
+  }
+
+  template<class C>
+  C * get(Entity e) {
+    //Null if the entity is destroyed or has no component C. The pointer is valid until the next
+    //entity of the same archetype is destroyed.
+    if( !isAlive(e) ) {
+      return nullptr;
+    }
+    const Record& r = records[e.index];
+    if( !r.archetype->has( getComponentId<C>() ) ) {
+      return nullptr;
+    }
+    return r.archetype->getComponent<C>(r.position);
+  }
+
+  template<class... C, class F>
+  void forEachChunk(F function) {
+    //Calls function(count,C*...) for every chunk of every archetype with all components C, with
+    //the arrays of the chunk. This is the loop for SIMD code.
+    uint64_t mask = getMask<C...>();
+    for(const auto& a : archetypes) {
+      if( (a->mask & mask) != mask ) {
+        continue;
+      }
+      for(size_t c = 0; c < a->chunks.size(); ++c) {
+        size_t count = a->getChunkCount(c);
+        if(count == 0) {
+          break;
+        }
+        function( count,a->getArray<C>(c)... );
+      }
+    }
+  }
+
+  template<class... C, class F>
+  void forEach(F function) {
+    //Calls function(C&...) for every entity with all components C.
+    forEachChunk<C...>( [&function](size_t count, C *... arrays) {
+      for(size_t i = 0; i < count; ++i) {
+        function(arrays[i]...);
+      }
+    });
+  }
+
+  size_t size() const {
+    return entityCount;
+  }
+
+  size_t getArchetypeCount() const {
+    return archetypes.size();
+  }
+
+  template<class C>
+  static unsigned int getComponentId() {
+    static_assert(std::is_trivially_copyable<C>::value,"Components must be trivially copyable");
+    static_assert(alignof(C) <= CHUNK_ALIGNMENT,"Components may be aligned to 16 bytes at most");
+    static const unsigned int id = registerComponent( sizeof(C) );
+    return id;
+  }
+
+ private:
+  static constexpr size_t CHUNK_ALIGNMENT = 16;
+
+  class Archetype {
+   public:
+    uint64_t mask;
+    size_t capacity; //Entities per chunk.
+    size_t count{0};
+    std::vector<unsigned int> components;
+    size_t offsets[MAX_COMPONENT_TYPES]{}; //Of the array of a component within a chunk.
+    size_t sizes[MAX_COMPONENT_TYPES]{};
+    std::vector< std::unique_ptr<unsigned char[]> > chunks;
+
+    explicit Archetype(uint64_t mask) : mask(mask) {
+      size_t bytesPerEntity = sizeof(Entity);
+      for(unsigned int id = 0; id < MAX_COMPONENT_TYPES; ++id) {
+        if( mask & (uint64_t(1) << id) ) {
+          components.push_back(id);
+          sizes[id] = getComponentSize(id);
+          bytesPerEntity += sizes[id];
+        }
+      }
+      //Every array starts at a multiple of CHUNK_ALIGNMENT, which costs at most that much each.
+      size_t padding = CHUNK_ALIGNMENT*(components.size() + 1);
+      capacity = CHUNK_BYTES > padding + bytesPerEntity ?
+        (CHUNK_BYTES - padding)/bytesPerEntity : 1;
+      size_t offset = align(sizeof(Entity)*capacity);
+      for(unsigned int id : components) {
+        offsets[id] = offset;
+        offset = align(offset + sizes[id]*capacity);
+      }
+      chunkBytes = std::max( offset,(size_t) CHUNK_BYTES );
+    }
+
+    bool has(unsigned int id) const {
+      return (mask >> id) & 1;
+    }
+
+    template<class C>
+    C * getArray(size_t chunk) {
+      return reinterpret_cast<C *>( chunks[chunk].get() + offsets[getComponentId<C>()] );
+    }
+
+    template<class C>
+    C * getComponent(size_t position) {
+      return getArray<C>(position/capacity) + position % capacity;
+    }
+
+    Entity * getEntities(size_t chunk) {
+      return reinterpret_cast<Entity *>( chunks[chunk].get() );
+    }
+
+    size_t getChunkCount(size_t chunk) const {
+      size_t begin = chunk*capacity;
+      return count > begin ? std::min(count - begin,capacity) : 0;
+    }
+
+    void reserve(size_t n) {
+      while(chunks.size()*capacity < n) {
+        //new[] of unsigned char is aligned to alignof(std::max_align_t), at least 16 on the
+        //platforms of this program.
+        chunks.emplace_back( new unsigned char[chunkBytes] );
+      }
+    }
+
+    size_t add(Entity e) {
+      reserve(count + 1);
+      size_t position = count++;
+      size_t chunk = position/capacity, row = position % capacity;
+      new ( getEntities(chunk) + row ) Entity(e); //The caller constructs the components.
+      return position;
+    }
+
+    Entity remove(size_t position) {
+      //Moves the last entity to position and returns it.
+      size_t last = --count;
+      size_t chunk = position/capacity, row = position % capacity;
+      size_t lastChunk = last/capacity, lastRow = last % capacity;
+      Entity moved = getEntities(lastChunk)[lastRow];
+      if(position != last) {
+        getEntities(chunk)[row] = moved;
+        for(unsigned int id : components) {
+          std::memcpy(chunks[chunk].get() + offsets[id] + row*sizes[id],
+            chunks[lastChunk].get() + offsets[id] + lastRow*sizes[id],sizes[id]
+          );
+        }
+      }
+      return moved;
+    }
+
+   private:
+    size_t chunkBytes{CHUNK_BYTES};
+
+    static size_t align(size_t n) {
+      return (n + CHUNK_ALIGNMENT - 1)/CHUNK_ALIGNMENT*CHUNK_ALIGNMENT;
+    }
+  };
+
+  class Record {
+   public:
+    Archetype * archetype{nullptr};
+    size_t position{0};
+    uint32_t generation{0};
+  };
+
+  std::vector< std::unique_ptr<Archetype> > archetypes;
+  std::unordered_map<uint64_t,Archetype *> archetypesByMask;
+  std::vector<Record> records;
+  std::vector<uint32_t> freeIndices;
+  size_t entityCount{0};
+
+  template<class... C>
+  static uint64_t getMask() {
+    uint64_t mask = 0;
+    int unused[] = { 0,( mask |= uint64_t(1) << getComponentId<C>(), 0 )... };
+    (void) unused;
+    return mask;
+  }
+
+  template<class... C>
+  Archetype& getArchetype() {
+    static_assert(sizeof...(C) > 0,"An entity needs at least one component");
+    uint64_t mask = getMask<C...>();
+    auto it = archetypesByMask.find(mask);
+    if( it != archetypesByMask.end() ) {
+      return *it->second;
+    }
+    archetypes.emplace_back( new Archetype(mask) );
+    archetypesByMask[mask] = archetypes.back().get();
+    return *archetypes.back();
+  }
+
+  Entity allocateEntity(Archetype& a) {
+    Entity e;
+    if( freeIndices.empty() ) {
+      e.index = (uint32_t) records.size();
+      records.emplace_back();
+    }
+    else {
+      e.index = freeIndices.back();
+      freeIndices.pop_back();
+    }
+    Record& r = records[e.index];
+    e.generation = r.generation;
+    r.archetype = &a;
+    r.position = a.add(e);
+    ++entityCount;
+    return e;
+  }
+
+  static std::vector<size_t>& getComponentSizes() {
+    static std::vector<size_t> sizes;
+    return sizes;
+  }
+
+  static std::mutex& getRegistryMutex() {
+    static std::mutex mutex;
+    return mutex;
+  }
+
+  static unsigned int registerComponent(size_t size) {
+    std::lock_guard<std::mutex> lock( getRegistryMutex() );
+    std::vector<size_t>& sizes = getComponentSizes();
+    if(sizes.size() == MAX_COMPONENT_TYPES) {
+      throw std::length_error("EntityStore: too many component types");
+    }
+    sizes.push_back(size);
+    return (unsigned int) sizes.size() - 1;
+  }
+
+  static size_t getComponentSize(unsigned int id) {
+    std::lock_guard<std::mutex> lock( getRegistryMutex() );
+    return getComponentSizes()[id];
+  }
+};
+
+}
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+  #include <emmintrin.h>
+  #define PROJECTNAME_FLOAT4_SSE
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  #include <arm_neon.h>
+  #define PROJECTNAME_FLOAT4_NEON
+#endif
+
+namespace ProjectName {
+
+class Float4 {
+  //Four floats in one SSE2 or NEON register, or in an array on other processors, for the
+  //arithmetic of kernels that process arrays four elements at a time. Loads and stores do not
+  //need aligned addresses. 32-bit ARM has no NEON division or square root, so reciprocal() and
+  //reciprocalSqrt() refine the estimates of the hardware there, to about 1e-6 relative error.
+ public:
+#if defined(PROJECTNAME_FLOAT4_SSE)
+  __m128 v;
+
+  static Float4 load(const float * p) {
+    return Float4{ _mm_loadu_ps(p) };
+  }
+
+  static Float4 broadcast(float f) {
+    return Float4{ _mm_set1_ps(f) };
+  }
+
+  void store(float * p) const {
+    _mm_storeu_ps(p,v);
+  }
+
+  friend Float4 operator+(Float4 a, Float4 b) {
+    return Float4{ _mm_add_ps(a.v,b.v) };
+  }
+
+  friend Float4 operator-(Float4 a, Float4 b) {
+    return Float4{ _mm_sub_ps(a.v,b.v) };
+  }
+
+  friend Float4 operator*(Float4 a, Float4 b) {
+    return Float4{ _mm_mul_ps(a.v,b.v) };
+  }
+
+  static Float4 min(Float4 a, Float4 b) {
+    return Float4{ _mm_min_ps(a.v,b.v) };
+  }
+
+  static Float4 max(Float4 a, Float4 b) {
+    return Float4{ _mm_max_ps(a.v,b.v) };
+  }
+
+  Float4 reciprocal() const {
+    return Float4{ _mm_div_ps(_mm_set1_ps(1),v) };
+  }
+
+  Float4 reciprocalSqrt() const {
+    return Float4{ _mm_div_ps( _mm_set1_ps(1),_mm_sqrt_ps(v) ) };
+  }
+#elif defined(PROJECTNAME_FLOAT4_NEON)
+  float32x4_t v;
+
+  static Float4 load(const float * p) {
+    return Float4{ vld1q_f32(p) };
+  }
+
+  static Float4 broadcast(float f) {
+    return Float4{ vdupq_n_f32(f) };
+  }
+
+  void store(float * p) const {
+    vst1q_f32(p,v);
+  }
+
+  friend Float4 operator+(Float4 a, Float4 b) {
+    return Float4{ vaddq_f32(a.v,b.v) };
+  }
+
+  friend Float4 operator-(Float4 a, Float4 b) {
+    return Float4{ vsubq_f32(a.v,b.v) };
+  }
+
+  friend Float4 operator*(Float4 a, Float4 b) {
+    return Float4{ vmulq_f32(a.v,b.v) };
+  }
+
+  static Float4 min(Float4 a, Float4 b) {
+    return Float4{ vminq_f32(a.v,b.v) };
+  }
+
+  static Float4 max(Float4 a, Float4 b) {
+    return Float4{ vmaxq_f32(a.v,b.v) };
+  }
+
+#if defined(__aarch64__)
+  Float4 reciprocal() const {
+    return Float4{ vdivq_f32(vdupq_n_f32(1),v) };
+  }
+
+  Float4 reciprocalSqrt() const {
+    return Float4{ vdivq_f32( vdupq_n_f32(1),vsqrtq_f32(v) ) };
+  }
+#else
+  Float4 reciprocal() const {
+    //Two Newton-Raphson steps.
+    float32x4_t r = vrecpeq_f32(v);
+    r = vmulq_f32( vrecpsq_f32(v,r),r );
+    return Float4{ vmulq_f32( vrecpsq_f32(v,r),r ) };
+  }
+
+  Float4 reciprocalSqrt() const {
+    float32x4_t r = vrsqrteq_f32(v);
+    r = vmulq_f32( vrsqrtsq_f32( vmulq_f32(v,r),r ),r );
+    return Float4{ vmulq_f32( vrsqrtsq_f32( vmulq_f32(v,r),r ),r ) };
+  }
+#endif
+#else
+  float v[4];
+
+  static Float4 load(const float * p) {
+    return Float4{ {p[0],p[1],p[2],p[3]} };
+  }
+
+  static Float4 broadcast(float f) {
+    return Float4{ {f,f,f,f} };
+  }
+
+  void store(float * p) const {
+    for(int i = 0; i < 4; ++i) {
+      p[i] = v[i];
+    }
+  }
+
+  friend Float4 operator+(Float4 a, Float4 b) {
+    return Float4{ {a.v[0] + b.v[0],a.v[1] + b.v[1],a.v[2] + b.v[2],a.v[3] + b.v[3]} };
+  }
+
+  friend Float4 operator-(Float4 a, Float4 b) {
+    return Float4{ {a.v[0] - b.v[0],a.v[1] - b.v[1],a.v[2] - b.v[2],a.v[3] - b.v[3]} };
+  }
+
+  friend Float4 operator*(Float4 a, Float4 b) {
+    return Float4{ {a.v[0]*b.v[0],a.v[1]*b.v[1],a.v[2]*b.v[2],a.v[3]*b.v[3]} };
+  }
+
+  static Float4 min(Float4 a, Float4 b) {
+    Float4 r;
+    for(int i = 0; i < 4; ++i) {
+      r.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i];
+    }
+    return r;
+  }
+
+  static Float4 max(Float4 a, Float4 b) {
+    Float4 r;
+    for(int i = 0; i < 4; ++i) {
+      r.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i];
+    }
+    return r;
+  }
+
+  Float4 reciprocal() const {
+    return Float4{ {1/v[0],1/v[1],1/v[2],1/v[3]} };
+  }
+
+  Float4 reciprocalSqrt() const {
+    Float4 r;
+    for(int i = 0; i < 4; ++i) {
+      r.v[i] = 1/std::sqrt(v[i]);
+    }
+    return r;
+  }
+#endif
+
+  Float4& operator+=(Float4 b) {
+    return *this = *this + b;
+  }
+};
+
+}
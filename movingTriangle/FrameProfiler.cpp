@@ -0,0 +1,352 @@
+#include "FrameProfiler.h"
+#include "GLExtensions.h"
+#include "Logger.h"
+
+#include <glad/glad.h>
+
+#include <chrono>
+
+namespace ProjectName {
+
+namespace {
+
+//GL_EXT_disjoint_timer_query
+constexpr GLenum QUERY_COUNTER_BITS = 0x8864;
+constexpr GLenum QUERY_RESULT = 0x8866;
+constexpr GLenum QUERY_RESULT_AVAILABLE = 0x8867;
+constexpr GLenum TIME_ELAPSED = 0x88BF;
+constexpr GLenum TIMESTAMP = 0x8E28;
+constexpr GLenum GPU_DISJOINT = 0x8FBB;
+
+using GenQueries = void (APIENTRYP)(GLsizei n, GLuint * ids);
+using DeleteQueries = void (APIENTRYP)(GLsizei n, const GLuint * ids);
+using BeginQuery = void (APIENTRYP)(GLenum target, GLuint id);
+using EndQuery = void (APIENTRYP)(GLenum target);
+using QueryCounter = void (APIENTRYP)(GLuint id, GLenum target);
+using GetQueryiv = void (APIENTRYP)(GLenum target, GLenum pname, GLint * params);
+using GetQueryObjectuiv = void (APIENTRYP)(GLuint id, GLenum pname, GLuint * params);
+using GetQueryObjectui64v = void (APIENTRYP)(GLuint id, GLenum pname, GLuint64 * params);
+
+using Clock = std::chrono::steady_clock;
+
+double toMilliseconds(Clock::duration d) {
+  return std::chrono::duration<double,std::milli>(d).count();
+}
+
+}
+
+class FrameProfiler::I {
+ public:
+  void initialize() {
+    mode = Mode::CPU_ONLY;
+    if( !GLExtensions::has("GL_EXT_disjoint_timer_query") ) {
+      LOG_INFO("GL_EXT_disjoint_timer_query is not available; profiling the CPU only.\n");
+      return;
+    }
+    bool loaded = GLExtensions::load(genQueries,"glGenQueriesEXT")
+      && GLExtensions::load(deleteQueries,"glDeleteQueriesEXT")
+      && GLExtensions::load(beginQuery,"glBeginQueryEXT")
+      && GLExtensions::load(endQuery,"glEndQueryEXT")
+      && GLExtensions::load(getQueryObjectuiv,"glGetQueryObjectuivEXT")
+      && GLExtensions::load(getQueryObjectui64v,"glGetQueryObjectui64vEXT");
+    if(!loaded) {
+      LOG_WARNING("Could not load the functions of GL_EXT_disjoint_timer_query.\n");
+      return;
+    }
+
+    //Some drivers expose the extension without a timestamp counter.
+    GLint timestampBits = 0;
+    if( GLExtensions::load(queryCounter,"glQueryCounterEXT")
+      && GLExtensions::load(getQueryiv,"glGetQueryivEXT") )
+    {
+      getQueryiv(TIMESTAMP,QUERY_COUNTER_BITS,&timestampBits);
+    }
+    mode = timestampBits > 0 ? Mode::TIMESTAMP : Mode::ELAPSED;
+    LOG_INFO( "GPU timing uses %s queries.\n",
+      mode == Mode::TIMESTAMP ? "timestamp" : "elapsed time"
+    );
+  }
+
+  void releaseGPUResources() {
+    for(PendingFrame& f : frames) {
+      if( !f.queries.empty() && deleteQueries != nullptr ) {
+        deleteQueries( (GLsizei) f.queries.size(),f.queries.data() );
+      }
+      f.queries.clear();
+      f.queriesUsed = 0;
+    }
+    mode = Mode::CPU_ONLY;
+  }
+
+  bool hasGPUTimers() const {
+    return mode != Mode::CPU_ONLY;
+  }
+
+  void beginFrame() {
+    resolveAvailableFrames();
+    if(submitted - resolved == PENDING_FRAMES) { //The slot of this frame is still in use.
+      publish(getFrame(resolved),false);
+      ++dropped;
+      ++resolved;
+    }
+
+    PendingFrame& f = getFrame(submitted);
+    f.frameNumber = submitted;
+    f.scopes.clear();
+    f.queriesUsed = 0;
+    f.gpuValid = hasGPUTimers();
+    open.clear();
+    elapsedQueryActive = false;
+    frameStart = Clock::now();
+  }
+
+  void endFrame() {
+    PendingFrame& f = getFrame(submitted);
+    while( !open.empty() ) {
+      endScope();
+    }
+    f.cpuMilliseconds = toMilliseconds(Clock::now() - frameStart);
+    ++submitted;
+  }
+
+  void beginScope(const char * name) {
+    PendingFrame& f = getFrame(submitted);
+    PendingScope s;
+    s.name = name;
+    s.depth = (unsigned char) open.size();
+    s.beginQuery = s.endQuery = NO_QUERY;
+
+    if(mode == Mode::TIMESTAMP) {
+      s.beginQuery = takeQuery(f);
+      queryCounter(f.queries[s.beginQuery],TIMESTAMP);
+    }
+    else if(mode == Mode::ELAPSED && !elapsedQueryActive) {
+      s.beginQuery = takeQuery(f);
+      beginQuery(TIME_ELAPSED,f.queries[s.beginQuery]);
+      elapsedQueryActive = true;
+    }
+
+    open.push_back( f.scopes.size() );
+    f.scopes.push_back(s);
+    f.scopes.back().cpuStart = Clock::now();
+  }
+
+  void endScope() {
+    if( open.empty() ) {
+      return;
+    }
+    PendingFrame& f = getFrame(submitted);
+    PendingScope& s = f.scopes[open.back()];
+    open.pop_back();
+    s.cpuMilliseconds = toMilliseconds(Clock::now() - s.cpuStart);
+
+    if(mode == Mode::TIMESTAMP) {
+      s.endQuery = takeQuery(f);
+      queryCounter(f.queries[s.endQuery],TIMESTAMP);
+    }
+    else if(mode == Mode::ELAPSED && s.beginQuery != NO_QUERY) {
+      endQuery(TIME_ELAPSED);
+      elapsedQueryActive = false;
+    }
+  }
+
+  const FrameProfile& getLatestProfile() const {
+    return latest;
+  }
+
+  unsigned long getDroppedGPUFrameCount() const {
+    return dropped;
+  }
+
+ private:
+  enum class Mode { CPU_ONLY, ELAPSED, TIMESTAMP };
+
+  static constexpr size_t NO_QUERY = ~(size_t) 0;
+  static constexpr size_t QUERY_ALLOCATION = 16;
+
+  class PendingScope {
+   public:
+    const char * name;
+    unsigned char depth;
+    Clock::time_point cpuStart;
+    double cpuMilliseconds{0};
+    size_t beginQuery, endQuery; //Indices in PendingFrame::queries.
+  };
+
+  class PendingFrame {
+   public:
+    unsigned long frameNumber{0};
+    double cpuMilliseconds{0};
+    bool gpuValid{false};
+    std::vector<PendingScope> scopes;
+    std::vector<GLuint> queries; //Kept from frame to frame.
+    size_t queriesUsed{0};
+  };
+
+  Mode mode{Mode::CPU_ONLY};
+  GenQueries genQueries{nullptr};
+  DeleteQueries deleteQueries{nullptr};
+  BeginQuery beginQuery{nullptr};
+  EndQuery endQuery{nullptr};
+  QueryCounter queryCounter{nullptr};
+  GetQueryiv getQueryiv{nullptr};
+  GetQueryObjectuiv getQueryObjectuiv{nullptr};
+  GetQueryObjectui64v getQueryObjectui64v{nullptr};
+
+  PendingFrame frames[PENDING_FRAMES];
+  unsigned long submitted{0}; //Frames that have ended.
+  unsigned long resolved{0}; //Frames whose profile has been published.
+  unsigned long dropped{0};
+  std::vector<size_t> open; //Indices of the scopes that have begun but not ended.
+  bool elapsedQueryActive{false};
+  Clock::time_point frameStart;
+  FrameProfile latest;
+
+  PendingFrame& getFrame(unsigned long frameNumber) {
+    return frames[frameNumber % PENDING_FRAMES];
+  }
+
+  size_t takeQuery(PendingFrame& f) {
+    if( f.queriesUsed == f.queries.size() ) {
+      size_t oldSize = f.queries.size();
+      f.queries.resize(oldSize + QUERY_ALLOCATION);
+      genQueries( (GLsizei) QUERY_ALLOCATION,&f.queries[oldSize] );
+    }
+    return f.queriesUsed++;
+  }
+
+  void resolveAvailableFrames() {
+    if( hasGPUTimers() ) {
+      //A disjoint timer makes every result that has not been read meaningless.
+      GLint disjoint = 0;
+      glGetIntegerv(GPU_DISJOINT,&disjoint);
+      if(disjoint) {
+        for(unsigned long n = resolved; n < submitted; ++n) {
+          getFrame(n).gpuValid = false;
+        }
+      }
+    }
+
+    while(resolved < submitted) {
+      PendingFrame& f = getFrame(resolved);
+      if( f.gpuValid && f.queriesUsed > 0 ) {
+        //Queries finish in order, so the last one decides.
+        GLuint available = GL_FALSE;
+        getQueryObjectuiv(f.queries[f.queriesUsed - 1],QUERY_RESULT_AVAILABLE,&available);
+        if(!available) {
+          return;
+        }
+      }
+      if(!f.gpuValid && hasGPUTimers()) {
+        ++dropped;
+      }
+      publish(f,f.gpuValid);
+      ++resolved;
+    }
+  }
+
+  void publish(const PendingFrame& f, bool readGPU) {
+    latest.frameNumber = f.frameNumber;
+    latest.cpuMilliseconds = f.cpuMilliseconds;
+    latest.gpuMilliseconds = 0;
+    latest.hasGPUTime = false;
+    latest.scopes.clear();
+
+    for(const PendingScope& s : f.scopes) {
+      ScopeTiming t{ s.name,s.depth,s.cpuMilliseconds,0.0,false };
+      if(readGPU && s.beginQuery != NO_QUERY) {
+        t.gpuMilliseconds = readGPUMilliseconds(f,s);
+        t.hasGPUTime = true;
+        if(s.depth == 0) {
+          latest.gpuMilliseconds += t.gpuMilliseconds;
+          latest.hasGPUTime = true;
+        }
+      }
+      latest.scopes.push_back(t);
+    }
+  }
+
+  double readGPUMilliseconds(const PendingFrame& f, const PendingScope& s) {
+    GLuint64 begin = 0, end = 0;
+    getQueryObjectui64v(f.queries[s.beginQuery],QUERY_RESULT,&begin);
+    if(mode == Mode::ELAPSED) {
+      return begin/1e6;
+    }
+    getQueryObjectui64v(f.queries[s.endQuery],QUERY_RESULT,&end);
+    return end > begin ? (end - begin)/1e6 : 0.0;
+  }
+};
+
+constexpr unsigned int FrameProfiler::PENDING_FRAMES;
+constexpr size_t FrameProfiler::I::NO_QUERY;
+constexpr size_t FrameProfiler::I::QUERY_ALLOCATION;
+
+FrameProfiler::FrameProfiler() {
+  imp = std::unique_ptr<I>( new I() );
+}
+
+FrameProfiler::~FrameProfiler() = default;
+
+void FrameProfiler::initialize() {
+  imp->initialize();
+}
+
+void FrameProfiler::releaseGPUResources() {
+  imp->releaseGPUResources();
+}
+
+bool FrameProfiler::hasGPUTimers() const {
+  return imp->hasGPUTimers();
+}
+
+void FrameProfiler::beginFrame() {
+  imp->beginFrame();
+}
+
+void FrameProfiler::endFrame() {
+  imp->endFrame();
+}
+
+void FrameProfiler::beginScope(const char * name) {
+  imp->beginScope(name);
+}
+
+void FrameProfiler::endScope() {
+  imp->endScope();
+}
+
+const FrameProfile& FrameProfiler::getLatestProfile() const {
+  return imp->getLatestProfile();
+}
+
+unsigned long FrameProfiler::getDroppedGPUFrameCount() const {
+  return imp->getDroppedGPUFrameCount();
+}
+
+void FrameProfiler::logLatestProfile() const {
+  const FrameProfile& p = getLatestProfile();
+  if(p.hasGPUTime) {
+    LOG_INFO("Frame %lu: CPU %.3f ms, GPU %.3f ms\n",p.frameNumber,p.cpuMilliseconds,
+      p.gpuMilliseconds
+    );
+  }
+  else {
+    LOG_INFO("Frame %lu: CPU %.3f ms, GPU unknown\n",p.frameNumber,p.cpuMilliseconds);
+  }
+  const char * spaces = "                ";
+  const unsigned int MAX_INDENT = 16;
+  for(const ScopeTiming& s : p.scopes) {
+    unsigned int indent = 2u*s.depth + 2 < MAX_INDENT ? 2u*s.depth + 2 : MAX_INDENT;
+    const char * indentation = spaces + (MAX_INDENT - indent);
+    if(s.hasGPUTime) {
+      LOG_VERBOSE("%s%s: CPU %.3f ms, GPU %.3f ms\n",indentation,s.name,s.cpuMilliseconds,
+        s.gpuMilliseconds
+      );
+    }
+    else {
+      LOG_VERBOSE("%s%s: CPU %.3f ms\n",indentation,s.name,s.cpuMilliseconds);
+    }
+  }
+}
+
+}
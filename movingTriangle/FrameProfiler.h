@@ -0,0 +1,87 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+namespace ProjectName {
+
+class ScopeTiming {
+ public:
+  const char * name;
+  unsigned char depth; //0 for the outermost scopes of a frame.
+  double cpuMilliseconds;
+  double gpuMilliseconds;
+  bool hasGPUTime;
+};
+
+class FrameProfile {
+ public:
+  unsigned long frameNumber{0};
+  double cpuMilliseconds{0}; //From beginFrame to endFrame.
+  double gpuMilliseconds{0}; //The sum of the outermost scopes that have a GPU time.
+  bool hasGPUTime{false};
+  std::vector<ScopeTiming> scopes; //In the order in which the scopes began.
+};
+
+class FrameProfiler {
+  //Measures named scopes of the render thread on the CPU and, with GL_EXT_disjoint_timer_query,
+  //on the GPU. GPU results arrive a few frames late: the queries of a frame are only read when
+  //they are available, so the render thread never waits for the GPU, and getLatestProfile
+  //returns the newest frame whose results are complete. If the GPU falls PENDING_FRAMES frames
+  //behind, the GPU times of the oldest frame are dropped instead of waiting.
+  //Without the extension, for instance on llvmpipe, the profiles have CPU times only. Timestamp
+  //queries time nested scopes too; drivers that only have GL_TIME_ELAPSED_EXT time the outermost
+  //scopes, because those queries cannot be nested. All methods must be called on the render
+  //thread, and the names must be string literals.
+ public:
+  static constexpr unsigned int PENDING_FRAMES = 4;
+
+  class Scope {
+   public:
+    Scope(FrameProfiler& profiler, const char * name) : profiler(profiler) {
+      profiler.beginScope(name);
+    }
+
+    ~Scope() {
+      profiler.endScope();
+    }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+   private:
+    FrameProfiler& profiler;
+  };
+
+  FrameProfiler();
+  ~FrameProfiler();
+
+  void initialize();
+  //Requires a current OpenGL context and loaded functions.
+
+  void releaseGPUResources();
+  //Deletes the query objects; call before the context is destroyed.
+
+  bool hasGPUTimers() const;
+
+  void beginFrame();
+  void endFrame();
+
+  void beginScope(const char * name);
+  void endScope();
+
+  const FrameProfile& getLatestProfile() const;
+
+  unsigned long getDroppedGPUFrameCount() const;
+  //Frames whose GPU times were lost, because the GPU was too far behind or the timer was
+  //disjoint (for instance after a change of the GPU frequency).
+
+  void logLatestProfile() const;
+  //Writes the times of the latest frame with LOG_INFO, and those of its scopes with LOG_VERBOSE.
+
+ private:
+  class I;
+  std::unique_ptr<I> imp;
+};
+
+}
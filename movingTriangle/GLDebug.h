@@ -0,0 +1,117 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include "GLExtensions.h"
+#include "Logger.h"
+
+//GL_CHECK(call) checks glGetError after call when PROJECTNAME_GL_DEBUG is defined, which meson
+//does for the debug build types, and reports the call, file and line. Otherwise it is just call,
+//because glGetError is a synchronization point on many drivers. It works for calls with a
+//result as well:
+//  GLint location = GL_CHECK( glGetUniformLocation(program,"theMatrix") );
+#ifdef PROJECTNAME_GL_DEBUG
+  #define GL_CHECK(call) ( ProjectName::GLErrorCheck(#call,__FILE__,__LINE__), (call) )
+#else
+  #define GL_CHECK(call) (call)
+#endif
+
+namespace ProjectName {
+
+class GLDebug {
+ public:
+  static const char * getErrorName(GLenum error) {
+    switch(error) {
+      case GL_NO_ERROR: return "No error";
+      case GL_INVALID_ENUM: return "Invalid enum";
+      case GL_INVALID_VALUE: return "Invalid value";
+      case GL_INVALID_OPERATION: return "Invalid operation";
+      case GL_INVALID_FRAMEBUFFER_OPERATION: return "Invalid framebuffer operation";
+      case GL_OUT_OF_MEMORY: return "Out of memory";
+      default: return "Unknown error";
+    }
+  }
+
+  static unsigned int logErrors(const char * where, const char * file = "", int line = 0) {
+    //An implementation can record several errors; glGetError returns and clears one at a time.
+    unsigned int count = 0;
+    for(GLenum error = glGetError(); error != GL_NO_ERROR; error = glGetError()) {
+      LOG_ERROR("OpenGL error: %s (0x%x) at %s:%d in %s\n",getErrorName(error),error,file,line,
+        where
+      );
+      if(++count == MAX_ERRORS_PER_CHECK) { //A lost context keeps returning errors.
+        break;
+      }
+    }
+    return count;
+  }
+
+  static bool installMessageCallback() {
+    //GL_KHR_debug reports errors with a description, and also performance warnings. Returns
+    //false if the driver does not have the extension.
+    if( !GLExtensions::has("GL_KHR_debug") ) {
+      LOG_INFO("GL_KHR_debug is not available; only glGetError is used.\n");
+      return false;
+    }
+    PFNGLDEBUGMESSAGECALLBACKKHRPROC debugMessageCallback;
+    if( !GLExtensions::load(debugMessageCallback,"glDebugMessageCallbackKHR") ) {
+      return false;
+    }
+    //Synchronous output makes the callback run inside the offending call, on the render thread.
+    glEnable(DEBUG_OUTPUT_SYNCHRONOUS);
+    glEnable(DEBUG_OUTPUT);
+    debugMessageCallback(&messageCallback,nullptr);
+    LOG_INFO("Installed the GL_KHR_debug message callback.\n");
+    return true;
+  }
+
+ private:
+  static constexpr unsigned int MAX_ERRORS_PER_CHECK = 8;
+
+  static constexpr GLenum DEBUG_OUTPUT = 0x92E0; //GL_DEBUG_OUTPUT_KHR
+  static constexpr GLenum DEBUG_OUTPUT_SYNCHRONOUS = 0x8242; //GL_DEBUG_OUTPUT_SYNCHRONOUS_KHR
+  static constexpr GLenum DEBUG_SEVERITY_HIGH = 0x9146;
+  static constexpr GLenum DEBUG_SEVERITY_MEDIUM = 0x9147;
+  static constexpr GLenum DEBUG_SEVERITY_LOW = 0x9148;
+
+  using PFNGLDEBUGMESSAGECALLBACKKHRPROC = void (APIENTRYP)(GLDEBUGPROCKHR callback,
+    const void * userParam
+  );
+
+  static void APIENTRY messageCallback(GLenum, GLenum, GLuint id, GLenum severity, GLsizei,
+    const GLchar * message, const void *)
+  {
+    switch(severity) {
+      case DEBUG_SEVERITY_HIGH: LOG_ERROR("OpenGL debug %u: %s\n",id,message); break;
+      case DEBUG_SEVERITY_MEDIUM: LOG_WARNING("OpenGL debug %u: %s\n",id,message); break;
+      case DEBUG_SEVERITY_LOW: LOG_INFO("OpenGL debug %u: %s\n",id,message); break;
+      default: LOG_VERBOSE("OpenGL debug %u: %s\n",id,message); break;
+    }
+  }
+};
+
+class GLErrorCheck {
+  //The temporary that GL_CHECK creates. It is destroyed at the end of the full expression, so
+  //after the call it guards. Errors that were already pending are reported separately, so that
+  //they are not blamed on this call.
+ public:
+  GLErrorCheck(const char * call, const char * file, int line) : call(call), file(file),
+    line(line)
+  {
+    GLDebug::logErrors("an earlier call (found by GL_CHECK)",file,line);
+  }
+
+  ~GLErrorCheck() {
+    GLDebug::logErrors(call,file,line);
+  }
+
+  GLErrorCheck(const GLErrorCheck&) = delete;
+  GLErrorCheck& operator=(const GLErrorCheck&) = delete;
+
+ private:
+  const char * call;
+  const char * file;
+  int line;
+};
+
+}
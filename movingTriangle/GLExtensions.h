@@ -0,0 +1,178 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <string>
+#include <cstring>
+
+namespace ProjectName {
+
+using GenVertexArrays = void (APIENTRYP)(GLsizei n, GLuint * arrays);
+using BindVertexArray = void (APIENTRYP)(GLuint array);
+using DeleteVertexArrays = void (APIENTRYP)(GLsizei n, const GLuint * arrays);
+using InvalidateFramebuffer = void (APIENTRYP)(GLenum target, GLsizei count,
+  const GLenum * attachments
+); //glInvalidateFramebuffer and glDiscardFramebufferEXT.
+
+class VertexArrayFunctions {
+  //Of OpenGL ES 3.0 or GL_OES_vertex_array_object; all null when neither is available.
+ public:
+  GenVertexArrays genVertexArrays{nullptr};
+  BindVertexArray bindVertexArray{nullptr};
+  DeleteVertexArrays deleteVertexArrays{nullptr};
+};
+
+class GLExtensions {
+  //The glad loader in this tree only loads OpenGL ES 2.0 itself. This class answers whether an
+  //extension is present and loads extension functions with the loader that GLWindow has used
+  //for glad. All methods require a current OpenGL context.
+ public:
+  static void setLoader(GLADloadproc loader) {
+    getLoader() = loader;
+    getCachedExtensionString().clear();
+    getCachedVertexArrayFunctions().loaded = false;
+    getCachedInvalidateFramebuffer().loaded = false;
+  }
+
+  static bool has(const char * name) {
+    const std::string& extensions = getExtensionString();
+    size_t length = std::strlen(name);
+    size_t position = 0;
+    while( (position = extensions.find(name,position)) != std::string::npos ) {
+      //Avoid matching a prefix, for instance GL_OES_texture_float in GL_OES_texture_float_linear.
+      bool startsWord = position == 0 || extensions[position-1] == ' ';
+      bool endsWord = position + length == extensions.size() || extensions[position+length] == ' ';
+      if(startsWord && endsWord) {
+        return true;
+      }
+      position += length;
+    }
+    return false;
+  }
+
+  static void disableExtensionFunctions() {
+    //From now on nothing is loaded, so only the OpenGL ES 2.0 functions of glad are called:
+    //vertex arrays are emulated, and framebuffers are not invalidated. GLTrace needs this,
+    //because it can only record the functions of glad. Functions loaded before stay valid.
+    getExtensionFunctionsDisabled() = true;
+    getCachedVertexArrayFunctions().loaded = false;
+    getCachedInvalidateFramebuffer().loaded = false;
+  }
+
+  static void * getProcAddress(const char * name) {
+    if(getLoader() == nullptr || getExtensionFunctionsDisabled()) {
+      return nullptr;
+    }
+    return getLoader()(name);
+  }
+
+  template<class FunctionPointer>
+  static bool load(FunctionPointer& f, const char * name) {
+    f = reinterpret_cast<FunctionPointer>( getProcAddress(name) );
+    return f != nullptr;
+  }
+
+  static int getMajorVersion() {
+    //glGetString(GL_VERSION) has the form "OpenGL ES N.M ...".
+    const char * version = (const char *) glGetString(GL_VERSION);
+    const char * prefix = "OpenGL ES ";
+    if( version == nullptr || std::strncmp(version,prefix,std::strlen(prefix)) != 0 ) {
+      return 2;
+    }
+    return version[ std::strlen(prefix) ] - '0';
+  }
+
+  static const VertexArrayFunctions& getVertexArrayFunctions() {
+    //Loaded on the first call. Vertex array objects are core in OpenGL ES 3.0; OpenGL ES 2.0
+    //has them with the OES suffix if the extension is present.
+    CachedVertexArrayFunctions& c = getCachedVertexArrayFunctions();
+    if(c.loaded) {
+      return c.functions;
+    }
+    c.loaded = true;
+    VertexArrayFunctions& f = c.functions;
+    const char * suffix = nullptr;
+    if(getMajorVersion() >= 3) {
+      suffix = "";
+    }
+    else if( has("GL_OES_vertex_array_object") ) {
+      suffix = "OES";
+    }
+    bool loaded = suffix != nullptr
+      && load( f.genVertexArrays,(std::string("glGenVertexArrays") + suffix).c_str() )
+      && load( f.bindVertexArray,(std::string("glBindVertexArray") + suffix).c_str() )
+      && load( f.deleteVertexArrays,(std::string("glDeleteVertexArrays") + suffix).c_str() );
+    if(!loaded) {
+      f = VertexArrayFunctions();
+    }
+    return f;
+  }
+
+  static InvalidateFramebuffer getInvalidateFramebuffer() {
+    //Loaded on the first call; null when neither OpenGL ES 3.0 nor GL_EXT_discard_framebuffer is
+    //available. Both take the same attachment names for framebuffer objects, and for the default
+    //framebuffer GL_COLOR, GL_DEPTH and GL_STENCIL, which have the same values as GL_COLOR_EXT,
+    //GL_DEPTH_EXT and GL_STENCIL_EXT.
+    CachedInvalidateFramebuffer& c = getCachedInvalidateFramebuffer();
+    if(!c.loaded) {
+      c.loaded = true;
+      c.function = nullptr;
+      if(getMajorVersion() >= 3) {
+        load(c.function,"glInvalidateFramebuffer");
+      }
+      else if( has("GL_EXT_discard_framebuffer") ) {
+        load(c.function,"glDiscardFramebufferEXT");
+      }
+    }
+    return c.function;
+  }
+
+ private:
+  static GLADloadproc& getLoader() {
+    static GLADloadproc loader{nullptr};
+    return loader;
+  }
+
+  static bool& getExtensionFunctionsDisabled() {
+    static bool disabled{false};
+    return disabled;
+  }
+
+  static const std::string& getExtensionString() {
+    std::string& extensions = getCachedExtensionString();
+    if( extensions.empty() ) {
+      const char * e = (const char *) glGetString(GL_EXTENSIONS);
+      extensions = e != nullptr ? e : " ";
+    }
+    return extensions;
+  }
+
+  static std::string& getCachedExtensionString() {
+    static std::string extensions;
+    return extensions;
+  }
+
+  class CachedVertexArrayFunctions {
+   public:
+    VertexArrayFunctions functions;
+    bool loaded{false};
+  };
+
+  static CachedVertexArrayFunctions& getCachedVertexArrayFunctions() {
+    static CachedVertexArrayFunctions cached;
+    return cached;
+  }
+
+  class CachedInvalidateFramebuffer {
+   public:
+    InvalidateFramebuffer function{nullptr};
+    bool loaded{false};
+  };
+
+  static CachedInvalidateFramebuffer& getCachedInvalidateFramebuffer() {
+    static CachedInvalidateFramebuffer cached;
+    return cached;
+  }
+};
+
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+//Every OpenGL ES 2.0 function that glad loads, as an X macro: PROJECTNAME_GL_FUNCTIONS(F) expands
+//to F(glActiveTexture) F(glAttachShader) ... . The tracer uses it to hook the glad function
+//pointers and the replay tool to call them. Keep it in the order of gladInclude/glad/glad.h.
+#define PROJECTNAME_GL_FUNCTIONS(F) \
+  F(glActiveTexture) \
+  F(glAttachShader) \
+  F(glBindAttribLocation) \
+  F(glBindBuffer) \
+  F(glBindFramebuffer) \
+  F(glBindRenderbuffer) \
+  F(glBindTexture) \
+  F(glBlendColor) \
+  F(glBlendEquation) \
+  F(glBlendEquationSeparate) \
+  F(glBlendFunc) \
+  F(glBlendFuncSeparate) \
+  F(glBufferData) \
+  F(glBufferSubData) \
+  F(glCheckFramebufferStatus) \
+  F(glClear) \
+  F(glClearColor) \
+  F(glClearDepthf) \
+  F(glClearStencil) \
+  F(glColorMask) \
+  F(glCompileShader) \
+  F(glCompressedTexImage2D) \
+  F(glCompressedTexSubImage2D) \
+  F(glCopyTexImage2D) \
+  F(glCopyTexSubImage2D) \
+  F(glCreateProgram) \
+  F(glCreateShader) \
+  F(glCullFace) \
+  F(glDeleteBuffers) \
+  F(glDeleteFramebuffers) \
+  F(glDeleteProgram) \
+  F(glDeleteRenderbuffers) \
+  F(glDeleteShader) \
+  F(glDeleteTextures) \
+  F(glDepthFunc) \
+  F(glDepthMask) \
+  F(glDepthRangef) \
+  F(glDetachShader) \
+  F(glDisable) \
+  F(glDisableVertexAttribArray) \
+  F(glDrawArrays) \
+  F(glDrawElements) \
+  F(glEnable) \
+  F(glEnableVertexAttribArray) \
+  F(glFinish) \
+  F(glFlush) \
+  F(glFramebufferRenderbuffer) \
+  F(glFramebufferTexture2D) \
+  F(glFrontFace) \
+  F(glGenBuffers) \
+  F(glGenerateMipmap) \
+  F(glGenFramebuffers) \
+  F(glGenRenderbuffers) \
+  F(glGenTextures) \
+  F(glGetActiveAttrib) \
+  F(glGetActiveUniform) \
+  F(glGetAttachedShaders) \
+  F(glGetAttribLocation) \
+  F(glGetBooleanv) \
+  F(glGetBufferParameteriv) \
+  F(glGetError) \
+  F(glGetFloatv) \
+  F(glGetFramebufferAttachmentParameteriv) \
+  F(glGetIntegerv) \
+  F(glGetProgramiv) \
+  F(glGetProgramInfoLog) \
+  F(glGetRenderbufferParameteriv) \
+  F(glGetShaderiv) \
+  F(glGetShaderInfoLog) \
+  F(glGetShaderPrecisionFormat) \
+  F(glGetShaderSource) \
+  F(glGetString) \
+  F(glGetTexParameterfv) \
+  F(glGetTexParameteriv) \
+  F(glGetUniformfv) \
+  F(glGetUniformiv) \
+  F(glGetUniformLocation) \
+  F(glGetVertexAttribfv) \
+  F(glGetVertexAttribiv) \
+  F(glGetVertexAttribPointerv) \
+  F(glHint) \
+  F(glIsBuffer) \
+  F(glIsEnabled) \
+  F(glIsFramebuffer) \
+  F(glIsProgram) \
+  F(glIsRenderbuffer) \
+  F(glIsShader) \
+  F(glIsTexture) \
+  F(glLineWidth) \
+  F(glLinkProgram) \
+  F(glPixelStorei) \
+  F(glPolygonOffset) \
+  F(glReadPixels) \
+  F(glReleaseShaderCompiler) \
+  F(glRenderbufferStorage) \
+  F(glSampleCoverage) \
+  F(glScissor) \
+  F(glShaderBinary) \
+  F(glShaderSource) \
+  F(glStencilFunc) \
+  F(glStencilFuncSeparate) \
+  F(glStencilMask) \
+  F(glStencilMaskSeparate) \
+  F(glStencilOp) \
+  F(glStencilOpSeparate) \
+  F(glTexImage2D) \
+  F(glTexParameterf) \
+  F(glTexParameterfv) \
+  F(glTexParameteri) \
+  F(glTexParameteriv) \
+  F(glTexSubImage2D) \
+  F(glUniform1f) \
+  F(glUniform1fv) \
+  F(glUniform1i) \
+  F(glUniform1iv) \
+  F(glUniform2f) \
+  F(glUniform2fv) \
+  F(glUniform2i) \
+  F(glUniform2iv) \
+  F(glUniform3f) \
+  F(glUniform3fv) \
+  F(glUniform3i) \
+  F(glUniform3iv) \
+  F(glUniform4f) \
+  F(glUniform4fv) \
+  F(glUniform4i) \
+  F(glUniform4iv) \
+  F(glUniformMatrix2fv) \
+  F(glUniformMatrix3fv) \
+  F(glUniformMatrix4fv) \
+  F(glUseProgram) \
+  F(glValidateProgram) \
+  F(glVertexAttrib1f) \
+  F(glVertexAttrib1fv) \
+  F(glVertexAttrib2f) \
+  F(glVertexAttrib2fv) \
+  F(glVertexAttrib3f) \
+  F(glVertexAttrib3fv) \
+  F(glVertexAttrib4f) \
+  F(glVertexAttrib4fv) \
+  F(glVertexAttribPointer) \
+  F(glViewport)
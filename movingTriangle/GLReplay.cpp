@@ -0,0 +1,311 @@
+#include "GLTraceFormat.h"
+#include "HiddenContext.h"
+
+#include <glad/glad.h>
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+
+//Executes a trace that GLTrace has recorded and reports the CPU time of every function, next to
+//the time it took when the trace was recorded. The window is hidden; on a machine without a
+//display, run it with a headless SDL video driver, for instance SDL_VIDEODRIVER=offscreen, or
+//with Mesa's software rasterizer (LIBGL_ALWAYS_SOFTWARE=1) to compare against a driver.
+//
+//  glReplay trace.bin [repetitions] [width height]
+//
+//The records before the first frame marker are executed once. They create the buffers, shaders
+//and textures, which get the same names as when the trace was recorded because a new context
+//hands out names in the same order. The frames are then executed repetitions times.
+
+namespace ProjectName {
+
+using namespace GLTraceFormat;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+class FunctionInfo {
+ public:
+  size_t argumentBytes;
+  size_t argumentCount;
+  bool (*isPointer)(size_t i);
+  void (*decode)(const char * bytes, uint64_t * raw);
+  void (*call)(const uint64_t * raw, void * const * overrides);
+};
+
+const FunctionInfo& getFunctionInfo(FunctionId id) {
+  #define PROJECTNAME_FUNCTION_INFO(name) \
+    { \
+      FunctionSignature<decltype(name)>::getBytes(), \
+      FunctionSignature<decltype(name)>::COUNT, \
+      &FunctionSignature<decltype(name)>::isPointer, \
+      &FunctionSignature<decltype(name)>::decode, \
+      [](const uint64_t * raw, void * const * overrides) { \
+        FunctionSignature<decltype(name)>::call(name,raw,overrides); \
+      } \
+    },
+  static const FunctionInfo table[] = {
+    PROJECTNAME_GL_FUNCTIONS(PROJECTNAME_FUNCTION_INFO)
+  };
+  #undef PROJECTNAME_FUNCTION_INFO
+  return table[id];
+}
+
+class Call {
+ public:
+  FunctionId id;
+  uint32_t recordedNanoseconds;
+  uint64_t raw[MAX_ARGUMENTS]{};
+  const char * payload{nullptr};
+  uint32_t payloadBytes{0};
+};
+
+class FunctionStatistics {
+ public:
+  unsigned long calls{0};
+  double recordedNanoseconds{0};
+  double replayedNanoseconds{0};
+};
+
+class Trace {
+ public:
+  std::vector<Call> setup;
+  std::vector< std::vector<Call> > frames;
+
+  explicit Trace(const std::string& path) {
+    std::ifstream stream(path,std::ios::binary);
+    if(!stream) {
+      throw std::runtime_error("Could not open " + path);
+    }
+    bytes.assign( std::istreambuf_iterator<char>(stream),std::istreambuf_iterator<char>() );
+    parse();
+  }
+
+ private:
+  std::vector<char> bytes;
+  size_t position{0};
+  std::vector<FunctionId> localIds; //Function id in the file -> function id in this program.
+
+  template<class T>
+  T read() {
+    if(position + sizeof(T) > bytes.size()) {
+      throw std::runtime_error("The trace ends in the middle of a record.");
+    }
+    T t;
+    std::memcpy( &t,&bytes[position],sizeof(T) );
+    position += sizeof(T);
+    return t;
+  }
+
+  const char * skip(size_t n) {
+    if(position + n > bytes.size()) {
+      throw std::runtime_error("The trace ends in the middle of a record.");
+    }
+    const char * result = &bytes[position];
+    position += n;
+    return result;
+  }
+
+  void parse() {
+    if( bytes.size() < 4 || std::memcmp(bytes.data(),getMagic(),4) != 0 ) {
+      throw std::runtime_error("This is not a trace of GLTrace.");
+    }
+    position = 4;
+    if(read<uint32_t>() != VERSION) {
+      throw std::runtime_error("The trace has a different version.");
+    }
+    readFunctionTable();
+
+    std::vector<Call> * current = &setup;
+    while( position < bytes.size() ) {
+      uint16_t fileId = read<uint16_t>();
+      uint8_t flags = read<uint8_t>();
+      uint32_t nanoseconds = read<uint32_t>();
+
+      if(fileId == FRAME_MARKER) {
+        frames.emplace_back();
+        current = &frames.back();
+        continue;
+      }
+      if( fileId >= localIds.size() ) {
+        throw std::runtime_error("The trace contains an unknown function id.");
+      }
+
+      Call call;
+      call.id = localIds[fileId];
+      call.recordedNanoseconds = nanoseconds;
+      const FunctionInfo& info = getFunctionInfo(call.id);
+      info.decode( skip(info.argumentBytes),call.raw );
+      if(flags & HAS_PAYLOAD) {
+        call.payloadBytes = read<uint32_t>();
+        call.payload = skip(call.payloadBytes);
+      }
+      current->push_back(call);
+    }
+
+    if( !frames.empty() && frames.back().empty() ) {
+      frames.pop_back(); //The calls after the last marker of a trace that stopped normally.
+    }
+  }
+
+  void readFunctionTable() {
+    uint16_t count = read<uint16_t>();
+    for(uint16_t i = 0; i < count; ++i) {
+      uint8_t length = read<uint8_t>();
+      std::string name(skip(length),length);
+
+      uint16_t local = 0;
+      while( local < NUMBER_OF_FUNCTIONS && name != getFunctionName( (FunctionId) local ) ) {
+        ++local;
+      }
+      if(local == NUMBER_OF_FUNCTIONS) {
+        throw std::runtime_error("The trace contains the unknown function " + name);
+      }
+      localIds.push_back( (FunctionId) local );
+    }
+  }
+};
+
+class Replayer {
+ public:
+  FunctionStatistics statistics[NUMBER_OF_FUNCTIONS];
+
+  void execute(const Call& call, bool measure) {
+    const FunctionInfo& info = getFunctionInfo(call.id);
+    uint64_t raw[MAX_ARGUMENTS];
+    void * overrides[MAX_ARGUMENTS];
+    std::copy(call.raw,call.raw + MAX_ARGUMENTS,raw);
+
+    //Pointers of the recording process mean nothing here. Unless a payload rule says otherwise
+    //they point to scratch memory, which is large enough for what queries write back.
+    for(size_t i = 0; i < info.argumentCount; ++i) {
+      overrides[i] = info.isPointer(i) ? scratch.data() : nullptr;
+    }
+
+    const GLchar * source = nullptr;
+    GLint sourceLength = 0;
+    PayloadRule rule = getPayloadRule(call.id,call.raw);
+    switch(rule.kind) {
+      case PayloadRule::NONE:
+        break;
+      case PayloadRule::OFFSET:
+        overrides[rule.argument] = nullptr;
+        break;
+      case PayloadRule::SHADER_SOURCE:
+        if(call.payload != nullptr) {
+          source = call.payload;
+          sourceLength = (GLint) call.payloadBytes - 1;
+          raw[1] = 1;
+          overrides[rule.argument] = (void *) &source;
+          overrides[3] = (void *) &sourceLength;
+        }
+        else {
+          raw[1] = 0;
+        }
+        break;
+      default:
+        overrides[rule.argument] = (void *) call.payload; //Null pointers stay null.
+        raw[rule.argument] = 0;
+        break;
+    }
+
+    Clock::time_point start = Clock::now();
+    info.call(raw,overrides);
+    double nanoseconds = std::chrono::duration<double,std::nano>(Clock::now() - start).count();
+
+    if(measure) {
+      FunctionStatistics& s = statistics[call.id];
+      ++s.calls;
+      s.recordedNanoseconds += call.recordedNanoseconds;
+      s.replayedNanoseconds += nanoseconds;
+    }
+  }
+
+ private:
+  static constexpr size_t SCRATCH_BYTES = 64 << 20; //glReadPixels of a 4K RGBA frame fits.
+  std::vector<char> scratch = std::vector<char>(SCRATCH_BYTES);
+};
+
+void printReport(const Replayer& replayer, unsigned long frames, double frameNanoseconds) {
+  std::vector<FunctionId> order;
+  for(uint16_t i = 0; i < NUMBER_OF_FUNCTIONS; ++i) {
+    if(replayer.statistics[i].calls > 0) {
+      order.push_back( (FunctionId) i );
+    }
+  }
+  std::sort( order.begin(),order.end(),[&replayer](FunctionId a, FunctionId b) {
+    return replayer.statistics[a].replayedNanoseconds > replayer.statistics[b].replayedNanoseconds;
+  });
+
+  std::printf("%-28s %10s %14s %14s %14s\n","function","calls","recorded ns","replayed ns",
+    "replayed total"
+  );
+  for(FunctionId id : order) {
+    const FunctionStatistics& s = replayer.statistics[id];
+    std::printf("%-28s %10lu %14.0f %14.0f %14.0f\n",getFunctionName(id),s.calls,
+      s.recordedNanoseconds/s.calls,s.replayedNanoseconds/s.calls,s.replayedNanoseconds
+    );
+  }
+  if(frames > 0) {
+    std::printf("\n%lu frames, %.3f ms per frame including glFinish.\n",frames,
+      frameNanoseconds/frames/1e6
+    );
+  }
+}
+
+}
+
+}
+
+int main(int n, char ** arguments) {
+  using namespace ProjectName;
+
+  if(n < 2) {
+    std::printf("usage: glReplay trace.bin [repetitions] [width height]\n");
+    return 1;
+  }
+  int repetitions = n > 2 ? std::atoi(arguments[2]) : 10;
+  int width = n > 4 ? std::atoi(arguments[3]) : 1280;
+  int height = n > 4 ? std::atoi(arguments[4]) : 720;
+
+  try {
+    Trace trace(arguments[1]);
+    HiddenContext context("glReplay",width,height);
+    Replayer replayer;
+
+    for(const Call& call : trace.setup) {
+      replayer.execute(call,false);
+    }
+    glFinish();
+
+    unsigned long frames = 0;
+    double frameNanoseconds = 0;
+    for(int r = 0; r < repetitions; ++r) {
+      for(const std::vector<Call>& frame : trace.frames) {
+        Clock::time_point start = Clock::now();
+        for(const Call& call : frame) {
+          replayer.execute(call,true);
+        }
+        glFinish();
+        frameNanoseconds += std::chrono::duration<double,std::nano>(Clock::now() - start).count();
+        ++frames;
+        context.swap();
+      }
+    }
+
+    printReport(replayer,frames,frameNanoseconds);
+  }
+  catch(const std::exception& e) {
+    std::printf("glReplay: %s\n",e.what());
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,304 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+
+#include "BufferBindingCache.h"
+#include "GLExtensions.h"
+#include "GLDebug.h"
+
+namespace ProjectName {
+
+enum class ResourceCategory : unsigned char {
+  BUFFER,
+  PROGRAM,
+  TEXTURE,
+  FRAMEBUFFER,
+  RENDERBUFFER,
+  VERTEX_ARRAY,
+  NUMBER_OF_CATEGORIES
+};
+
+class ResourceStatistics {
+  //Live OpenGL objects and the number of bytes of GPU memory they occupy, per category. The
+  //byte counts are what the program has asked for; the driver may use more.
+ public:
+  static constexpr unsigned char N = (unsigned char) ResourceCategory::NUMBER_OF_CATEGORIES;
+
+  class Snapshot {
+   public:
+    size_t liveObjects[N]{}, bytes[N]{};
+  };
+
+  static ResourceStatistics& get() {
+    static ResourceStatistics statistics;
+    return statistics;
+  }
+
+  void addObject(ResourceCategory c) {
+    liveObjects[index(c)].fetch_add(1,std::memory_order_relaxed);
+  }
+
+  void removeObject(ResourceCategory c) {
+    liveObjects[index(c)].fetch_sub(1,std::memory_order_relaxed);
+  }
+
+  void addBytes(ResourceCategory c, size_t b) {
+    bytes[index(c)].fetch_add(b,std::memory_order_relaxed);
+  }
+
+  void removeBytes(ResourceCategory c, size_t b) {
+    bytes[index(c)].fetch_sub(b,std::memory_order_relaxed);
+  }
+
+  Snapshot getSnapshot() const {
+    Snapshot s;
+    for(unsigned char i = 0; i < N; ++i) {
+      s.liveObjects[i] = liveObjects[i].load(std::memory_order_relaxed);
+      s.bytes[i] = bytes[i].load(std::memory_order_relaxed);
+    }
+    return s;
+  }
+
+  static const char * getCategoryName(ResourceCategory c) {
+    switch(c) {
+      case ResourceCategory::BUFFER  : return "buffer";
+      case ResourceCategory::PROGRAM : return "program";
+      case ResourceCategory::TEXTURE : return "texture";
+      case ResourceCategory::FRAMEBUFFER : return "framebuffer";
+      case ResourceCategory::RENDERBUFFER : return "renderbuffer";
+      case ResourceCategory::VERTEX_ARRAY : return "vertex array";
+      default : return "unknown";
+    }
+  }
+
+ private:
+  std::atomic<size_t> liveObjects[N]{}, bytes[N]{};
+
+  static unsigned char index(ResourceCategory c) {
+    return (unsigned char) c;
+  }
+};
+
+class DeletionQueue {
+  //OpenGL objects may only be deleted on the render thread, and deleting an object that is
+  //still used by a frame the GPU has not finished can stall the pipeline. Therefore handles do
+  //not delete their object, but put it in this queue together with the current frame number.
+  //The render thread deletes it FRAMES_IN_FLIGHT frames later, when no frame that may have
+  //used it is still being processed. enqueue() can be called from any thread; the other methods
+  //must be called by the render thread.
+ public:
+  static constexpr unsigned long FRAMES_IN_FLIGHT = 2;
+
+  static DeletionQueue& get() {
+    static DeletionQueue queue;
+    return queue;
+  }
+
+  void enqueue(ResourceCategory c, GLuint name) {
+    std::lock_guard<std::mutex> lock(mutex);
+    pending.push_back( Entry{c,name,getFrameNumber()} );
+  }
+
+  unsigned long getFrameNumber() const {
+    return frameNumber.load(std::memory_order_relaxed);
+  }
+
+  void endFrame() {
+    //Called after the buffers have been swapped.
+    frameNumber.fetch_add(1,std::memory_order_relaxed);
+    collect(false);
+  }
+
+  void collectAll() {
+    //Deletes everything, for instance before the context is destroyed.
+    collect(true);
+  }
+
+  size_t getPendingCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pending.size();
+  }
+
+ private:
+  class Entry {
+   public:
+    ResourceCategory category;
+    GLuint name;
+    unsigned long frame;
+  };
+
+  std::mutex mutex;
+  std::vector<Entry> pending, ready;
+  std::atomic<unsigned long> frameNumber{0};
+
+  void collect(bool everything) {
+    unsigned long current = getFrameNumber();
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto isReady = [&](const Entry& e) {
+        return everything || e.frame + FRAMES_IN_FLIGHT <= current;
+      };
+      auto it = std::stable_partition(pending.begin(),pending.end(),
+        [&](const Entry& e) { return !isReady(e); }
+      );
+      ready.assign(it,pending.end());
+      pending.erase(it,pending.end());
+    }
+    //The objects are deleted outside of the lock, so other threads are never blocked by the driver.
+    for(const auto& e : ready) {
+      deleteObject(e);
+    }
+    ready.clear();
+  }
+
+  static void deleteObject(const Entry& e) {
+    switch(e.category) {
+      case ResourceCategory::BUFFER :
+        BufferBindingCache::forget(e.name);
+        GL_CHECK( glDeleteBuffers(1,&e.name) );
+        break;
+      case ResourceCategory::PROGRAM :
+        GL_CHECK( glDeleteProgram(e.name) );
+        break;
+      case ResourceCategory::TEXTURE :
+        GL_CHECK( glDeleteTextures(1,&e.name) );
+        break;
+      case ResourceCategory::FRAMEBUFFER :
+        GL_CHECK( glDeleteFramebuffers(1,&e.name) );
+        break;
+      case ResourceCategory::RENDERBUFFER :
+        GL_CHECK( glDeleteRenderbuffers(1,&e.name) );
+        break;
+      case ResourceCategory::VERTEX_ARRAY :
+        GL_CHECK( GLExtensions::getVertexArrayFunctions().deleteVertexArrays(1,&e.name) );
+        break;
+      default:
+        break;
+    }
+  }
+};
+
+template<ResourceCategory C>
+class GLHandle {
+  //Owns the name of an OpenGL object. The object is created on the render thread, but the handle
+  //can be destroyed on any thread; the actual deletion happens later through the DeletionQueue.
+ public:
+  GLHandle() {
+
+  }
+
+  ~GLHandle() {
+    reset();
+  }
+
+  GLHandle(const GLHandle&) = delete;
+  GLHandle& operator=(const GLHandle&) = delete;
+
+  GLHandle(GLHandle&& other) noexcept {
+    *this = std::move(other);
+  }
+
+  GLHandle& operator=(GLHandle&& other) noexcept {
+    if(this != &other) {
+      reset();
+      name = other.name;
+      bytes = other.bytes;
+      other.name = 0;
+      other.bytes = 0;
+    }
+    return *this;
+  }
+
+  void create() { //Requires an OpenGL context.
+    reset();
+    name = createObject();
+    ResourceStatistics::get().addObject(C);
+  }
+
+  void reset() {
+    if(name == 0) {
+      return;
+    }
+    DeletionQueue::get().enqueue(C,name);
+    ResourceStatistics::get().removeObject(C);
+    ResourceStatistics::get().removeBytes(C,bytes);
+    name = 0;
+    bytes = 0;
+  }
+
+  void setSize(size_t b) {
+    //The amount of GPU memory the object uses, for the statistics.
+    ResourceStatistics::get().removeBytes(C,bytes);
+    ResourceStatistics::get().addBytes(C,b);
+    bytes = b;
+  }
+
+  GLuint get() const {
+    return name;
+  }
+
+  explicit operator bool() const {
+    return name != 0;
+  }
+
+ private:
+  GLuint name{0};
+  size_t bytes{0};
+
+  static GLuint createObject();
+};
+
+template<>
+inline GLuint GLHandle<ResourceCategory::BUFFER>::createObject() {
+  GLuint result = 0;
+  GL_CHECK( glGenBuffers(1,&result) );
+  return result;
+}
+
+template<>
+inline GLuint GLHandle<ResourceCategory::PROGRAM>::createObject() {
+  return GL_CHECK( glCreateProgram() );
+}
+
+template<>
+inline GLuint GLHandle<ResourceCategory::TEXTURE>::createObject() {
+  GLuint result = 0;
+  GL_CHECK( glGenTextures(1,&result) );
+  return result;
+}
+
+template<>
+inline GLuint GLHandle<ResourceCategory::FRAMEBUFFER>::createObject() {
+  GLuint result = 0;
+  GL_CHECK( glGenFramebuffers(1,&result) );
+  return result;
+}
+
+template<>
+inline GLuint GLHandle<ResourceCategory::RENDERBUFFER>::createObject() {
+  GLuint result = 0;
+  GL_CHECK( glGenRenderbuffers(1,&result) );
+  return result;
+}
+
+template<>
+inline GLuint GLHandle<ResourceCategory::VERTEX_ARRAY>::createObject() {
+  //Only when GLExtensions::getVertexArrayFunctions() has them.
+  GLuint result = 0;
+  GL_CHECK( GLExtensions::getVertexArrayFunctions().genVertexArrays(1,&result) );
+  return result;
+}
+
+using BufferHandle = GLHandle<ResourceCategory::BUFFER>;
+using ProgramHandle = GLHandle<ResourceCategory::PROGRAM>;
+using TextureHandle = GLHandle<ResourceCategory::TEXTURE>;
+using FramebufferHandle = GLHandle<ResourceCategory::FRAMEBUFFER>;
+using RenderbufferHandle = GLHandle<ResourceCategory::RENDERBUFFER>;
+using VertexArrayHandle = GLHandle<ResourceCategory::VERTEX_ARRAY>;
+
+}
@@ -0,0 +1,1034 @@
+#include "GLSLPreprocessor.h"
+
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <stdexcept>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
+namespace ProjectName {
+
+namespace {
+
+bool isIdentifierStart(char c) {
+  return std::isalpha( (unsigned char) c ) || c == '_';
+}
+
+bool isIdentifierPart(char c) {
+  return std::isalnum( (unsigned char) c ) || c == '_';
+}
+
+bool isSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+}
+
+}
+
+class GLSLPreprocessor::I {
+ public:
+  Options options;
+
+  void setIncludeLoader(IncludeLoader l) {
+    loader = std::move(l);
+  }
+
+  void setIncludeDirectory(const String& directory) {
+    loader = [directory](const String& name, String& contents) {
+      std::ifstream stream(directory + "/" + name);
+      if( !stream.good() ) {
+        return false;
+      }
+      std::stringstream s;
+      s << stream.rdbuf();
+      contents = s.str();
+      return true;
+    };
+  }
+
+  void define(const String& name, const String& value) {
+    definitions[name] = value;
+  }
+
+  void undefine(const String& name) {
+    definitions.erase(name);
+  }
+
+  String process(const String& source, Stage stage, const String& sourceName) {
+    macros.clear();
+    macros["GL_ES"].body.push_back( Token{"1",Token::NUMBER,0,0} );
+    for(const auto& d : definitions) {
+      Macro m;
+      tokenize(d.second,0,0,m.body);
+      macros[d.first] = m;
+    }
+    fileNames.assign(1,sourceName);
+    items.clear();
+    pendingText.clear();
+    version = 100;
+
+    processFile(source,0,0);
+    if(options.removeUnused) {
+      removeUnused(stage);
+    }
+    return options.minify ? writeMinified() : writeLines();
+  }
+
+  const std::vector<String>& getFileNames() const {
+    return fileNames;
+  }
+
+ private:
+  static constexpr unsigned int MAX_INCLUDE_DEPTH = 16;
+
+  class Token {
+   public:
+    enum Kind : unsigned char {
+      IDENTIFIER,
+      NUMBER,
+      OPERATOR
+    };
+
+    String text;
+    Kind kind;
+    unsigned int file, line;
+  };
+
+  class Item {
+    //A token of the output, or a directive that is passed on, with the whole line as text.
+   public:
+    Token token;
+    bool directive{false};
+    bool removed{false};
+  };
+
+  class Macro {
+   public:
+    std::vector<Token> body;
+    std::vector<String> parameters;
+    bool functionLike{false};
+  };
+
+  class Condition {
+   public:
+    bool active; //This branch is compiled.
+    bool taken; //One of the branches so far has been compiled.
+    bool parentActive;
+    bool sawElse{false};
+  };
+
+  class Line {
+   public:
+    String text;
+    unsigned int number;
+  };
+
+  class Declaration {
+    //A top-level declaration of the output, as a range of the token items.
+   public:
+    enum Kind {
+      OTHER,
+      FUNCTION, //A definition or a prototype.
+      VARIABLES //Of uniforms or varyings that may be removed.
+    };
+
+    size_t begin, end;
+    Kind kind{OTHER};
+    String name; //Of a function.
+    size_t declarators{0}; //Of VARIABLES, where the names start.
+    bool kept{false};
+  };
+
+  IncludeLoader loader;
+  std::map<String,String> definitions;
+  std::unordered_map<String,Macro> macros;
+  std::vector<String> fileNames;
+  std::vector<Item> items;
+  std::vector<Token> pendingText; //Lines of code whose macros have not been expanded yet.
+  long long version{100};
+
+  [[noreturn]] void error(unsigned int file, unsigned int line, const String& message) const {
+    throw std::runtime_error(
+      "GLSLPreprocessor: " + fileNames[file] + ":" + std::to_string(line) + ": " + message
+    );
+  }
+
+  //Reading
+
+  std::vector<Line> readLines(const String& text, unsigned int file) const {
+    //Removes the comments and joins lines that end with a backslash. A line keeps the number of
+    //its first physical line.
+    std::vector<Line> lines;
+    String current;
+    unsigned int physical = 1, start = 1;
+    for(size_t i = 0; i < text.size(); ++i) {
+      char c = text[i];
+      if(c == '/' && i + 1 < text.size() && text[i+1] == '/') {
+        while(i + 1 < text.size() && text[i+1] != '\n') {
+          ++i;
+        }
+      }
+      else if(c == '/' && i + 1 < text.size() && text[i+1] == '*') {
+        size_t end = text.find("*/",i + 2);
+        if(end == String::npos) {
+          error(file,physical,"unterminated comment");
+        }
+        physical += (unsigned int) std::count(text.begin() + i,text.begin() + end,'\n');
+        current += ' ';
+        i = end + 1;
+      }
+      else if(c == '\\' && i + 1 < text.size() && text[i+1] == '\n') {
+        ++physical;
+        ++i;
+      }
+      else if(c == '\n') {
+        lines.push_back( Line{current,start} );
+        current.clear();
+        start = ++physical;
+      }
+      else {
+        current += c;
+      }
+    }
+    lines.push_back( Line{current,start} );
+    return lines;
+  }
+
+  void tokenize(const String& s, unsigned int file, unsigned int line,
+    std::vector<Token>& out) const
+  {
+    static const char * const OPERATORS[] = {
+      "<<=",">>=","++","--","<=",">=","==","!=","&&","||","^^","+=","-=","*=","/=","%=",
+      "&=","|=","^=","<<",">>"
+    };
+    size_t i = 0, n = s.size();
+    while(i < n) {
+      char c = s[i];
+      size_t begin = i;
+      if( isSpace(c) ) {
+        ++i;
+        continue;
+      }
+      Token t;
+      t.file = file;
+      t.line = line;
+      if( isIdentifierStart(c) ) {
+        while( i < n && isIdentifierPart(s[i]) ) {
+          ++i;
+        }
+        t.kind = Token::IDENTIFIER;
+      }
+      else if( std::isdigit( (unsigned char) c ) ||
+        ( c == '.' && i + 1 < n && std::isdigit( (unsigned char) s[i+1] ) ) )
+      {
+        //A preprocessing number, as in C: it also takes the sign of an exponent.
+        ++i;
+        while( i < n && (isIdentifierPart(s[i]) || s[i] == '.' ||
+          ( (s[i] == '+' || s[i] == '-') && (s[i-1] == 'e' || s[i-1] == 'E') ) ) )
+        {
+          ++i;
+        }
+        t.kind = Token::NUMBER;
+      }
+      else {
+        t.kind = Token::OPERATOR;
+        i = begin + 1;
+        for(const char * o : OPERATORS) {
+          size_t length = std::strlen(o);
+          if(s.compare(begin,length,o) == 0) {
+            i = begin + length;
+            break;
+          }
+        }
+      }
+      t.text = s.substr(begin,i - begin);
+      out.push_back( std::move(t) );
+    }
+  }
+
+  //Directives
+
+  void processFile(const String& text, unsigned int file, unsigned int depth) {
+    std::vector<Condition> conditions;
+    long long lineOffset = 0; //Changed by #line.
+    unsigned int line = 1;
+    for(const Line& l : readLines(text,file)) {
+      line = (unsigned int) (l.number + lineOffset);
+      size_t start = l.text.find_first_not_of(" \t\r\f\v");
+      if(start == String::npos || l.text[start] != '#') {
+        if( isActive(conditions) ) {
+          tokenize(l.text,file,line,pendingText);
+        }
+        continue;
+      }
+      flush();
+      long long newLine = -1;
+      directive(l.text.substr(start + 1),file,line,depth,conditions,newLine);
+      if(newLine >= 0) {
+        lineOffset = newLine - (l.number + 1);
+      }
+    }
+    flush();
+    if( !conditions.empty() ) {
+      error(file,line,"#if without #endif");
+    }
+  }
+
+  static bool isActive(const std::vector<Condition>& conditions) {
+    return conditions.empty() || conditions.back().active;
+  }
+
+  void directive(const String& text, unsigned int file, unsigned int line, unsigned int depth,
+    std::vector<Condition>& conditions, long long& newLine)
+  {
+    size_t i = text.find_first_not_of(" \t\r\f\v");
+    if(i == String::npos) {
+      return; //The null directive.
+    }
+    size_t nameEnd = i;
+    while( nameEnd < text.size() && isIdentifierPart(text[nameEnd]) ) {
+      ++nameEnd;
+    }
+    String name = text.substr(i,nameEnd - i);
+    String rest = trim( text.substr(nameEnd) );
+    bool active = isActive(conditions);
+
+    if(name == "ifdef" || name == "ifndef") {
+      bool defined = macros.count( getIdentifier(rest,file,line) ) > 0;
+      bool value = name == "ifdef" ? defined : !defined;
+      conditions.push_back( Condition{active && value,active && value,active} );
+      return;
+    }
+    if(name == "if") {
+      bool value = active && evaluate(rest,file,line) != 0;
+      conditions.push_back( Condition{value,value,active} );
+      return;
+    }
+    if(name == "elif" || name == "else" || name == "endif") {
+      if( conditions.empty() || (name != "endif" && conditions.back().sawElse) ) {
+        error(file,line,"#" + name + " without #if");
+      }
+      Condition& c = conditions.back();
+      if(name == "endif") {
+        conditions.pop_back();
+      }
+      else if(name == "else") {
+        c.active = c.parentActive && !c.taken;
+        c.taken = true;
+        c.sawElse = true;
+      }
+      else {
+        c.active = c.parentActive && !c.taken && evaluate(rest,file,line) != 0;
+        c.taken = c.taken || c.active;
+      }
+      return;
+    }
+    if(!active) {
+      return;
+    }
+
+    if(name == "define") {
+      defineMacro(rest,file,line);
+    }
+    else if(name == "undef") {
+      macros.erase( getIdentifier(rest,file,line) );
+    }
+    else if(name == "include") {
+      include(rest,file,line,depth);
+    }
+    else if(name == "version") {
+      if(file != 0 || !items.empty() ) {
+        error(file,line,"#version has to come first");
+      }
+      version = std::atoll( rest.c_str() );
+      addDirective("#version " + rest,file,line);
+    }
+    else if(name == "extension" || name == "pragma") {
+      addDirective("#" + name + " " + rest,file,line);
+    }
+    else if(name == "line") {
+      newLine = evaluate(rest,file,line);
+    }
+    else if(name == "error") {
+      error(file,line,"#error " + rest);
+    }
+    else {
+      error(file,line,"unknown directive #" + name);
+    }
+  }
+
+  static String trim(const String& s) {
+    size_t begin = s.find_first_not_of(" \t\r\f\v");
+    if(begin == String::npos) {
+      return String();
+    }
+    size_t end = s.find_last_not_of(" \t\r\f\v");
+    return s.substr(begin,end + 1 - begin);
+  }
+
+  String getIdentifier(const String& s, unsigned int file, unsigned int line) const {
+    std::vector<Token> tokens;
+    tokenize(s,file,line,tokens);
+    if(tokens.size() != 1 || tokens[0].kind != Token::IDENTIFIER) {
+      error(file,line,"expected a macro name");
+    }
+    return tokens[0].text;
+  }
+
+  void addDirective(const String& text, unsigned int file, unsigned int line) {
+    Item item;
+    item.token.text = text;
+    item.token.kind = Token::OPERATOR;
+    item.token.file = file;
+    item.token.line = line;
+    item.directive = true;
+    items.push_back( std::move(item) );
+  }
+
+  void defineMacro(const String& s, unsigned int file, unsigned int line) {
+    size_t i = 0;
+    while( i < s.size() && isIdentifierPart(s[i]) ) {
+      ++i;
+    }
+    if( i == 0 || !isIdentifierStart(s[0]) ) {
+      error(file,line,"expected a macro name");
+    }
+    String name = s.substr(0,i);
+    Macro m;
+    if(i < s.size() && s[i] == '(') {
+      //A function-like macro: the parenthesis follows the name without a space.
+      m.functionLike = true;
+      size_t close = s.find(')',i);
+      if(close == String::npos) {
+        error(file,line,"missing ) in the parameters of " + name);
+      }
+      std::vector<Token> parameters;
+      tokenize(s.substr(i + 1,close - i - 1),file,line,parameters);
+      for(size_t p = 0; p < parameters.size(); ++p) {
+        bool isName = p % 2 == 0;
+        if( (isName && parameters[p].kind != Token::IDENTIFIER) ||
+          (!isName && parameters[p].text != ",") || parameters.size() % 2 == 0 )
+        {
+          error(file,line,"bad parameters of " + name);
+        }
+        if(isName) {
+          m.parameters.push_back(parameters[p].text);
+        }
+      }
+      i = close + 1;
+    }
+    tokenize(s.substr(i),file,line,m.body);
+    for(const Token& t : m.body) {
+      if(t.text == "#") {
+        //Also ##, which is two tokens here. Passing it on would hide the error from the driver.
+        error(file,line,"GLSL ES has no # and ## operators, in " + name);
+      }
+    }
+
+    auto it = macros.find(name);
+    if( it != macros.end() && !isSameMacro(it->second,m) ) {
+      error(file,line,"macro " + name + " redefined differently");
+    }
+    macros[name] = std::move(m);
+  }
+
+  static bool isSameMacro(const Macro& a, const Macro& b) {
+    if(a.functionLike != b.functionLike || a.parameters != b.parameters ||
+      a.body.size() != b.body.size() )
+    {
+      return false;
+    }
+    for(size_t i = 0; i < a.body.size(); ++i) {
+      if(a.body[i].text != b.body[i].text) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void include(const String& s, unsigned int file, unsigned int line, unsigned int depth) {
+    if(s.size() < 2 || !( (s.front() == '"' && s.back() == '"') ||
+      (s.front() == '<' && s.back() == '>') ) )
+    {
+      error(file,line,"expected #include \"name\"");
+    }
+    String name = s.substr(1,s.size() - 2);
+    if( std::find(fileNames.begin(),fileNames.end(),name) != fileNames.end() ) {
+      return;
+    }
+    if(depth >= MAX_INCLUDE_DEPTH) {
+      error(file,line,"#include nested too deeply");
+    }
+    String contents;
+    if( !loader || !loader(name,contents) ) {
+      error(file,line,"cannot include " + name);
+    }
+    fileNames.push_back(name);
+    processFile(contents,(unsigned int) fileNames.size() - 1,depth + 1);
+  }
+
+  //Macro expansion
+
+  void flush() {
+    if( pendingText.empty() ) {
+      return;
+    }
+    std::vector<Token> expanded;
+    std::vector<String> disabled;
+    expand(pendingText,expanded,disabled);
+    for(Token& t : expanded) {
+      Item item;
+      item.token = std::move(t);
+      items.push_back( std::move(item) );
+    }
+    pendingText.clear();
+  }
+
+  void expand(const std::vector<Token>& in, std::vector<Token>& out,
+    std::vector<String>& disabled) const
+  {
+    //disabled holds the macros that are being expanded, which are not expanded again within
+    //their own replacement.
+    for(size_t i = 0; i < in.size(); ++i) {
+      const Token& t = in[i];
+      if(t.kind != Token::IDENTIFIER ||
+        std::find(disabled.begin(),disabled.end(),t.text) != disabled.end() )
+      {
+        out.push_back(t);
+        continue;
+      }
+      if(t.text == "__LINE__" || t.text == "__FILE__" || t.text == "__VERSION__") {
+        long long value = t.text == "__LINE__" ? t.line : t.text == "__FILE__" ? t.file : version;
+        out.push_back( Token{std::to_string(value),Token::NUMBER,t.file,t.line} );
+        continue;
+      }
+      auto it = macros.find(t.text);
+      if( it == macros.end() ) {
+        out.push_back(t);
+        continue;
+      }
+      const Macro& m = it->second;
+      std::vector<Token> replacement;
+      if(!m.functionLike) {
+        replacement = m.body;
+      }
+      else {
+        if(i + 1 == in.size() || in[i+1].text != "(") {
+          out.push_back(t); //The name alone, for instance of a function of the shader.
+          continue;
+        }
+        std::vector< std::vector<Token> > arguments;
+        i = collectArguments(in,i + 1,arguments);
+        if( arguments.size() == 1 && arguments[0].empty() && m.parameters.empty() ) {
+          arguments.clear();
+        }
+        if( arguments.size() != m.parameters.size() ) {
+          error(t.file,t.line,"wrong number of arguments of " + t.text);
+        }
+        for(auto& a : arguments) {
+          std::vector<Token> e;
+          expand(a,e,disabled);
+          a = std::move(e);
+        }
+        for(const Token& b : m.body) {
+          auto p = std::find(m.parameters.begin(),m.parameters.end(),b.text);
+          if(b.kind == Token::IDENTIFIER && p != m.parameters.end()) {
+            const auto& a = arguments[p - m.parameters.begin()];
+            replacement.insert( replacement.end(),a.begin(),a.end() );
+          }
+          else {
+            replacement.push_back(b);
+          }
+        }
+      }
+      for(Token& r : replacement) {
+        r.file = t.file;
+        r.line = t.line;
+      }
+      disabled.push_back(t.text);
+      expand(replacement,out,disabled);
+      disabled.pop_back();
+    }
+  }
+
+  size_t collectArguments(const std::vector<Token>& in, size_t open,
+    std::vector< std::vector<Token> >& arguments) const
+  {
+    //Returns the index of the closing parenthesis.
+    arguments.assign(1,std::vector<Token>());
+    int depth = 0;
+    for(size_t i = open + 1; i < in.size(); ++i) {
+      const String& s = in[i].text;
+      if(s == ")" && depth == 0) {
+        return i;
+      }
+      if(s == "," && depth == 0) {
+        arguments.emplace_back();
+        continue;
+      }
+      depth += s == "(" ? 1 : s == ")" ? -1 : 0;
+      arguments.back().push_back(in[i]);
+    }
+    error(in[open].file,in[open].line,"missing ) in the arguments of a macro");
+  }
+
+  //Conditions
+
+  long long evaluate(const String& s, unsigned int file, unsigned int line) const {
+    //defined is replaced before the macros are expanded, as in C.
+    std::vector<Token> tokens, replaced, expanded;
+    tokenize(s,file,line,tokens);
+    for(size_t i = 0; i < tokens.size(); ++i) {
+      if(tokens[i].text != "defined") {
+        replaced.push_back(tokens[i]);
+        continue;
+      }
+      bool parenthesis = i + 1 < tokens.size() && tokens[i+1].text == "(";
+      size_t n = i + (parenthesis ? 2 : 1);
+      if(n >= tokens.size() || tokens[n].kind != Token::IDENTIFIER ||
+        ( parenthesis && (n + 1 >= tokens.size() || tokens[n+1].text != ")") ) )
+      {
+        error(file,line,"bad use of defined");
+      }
+      replaced.push_back( Token{macros.count(tokens[n].text) ? "1" : "0",Token::NUMBER,file,line} );
+      i = n + (parenthesis ? 1 : 0);
+    }
+    std::vector<String> disabled;
+    expand(replaced,expanded,disabled);
+    if( expanded.empty() ) {
+      error(file,line,"#if without an expression");
+    }
+    size_t position = 0;
+    long long value = parseBinary(expanded,position,0);
+    if( position != expanded.size() ) {
+      error(file,line,"unexpected " + expanded[position].text + " in #if");
+    }
+    return value;
+  }
+
+  long long parseBinary(const std::vector<Token>& t, size_t& p, size_t level) const {
+    //Precedence climbing over the binary operators of the GLSL preprocessor, loosest first.
+    static const std::vector< std::vector<String> > LEVELS = {
+      {"||"},{"&&"},{"|"},{"^"},{"&"},{"==","!="},{"<",">","<=",">="},{"<<",">>"},{"+","-"},
+      {"*","/","%"}
+    };
+    if( level == LEVELS.size() ) {
+      return parseUnary(t,p);
+    }
+    long long a = parseBinary(t,p,level + 1);
+    while( p < t.size() && t[p].kind == Token::OPERATOR &&
+      std::find(LEVELS[level].begin(),LEVELS[level].end(),t[p].text) != LEVELS[level].end() )
+    {
+      const Token& o = t[p++];
+      long long b = parseBinary(t,p,level + 1);
+      const String& s = o.text;
+      if( (s == "/" || s == "%") && b == 0 ) {
+        error(o.file,o.line,"division by zero in #if");
+      }
+      a = s == "||" ? (a || b) : s == "&&" ? (a && b) : s == "|" ? (a | b) : s == "^" ? (a ^ b) :
+        s == "&" ? (a & b) : s == "==" ? (a == b) : s == "!=" ? (a != b) : s == "<" ? (a < b) :
+        s == ">" ? (a > b) : s == "<=" ? (a <= b) : s == ">=" ? (a >= b) :
+        s == "<<" ? (a << b) : s == ">>" ? (a >> b) : s == "+" ? (a + b) : s == "-" ? (a - b) :
+        s == "*" ? (a*b) : s == "/" ? (a/b) : (a % b);
+    }
+    return a;
+  }
+
+  long long parseUnary(const std::vector<Token>& t, size_t& p) const {
+    if( p == t.size() ) {
+      const Token& last = t.back();
+      error(last.file,last.line,"incomplete expression in #if");
+    }
+    const Token& x = t[p++];
+    if(x.text == "+") {
+      return parseUnary(t,p);
+    }
+    if(x.text == "-") {
+      return -parseUnary(t,p);
+    }
+    if(x.text == "~") {
+      return ~parseUnary(t,p);
+    }
+    if(x.text == "!") {
+      return !parseUnary(t,p);
+    }
+    if(x.text == "(") {
+      long long value = parseBinary(t,p,0);
+      if(p == t.size() || t[p].text != ")") {
+        error(x.file,x.line,"missing ) in #if");
+      }
+      ++p;
+      return value;
+    }
+    if(x.kind == Token::NUMBER) {
+      String digits = x.text;
+      if( !digits.empty() && (digits.back() == 'u' || digits.back() == 'U') ) {
+        digits.pop_back();
+      }
+      char * end = nullptr;
+      long long value = std::strtoll(digits.c_str(),&end,0);
+      if(*end != '\0') {
+        error(x.file,x.line,"#if needs integers, not " + x.text);
+      }
+      return value;
+    }
+    //Unlike C, GLSL does not take undefined names for 0.
+    error(x.file,x.line,"undefined identifier " + x.text + " in #if");
+  }
+
+  //Removal of unused declarations
+
+  void removeUnused(Stage stage) {
+    std::vector<size_t> tokenItems;
+    for(size_t i = 0; i < items.size(); ++i) {
+      if(!items[i].directive) {
+        tokenItems.push_back(i);
+      }
+    }
+    auto text = [&](size_t k) -> const String& {
+      return items[ tokenItems[k] ].token.text;
+    };
+
+    std::vector<Declaration> declarations = split(tokenItems);
+    std::unordered_map< String,std::vector<size_t> > functions;
+    std::vector<size_t> work;
+    for(size_t d = 0; d < declarations.size(); ++d) {
+      Declaration& c = declarations[d];
+      classify(c,tokenItems,stage);
+      if(c.kind == Declaration::FUNCTION) {
+        functions[c.name].push_back(d);
+      }
+      if(c.kind == Declaration::OTHER || (c.kind == Declaration::FUNCTION && c.name == "main")) {
+        c.kept = true;
+        work.push_back(d);
+      }
+    }
+
+    //The functions that are called from kept code are kept, with all their overloads.
+    std::unordered_set<String> referenced;
+    while( !work.empty() ) {
+      const Declaration& c = declarations[ work.back() ];
+      work.pop_back();
+      for(size_t k = c.begin; k < c.end; ++k) {
+        if(items[ tokenItems[k] ].token.kind != Token::IDENTIFIER) {
+          continue;
+        }
+        referenced.insert( text(k) );
+        auto it = functions.find( text(k) );
+        if( it == functions.end() ) {
+          continue;
+        }
+        for(size_t f : it->second) {
+          if(!declarations[f].kept) {
+            declarations[f].kept = true;
+            work.push_back(f);
+          }
+        }
+      }
+    }
+
+    for(const Declaration& c : declarations) {
+      if(c.kind == Declaration::FUNCTION && !c.kept) {
+        removeTokens(tokenItems,c.begin,c.end);
+      }
+      else if(c.kind == Declaration::VARIABLES) {
+        removeUnusedDeclarators(tokenItems,c,referenced);
+      }
+    }
+  }
+
+  std::vector<Declaration> split(const std::vector<size_t>& tokenItems) const {
+    //A declaration ends with a semicolon outside of braces, or with the brace that closes the
+    //body of a function.
+    std::vector<Declaration> declarations;
+    size_t begin = 0;
+    int braces = 0, parentheses = 0;
+    bool functionBody = false;
+    for(size_t k = 0; k < tokenItems.size(); ++k) {
+      const String& s = items[ tokenItems[k] ].token.text;
+      bool end = false;
+      if(s == "(") {
+        ++parentheses;
+      }
+      else if(s == ")") {
+        --parentheses;
+      }
+      else if(s == "{") {
+        if(braces == 0 && k > begin && items[ tokenItems[k-1] ].token.text == ")") {
+          functionBody = true;
+        }
+        ++braces;
+      }
+      else if(s == "}") {
+        end = --braces == 0 && functionBody;
+      }
+      else if(s == ";") {
+        end = braces == 0 && parentheses == 0;
+      }
+      if(end) {
+        Declaration d;
+        d.begin = begin;
+        d.end = k + 1;
+        declarations.push_back(d);
+        begin = k + 1;
+        functionBody = false;
+      }
+    }
+    if( begin < tokenItems.size() ) {
+      Declaration d;
+      d.begin = begin;
+      d.end = tokenItems.size();
+      declarations.push_back(d);
+    }
+    return declarations;
+  }
+
+  void classify(Declaration& d, const std::vector<size_t>& tokenItems, Stage stage) const {
+    auto token = [&](size_t k) -> const Token& {
+      return items[ tokenItems[k] ].token;
+    };
+    bool assignment = false;
+    for(size_t k = d.begin; k < d.end; ++k) {
+      const String& s = token(k).text;
+      if(s == "=" || s == "{") {
+        assignment = true;
+        if(s == "{" && k > d.begin && token(k-1).text == ")") {
+          break; //The body of a function.
+        }
+      }
+      if(s == "(" && !assignment && k > d.begin && token(k-1).kind == Token::IDENTIFIER &&
+        token(k-1).text != "layout")
+      {
+        d.kind = Declaration::FUNCTION;
+        d.name = token(k-1).text;
+        return;
+      }
+    }
+    if(assignment) {
+      return;
+    }
+
+    static const std::unordered_set<String> QUALIFIERS = {
+      "invariant","uniform","varying","attribute","const","highp","mediump","lowp","in","out",
+      "flat","smooth","centroid"
+    };
+    bool removable = false;
+    size_t k = d.begin;
+    for(; k < d.end && QUALIFIERS.count( token(k).text ); ++k) {
+      removable = removable || token(k).text == "uniform" ||
+        (token(k).text == "varying" && stage == Stage::FRAGMENT);
+    }
+    if(!removable || k + 1 >= d.end || token(k).kind != Token::IDENTIFIER ||
+      token(k).text == "struct")
+    {
+      return;
+    }
+    //The type, then names with optional array sizes, separated by commas.
+    size_t declarators = k + 1;
+    for(k = declarators; k + 1 < d.end; ) {
+      if(token(k).kind != Token::IDENTIFIER) {
+        return;
+      }
+      ++k;
+      if(token(k).text == "[") {
+        while( k < d.end && token(k).text != "]" ) {
+          ++k;
+        }
+        ++k;
+      }
+      if( k + 1 < d.end && token(k).text == "," ) {
+        ++k;
+      }
+      else if(k + 1 != d.end) {
+        return;
+      }
+    }
+    if(k + 1 != d.end || token(k).text != ";") {
+      return;
+    }
+    d.kind = Declaration::VARIABLES;
+    d.declarators = declarators;
+  }
+
+  void removeUnusedDeclarators(const std::vector<size_t>& tokenItems, const Declaration& d,
+    const std::unordered_set<String>& referenced)
+  {
+    //Every declarator is a name with an optional array size, followed by a comma or the
+    //semicolon. The commas are removed with the unused declarators, and the ones between the
+    //remaining declarators are put back.
+    auto text = [&](size_t k) -> const String& {
+      return items[ tokenItems[k] ].token.text;
+    };
+    std::vector<size_t> commas;
+    bool anyKept = false;
+    for(size_t k = d.declarators; k + 1 < d.end; ) {
+      size_t begin = k;
+      bool used = referenced.count( text(k) ) > 0;
+      while( k + 1 < d.end && text(k) != "," ) {
+        ++k;
+      }
+      if(!used) {
+        removeTokens(tokenItems,begin,k);
+      }
+      else if(anyKept) {
+        items[ tokenItems[commas.back()] ].removed = false;
+      }
+      anyKept = anyKept || used;
+      if(text(k) == ",") {
+        items[ tokenItems[k] ].removed = true;
+        if(used) {
+          commas.push_back(k);
+        }
+        ++k;
+      }
+    }
+    if(!anyKept) {
+      removeTokens(tokenItems,d.begin,d.end);
+    }
+  }
+
+  void removeTokens(const std::vector<size_t>& tokenItems, size_t begin, size_t end) {
+    for(size_t k = begin; k < end; ++k) {
+      items[ tokenItems[k] ].removed = true;
+    }
+  }
+
+  //Writing
+
+  static bool needsSpace(const Token& a, const Token& b) {
+    //Whether the two tokens would merge into another token without a space between them.
+    static const std::unordered_set<String> PAIRS = {
+      "++","--","<<",">>","<=",">=","==","!=","&&","||","^^","+=","-=","*=","/=","%=","&=",
+      "|=","^=","//","/*"
+    };
+    char x = a.text.back(), y = b.text.front();
+    if( isIdentifierPart(x) && (isIdentifierPart(y) || (a.kind == Token::NUMBER && y == '.')) ) {
+      return true;
+    }
+    if( b.kind == Token::NUMBER && y == '.' && (isIdentifierPart(x) || x == '.') ) {
+      return true;
+    }
+    return a.kind == Token::OPERATOR && b.kind == Token::OPERATOR &&
+      PAIRS.count( String(1,x) + y ) > 0;
+  }
+
+  String writeMinified() const {
+    String out;
+    const Token * previous = nullptr;
+    for(const Item& item : items) {
+      if(item.removed) {
+        continue;
+      }
+      if(item.directive) {
+        if( !out.empty() && out.back() != '\n' ) {
+          out += '\n';
+        }
+        out += item.token.text;
+        out += '\n';
+        previous = nullptr;
+        continue;
+      }
+      if( previous != nullptr && needsSpace(*previous,item.token) ) {
+        out += ' ';
+      }
+      out += item.token.text;
+      previous = &item.token;
+    }
+    if( !out.empty() && out.back() != '\n' ) {
+      out += '\n';
+    }
+    return out;
+  }
+
+  String writeLines() const {
+    //The line after "#line n" has number n, as in GLSL ES 3.00 and C.
+    String out;
+    unsigned int file = 0, line = 1;
+    const Token * previous = nullptr;
+    for(const Item& item : items) {
+      if(item.removed) {
+        continue;
+      }
+      const Token& t = item.token;
+      if(t.file != file || t.line < line) {
+        if( !out.empty() && out.back() != '\n' ) {
+          out += '\n';
+        }
+        out += "#line " + std::to_string(t.line) + " " + std::to_string(t.file) + "\n";
+        file = t.file;
+        line = t.line;
+        previous = nullptr;
+      }
+      else if(t.line > line) {
+        out.append(t.line - line,'\n');
+        line = t.line;
+        previous = nullptr;
+      }
+      if(item.directive) {
+        out += t.text;
+        previous = nullptr;
+        continue;
+      }
+      if( previous != nullptr ? needsSpace(*previous,t) : !out.empty() && out.back() != '\n' ) {
+        out += ' ';
+      }
+      out += t.text;
+      previous = &t;
+    }
+    out += '\n';
+    return out;
+  }
+};
+
+constexpr unsigned int GLSLPreprocessor::I::MAX_INCLUDE_DEPTH;
+
+GLSLPreprocessor::GLSLPreprocessor() {
+  imp = std::unique_ptr<I>( new I() );
+}
+
+GLSLPreprocessor::~GLSLPreprocessor() = default;
+
+GLSLPreprocessor::Options& GLSLPreprocessor::getOptions() {
+  return imp->options;
+}
+
+void GLSLPreprocessor::setIncludeLoader(IncludeLoader loader) {
+  imp->setIncludeLoader( std::move(loader) );
+}
+
+void GLSLPreprocessor::setIncludeDirectory(const String& directory) {
+  imp->setIncludeDirectory(directory);
+}
+
+void GLSLPreprocessor::define(const String& name, const String& value) {
+  imp->define(name,value);
+}
+
+void GLSLPreprocessor::undefine(const String& name) {
+  imp->undefine(name);
+}
+
+std::string GLSLPreprocessor::process(const String& source, Stage stage,
+  const String& sourceName)
+{
+  return imp->process(source,stage,sourceName);
+}
+
+const std::vector<std::string>& GLSLPreprocessor::getFileNames() const {
+  return imp->getFileNames();
+}
+
+uint64_t GLSLPreprocessor::hash(const String& processed) {
+  uint64_t h = 14695981039346656037ull;
+  for(char c : processed) {
+    h ^= (unsigned char) c;
+    h *= 1099511628211ull;
+  }
+  return h;
+}
+
+}
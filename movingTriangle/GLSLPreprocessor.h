@@ -0,0 +1,64 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstdint>
+
+namespace ProjectName {
+
+class GLSLPreprocessor {
+  //Preprocesses GLSL ES before it is given to the driver, whose compiler is slow on embedded
+  //GPUs and spends part of its time on text that does not contribute to the shader:
+  //  - #include "name" inserts a file, each file once per process() call;
+  //  - #define, #undef and the conditionals are evaluated here, and the macros expanded, so the
+  //    conditions fold to the code of one branch;
+  //  - comments are removed, and with Options::removeUnused functions that main() never calls
+  //    and uniforms that no remaining code uses, and in fragment shaders unused varyings;
+  //  - with Options::minify the tokens are joined with a space only where one is needed.
+  //#version, #extension and #pragma are passed on. The output of equal inputs is equal, and
+  //hash() of it is the same on every run and platform, so it can be the key of a cache of
+  //compiled shaders. Errors throw std::runtime_error with the file and line; the # and ##
+  //operators, which GLSL ES does not have, are errors in #define.
+  //GL_ES and __VERSION__ are predefined. GL_FRAGMENT_PRECISION_HIGH depends on the GPU; define
+  //it with define() if a shader asks for it and the GPU supports highp in fragment shaders.
+ public:
+  using String = std::string;
+  using IncludeLoader = std::function<bool(const String& name, String& contents)>;
+
+  enum class Stage {
+    VERTEX,
+    FRAGMENT
+  };
+
+  class Options {
+   public:
+    bool removeUnused{true};
+    bool minify{true}; //Otherwise the lines stay where they were, see process().
+  };
+
+  GLSLPreprocessor();
+  ~GLSLPreprocessor();
+
+  Options& getOptions();
+
+  void setIncludeLoader(IncludeLoader loader); //Returns false if there is no such file.
+  void setIncludeDirectory(const String& directory); //Sets a loader that reads the files there.
+
+  void define(const String& name, const String& value = "1");
+  void undefine(const String& name);
+
+  String process(const String& source, Stage stage, const String& sourceName = "source");
+  //Without minify every line is at its line number, and the lines of an included file follow
+  //"#line 1 n", where n is the number of the file in the order of getFileNames().
+  const std::vector<String>& getFileNames() const; //Of the last process(); the source first.
+
+  static uint64_t hash(const String& processed); //64-bit FNV-1a.
+
+ private:
+  class I;
+  std::unique_ptr<I> imp;
+};
+
+}
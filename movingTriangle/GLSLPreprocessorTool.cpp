@@ -0,0 +1,99 @@
+#include "GLSLPreprocessor.h"
+
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+//Preprocesses a GLSL file offline, as ShaderPermutations does at run time, and writes the
+//result to the standard output and its hash to the standard error. The included files are
+//looked up in the directory of the file unless -I is given.
+//
+//  glslPreprocessor [-v|-f] [-DNAME[=VALUE]...] [-Idirectory] [-l] [-k] file.glsl
+//
+//  -v, -f  vertex (the default) or fragment shader; only fragment shaders lose unused varyings
+//  -l      keep the lines instead of minifying
+//  -k      keep unused functions, uniforms and varyings
+
+namespace {
+
+using namespace ProjectName;
+
+std::string readFile(const std::string& path) {
+  std::ifstream stream(path);
+  if( !stream.good() ) {
+    throw std::runtime_error("Cannot read " + path);
+  }
+  std::stringstream s;
+  s << stream.rdbuf();
+  return s.str();
+}
+
+std::string getDirectory(const std::string& path) {
+  size_t slash = path.find_last_of('/');
+  return slash == std::string::npos ? "." : path.substr(0,slash);
+}
+
+}
+
+int main(int n, char ** arguments) {
+  GLSLPreprocessor preprocessor;
+  GLSLPreprocessor::Stage stage = GLSLPreprocessor::Stage::VERTEX;
+  std::string file, includeDirectory;
+  for(int i = 1; i < n; ++i) {
+    const char * a = arguments[i];
+    if(std::strcmp(a,"-v") == 0) {
+      stage = GLSLPreprocessor::Stage::VERTEX;
+    }
+    else if(std::strcmp(a,"-f") == 0) {
+      stage = GLSLPreprocessor::Stage::FRAGMENT;
+    }
+    else if(std::strcmp(a,"-l") == 0) {
+      preprocessor.getOptions().minify = false;
+    }
+    else if(std::strcmp(a,"-k") == 0) {
+      preprocessor.getOptions().removeUnused = false;
+    }
+    else if(std::strncmp(a,"-D",2) == 0) {
+      std::string definition = a + 2;
+      size_t equals = definition.find('=');
+      if(equals == std::string::npos) {
+        preprocessor.define(definition);
+      }
+      else {
+        preprocessor.define( definition.substr(0,equals),definition.substr(equals + 1) );
+      }
+    }
+    else if(std::strncmp(a,"-I",2) == 0) {
+      includeDirectory = a + 2;
+    }
+    else {
+      file = a;
+    }
+  }
+  if( file.empty() ) {
+    std::fprintf(stderr,"usage: glslPreprocessor [-v|-f] [-DNAME[=VALUE]] [-Idirectory] [-l] "
+      "[-k] file.glsl\n"
+    );
+    return 2;
+  }
+
+  try {
+    std::string source = readFile(file);
+    preprocessor.setIncludeDirectory( includeDirectory.empty() ? getDirectory(file) :
+      includeDirectory
+    );
+    std::string result = preprocessor.process(source,stage,file);
+    std::fputs(result.c_str(),stdout);
+    std::fprintf(stderr,"%zu of %zu bytes, hash %016llx\n",result.size(),source.size(),
+      (unsigned long long) GLSLPreprocessor::hash(result)
+    );
+  }
+  catch(const std::exception& e) {
+    std::fprintf(stderr,"%s\n",e.what());
+    return 1;
+  }
+  return 0;
+}
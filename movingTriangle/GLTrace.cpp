@@ -0,0 +1,295 @@
+#include "GLTrace.h"
+#include "GLTraceFormat.h"
+#include "GLExtensions.h"
+#include "Logger.h"
+
+#include <glad/glad.h>
+
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+namespace ProjectName {
+
+using namespace GLTraceFormat;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::vector<char> * recordBuffer{nullptr}; //Only used on the render thread.
+uint64_t unpackAlignment{4}; //GL_UNPACK_ALIGNMENT, followed through the hooked glPixelStorei.
+
+void append(const void * data, size_t bytes) {
+  const char * c = (const char *) data;
+  recordBuffer->insert(recordBuffer->end(),c,c + bytes);
+}
+
+template<class T>
+void appendValue(T t) {
+  append( &t,sizeof(T) );
+}
+
+class CallRecorder {
+  //Lives for the duration of one hooked call. The arguments are encoded before the clock starts
+  //and the record is appended after it stops, so that the time is that of the driver alone.
+ public:
+  explicit CallRecorder(FunctionId id) : id(id) {
+
+  }
+
+  ~CallRecorder() {
+    uint64_t nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      Clock::now() - start
+    ).count();
+    if(recordBuffer == nullptr) {
+      return;
+    }
+
+    std::string source; //Only for glShaderSource.
+    const void * payload = nullptr;
+    uint64_t payloadBytes = 0;
+    findPayload(source,payload,payloadBytes);
+    if(id == glPixelStorei_ID && raw[0] == GL_UNPACK_ALIGNMENT) {
+      unpackAlignment = raw[1];
+    }
+
+    appendValue( (uint16_t) id );
+    appendValue( (uint8_t) (payload != nullptr ? HAS_PAYLOAD : 0) );
+    appendValue( (uint32_t) (nanoseconds < UINT32_MAX ? nanoseconds : UINT32_MAX) );
+    append(argumentBytes,argumentByteCount);
+    if(payload != nullptr) {
+      appendValue( (uint32_t) payloadBytes );
+      append(payload,payloadBytes);
+    }
+  }
+
+  template<class... Arguments>
+  void setArguments(Arguments... arguments) {
+    argumentByteCount = Signature<Arguments...>::getBytes();
+    Signature<Arguments...>::encode(argumentBytes,raw,arguments...);
+  }
+
+  void startClock() {
+    start = Clock::now();
+  }
+
+ private:
+  FunctionId id;
+  char argumentBytes[MAX_ARGUMENTS*sizeof(uint64_t)];
+  size_t argumentByteCount{0};
+  uint64_t raw[MAX_ARGUMENTS];
+  Clock::time_point start;
+
+  void findPayload(std::string& source, const void *& payload, uint64_t& bytes) {
+    PayloadRule rule = getPayloadRule(id,raw,unpackAlignment);
+    if(rule.kind == PayloadRule::NONE || rule.kind == PayloadRule::OFFSET) {
+      return;
+    }
+    const void * pointer = (const void *) (uintptr_t) raw[rule.argument];
+    if(pointer == nullptr) {
+      return;
+    }
+
+    switch(rule.kind) {
+      case PayloadRule::BYTES:
+        payload = pointer;
+        bytes = rule.size;
+        break;
+      case PayloadRule::STRING:
+        payload = pointer;
+        bytes = std::strlen( (const char *) pointer ) + 1;
+        break;
+      case PayloadRule::SHADER_SOURCE: {
+        GLsizei count = (GLsizei) raw[1];
+        const GLchar * const * strings = (const GLchar * const *) pointer;
+        const GLint * lengths = (const GLint *) (uintptr_t) raw[3];
+        for(GLsizei i = 0; i < count; ++i) {
+          if(lengths != nullptr && lengths[i] >= 0) {
+            source.append(strings[i],lengths[i]);
+          }
+          else {
+            source.append(strings[i]);
+          }
+        }
+        payload = source.c_str();
+        bytes = source.size() + 1;
+        break;
+      }
+      default:
+        break;
+    }
+  }
+};
+
+template<FunctionId ID, class F>
+class Hook;
+
+template<FunctionId ID, class R, class... Arguments>
+class Hook<ID,R (APIENTRYP)(Arguments...)> {
+ public:
+  using Function = R (APIENTRYP)(Arguments...);
+
+  static Function original;
+
+  static R APIENTRY call(Arguments... arguments) {
+    CallRecorder recorder(ID);
+    recorder.setArguments(arguments...);
+    recorder.startClock();
+    return original(arguments...);
+  }
+};
+
+template<FunctionId ID, class R, class... Arguments>
+typename Hook<ID,R (APIENTRYP)(Arguments...)>::Function
+Hook<ID,R (APIENTRYP)(Arguments...)>::original{nullptr};
+
+void installHooks() {
+  #define PROJECTNAME_INSTALL_HOOK(name) \
+    if(name != nullptr) { \
+      Hook<name##_ID,decltype(name)>::original = name; \
+      name = &Hook<name##_ID,decltype(name)>::call; \
+    }
+  PROJECTNAME_GL_FUNCTIONS(PROJECTNAME_INSTALL_HOOK)
+  #undef PROJECTNAME_INSTALL_HOOK
+}
+
+void uninstallHooks() {
+  #define PROJECTNAME_UNINSTALL_HOOK(name) \
+    if(Hook<name##_ID,decltype(name)>::original != nullptr) { \
+      name = Hook<name##_ID,decltype(name)>::original; \
+      Hook<name##_ID,decltype(name)>::original = nullptr; \
+    }
+  PROJECTNAME_GL_FUNCTIONS(PROJECTNAME_UNINSTALL_HOOK)
+  #undef PROJECTNAME_UNINSTALL_HOOK
+}
+
+}
+
+class GLTrace::I {
+ public:
+  ~I() {
+    stop();
+  }
+
+  bool start(const std::string& path, unsigned int frames) {
+    stop();
+    file = std::fopen(path.c_str(),"wb");
+    if(file == nullptr) {
+      LOG_ERROR("Could not open the trace file %s.\n",path);
+      return false;
+    }
+    //Calls through extension functions would be missing from the trace, and a replay would
+    //draw with other state. They stay disabled after the trace, because vertex arrays that are
+    //emulated now cannot become real ones.
+    GLExtensions::disableExtensionFunctions();
+    framesLeft = frames;
+    buffer.clear();
+    recordBuffer = &buffer;
+    writeHeader();
+    GLint alignment = 4;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT,&alignment);
+    unpackAlignment = (uint64_t) alignment;
+    installHooks();
+    LOG_INFO("Tracing %u frames of OpenGL calls to %s.\n",frames,path);
+    return true;
+  }
+
+  void endFrame() {
+    if(file == nullptr) {
+      return;
+    }
+    appendValue(FRAME_MARKER);
+    appendValue( (uint8_t) 0 );
+    appendValue( (uint32_t) 0 );
+    writeBuffer();
+
+    if(--framesLeft == 0) {
+      stop();
+    }
+  }
+
+  void stop() {
+    if(file == nullptr) {
+      return;
+    }
+    uninstallHooks();
+    writeBuffer();
+    recordBuffer = nullptr;
+    std::fclose(file);
+    file = nullptr;
+    LOG_INFO("The OpenGL trace has been written.\n");
+  }
+
+  bool isActive() const {
+    return file != nullptr;
+  }
+
+ private:
+  std::FILE * file{nullptr};
+  unsigned int framesLeft{0};
+  std::vector<char> buffer;
+
+  void writeHeader() {
+    append(getMagic(),4);
+    appendValue(VERSION);
+    appendValue( (uint16_t) NUMBER_OF_FUNCTIONS );
+    for(uint16_t i = 0; i < NUMBER_OF_FUNCTIONS; ++i) {
+      const char * name = getFunctionName( (FunctionId) i );
+      appendValue( (uint8_t) std::strlen(name) );
+      append( name,std::strlen(name) );
+    }
+  }
+
+  void writeBuffer() {
+    if( !buffer.empty() ) {
+      std::fwrite(buffer.data(),1,buffer.size(),file);
+      buffer.clear();
+    }
+  }
+};
+
+constexpr unsigned int GLTrace::DEFAULT_FRAMES;
+
+GLTrace& GLTrace::get() {
+  static GLTrace trace;
+  return trace;
+}
+
+GLTrace::GLTrace() {
+  imp = std::unique_ptr<I>( new I() );
+}
+
+GLTrace::~GLTrace() = default;
+
+bool GLTrace::start(const std::string& path, unsigned int frames) {
+  return imp->start(path,frames);
+}
+
+bool GLTrace::startFromEnvironment() {
+  const char * path = std::getenv("PROJECTNAME_GL_TRACE");
+  if(path == nullptr || *path == '\0') {
+    return false;
+  }
+  unsigned int frames = DEFAULT_FRAMES;
+  const char * framesText = std::getenv("PROJECTNAME_GL_TRACE_FRAMES");
+  if(framesText != nullptr && std::atoi(framesText) > 0) {
+    frames = (unsigned int) std::atoi(framesText);
+  }
+  return imp->start(path,frames);
+}
+
+void GLTrace::endFrame() {
+  imp->endFrame();
+}
+
+void GLTrace::stop() {
+  imp->stop();
+}
+
+bool GLTrace::isActive() const {
+  return imp->isActive();
+}
+
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+namespace ProjectName {
+
+class GLTrace {
+  //Records every OpenGL call of the render thread into a binary trace (see GLTraceFormat.h) that
+  //glReplay can execute again without this program. While a trace is recorded, the glad function
+  //pointers point to hooks that time the original function and store its name, arguments and
+  //the memory it reads; otherwise the hooks are not installed and cost nothing.
+  //
+  //GLWindow starts a trace when the environment variable PROJECTNAME_GL_TRACE holds a file name;
+  //PROJECTNAME_GL_TRACE_FRAMES sets the number of frames (default DEFAULT_FRAMES). The trace
+  //starts right after the functions have been loaded, so that the initialization of the
+  //renderer is part of it and a replay can rebuild the same objects. Only the functions of glad
+  //are hooked, so a trace disables the extension functions of GLExtensions for the rest of the
+  //run: vertex array objects are emulated, and there are no GPU timer queries.
+ public:
+  static constexpr unsigned int DEFAULT_FRAMES = 60;
+
+  static GLTrace& get();
+
+  ~GLTrace();
+
+  bool start(const std::string& path, unsigned int frames);
+  //Requires that glad has loaded the functions. Returns false if the file cannot be opened.
+
+  bool startFromEnvironment();
+
+  void endFrame();
+  //Call after swapping the buffers. Writes the calls of the frame to the file and stops the
+  //trace after the requested number of frames.
+
+  void stop();
+
+  bool isActive() const;
+
+ private:
+  class I;
+  std::unique_ptr<I> imp;
+
+  GLTrace();
+};
+
+}
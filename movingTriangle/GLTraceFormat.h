@@ -0,0 +1,278 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include "GLFunctionList.h"
+
+//The binary format that GLTrace writes and glReplay reads. All numbers are in the byte order of
+//the machine that recorded the trace.
+//
+//  header:  "GLTR", uint32 version, uint16 number of functions, and for every function a uint8
+//           name length and the name. Function ids in the records index this table, so a trace
+//           stays readable when glad is regenerated.
+//  record:  uint16 function id, uint8 flags, uint32 CPU time of the call in nanoseconds, the
+//           arguments with sizeof(type) bytes each, and with HAS_PAYLOAD a uint32 size and the
+//           bytes that a pointer argument pointed to (see getPayloadRule).
+//  frame:   a record with function id FRAME_MARKER and no arguments. The records before the
+//           first marker set up the state that the frames need.
+
+namespace ProjectName {
+
+namespace GLTraceFormat {
+
+constexpr uint32_t VERSION = 1;
+constexpr uint16_t FRAME_MARKER = 0xFFFF;
+constexpr uint8_t HAS_PAYLOAD = 1;
+constexpr unsigned char MAX_ARGUMENTS = 9; //glTexImage2D and glTexSubImage2D
+
+inline const char * getMagic() {
+  return "GLTR";
+}
+
+#define PROJECTNAME_GL_FUNCTION_ID(name) name##_ID,
+enum FunctionId : uint16_t {
+  PROJECTNAME_GL_FUNCTIONS(PROJECTNAME_GL_FUNCTION_ID)
+  NUMBER_OF_FUNCTIONS
+};
+#undef PROJECTNAME_GL_FUNCTION_ID
+
+inline const char * getFunctionName(FunctionId id) {
+  #define PROJECTNAME_GL_FUNCTION_NAME(name) #name,
+  static const char * names[] = {
+    PROJECTNAME_GL_FUNCTIONS(PROJECTNAME_GL_FUNCTION_NAME)
+  };
+  #undef PROJECTNAME_GL_FUNCTION_NAME
+  return id < NUMBER_OF_FUNCTIONS ? names[id] : "frame";
+}
+
+//Every argument is also kept as a uint64: integers are sign or zero extended, floats keep their
+//bits and pointers their address. The payload rules and the replay work on these values.
+
+template<class T>
+typename std::enable_if<std::is_pointer<T>::value,uint64_t>::type toRaw(T t) {
+  return (uint64_t) (uintptr_t) t;
+}
+
+template<class T>
+typename std::enable_if<std::is_floating_point<T>::value,uint64_t>::type toRaw(T t) {
+  if( sizeof(T) == sizeof(uint32_t) ) {
+    uint32_t bits;
+    std::memcpy( &bits,&t,sizeof(bits) );
+    return bits;
+  }
+  uint64_t bits;
+  std::memcpy( &bits,&t,sizeof(bits) );
+  return bits;
+}
+
+template<class T>
+typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value,uint64_t>::type
+toRaw(T t) {
+  return (uint64_t) (int64_t) t;
+}
+
+template<class T>
+typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value,uint64_t>::type
+toRaw(T t) {
+  return (uint64_t) t;
+}
+
+template<class T>
+typename std::enable_if<std::is_pointer<T>::value,T>::type fromRaw(uint64_t raw, void * override) {
+  return override != nullptr ? (T) override : (T) (uintptr_t) raw;
+}
+
+template<class T>
+typename std::enable_if<std::is_floating_point<T>::value,T>::type fromRaw(uint64_t raw, void *) {
+  T t;
+  if( sizeof(T) == sizeof(uint32_t) ) {
+    uint32_t bits = (uint32_t) raw;
+    std::memcpy( &t,&bits,sizeof(T) );
+  }
+  else {
+    std::memcpy( &t,&raw,sizeof(T) );
+  }
+  return t;
+}
+
+template<class T>
+typename std::enable_if<std::is_integral<T>::value,T>::type fromRaw(uint64_t raw, void *) {
+  return (T) raw;
+}
+
+template<class... Arguments>
+class Signature {
+  //Encodes and decodes the arguments of a function with these parameter types.
+ public:
+  static constexpr size_t COUNT = sizeof...(Arguments);
+  static_assert(COUNT <= MAX_ARGUMENTS,"Increase GLTraceFormat::MAX_ARGUMENTS");
+
+  static size_t getBytes() {
+    size_t sizes[] = { 0,sizeof(Arguments)... };
+    size_t result = 0;
+    for(size_t s : sizes) {
+      result += s;
+    }
+    return result;
+  }
+
+  static bool isPointer(size_t i) {
+    bool pointers[] = { false,std::is_pointer<Arguments>::value... };
+    return pointers[i + 1];
+  }
+
+  static void encode(char * bytes, uint64_t * raw, Arguments... arguments) {
+    int expand[] = { 0,( encodeOne(bytes,raw,arguments),0 )... };
+    (void) expand;
+    (void) bytes; //For functions without arguments.
+    (void) raw;
+  }
+
+  static void decode(const char * bytes, uint64_t * raw) {
+    int expand[] = { 0,( decodeOne<Arguments>(bytes,raw),0 )... };
+    (void) expand;
+    (void) bytes;
+    (void) raw;
+  }
+
+ private:
+  template<class T>
+  static void encodeOne(char *& bytes, uint64_t *& raw, T t) {
+    std::memcpy( bytes,&t,sizeof(T) );
+    bytes += sizeof(T);
+    *raw++ = toRaw(t);
+  }
+
+  template<class T>
+  static void decodeOne(const char *& bytes, uint64_t *& raw) {
+    T t;
+    std::memcpy( &t,bytes,sizeof(T) );
+    bytes += sizeof(T);
+    *raw++ = toRaw(t);
+  }
+};
+
+template<class F>
+class FunctionSignature;
+
+template<class R, class... Arguments>
+class FunctionSignature<R (APIENTRYP)(Arguments...)> : public Signature<Arguments...> {
+ public:
+  using Function = R (APIENTRYP)(Arguments...);
+
+  static void call(Function f, const uint64_t * raw, void * const * overrides) {
+    call( f,raw,overrides,std::index_sequence_for<Arguments...>() );
+  }
+
+ private:
+  template<size_t... I>
+  static void call(Function f, const uint64_t * raw, void * const * overrides,
+    std::index_sequence<I...>)
+  {
+    (void) raw;
+    (void) overrides;
+    f( fromRaw<Arguments>(raw[I],overrides[I])... );
+  }
+};
+
+class PayloadRule {
+  //Which argument points to memory that the call reads, and how much of it.
+ public:
+  enum Kind : unsigned char {
+    NONE, //No pointer argument that the call reads.
+    BYTES, //size bytes.
+    STRING, //A zero terminated string.
+    SHADER_SOURCE, //The string array of glShaderSource, stored as one string.
+    OFFSET //A pointer argument that is an offset into a buffer object; replayed as it is.
+  };
+
+  Kind kind{NONE};
+  unsigned char argument{0};
+  uint64_t size{0};
+
+  PayloadRule() = default;
+
+  PayloadRule(Kind kind, unsigned char argument, uint64_t size = 0) : kind(kind),
+    argument(argument), size(size)
+  {
+
+  }
+};
+
+inline uint64_t getPixelBytes(uint64_t width, uint64_t height, uint64_t format, uint64_t type,
+  uint64_t alignment)
+{
+  //Every row but the last is padded to the alignment, GL_UNPACK_ALIGNMENT.
+  if(width == 0 || height == 0) {
+    return 0;
+  }
+  uint64_t channels = 4;
+  switch(format) {
+    case GL_ALPHA: case 0x1909: channels = 1; break; //GL_LUMINANCE
+    case 0x190A: channels = 2; break; //GL_LUMINANCE_ALPHA
+    case GL_RGB: channels = 3; break;
+  }
+  uint64_t bytesPerPixel = channels;
+  switch(type) {
+    case GL_UNSIGNED_SHORT_5_6_5: case GL_UNSIGNED_SHORT_4_4_4_4: case GL_UNSIGNED_SHORT_5_5_5_1:
+      bytesPerPixel = 2;
+      break;
+    case GL_FLOAT: bytesPerPixel = channels*4; break;
+    case 0x8D61: bytesPerPixel = channels*2; break; //GL_HALF_FLOAT_OES
+  }
+  uint64_t pixelBytes = width*bytesPerPixel;
+  uint64_t rowBytes = (pixelBytes + alignment - 1)/alignment*alignment;
+  return rowBytes*(height - 1) + pixelBytes;
+}
+
+inline PayloadRule getPayloadRule(FunctionId id, const uint64_t * raw,
+  uint64_t unpackAlignment = 4)
+{
+  //The alignment is the GL_UNPACK_ALIGNMENT of the call; only the sizes of pixels depend on it.
+  using R = PayloadRule;
+  const uint64_t a = unpackAlignment;
+  switch(id) {
+    case glBufferData_ID: return R(R::BYTES,2,raw[1]);
+    case glBufferSubData_ID: return R(R::BYTES,3,raw[2]);
+    case glTexImage2D_ID: return R( R::BYTES,8,getPixelBytes(raw[3],raw[4],raw[6],raw[7],a) );
+    case glTexSubImage2D_ID: return R( R::BYTES,8,getPixelBytes(raw[4],raw[5],raw[6],raw[7],a) );
+    case glCompressedTexImage2D_ID: return R(R::BYTES,7,raw[6]);
+    case glCompressedTexSubImage2D_ID: return R(R::BYTES,8,raw[7]);
+
+    case glUniform1fv_ID: case glUniform1iv_ID: return R(R::BYTES,2,raw[1]*4);
+    case glUniform2fv_ID: case glUniform2iv_ID: return R(R::BYTES,2,raw[1]*8);
+    case glUniform3fv_ID: case glUniform3iv_ID: return R(R::BYTES,2,raw[1]*12);
+    case glUniform4fv_ID: case glUniform4iv_ID: return R(R::BYTES,2,raw[1]*16);
+    case glUniformMatrix2fv_ID: return R(R::BYTES,3,raw[1]*16);
+    case glUniformMatrix3fv_ID: return R(R::BYTES,3,raw[1]*36);
+    case glUniformMatrix4fv_ID: return R(R::BYTES,3,raw[1]*64);
+    case glVertexAttrib1fv_ID: return R(R::BYTES,1,4);
+    case glVertexAttrib2fv_ID: return R(R::BYTES,1,8);
+    case glVertexAttrib3fv_ID: return R(R::BYTES,1,12);
+    case glVertexAttrib4fv_ID: return R(R::BYTES,1,16);
+    case glTexParameterfv_ID: case glTexParameteriv_ID: return R(R::BYTES,2,4);
+
+    case glDeleteBuffers_ID: case glDeleteTextures_ID: case glDeleteFramebuffers_ID:
+    case glDeleteRenderbuffers_ID:
+      return R(R::BYTES,1,raw[0]*4);
+
+    case glBindAttribLocation_ID: return R(R::STRING,2);
+    case glGetUniformLocation_ID: case glGetAttribLocation_ID: return R(R::STRING,1);
+    case glShaderSource_ID: return R(R::SHADER_SOURCE,2);
+
+    case glDrawElements_ID: return R(R::OFFSET,3);
+    case glVertexAttribPointer_ID: return R(R::OFFSET,5);
+
+    default: return R();
+  }
+}
+
+}
+
+}
@@ -1,11 +1,28 @@
 #include "GLWindow.h"
+#include "LinearArena.h"
+#include "FrameProfiler.h"
+#include "DynamicResolution.h"
+#include "DamageRegion.h"
+#include "EGLDamage.h"
+#include "RenderPass.h"
+#include "Profiler.h"
+#include "GLResource.h"
+#include "GLExtensions.h"
+#include "Logger.h"
+#include "GLDebug.h"
+#include "GLTrace.h"
 
-#include <cstdio>
 #include <atomic>
 
 #include <thread>
+#include <chrono>
 
+#include <vector>
+#include <string>
+#include <algorithm>
 #include <stdexcept>
+#include <cstdlib>
+#include <ctime>
 
 #include<glad/glad.h>
 #include <SDL.h>
@@ -13,6 +30,8 @@
 namespace ProjectName {
   
 class GLWindow::I {
+  using Clock = std::chrono::steady_clock;
+
  public:
   I() {
     
@@ -27,15 +46,42 @@ class GLWindow::I {
   }
 
   int getScreenWidth() const {
-    return screenWidth;
+    return displays[0].width;
   }
 
   int getScreenHeight() const {
-    return screenHeight;
+    return displays[0].height;
   }
 
   int getScreenFrequency() const {
-    return screenFrequency;
+    return displays[0].frequency;
+  }
+
+  unsigned int getDisplayCount() const {
+    return (unsigned int) displays.size();
+  }
+
+  const DisplayInformation& getDisplayInformation(unsigned int displayNumber) const {
+    if( displayNumber >= displays.size() ) {
+      throw std::out_of_range("GLWindow::getDisplayInformation");
+    }
+    return displays[displayNumber];
+  }
+
+  void setWindowCount(unsigned int n) {
+    windowCount = n;
+  }
+
+  void setDynamicResolution(bool enabled) {
+    dynamicResolutionEnabled = enabled;
+  }
+
+  DynamicResolution& getDynamicResolution() {
+    return dynamicResolution;
+  }
+
+  void setDamageTracking(bool enabled) {
+    damageTrackingEnabled = enabled;
   }
 
   void start() {
@@ -45,7 +91,7 @@ class GLWindow::I {
     
     stopBoolean = false;
 
-    createWindow();
+    createWindows();
 
     renderThread = std::thread( [this]() { renderThreadFunction(); } );
   }
@@ -54,61 +100,148 @@ class GLWindow::I {
     renderer = r;
   }
 
+  FrameArena& getFrameArena() {
+    return frameArena;
+  }
+
+  FrameProfiler& getFrameProfiler() {
+    return frameProfiler;
+  }
+
   void stop() {
     stopBoolean = true;
     renderThread.join();
   }
 
  private:
+  class Window {
+   public:
+    SDL_Window * window{nullptr};
+    const DisplayInformation * display{nullptr};
+    unsigned int windowNumber{0};
+    unsigned int renderInterval{1}; //The window is rendered every renderInterval frames.
+    bool waitsForVerticalBlank{false};
+    int width{0}, height{0}; //Of the drawable in the last frame.
+    DamageRegion damage; //Since the window was rendered last.
+    DamageRegion repaint;
+    DamageHistory history;
+  };
+
+  class DamageStatistics {
+    //Since the last log.
+   public:
+    unsigned long frames{0}, skippedFrames{0}, renderedViews{0};
+    double pixels{0}, viewPixels{0}; //Of the rendered views: in the scissor, and in total.
+    Clock::duration idleTime{0};
+    std::clock_t idleCPUTime{0}; //Of all threads of the process, during idleTime.
+    Clock::time_point lastFrame{ Clock::now() };
+    std::clock_t lastCPUTime{ std::clock() };
+
+    void endFrame(bool skipped) {
+      Clock::time_point now = Clock::now();
+      std::clock_t cpu = std::clock();
+      ++frames;
+      if(skipped) {
+        ++skippedFrames;
+        idleTime += now - lastFrame;
+        idleCPUTime += cpu - lastCPUTime;
+      }
+      lastFrame = now;
+      lastCPUTime = cpu;
+    }
+  };
+
   Renderer * renderer{nullptr};
-  SDL_Window * window{nullptr};
+  std::vector<Window> windows; //The window that waits for the vertical blank is the last one.
   SDL_GLContext context{nullptr};
+  SDL_Window * currentWindow{nullptr};
 
   std::atomic<bool> stopBoolean{true};
   std::thread renderThread;
 
-  int screenWidth{0}, screenHeight{0}, screenFrequency{0};
+  FrameArena frameArena;
+  FrameProfiler frameProfiler;
+  DynamicResolution dynamicResolution;
+  bool dynamicResolutionEnabled{false};
+  bool damageTrackingEnabled{true};
+  EGLDamage eglDamage;
+  DamageRegion frameDamage; //What the renderer reports for one view.
+  DamageStatistics damageStatistics;
+  unsigned long lastGPUProfile{0}; //The last frame whose GPU time went to dynamicResolution.
+  static constexpr unsigned int PROFILE_LOG_INTERVAL = 600; //Frames
+
+  std::vector<DisplayInformation> displays;
+  unsigned int windowCount{0}; //0 for one window per display.
 
   void initializeVideoSubsystem() {
-    std::printf("Initializing the video subsystem.\n");
+    LOG_INFO("Initializing the video subsystem.\n");
     if( SDL_InitSubSystem(SDL_INIT_VIDEO) != 0 ) {
-      std::printf("The video subsystem could not be initialized.\n");
+      LOG_ERROR("The video subsystem could not be initialized.\n");
       throw std::runtime_error("SDL initialization error");
     }
   }
 
   void obtainScreenInformation() {
     int n = SDL_GetNumVideoDisplays();
-    if(n == 1) {
-      std::printf("There is one video display.\n");
+    if(n < 1) {
+      LOG_ERROR("Could not obtain a video display.\n");
+      SDL_Quit();
+      throw std::runtime_error("No display");
     }
-    else if(n > 0) {
-      std::printf(
-        "There are %d video displays, but this program will naively use the first\n"
-        "display it can find.\n",n
-      );
+    LOG_INFO("There %s %d video display%s.\n",n == 1 ? "is" : "are",n,n == 1 ? "" : "s");
+
+    displays.clear();
+    for(int i = 0; i < n; ++i) {
+      obtainDisplayInformation(i);
     }
-    else {
-      std::printf("Could not obtain a video display.\n");
+    if( displays.empty() ) {
+      LOG_ERROR("Could not obtain information about any video display.\n");
       SDL_Quit();
       throw std::runtime_error("No display");
     }
 
-    obtainDisplayInformation(0);
+    const char * windows = std::getenv("PROJECTNAME_WINDOWS");
+    if(windows != nullptr) {
+      windowCount = (unsigned int) std::max( std::atoi(windows),0 );
+    }
+    const char * dynamic = std::getenv("PROJECTNAME_DYNAMIC_RESOLUTION");
+    if(dynamic != nullptr) {
+      dynamicResolutionEnabled = std::atoi(dynamic) != 0;
+    }
+    const char * damage = std::getenv("PROJECTNAME_DAMAGE");
+    if(damage != nullptr) {
+      damageTrackingEnabled = std::atoi(damage) != 0;
+    }
   }
 
-  void obtainDisplayInformation(int displayNumber) { 
-
+  void obtainDisplayInformation(int displayNumber) {
     SDL_DisplayMode desktopMode;
-    SDL_GetDesktopDisplayMode(displayNumber,&desktopMode);
-    
-    screenWidth = desktopMode.w;
-    screenHeight = desktopMode.h;
-    screenFrequency = desktopMode.refresh_rate;
+    SDL_Rect bounds;
+    if( SDL_GetDesktopDisplayMode(displayNumber,&desktopMode) != 0 ||
+      SDL_GetDisplayBounds(displayNumber,&bounds) != 0
+    ) {
+      LOG_WARNING("Skipping display %d: %s\n",displayNumber,SDL_GetError());
+      SDL_ClearError();
+      return;
+    }
+
+    DisplayInformation d;
+    d.displayNumber = displayNumber;
+    d.x = bounds.x;
+    d.y = bounds.y;
+    d.width = desktopMode.w;
+    d.height = desktopMode.h;
+    d.frequency = desktopMode.refresh_rate;
+    displays.push_back(d);
+
+    const char * name = SDL_GetDisplayName(displayNumber);
+    LOG_INFO("Display %d (%s): %dx%d at (%d,%d), %d Hz\n",displayNumber,name ? name : "unnamed",
+      d.width,d.height,d.x,d.y,d.frequency
+    );
   }
-  
+
   void throwMissingRendererError() {
-    std::printf(
+    LOG_ERROR(
       "Method start of GLWindow is called without a specified renderer.\n"
       "The method setRenderer should be used.\n"
     );
@@ -117,7 +250,7 @@ class GLWindow::I {
   }
 
   void throwWindowCreationError() {
-    std::printf(
+    LOG_ERROR(
       "Could not create a window.\n"
       "SDL error message: %s\n",SDL_GetError()
     );
@@ -125,55 +258,291 @@ class GLWindow::I {
     throw std::runtime_error("Window creation failed");
   }
   
-  void createWindow() {
+  void createWindows() {
     SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
     SDL_GL_SetAttribute(SDL_GL_ACCELERATED_VISUAL, 1);
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_ES);
+    //SDL asks for a 16 bit depth buffer by default, which no renderer uses.
+    SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, 0);
 
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 2);
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 0);
-
-    
- 
-    window = SDL_CreateWindow("NameOfWindow",0,0,screenWidth,screenHeight,
-      SDL_WINDOW_OPENGL|
-      SDL_WINDOW_FULLSCREEN|
-      SDL_WINDOW_BORDERLESS
-    );
-
-    if(!window) {
-      throwWindowCreationError();
+#ifdef PROJECTNAME_GL_DEBUG
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS, SDL_GL_CONTEXT_DEBUG_FLAG);
+#endif
+
+    //All windows are created with the same attributes, so the one context can be made current
+    //with each of them.
+    unsigned int n = windowCount > 0 ? windowCount : (unsigned int) displays.size();
+    windows.clear();
+    for(unsigned int i = 0; i < n; ++i) {
+      const DisplayInformation& d = displays[i % displays.size()];
+      Window w;
+      w.window = SDL_CreateWindow("NameOfWindow",d.x,d.y,d.width,d.height,
+        SDL_WINDOW_OPENGL|
+        SDL_WINDOW_FULLSCREEN|
+        SDL_WINDOW_BORDERLESS
+      );
+      if(!w.window) {
+        throwWindowCreationError();
+      }
+      w.display = &d;
+      w.windowNumber = i;
+      windows.push_back(w);
     }
 
+    scheduleWindows();
+  }
 
+  void scheduleWindows() {
+    //Swapping a window that waits for the vertical blank blocks the render thread until then. If
+    //every window waited, the frame rate would drop with every further display, so only one of
+    //them waits: the one with the highest frequency. The others are rendered every
+    //renderInterval frames, the number of vertical blanks of the fastest display per vertical
+    //blank of theirs.
+    auto fastest = std::max_element( windows.begin(),windows.end(),
+      [](const Window& a, const Window& b) { return a.display->frequency < b.display->frequency; }
+    );
+    std::rotate( windows.begin(),fastest + 1,windows.end() ); //The fastest window becomes last.
+
+    int frequency = windows.back().display->frequency;
+    for(Window& w : windows) {
+      w.waitsForVerticalBlank = &w == &windows.back();
+      int f = w.display->frequency;
+      w.renderInterval = f > 0 && frequency > f ? (unsigned int) ( (frequency + f/2)/f ) : 1;
+      LOG_INFO("Window %u on display %d: rendered every %u frame%s%s.\n",w.windowNumber,
+        w.display->displayNumber,w.renderInterval,w.renderInterval == 1 ? "" : "s",
+        w.waitsForVerticalBlank ? ", waits for the vertical blank" : ""
+      );
+    }
   }
-  
+
   void renderThreadFunction() {
+    PROFILE_THREAD_NAME("render");
     createContext();
 
-    makeContextCurrent();
-
-    setSwapInterval();//The swap interval can only be set after obtaining a valid current context.
+    //The swap interval belongs to the drawable, and can only be set with a current context.
+    for(Window& w : windows) {
+      makeContextCurrent(w.window);
+      if(w.waitsForVerticalBlank) {
+        setSwapInterval();
+      }
+      else {
+        trySettingSwapInterval(0);
+      }
+    }
 
     loadOpenGLFunctions();
+    if(damageTrackingEnabled) {
+      eglDamage.initialize();
+    }
+
+    frameProfiler.initialize();
+    if(dynamicResolutionEnabled) {
+      initializeDynamicResolution();
+    }
 
     renderer->initializeRendering();
-    
-    while(!stopBoolean) {
-      renderer->render();
-      SDL_GL_SwapWindow(window);
+
+    int frequency = windows.back().display->frequency;
+    Clock::duration framePeriod = std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>( 1.0/(frequency > 0 ? frequency : 60) )
+    );
+    Clock::time_point frameStart = Clock::now();
+    damageStatistics = DamageStatistics();
+    for(unsigned long frame = 1; !stopBoolean; ++frame) {
+      PROFILE_SCOPE("frame");
+      Clock::time_point frameBegin = Clock::now();
+      frameArena.beginFrame();
+      frameProfiler.beginFrame();
+      renderer->beginFrame();
+      bool rendered = false, waitedForVerticalBlank = false;
+      for(Window& w : windows) {
+        RenderView view = getView(w);
+        collectDamage(w,view);
+        if(frame % w.renderInterval == 0 && !w.damage.isEmpty()) {
+          renderWindow(w,view);
+          rendered = true;
+          waitedForVerticalBlank = waitedForVerticalBlank || w.waitsForVerticalBlank;
+        }
+      }
+      frameProfiler.endFrame();
+      if(!waitedForVerticalBlank) {
+        //No swap has blocked until the vertical blank, so the frame rate is kept here.
+        PROFILE_SCOPE("idle");
+        std::this_thread::sleep_until(frameBegin + framePeriod);
+      }
+      if(rendered) {
+        if(dynamicResolutionEnabled) {
+          std::chrono::duration<double,std::milli> interval = Clock::now() - frameStart;
+          updateResolutionScale( interval.count() );
+        }
+        DeletionQueue::get().endFrame();
+        GLTrace::get().endFrame();
+      }
+      frameStart = Clock::now();
+      damageStatistics.endFrame(!rendered);
+
+      if(frame % PROFILE_LOG_INTERVAL == 0) {
+        frameProfiler.logLatestProfile();
+        logDamageStatistics();
+        logMemoryStatistics();
+        renderer->logStatistics();
+      }
+    }
+
+    frameProfiler.releaseGPUResources();
+    dynamicResolution.releaseGPUResources();
+    DeletionQueue::get().collectAll();
+    GLTrace::get().stop();
+  }
+
+  RenderView getView(const Window& w) {
+    RenderView view;
+    view.windowNumber = w.windowNumber;
+    view.displayNumber = w.display->displayNumber;
+    SDL_GL_GetDrawableSize(w.window,&view.width,&view.height);
+    return view;
+  }
+
+  void collectDamage(Window& w, const RenderView& view) {
+    //Adds the damage of this frame to the damage since the window was rendered last.
+    if(view.width != w.width || view.height != w.height) {
+      //The content of the buffers is unknown after a change of the size.
+      w.width = view.width;
+      w.height = view.height;
+      w.history.clear();
+      w.damage.reset(w.width,w.height);
+      w.damage.addAll();
+    }
+    if(!damageTrackingEnabled) {
+      w.damage.addAll();
+      return;
+    }
+    frameDamage.reset(w.width,w.height);
+    renderer->reportDamage(view,frameDamage);
+    w.damage.add(frameDamage);
+  }
+
+  void renderWindow(Window& w, RenderView view) {
+    makeContextCurrent(w.window);
+
+    //With dynamic resolution, the whole window is scaled up every frame.
+    bool partial = damageTrackingEnabled && !dynamicResolutionEnabled && !w.damage.isFull();
+    bool partialSwap = partial;
+    if(partial) {
+      w.history.getRepaintRegion(w.damage,eglDamage.queryBufferAge(),w.repaint);
+      eglDamage.setDamageRegion(w.repaint);
+      partial = !w.repaint.isFull();
+    }
+    DamageRectangle scissor{0,0,w.width,w.height};
+    if(partial) {
+      scissor = w.repaint.getBounds();
+    }
+    ++damageStatistics.renderedViews;
+    damageStatistics.pixels += (double) scissor.getArea();
+    damageStatistics.viewPixels += (double) w.width*w.height;
+
+    {
+      PROFILE_SCOPE("render");
+      FrameProfiler::Scope scope(frameProfiler,"render");
+      if(partial) {
+        RenderPass::setScissorTest(true);
+        GL_CHECK( glScissor(scissor.x,scissor.y,scissor.width,scissor.height) );
+      }
+      RenderPass::setViewport(0,0,view.width,view.height);
+      if(dynamicResolutionEnabled) {
+        dynamicResolution.renderView(view); //Calls the renderer with a scaled view.
+      }
+      else {
+        renderer->renderView(view);
+      }
+      if(partial) {
+        RenderPass::setScissorTest(false);
+      }
+    }
+    {
+      PROFILE_SCOPE("swap");
+      FrameProfiler::Scope scope(frameProfiler,"swap");
+      if( !partialSwap || !eglDamage.swapWithDamage(w.damage) ) {
+        SDL_GL_SwapWindow(w.window);
+      }
+    }
+    RenderPass::endFrame();
+    w.history.push(w.damage);
+    w.damage.reset(w.width,w.height);
+  }
+
+  void logDamageStatistics() {
+    DamageStatistics& s = damageStatistics;
+    double idleSeconds = std::chrono::duration<double>(s.idleTime).count();
+    LOG_INFO("Damage: %lu of %lu frames skipped, %.0f pixels per frame, %.1f%% of the rendered "
+      "views\n",s.skippedFrames,s.frames,s.pixels/s.frames,
+      s.viewPixels > 0 ? 100*s.pixels/s.viewPixels : 0.0
+    );
+    if(idleSeconds > 0) {
+      LOG_INFO("Damage: %.1f%% of a CPU while idle\n",
+        100.0*s.idleCPUTime/CLOCKS_PER_SEC/idleSeconds
+      );
+    }
+    s = DamageStatistics();
+  }
+
+  void logMemoryStatistics() {
+    LinearArena& arena = frameArena.current(); //Of the frame that has just ended.
+    AllocationSnapshot a = arena.getStatistics();
+    LOG_INFO("Memory: frame arena %zu of %zu bytes used, %zu at most, %zu overflows\n",
+      arena.getBytesUsed(),arena.getCapacity(),a.peakBytesInUse,arena.getOverflowCount()
+    );
+    ResourceStatistics::Snapshot r = ResourceStatistics::get().getSnapshot();
+    for(unsigned char i = 0; i < ResourceStatistics::N; ++i) {
+      if(r.liveObjects[i] > 0) {
+        LOG_INFO("Memory: %zu %s objects, %zu bytes\n",r.liveObjects[i],
+          ResourceStatistics::getCategoryName( (ResourceCategory) i ),r.bytes[i]
+        );
+      }
+    }
+  }
+
+  void initializeDynamicResolution() {
+    dynamicResolution.setRenderer(renderer);
+    dynamicResolution.initialize();
+    int frequency = windows.back().display->frequency; //The window that sets the frame rate.
+    double deadline = 1000.0/(frequency > 0 ? frequency : 60);
+    dynamicResolution.getController().setDeadline(deadline);
+    LOG_INFO("Dynamic resolution is enabled, with a deadline of %.2f ms and %s.\n",deadline,
+      frameProfiler.hasGPUTimers() ? "GPU timers" : "the frame interval"
+    );
+  }
+
+  void updateResolutionScale(double frameMilliseconds) {
+    ResolutionController& controller = dynamicResolution.getController();
+    bool changed = false;
+    if( frameProfiler.hasGPUTimers() ) {
+      //GPU times arrive a few frames late; every frame is used once.
+      const FrameProfile& p = frameProfiler.getLatestProfile();
+      if(p.hasGPUTime && p.frameNumber != lastGPUProfile) {
+        lastGPUProfile = p.frameNumber;
+        changed = controller.addGPUTime(p.gpuMilliseconds);
+      }
+    }
+    else {
+      changed = controller.addFrameInterval(frameMilliseconds);
+    }
+    if(changed) {
+      LOG_VERBOSE("The resolution scale is now %.2f.\n",controller.getScale());
     }
   }
 
   void createContext() {
-    context = SDL_GL_CreateContext(window);
+    context = SDL_GL_CreateContext(windows.front().window);
     if(!context) {
       throwContextCreationError();
     }
   }
 
   void throwContextCreationError() {
-    std::printf(
+    LOG_ERROR(
       "Could not create the OpenGL context.\n"
       "SDL error message: %s\n",SDL_GetError()
     );
@@ -181,14 +550,18 @@ class GLWindow::I {
     throw std::runtime_error("Context creation error");
   }
 
-  void makeContextCurrent() {
+  void makeContextCurrent(SDL_Window * window) {
+    if(window == currentWindow) {
+      return; //With one window, the context stays current.
+    }
     if( SDL_GL_MakeCurrent(window,context) != 0 ) {
       throwMakeCurrentError();
     }
+    currentWindow = window;
   }
 
   void throwMakeCurrentError() {
-    std::printf(
+    LOG_ERROR(
       "Could not make the OpenGL context current.\n"
       "SDL error message: %s\n",SDL_GetError()
     );
@@ -201,12 +574,12 @@ class GLWindow::I {
       trySettingSwapInterval(1);
     }
 
-    std::printf( "The swap interval has been set to %d\n",SDL_GL_GetSwapInterval() );
+    LOG_INFO( "The swap interval has been set to %d\n",SDL_GL_GetSwapInterval() );
   }
 
   bool trySettingSwapInterval(int i) {
     if( SDL_GL_SetSwapInterval(i) != 0 ) {
-      std::printf(
+      LOG_WARNING(
         "Swap interval %d is not supported.\n"
         "  SDL message: %s\n",
         i,
@@ -220,6 +593,12 @@ class GLWindow::I {
 
   void loadOpenGLFunctions() {
     gladLoadGLES2Loader( (GLADloadproc) &SDL_GL_GetProcAddress );
+    GLExtensions::setLoader( (GLADloadproc) &SDL_GL_GetProcAddress );
+#ifdef PROJECTNAME_GL_DEBUG
+    GLDebug::installMessageCallback();
+#endif
+    GLTrace::get().startFromEnvironment();
+    RenderPass::initialize();
   }
 
 }; //end of class I
@@ -244,6 +623,30 @@ int GLWindow::getScreenFrequency() const {
   return imp->getScreenFrequency();
 }
 
+unsigned int GLWindow::getDisplayCount() const {
+  return imp->getDisplayCount();
+}
+
+const DisplayInformation& GLWindow::getDisplayInformation(unsigned int displayNumber) const {
+  return imp->getDisplayInformation(displayNumber);
+}
+
+void GLWindow::setWindowCount(unsigned int n) {
+  imp->setWindowCount(n);
+}
+
+void GLWindow::setDynamicResolution(bool enabled) {
+  imp->setDynamicResolution(enabled);
+}
+
+void GLWindow::setDamageTracking(bool enabled) {
+  imp->setDamageTracking(enabled);
+}
+
+DynamicResolution& GLWindow::getDynamicResolution() {
+  return imp->getDynamicResolution();
+}
+
 void GLWindow::start() {
   imp->start();
 }
@@ -256,4 +659,12 @@ void GLWindow::setRenderer( Renderer * e ) {
   imp->setRenderer(e);
 }
 
+FrameArena& GLWindow::getFrameArena() {
+  return imp->getFrameArena();
+}
+
+FrameProfiler& GLWindow::getFrameProfiler() {
+  return imp->getFrameProfiler();
+}
+
 }
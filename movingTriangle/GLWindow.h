@@ -7,20 +7,69 @@
 
 namespace ProjectName {
 
+class FrameArena;
+class FrameProfiler;
+class DynamicResolution;
+
+class DisplayInformation {
+ public:
+  int displayNumber;
+  int x, y; //Of the display in the desktop.
+  int width, height;
+  int frequency; //0 if SDL does not know it.
+};
+
 class GLWindow {
+  //Creates one fullscreen window per display and renders all of them from one render thread with
+  //one OpenGL context. Every frame, the renderer renders each window in turn and the window is
+  //swapped right after. Only the window on the display with the highest frequency waits for the
+  //vertical blank; it is rendered last, so the frame rate follows that display. A window on a
+  //display with a lower frequency is only rendered every few frames, for instance every second
+  //frame on a 30 Hz display next to a 60 Hz one.
  public:
   GLWindow();
   ~GLWindow();
 
-  void initialize(); 
-  //Initializes the video subsystem of SDL2 and obtains screen information.
+  void initialize();
+  //Initializes the video subsystem of SDL2 and obtains information about all displays.
 
   int getScreenWidth() const;
   int getScreenHeight() const;
   int getScreenFrequency() const;
+  //Of the first display.
+
+  unsigned int getDisplayCount() const;
+  const DisplayInformation& getDisplayInformation(unsigned int displayNumber) const;
+
+  void setWindowCount(unsigned int n);
+  //By default there is one window per display. With more windows than displays, the displays are
+  //used in turn, which lets headless tests with a single offscreen display render several
+  //surfaces. The environment variable PROJECTNAME_WINDOWS sets the default. Call before start.
+
+  void setDynamicResolution(bool enabled);
+  //Renders into an offscreen framebuffer at a scale that follows the frame time, and scales the
+  //image up to the window. The environment variable PROJECTNAME_DYNAMIC_RESOLUTION=1 sets the
+  //default. RenderView then has the scaled size. Call before start.
+
+  DynamicResolution& getDynamicResolution();
+  //For the settings of its ResolutionController.
+
+  void setDamageTracking(bool enabled);
+  //Redraws only what Renderer::reportDamage reports, and skips frames without damage. Where EGL
+  //tells the age of the back buffer, the drawing is limited to the damage of the frames it
+  //lacks; otherwise a view with damage is redrawn completely. Enabled by default; the
+  //environment variable PROJECTNAME_DAMAGE=0 disables it. Call before start.
 
   void setRenderer(Renderer * r);
 
+  FrameArena& getFrameArena();
+  //Transient memory for the render thread. The arenas are swapped before every call of
+  //Renderer::beginFrame, so data allocated in the previous frame is still readable.
+
+  FrameProfiler& getFrameProfiler();
+  //CPU and GPU times of the frames of the render thread. Renderer::renderView runs inside the
+  //scope "render", so scopes of the renderer appear nested in it.
+
   void start();
 
   void stop();
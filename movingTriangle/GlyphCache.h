@@ -0,0 +1,291 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <unordered_map>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+#include "StrokeFont.h"
+#include "AtlasPacker.h"
+#include "JobSystem.h"
+
+namespace ProjectName {
+
+class SDFGlyph {
+ public:
+  bool empty{true}; //A space, which has an advance but no quad.
+  size_t page{0};
+  AtlasRectangle rectangle;
+  float u0{0}, v0{0}, u1{0}, v1{0}; //v0 is the top.
+  //The quad around the pen position on the baseline, in units of StrokeFont.
+  float left{0}, bottom{0}, right{0}, top{0};
+  float advance{0};
+};
+
+class GlyphPage {
+  //One channel of distances, with the rows from top to bottom. The rows [dirtyTop,dirtyBottom)
+  //have changed since the last upload.
+ public:
+  std::vector<uint8_t> pixels;
+  AtlasPacker packer;
+  int dirtyTop, dirtyBottom;
+
+  explicit GlyphPage(int size) :
+    pixels( (size_t) size*size,0 ), packer(size,size), dirtyTop(size), dirtyBottom(0)
+  {
+
+  }
+
+  bool isDirty() const {
+    return dirtyTop < dirtyBottom;
+  }
+};
+
+class GlyphCache {
+  //Signed distance fields of the glyphs of StrokeFont, in atlas pages of pageSize x pageSize
+  //bytes that TextRenderer uploads as GL_ALPHA textures. A texel is the distance of its center
+  //to the edge of the strokes: 0.5 on the edge, more inside, and 0 and 1 at SPREAD pixels out-
+  //and inside. Filtered linearly, the distances stay sharp when the text is scaled, unlike
+  //coverage, so one size of every glyph serves all sizes on screen.
+  //prepare() rasterizes the glyphs of a text that are not cached yet: they are packed in the
+  //order of the text, and then rasterized in parallel on a JobSystem, since their rectangles do
+  //not overlap. Characters that the font does not have become REPLACEMENT. Glyphs are never
+  //evicted; the font is small.
+ public:
+  static constexpr int PIXELS_PER_UNIT = 5; //Of the StrokeFont grid in the atlas.
+  static constexpr int SPREAD = 4; //Pixels.
+  static constexpr uint32_t REPLACEMENT = '?';
+
+  explicit GlyphCache(int pageSize = 512) : pageSize(pageSize) {
+    if(pageSize < GLYPH_WIDTH + 1 || pageSize < GLYPH_HEIGHT + 1) {
+      throw std::runtime_error("GlyphCache: the pages are smaller than a glyph.");
+    }
+  }
+
+  GlyphCache(const GlyphCache&) = delete;
+  GlyphCache& operator=(const GlyphCache&) = delete;
+
+  size_t prepare(const std::string& text, JobSystem * jobs = nullptr) {
+    //Returns the number of glyphs that were rasterized.
+    std::vector<uint32_t> missing;
+    for(size_t i = 0; i < text.size(); ) {
+      addMissing(decodeUTF8(text,i),missing);
+    }
+    if( missing.empty() ) {
+      return 0;
+    }
+
+    std::vector<Job> work;
+    for(uint32_t c : missing) {
+      const char * strokes = StrokeFont::getStrokes(c);
+      if(strokes == nullptr) {
+        continue; //Mapped to the replacement below, which is in missing too.
+      }
+      SDFGlyph g;
+      g.advance = StrokeFont::ADVANCE;
+      if(*strokes != '\0') {
+        pack(g);
+        work.push_back( Job{strokes,g} );
+      }
+      glyphs[c] = g;
+    }
+    for(uint32_t c : missing) {
+      if(StrokeFont::getStrokes(c) == nullptr) {
+        glyphs[c] = glyphs[(uint32_t) REPLACEMENT];
+      }
+    }
+
+    auto rasterizeRange = [this,&work](size_t begin, size_t end) {
+      for(size_t i = begin; i < end; ++i) {
+        rasterize(work[i].strokes,work[i].glyph);
+      }
+    };
+    if(jobs == nullptr || work.size() < 2) {
+      rasterizeRange(0,work.size());
+    }
+    else {
+      jobs->parallelFor(0,work.size(),1,rasterizeRange);
+    }
+    for(const Job& j : work) {
+      GlyphPage& page = *pages[j.glyph.page];
+      page.dirtyTop = std::min(page.dirtyTop,j.glyph.rectangle.y);
+      page.dirtyBottom = std::max(page.dirtyBottom,j.glyph.rectangle.y + GLYPH_HEIGHT);
+    }
+    rasterizedGlyphs += work.size();
+    return work.size();
+  }
+
+  const SDFGlyph * find(uint32_t codepoint) const {
+    //Null if the glyph has not been prepared.
+    auto found = glyphs.find(codepoint);
+    return found == glyphs.end() ? nullptr : &found->second;
+  }
+
+  size_t getPageCount() const {
+    return pages.size();
+  }
+
+  GlyphPage& getPage(size_t i) {
+    return *pages[i];
+  }
+
+  int getPageSize() const {
+    return pageSize;
+  }
+
+  size_t getMemoryBytes() const { //Of the pages, which is also their size on the GPU.
+    return pages.size()*pageSize*pageSize;
+  }
+
+  size_t getRasterizedGlyphCount() const {
+    return rasterizedGlyphs;
+  }
+
+  static float getSmoothing(float pixelsPerUnit) {
+    //Half the change of the distance over one pixel on screen, for text drawn at pixelsPerUnit
+    //pixels per unit of StrokeFont: the edge is smoothed over one pixel.
+    float perPixel = 0.5f/SPREAD*PIXELS_PER_UNIT/std::max(pixelsPerUnit,1e-3f);
+    return std::min(0.5f*perPixel,0.5f);
+  }
+
+  static uint32_t decodeUTF8(const std::string& text, size_t& i) {
+    //Returns the character at i and advances i past it; invalid bytes become REPLACEMENT.
+    unsigned char c = (unsigned char) text[i++];
+    if(c < 0x80) {
+      return c;
+    }
+    int extra = c >= 0xF0 ? 3 : (c >= 0xE0 ? 2 : (c >= 0xC0 ? 1 : -1));
+    if(extra < 0) {
+      return REPLACEMENT;
+    }
+    uint32_t result = c & (0x3F >> extra);
+    for(int k = 0; k < extra; ++k) {
+      if( i >= text.size() || ( (unsigned char) text[i] & 0xC0 ) != 0x80 ) {
+        return REPLACEMENT;
+      }
+      result = result << 6 | ( (unsigned char) text[i++] & 0x3F );
+    }
+    return result;
+  }
+
+ private:
+  //Room for half the stroke and the spread around the grid.
+  static constexpr int PADDING = (int) (StrokeFont::STROKE_WIDTH*0.5f*PIXELS_PER_UNIT + 0.99f) +
+    SPREAD;
+  static constexpr int GLYPH_WIDTH = StrokeFont::WIDTH*PIXELS_PER_UNIT + 2*PADDING;
+  static constexpr int GLYPH_HEIGHT = StrokeFont::CAP_HEIGHT*PIXELS_PER_UNIT + 2*PADDING;
+
+  class Job {
+   public:
+    const char * strokes;
+    SDFGlyph glyph;
+  };
+
+  class Segment {
+   public:
+    float x0, y0, x1, y1;
+  };
+
+  int pageSize;
+  std::vector<std::unique_ptr<GlyphPage>> pages;
+  std::unordered_map<uint32_t,SDFGlyph> glyphs;
+  size_t rasterizedGlyphs{0};
+
+  void addMissing(uint32_t c, std::vector<uint32_t>& missing) const {
+    if( glyphs.count(c) != 0 || std::find(missing.begin(),missing.end(),c) != missing.end() ) {
+      return;
+    }
+    missing.push_back(c);
+    if( StrokeFont::getStrokes(c) == nullptr ) {
+      addMissing(REPLACEMENT,missing);
+    }
+  }
+
+  void pack(SDFGlyph& g) {
+    //One pixel apart, so that filtering does not mix neighbours.
+    AtlasRectangle r;
+    if( pages.empty() || !pages.back()->packer.pack(GLYPH_WIDTH + 1,GLYPH_HEIGHT + 1,r) ) {
+      pages.emplace_back( new GlyphPage(pageSize) );
+      pages.back()->packer.pack(GLYPH_WIDTH + 1,GLYPH_HEIGHT + 1,r);
+    }
+    g.empty = false;
+    g.page = pages.size() - 1;
+    g.rectangle = r;
+    g.rectangle.width = GLYPH_WIDTH;
+    g.rectangle.height = GLYPH_HEIGHT;
+    g.u0 = (float) r.x/pageSize;
+    g.v0 = (float) r.y/pageSize;
+    g.u1 = (float) (r.x + GLYPH_WIDTH)/pageSize;
+    g.v1 = (float) (r.y + GLYPH_HEIGHT)/pageSize;
+    float padding = (float) PADDING/PIXELS_PER_UNIT;
+    g.left = -padding;
+    g.right = StrokeFont::WIDTH + padding;
+    g.bottom = -StrokeFont::BASELINE - padding;
+    g.top = StrokeFont::CAP_HEIGHT - StrokeFont::BASELINE + padding;
+  }
+
+  static std::vector<Segment> parse(const char * strokes) {
+    //The segments of every polyline; a polyline of one point becomes a segment of no length.
+    std::vector<Segment> result;
+    const char * p = strokes;
+    while(*p != '\0') {
+      if(*p == ' ') {
+        ++p;
+        continue;
+      }
+      size_t first = result.size();
+      float x = 0, y = 0;
+      for(bool start = true; *p != ' ' && *p != '\0'; p += 2, start = false) {
+        if(p[1] == ' ' || p[1] == '\0') {
+          throw std::runtime_error("GlyphCache: a point of a StrokeFont glyph is incomplete.");
+        }
+        float nx = (float) (p[0] - '0'), ny = (float) (p[1] - '0');
+        if(!start) {
+          result.push_back( Segment{x,y,nx,ny} );
+        }
+        x = nx;
+        y = ny;
+      }
+      if(result.size() == first) {
+        result.push_back( Segment{x,y,x,y} );
+      }
+    }
+    return result;
+  }
+
+  void rasterize(const char * strokes, const SDFGlyph& g) {
+    std::vector<Segment> segments = parse(strokes);
+    GlyphPage& page = *pages[g.page];
+    const float halfStroke = StrokeFont::STROKE_WIDTH*0.5f;
+    const float scale = 127.5f*PIXELS_PER_UNIT/SPREAD; //From units to bytes.
+    for(int row = 0; row < GLYPH_HEIGHT; ++row) {
+      uint8_t * out = &page.pixels[ (size_t) (g.rectangle.y + row)*pageSize + g.rectangle.x ];
+      float py = g.top + StrokeFont::BASELINE - (row + 0.5f)/PIXELS_PER_UNIT;
+      for(int column = 0; column < GLYPH_WIDTH; ++column) {
+        float px = g.left + (column + 0.5f)/PIXELS_PER_UNIT;
+        float squared = 1e30f;
+        for(const Segment& s : segments) {
+          squared = std::min( squared,squaredDistance(px,py,s) );
+        }
+        float distance = std::sqrt(squared) - halfStroke;
+        float value = 127.5f - distance*scale;
+        out[column] = (uint8_t) std::min( std::max(value + 0.5f,0.0f),255.0f );
+      }
+    }
+  }
+
+  static float squaredDistance(float px, float py, const Segment& s) {
+    float dx = s.x1 - s.x0, dy = s.y1 - s.y0;
+    float length = dx*dx + dy*dy;
+    float t = length > 0 ? ( (px - s.x0)*dx + (py - s.y0)*dy )/length : 0;
+    t = std::min( std::max(t,0.0f),1.0f );
+    float ex = s.x0 + t*dx - px, ey = s.y0 + t*dy - py;
+    return ex*ex + ey*ey;
+  }
+};
+
+}
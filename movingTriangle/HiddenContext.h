@@ -0,0 +1,53 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <SDL.h>
+
+#include <string>
+#include <stdexcept>
+
+namespace ProjectName {
+
+class HiddenContext {
+  //A hidden window with the same kind of context as GLWindow creates, current on the calling
+  //thread and with the functions loaded by glad, for the tools that measure OpenGL. Swaps do not
+  //wait for the vertical blank. See GLReplay.cpp for running the tools without a display.
+ public:
+  explicit HiddenContext(const char * title, int width = 64, int height = 64) {
+    if( SDL_Init(SDL_INIT_VIDEO) != 0 ) {
+      throw std::runtime_error("SDL initialization error");
+    }
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_ES);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 2);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 0);
+    window = SDL_CreateWindow(title,0,0,width,height,SDL_WINDOW_OPENGL|SDL_WINDOW_HIDDEN);
+    if(!window) {
+      throw std::runtime_error( std::string("Window creation failed: ") + SDL_GetError() );
+    }
+    context = SDL_GL_CreateContext(window);
+    if(!context) {
+      throw std::runtime_error( std::string("Context creation failed: ") + SDL_GetError() );
+    }
+    SDL_GL_SetSwapInterval(0);
+    gladLoadGLES2Loader( (GLADloadproc) &SDL_GL_GetProcAddress );
+  }
+
+  ~HiddenContext() {
+    SDL_GL_DeleteContext(context);
+    SDL_DestroyWindow(window);
+    SDL_Quit();
+  }
+
+  HiddenContext(const HiddenContext&) = delete;
+  HiddenContext& operator=(const HiddenContext&) = delete;
+
+  void swap() {
+    SDL_GL_SwapWindow(window);
+  }
+
+ private:
+  SDL_Window * window{nullptr};
+  SDL_GLContext context{nullptr};
+};
+
+}
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstring>
+#include <stdexcept>
+
+namespace ProjectName {
+
+class Image {
+  //An 8 bit RGBA image with its rows stored from top to bottom.
+ public:
+  static constexpr unsigned char CHANNELS = 4;
+
+  int width{0}, height{0};
+  std::vector<unsigned char> pixels;
+
+  Image() {
+
+  }
+
+  Image(int w, int h) : width(w), height(h), pixels( (size_t) w*h*CHANNELS,0 ) {
+
+  }
+
+  unsigned char * getPixel(int x, int y) {
+    return &pixels[ ( (size_t) y*width + x )*CHANNELS ];
+  }
+
+  const unsigned char * getPixel(int x, int y) const {
+    return &pixels[ ( (size_t) y*width + x )*CHANNELS ];
+  }
+
+  size_t getByteSize() const {
+    return pixels.size();
+  }
+};
+
+class ImageDecoder {
+  //Decodes the binary netpbm formats: P5 (grey), P6 (RGB) and P7 (PAM, with alpha). These can be
+  //written by almost every image tool and need no external library. Decoding is CPU-only, so it
+  //can be done on a worker thread.
+ public:
+  static Image decode(const std::vector<char>& data) {
+    ImageDecoder d(data);
+    return d.decode();
+  }
+
+ private:
+  const std::vector<char>& data;
+  size_t position{0};
+
+  explicit ImageDecoder(const std::vector<char>& d) : data(d) {
+
+  }
+
+  Image decode() {
+    if(data.size() < 2 || data[0] != 'P') {
+      throw std::runtime_error("ImageDecoder: not a netpbm image");
+    }
+    char kind = data[1];
+    position = 2;
+
+    int width, height, maxValue, channels;
+    if(kind == '5' || kind == '6') {
+      width = readNumber();
+      height = readNumber();
+      maxValue = readNumber();
+      channels = kind == '5' ? 1 : 3;
+      ++position; //Exactly one whitespace character separates the header from the pixels.
+    }
+    else if(kind == '7') {
+      readPAMHeader(width,height,maxValue,channels);
+    }
+    else {
+      throw std::runtime_error("ImageDecoder: unsupported netpbm format");
+    }
+
+    if(maxValue != 255 || width <= 0 || height <= 0) {
+      throw std::runtime_error("ImageDecoder: only 8 bit images are supported");
+    }
+    if(position + (size_t) width*height*channels > data.size() ) {
+      throw std::runtime_error("ImageDecoder: the image data is truncated");
+    }
+
+    return convertToRGBA(width,height,channels);
+  }
+
+  Image convertToRGBA(int width, int height, int channels) {
+    Image result(width,height);
+    const unsigned char * source = reinterpret_cast<const unsigned char*>(&data[position]);
+    unsigned char * target = result.pixels.data();
+
+    for(size_t i = 0, n = (size_t) width*height; i < n; ++i) {
+      if(channels <= 2) {
+        target[0] = target[1] = target[2] = source[0];
+        target[3] = channels == 2 ? source[1] : 255;
+      }
+      else {
+        target[0] = source[0];
+        target[1] = source[1];
+        target[2] = source[2];
+        target[3] = channels == 4 ? source[3] : 255;
+      }
+      source += channels;
+      target += Image::CHANNELS;
+    }
+    return result;
+  }
+
+  void skipWhitespaceAndComments() {
+    while(position < data.size()) {
+      char c = data[position];
+      if(c == '#') {
+        while(position < data.size() && data[position] != '\n') {
+          ++position;
+        }
+      }
+      else if(c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+        ++position;
+      }
+      else {
+        return;
+      }
+    }
+  }
+
+  int readNumber() {
+    skipWhitespaceAndComments();
+    int result = 0;
+    bool found = false;
+    while(position < data.size() && data[position] >= '0' && data[position] <= '9') {
+      result = result*10 + (data[position] - '0');
+      ++position;
+      found = true;
+    }
+    if(!found) {
+      throw std::runtime_error("ImageDecoder: expected a number in the header");
+    }
+    return result;
+  }
+
+  std::string readWord() {
+    skipWhitespaceAndComments();
+    std::string result;
+    while(position < data.size() && data[position] > ' ') {
+      result += data[position];
+      ++position;
+    }
+    return result;
+  }
+
+  void readPAMHeader(int& width, int& height, int& maxValue, int& channels) {
+    width = height = maxValue = channels = 0;
+    while(position < data.size()) {
+      std::string word = readWord();
+      if(word == "WIDTH") { width = readNumber(); }
+      else if(word == "HEIGHT") { height = readNumber(); }
+      else if(word == "DEPTH") { channels = readNumber(); }
+      else if(word == "MAXVAL") { maxValue = readNumber(); }
+      else if(word == "TUPLTYPE") { readWord(); }
+      else if(word == "ENDHDR") {
+        ++position;
+        break;
+      }
+    }
+    if(channels < 1 || channels > 4) {
+      throw std::runtime_error("ImageDecoder: unsupported PAM depth");
+    }
+  }
+};
+
+inline Image halveImage(const Image& source) {
+  //Box filter for the next mipmap level. Odd sizes are rounded down, but never below 1.
+  int w = source.width > 1 ? source.width/2 : 1;
+  int h = source.height > 1 ? source.height/2 : 1;
+  Image result(w,h);
+
+  for(int y = 0; y < h; ++y) {
+    int y0 = y*2 < source.height ? y*2 : source.height - 1;
+    int y1 = y*2 + 1 < source.height ? y*2 + 1 : y0;
+    for(int x = 0; x < w; ++x) {
+      int x0 = x*2 < source.width ? x*2 : source.width - 1;
+      int x1 = x*2 + 1 < source.width ? x*2 + 1 : x0;
+
+      const unsigned char * a = source.getPixel(x0,y0);
+      const unsigned char * b = source.getPixel(x1,y0);
+      const unsigned char * c = source.getPixel(x0,y1);
+      const unsigned char * d = source.getPixel(x1,y1);
+      unsigned char * t = result.getPixel(x,y);
+      for(int i = 0; i < Image::CHANNELS; ++i) {
+        t[i] = (unsigned char) ( (a[i] + b[i] + c[i] + d[i] + 2)/4 );
+      }
+    }
+  }
+  return result;
+}
+
+inline std::vector<Image> generateMipmaps(Image base, int levels) {
+  //Returns at most levels images, starting with the base image itself.
+  std::vector<Image> result;
+  result.push_back( std::move(base) );
+  while( (int) result.size() < levels && (result.back().width > 1 || result.back().height > 1) ) {
+    result.push_back( halveImage( result.back() ) );
+  }
+  return result;
+}
+
+}
@@ -2,6 +2,17 @@
 
 #include <glad/glad.h>
 #include<vector>
+#include <string>
+#include <cstdio>
+
+#include "MemoryResource.h"
+#include "BufferPool.h"
+#include "BufferBindingCache.h"
+#include "VertexArray.h"
+#include "GLResource.h"
+#include "Logger.h"
+#include "GLDebug.h"
+#include "Profiler.h"
 
 namespace ProjectName {
  
@@ -18,6 +29,23 @@ class IndexContainer {
   //eventually.
  
  public:
+  IndexContainer() : IndexContainer( getHeapResource() ) {
+
+  }
+
+  explicit IndexContainer(MemoryResource * resource) :
+    indexBuffer( ResourceAllocator<Type>(resource) )
+  {
+
+  }
+
+  ~IndexContainer() {
+    //See the destructor of AttributeContainer.
+    if( range.isValid() ) {
+      range.pool->free(range);
+    }
+  }
+
   void reserve(size_t numberOfIndices) {
     indexBuffer.reserve(numberOfIndices);
   }
@@ -29,33 +57,71 @@ class IndexContainer {
   }
 
   void printIndices() {
-    std::printf("indices:\n  ");
+    const size_t INDICES_PER_ROW = 16;
+    LOG_INFO("indices:\n");
 
-    for(auto s : indexBuffer) {
-      std::printf("(%u)",s);
+    std::string row;
+    char number[8];
+    for(size_t i = 0; i < indexBuffer.size(); ++i) {
+      std::snprintf( number,sizeof(number),"(%u)",(unsigned int) indexBuffer[i] );
+      row += number;
+      if( (i + 1) % INDICES_PER_ROW == 0 || i + 1 == indexBuffer.size() ) {
+        LOG_INFO("  %s\n",row);
+        row.clear();
+      }
     }
-
-    std::printf("\n");
   }
 
   void initialize() { //Requires an OpenGL context.
     sendIndicesToGPU();
   }
 
+  void initialize(BufferPool& pool) { //Requires an OpenGL context.
+    if( pool.getTarget() != GL_ELEMENT_ARRAY_BUFFER ) {
+      throw std::runtime_error(
+        "IndexContainer requires a pool of GL_ELEMENT_ARRAY_BUFFER buffers."
+      );
+    }
+    PROFILE_SCOPE("IndexContainer::upload");
+    size_t bytes = indexBuffer.size()*sizeof(Type);
+    range = pool.allocate(bytes,4);
+    pool.upload( range,(const GLvoid *) indexBuffer.data(),bytes );
+  }
+
+  GLuint getBuffer() const {
+    //The buffer object, for AttributeContainer::setIndexContainer, which binds it together with
+    //the vertices.
+    return range.isValid() ? range.pool->getBuffer(range) : indexBufferName.get();
+  }
+
+  GLsizei getIndexCount() const {
+    return (GLsizei) indexBuffer.size();
+  }
+
+  const GLvoid * getIndexOffset() const {
+    //The last argument of glDrawElements. It is not zero when the indices are stored in a pool.
+    size_t offset = range.isValid() ? range.pool->getOffset(range) : 0;
+    return (const GLvoid *) offset;
+  }
+
  private:
-  std::vector<Type> indexBuffer;
+  ResourceVector<Type> indexBuffer;
 
-  GLuint indexBufferName{0};
+  BufferHandle indexBufferName;
+  BufferRange range;
 
   void sendIndicesToGPU() {
-    glGenBuffers(1,&indexBufferName);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,indexBufferName);
-    glBufferData(
+    PROFILE_SCOPE("IndexContainer::upload");
+    indexBufferName.create();
+    indexBufferName.setSize( indexBuffer.size()*sizeof(Type) );
+    VertexArray::unbind();
+    BufferBindingCache::bind( GL_ELEMENT_ARRAY_BUFFER,indexBufferName.get() );
+    GL_CHECK( glBufferData(
       GL_ELEMENT_ARRAY_BUFFER,
       indexBuffer.size()*sizeof(Type),
       (const GLvoid *) indexBuffer.data(),
       GL_STATIC_DRAW
-    );
+    ) );
     
   }
   
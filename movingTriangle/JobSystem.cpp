@@ -0,0 +1,170 @@
+#include "JobSystem.h"
+#include "Profiler.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <atomic>
+
+namespace ProjectName {
+
+class JobSystem::I {
+ public:
+  explicit I(unsigned int numberOfThreads) {
+    if(numberOfThreads == 0) {
+      numberOfThreads = getDefaultThreadCount();
+    }
+    for(unsigned int i = 0; i < numberOfThreads; ++i) {
+      workers.emplace_back( [this]() { workerFunction(); } );
+    }
+  }
+
+  ~I() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    jobAvailable.notify_all();
+    for(auto& t : workers) {
+      t.join();
+    }
+  }
+
+  unsigned int getThreadCount() const {
+    return (unsigned int) workers.size();
+  }
+
+  void submit(Job job) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      jobs.push_back( std::move(job) );
+      ++unfinishedJobs;
+    }
+    jobAvailable.notify_one();
+  }
+
+  void parallelFor(size_t begin, size_t end, size_t grainSize, const RangeJob& job) {
+    if(end <= begin) {
+      return;
+    }
+    if(grainSize == 0) {
+      grainSize = 1;
+    }
+
+    size_t count = end - begin;
+    size_t pieces = (count + grainSize - 1)/grainSize;
+    size_t maxPieces = (getThreadCount() + 1)*PIECES_PER_THREAD;
+    if(pieces > maxPieces) {
+      pieces = maxPieces;
+    }
+    if(pieces == 1) {
+      job(begin,end);
+      return;
+    }
+
+    //The pieces are claimed through an atomic counter, so the calling thread and the workers
+    //share the work without putting every piece in the queue.
+    auto state = std::make_shared<ParallelForState>();
+    state->remaining = pieces;
+    auto runPieces = [state,begin,count,pieces,&job]() {
+      size_t p;
+      while( (p = state->next.fetch_add(1)) < pieces ) {
+        job(begin + count*p/pieces, begin + count*(p+1)/pieces);
+        if(state->remaining.fetch_sub(1) == 1) {
+          std::lock_guard<std::mutex> lock(state->mutex);
+          state->finished.notify_all();
+        }
+      }
+    };
+
+    size_t helpers = pieces - 1 < getThreadCount() ? pieces - 1 : getThreadCount();
+    for(size_t i = 0; i < helpers; ++i) {
+      submit(runPieces);
+    }
+    runPieces();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->finished.wait(lock,[&]() { return state->remaining.load() == 0; });
+  }
+
+  void waitUntilIdle() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock,[this]() { return unfinishedJobs == 0; });
+  }
+
+ private:
+  static constexpr size_t PIECES_PER_THREAD = 4;
+
+  class ParallelForState {
+   public:
+    std::atomic<size_t> next{0}, remaining{0};
+    std::mutex mutex;
+    std::condition_variable finished;
+  };
+
+  std::vector<std::thread> workers;
+  std::deque<Job> jobs;
+  std::mutex mutex;
+  std::condition_variable jobAvailable, idle;
+  size_t unfinishedJobs{0};
+  bool stopping{false};
+
+  static unsigned int getDefaultThreadCount() {
+    unsigned int n = std::thread::hardware_concurrency();
+    return n > 1 ? n - 1 : 1;
+  }
+
+  void workerFunction() {
+    PROFILE_THREAD_NAME("worker");
+    while(true) {
+      Job job;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        jobAvailable.wait(lock,[this]() { return stopping || !jobs.empty(); });
+        if( stopping && jobs.empty() ) {
+          return;
+        }
+        job = std::move( jobs.front() );
+        jobs.pop_front();
+      }
+
+      job();
+
+      std::lock_guard<std::mutex> lock(mutex);
+      if(--unfinishedJobs == 0) {
+        idle.notify_all();
+      }
+    }
+  }
+};
+
+JobSystem::JobSystem(unsigned int numberOfThreads) {
+  imp = std::unique_ptr<I>( new I(numberOfThreads) );
+}
+
+JobSystem::~JobSystem() = default;
+
+JobSystem& JobSystem::get() {
+  static JobSystem jobSystem;
+  return jobSystem;
+}
+
+unsigned int JobSystem::getThreadCount() const {
+  return imp->getThreadCount();
+}
+
+void JobSystem::submit(Job job) {
+  imp->submit( std::move(job) );
+}
+
+void JobSystem::parallelFor(size_t begin, size_t end, size_t grainSize, const RangeJob& job) {
+  imp->parallelFor(begin,end,grainSize,job);
+}
+
+void JobSystem::waitUntilIdle() {
+  imp->waitUntilIdle();
+}
+
+}
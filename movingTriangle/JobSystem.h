@@ -0,0 +1,37 @@
+#pragma once
+
+#include <memory>
+#include <functional>
+#include <cstddef>
+
+namespace ProjectName {
+
+class JobSystem {
+  //A fixed set of worker threads with one shared queue. Jobs must not use OpenGL; results that
+  //need the GPU are handed to the render thread, for instance through a TextureAtlas.
+ public:
+  using Job = std::function<void()>;
+  using RangeJob = std::function<void(size_t begin, size_t end)>;
+
+  explicit JobSystem(unsigned int numberOfThreads = 0);
+  //0 means one thread less than the number of hardware threads (but at least one).
+  ~JobSystem();
+
+  static JobSystem& get(); //A shared instance that is created on first use.
+
+  unsigned int getThreadCount() const;
+
+  void submit(Job job);
+
+  void parallelFor(size_t begin, size_t end, size_t grainSize, const RangeJob& job);
+  //Splits [begin,end) in pieces of at least grainSize elements and runs them on the workers.
+  //The calling thread also executes pieces and returns when all of them are finished.
+
+  void waitUntilIdle();
+
+ private:
+  class I;
+  std::unique_ptr<I> imp;
+};
+
+}
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+#include "MemoryResource.h"
+
+namespace ProjectName {
+
+class LinearArena : public MemoryResource {
+  //Bump allocator for transient data. Deallocation does nothing; all memory is released at
+  //once by reset(). An arena is not thread safe; it should be used by one thread at a time.
+ public:
+  explicit LinearArena(size_t capacity = DEFAULT_CAPACITY) {
+    addBlock(capacity);
+  }
+
+  LinearArena(const LinearArena&) = delete;
+  LinearArena& operator=(const LinearArena&) = delete;
+
+  void reset() {
+    if(blocks.size() > 1) {
+      consolidateBlocks();
+    }
+    blocks[0].used = 0;
+    currentBlock = 0;
+    releaseAllBytes();
+  }
+
+  size_t getCapacity() const {
+    size_t result = 0;
+    for(const auto& b : blocks) {
+      result += b.size;
+    }
+    return result;
+  }
+
+  size_t getBytesUsed() const {
+    size_t result = 0;
+    for(size_t i = 0; i <= currentBlock; ++i) {
+      result += blocks[i].used;
+    }
+    return result;
+  }
+
+  size_t getOverflowCount() const {
+    //The number of times the arena had to allocate an extra block from the heap. After a reset
+    //the blocks are merged, so this should stay at zero once the frame size has stabilized.
+    return overflowCount;
+  }
+
+ protected:
+  void * doAllocate(size_t bytes, size_t alignment) override {
+    void * p = tryAllocate(blocks[currentBlock],bytes,alignment);
+    if(p == nullptr) {
+      ++overflowCount;
+      size_t size = blocks[currentBlock].size*2;
+      if(size < bytes + alignment) {
+        size = bytes + alignment;
+      }
+      addBlock(size);
+      currentBlock = blocks.size() - 1;
+      p = tryAllocate(blocks[currentBlock],bytes,alignment);
+    }
+    return p;
+  }
+
+  void doDeallocate(void *, size_t, size_t) override {
+
+  }
+
+ private:
+  static constexpr size_t DEFAULT_CAPACITY = 1 << 20;
+
+  class Block {
+   public:
+    std::unique_ptr<char[]> memory;
+    size_t size{0}, used{0};
+  };
+
+  std::vector<Block> blocks;
+  size_t currentBlock{0};
+  size_t overflowCount{0};
+
+  void addBlock(size_t size) {
+    Block b;
+    b.memory = std::unique_ptr<char[]>( new char[size] );
+    b.size = size;
+    blocks.push_back( std::move(b) );
+  }
+
+  void consolidateBlocks() {
+    size_t capacity = getCapacity();
+    blocks.clear();
+    addBlock(capacity);
+  }
+
+  static void * tryAllocate(Block& b, size_t bytes, size_t alignment) {
+    uintptr_t base = reinterpret_cast<uintptr_t>( b.memory.get() );
+    uintptr_t address = base + b.used;
+    uintptr_t aligned = (address + alignment - 1) & ~(uintptr_t) (alignment - 1);
+
+    if(aligned + bytes > base + b.size) {
+      return nullptr;
+    }
+    b.used = aligned + bytes - base;
+    return reinterpret_cast<void*>(aligned);
+  }
+};
+
+class FrameArena {
+  //Two linear arenas that alternate every frame. Data allocated during frame n stays valid
+  //during frame n+1, so the render thread can read what was produced for the previous frame
+  //while the current frame is being built. The caller has to make sure that beginFrame() is not
+  //called while another thread still reads from previous().
+ public:
+  explicit FrameArena(size_t capacity = DEFAULT_CAPACITY) :
+    arenas{ LinearArenaPointer(new LinearArena(capacity)),
+            LinearArenaPointer(new LinearArena(capacity)) }
+  {
+
+  }
+
+  void beginFrame() {
+    currentIndex ^= 1;
+    arenas[currentIndex]->reset();
+    ++frameNumber;
+  }
+
+  LinearArena& current() {
+    return *arenas[currentIndex];
+  }
+
+  LinearArena& previous() {
+    return *arenas[currentIndex^1];
+  }
+
+  unsigned long getFrameNumber() const {
+    return frameNumber;
+  }
+
+  template<class T>
+  ResourceAllocator<T> getAllocator() {
+    return ResourceAllocator<T>( &current() );
+  }
+
+ private:
+  static constexpr size_t DEFAULT_CAPACITY = 1 << 20;
+  using LinearArenaPointer = std::unique_ptr<LinearArena>;
+
+  LinearArenaPointer arenas[2];
+  unsigned char currentIndex{0};
+  unsigned long frameNumber{0};
+};
+
+}
@@ -0,0 +1,291 @@
+#include "Logger.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdio>
+
+namespace ProjectName {
+
+class Logger::I {
+ public:
+  I() {
+    for(size_t i = 0; i < CAPACITY; ++i) {
+      slots[i].sequence.store(i,std::memory_order_relaxed);
+    }
+    consumer = std::thread( [this]() { consumerFunction(); } );
+  }
+
+  ~I() {
+    stopping = true;
+    wakeConsumer();
+    consumer.join();
+  }
+
+  Slot * acquireSlot(LogLevel level) {
+    //The bounded queue of Dmitry Vyukov: a slot is free for position pos when its sequence
+    //number equals pos, and readable when it equals pos + 1.
+    size_t position = enqueuePosition.load(std::memory_order_relaxed);
+    while(true) {
+      Slot& slot = slots[position & MASK];
+      size_t sequence = slot.sequence.load(std::memory_order_acquire);
+      long difference = (long) sequence - (long) position;
+
+      if(difference == 0) {
+        if( enqueuePosition.compare_exchange_weak(position,position + 1,
+          std::memory_order_relaxed) )
+        {
+          return &slot;
+        }
+      }
+      else if(difference < 0) { //The queue is full.
+        if(level != LogLevel::ERROR) {
+          dropped.fetch_add(1,std::memory_order_relaxed);
+          return nullptr;
+        }
+        std::this_thread::yield();
+        position = enqueuePosition.load(std::memory_order_relaxed);
+      }
+      else {
+        position = enqueuePosition.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  void publish(Slot& slot) {
+    size_t sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1,std::memory_order_release);
+  }
+
+  void flush() {
+    size_t target = enqueuePosition.load(std::memory_order_acquire);
+    wakeConsumer();
+    while(writtenPosition.load(std::memory_order_acquire) < target) {
+      std::this_thread::sleep_for( std::chrono::microseconds(FLUSH_POLL_MICROSECONDS) );
+    }
+  }
+
+  unsigned long getDroppedMessageCount() const {
+    return dropped.load(std::memory_order_relaxed);
+  }
+
+ private:
+  static constexpr size_t CAPACITY = 1024; //Must be a power of two.
+  static constexpr size_t MASK = CAPACITY - 1;
+  static constexpr unsigned int IDLE_SLEEP_MILLISECONDS = 2;
+  static constexpr unsigned int FLUSH_POLL_MICROSECONDS = 100;
+
+  Slot slots[CAPACITY];
+  std::atomic<size_t> enqueuePosition{0};
+  size_t dequeuePosition{0}; //Only used by the consumer thread.
+  std::atomic<size_t> writtenPosition{0};
+  std::atomic<unsigned long> dropped{0};
+  std::atomic<bool> stopping{false};
+  std::thread consumer;
+  std::string line;
+
+  //The producers do not wake the consumer, because that would cost them a lock; only flush does.
+  std::mutex wakeMutex;
+  std::condition_variable wakeCondition;
+  bool wakeRequested{false};
+
+  void wakeConsumer() {
+    {
+      std::lock_guard<std::mutex> lock(wakeMutex);
+      wakeRequested = true;
+    }
+    wakeCondition.notify_one();
+  }
+
+  void sleepUntilWokenOrIdleTimeOut() {
+    std::unique_lock<std::mutex> lock(wakeMutex);
+    wakeCondition.wait_for( lock,std::chrono::milliseconds(IDLE_SLEEP_MILLISECONDS),
+      [this]() { return wakeRequested; }
+    );
+    wakeRequested = false;
+  }
+
+  void consumerFunction() {
+    while(true) {
+      bool wroteSomething = drain();
+      if(wroteSomething) {
+        std::fflush(stdout);
+        writtenPosition.store(dequeuePosition,std::memory_order_release);
+      }
+      else if(stopping) {
+        return;
+      }
+      else {
+        sleepUntilWokenOrIdleTimeOut();
+      }
+    }
+  }
+
+  bool drain() {
+    bool result = false;
+    while(true) {
+      Slot& slot = slots[dequeuePosition & MASK];
+      size_t sequence = slot.sequence.load(std::memory_order_acquire);
+      if(sequence != dequeuePosition + 1) {
+        return result;
+      }
+
+      line.clear();
+      format(slot,line);
+      std::fwrite(line.data(),1,line.size(),stdout);
+
+      slot.sequence.store(dequeuePosition + CAPACITY,std::memory_order_release);
+      ++dequeuePosition;
+      result = true;
+    }
+  }
+};
+
+constexpr unsigned char Logger::MAX_ARGUMENTS;
+constexpr unsigned short Logger::MAX_STRING_BYTES;
+constexpr size_t Logger::I::CAPACITY;
+constexpr size_t Logger::I::MASK;
+constexpr unsigned int Logger::I::IDLE_SLEEP_MILLISECONDS;
+constexpr unsigned int Logger::I::FLUSH_POLL_MICROSECONDS;
+
+Logger& Logger::get() {
+  static Logger logger;
+  return logger;
+}
+
+Logger::Logger() {
+  imp = std::unique_ptr<I>( new I() );
+}
+
+Logger::~Logger() = default;
+
+Logger::Slot * Logger::acquireSlot(LogLevel level) {
+  return imp->acquireSlot(level);
+}
+
+void Logger::publish(Slot& slot) {
+  imp->publish(slot);
+}
+
+void Logger::flush() {
+  imp->flush();
+}
+
+unsigned long Logger::getDroppedMessageCount() const {
+  return imp->getDroppedMessageCount();
+}
+
+namespace {
+
+bool isFlag(char c) {
+  return c == '-' || c == '+' || c == ' ' || c == '#' || c == '0';
+}
+
+bool isDigit(char c) {
+  return c >= '0' && c <= '9';
+}
+
+bool isLengthModifier(char c) {
+  return c == 'h' || c == 'l' || c == 'L' || c == 'z' || c == 'j' || c == 't' || c == 'q';
+}
+
+}
+
+void Logger::format(const Slot& slot, std::string& output) {
+  //Interprets the printf conversions one at a time. The length modifiers of the format string
+  //are replaced, because every integer was stored as a long long and every float as a double.
+  const char * f = slot.format;
+  unsigned char next = 0;
+  char specification[32];
+  char buffer[64];
+
+  while(*f != '\0') {
+    if(*f != '%') {
+      output += *f;
+      ++f;
+      continue;
+    }
+    if(f[1] == '%') {
+      output += '%';
+      f += 2;
+      continue;
+    }
+
+    size_t length = 0;
+    specification[length++] = *f++;
+    while( ( isFlag(*f) || isDigit(*f) || *f == '.' ) && length < sizeof(specification) - 4 ) {
+      specification[length++] = *f++;
+    }
+    while( isLengthModifier(*f) ) {
+      ++f;
+    }
+    char conversion = *f;
+    if(conversion == '\0') {
+      break;
+    }
+    ++f;
+
+    if(next >= slot.argumentCount) {
+      output += "(missing argument)";
+      continue;
+    }
+    const Argument& a = slot.arguments[next++];
+    int written = 0;
+
+    switch(conversion) {
+      case 'd': case 'i': case 'o': case 'u': case 'x': case 'X':
+        specification[length++] = 'l';
+        specification[length++] = 'l';
+        specification[length++] = conversion;
+        specification[length] = '\0';
+        if(a.kind == Argument::SIGNED) {
+          written = std::snprintf(buffer,sizeof(buffer),specification,a.s);
+        }
+        else {
+          written = std::snprintf(buffer,sizeof(buffer),specification,a.u);
+        }
+        break;
+      case 'c':
+        specification[length++] = 'c';
+        specification[length] = '\0';
+        written = std::snprintf(buffer,sizeof(buffer),specification,(int) a.s);
+        break;
+      case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+        specification[length++] = conversion;
+        specification[length] = '\0';
+        written = std::snprintf(buffer,sizeof(buffer),specification,
+          a.kind == Argument::FLOATING ? a.d : (double) a.s);
+        break;
+      case 's':
+        specification[length++] = 's';
+        specification[length] = '\0';
+        if(a.kind == Argument::STRING) {
+          if(length == 2) { //The common case "%s" needs no formatting.
+            output += &slot.strings[a.stringOffset];
+            continue;
+          }
+          std::string padded(MAX_STRING_BYTES + 64,'\0');
+          written = std::snprintf(&padded[0],padded.size(),specification,
+            &slot.strings[a.stringOffset]);
+          output.append( padded.c_str() );
+          continue;
+        }
+        output += "(not a string)";
+        continue;
+      case 'p':
+        written = std::snprintf(buffer,sizeof(buffer),"%p",a.p);
+        break;
+      default:
+        output += "(unsupported conversion)";
+        continue;
+    }
+
+    if(written > 0) {
+      size_t n = (size_t) written < sizeof(buffer) ? (size_t) written : sizeof(buffer) - 1;
+      output.append(buffer,n);
+    }
+  }
+}
+
+}
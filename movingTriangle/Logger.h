@@ -0,0 +1,204 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <cstring>
+#include <cstddef>
+#include <type_traits>
+
+//Severity levels for the compile time filter. Messages below PROJECTNAME_LOG_LEVEL are removed
+//by the compiler, including the evaluation of their arguments.
+#define PROJECTNAME_LOG_LEVEL_VERBOSE 0
+#define PROJECTNAME_LOG_LEVEL_INFO 1
+#define PROJECTNAME_LOG_LEVEL_WARNING 2
+#define PROJECTNAME_LOG_LEVEL_ERROR 3
+
+#ifndef PROJECTNAME_LOG_LEVEL
+  #define PROJECTNAME_LOG_LEVEL PROJECTNAME_LOG_LEVEL_INFO
+#endif
+
+#if defined(LOG_VERBOSE) || defined(LOG_INFO) || defined(LOG_WARNING) || defined(LOG_ERROR)
+  #error "The LOG_ macros have already been defined, for instance by <syslog.h>."
+#endif
+
+#define PROJECTNAME_LOG(level, ...) \
+  do { \
+    if(level >= PROJECTNAME_LOG_LEVEL) { \
+      ProjectName::Logger::get().write( (ProjectName::LogLevel) level,__VA_ARGS__ ); \
+    } \
+  } while(false)
+
+#define LOG_VERBOSE(...) PROJECTNAME_LOG(PROJECTNAME_LOG_LEVEL_VERBOSE,__VA_ARGS__)
+#define LOG_INFO(...) PROJECTNAME_LOG(PROJECTNAME_LOG_LEVEL_INFO,__VA_ARGS__)
+#define LOG_WARNING(...) PROJECTNAME_LOG(PROJECTNAME_LOG_LEVEL_WARNING,__VA_ARGS__)
+#define LOG_ERROR(...) PROJECTNAME_LOG(PROJECTNAME_LOG_LEVEL_ERROR,__VA_ARGS__)
+
+namespace ProjectName {
+
+enum class LogLevel : unsigned char {
+  VERBOSE = PROJECTNAME_LOG_LEVEL_VERBOSE,
+  INFO = PROJECTNAME_LOG_LEVEL_INFO,
+  WARNING = PROJECTNAME_LOG_LEVEL_WARNING,
+  ERROR = PROJECTNAME_LOG_LEVEL_ERROR
+};
+
+class Logger {
+  //Replaces std::printf on threads that should not wait for the terminal. write() copies the
+  //format string pointer and the arguments into a slot of a lock-free ring buffer; a background
+  //thread formats the message with the printf rules and writes it to stdout. The format string
+  //has to be a string literal (or live as long as the program), but string arguments are
+  //copied, truncated to MAX_STRING_BYTES in total.
+  //Messages are dropped (and counted) when the ring buffer is full, except for errors: those
+  //wait for a free slot and are written before write() returns, because an error is usually
+  //followed by an exception that ends the program.
+ public:
+  static constexpr unsigned char MAX_ARGUMENTS = 8;
+  static constexpr unsigned short MAX_STRING_BYTES = 192;
+
+  static Logger& get();
+
+  ~Logger();
+
+  template<class... Arguments>
+  void write(LogLevel level, const char * format, const Arguments&... arguments) {
+    static_assert(sizeof...(Arguments) <= MAX_ARGUMENTS,"Too many arguments for the Logger");
+
+    Slot * slot = acquireSlot(level);
+    if(slot == nullptr) {
+      return;
+    }
+    slot->level = level;
+    slot->format = format;
+    slot->argumentCount = 0;
+    slot->stringBytes = 0;
+    captureArguments(*slot,arguments...);
+    publish(*slot);
+
+    if(level == LogLevel::ERROR) {
+      flush();
+    }
+  }
+
+  void flush();
+  //Blocks until everything that has been written before is on stdout.
+
+  unsigned long getDroppedMessageCount() const;
+
+ private:
+  class Argument {
+   public:
+    enum Kind : unsigned char { SIGNED, UNSIGNED, FLOATING, POINTER, STRING } kind;
+    union {
+      long long s;
+      unsigned long long u;
+      double d;
+      const void * p;
+      unsigned short stringOffset;
+    };
+  };
+
+  class Slot {
+   public:
+    std::atomic<size_t> sequence{0};
+    LogLevel level;
+    const char * format;
+    unsigned char argumentCount;
+    unsigned short stringBytes;
+    Argument arguments[MAX_ARGUMENTS];
+    char strings[MAX_STRING_BYTES];
+  };
+
+  class I;
+  std::unique_ptr<I> imp;
+
+  Logger();
+
+  Slot * acquireSlot(LogLevel level);
+  void publish(Slot& slot);
+
+  static void captureArguments(Slot&) {
+
+  }
+
+  template<class First, class... Rest>
+  static void captureArguments(Slot& slot, const First& first, const Rest&... rest) {
+    capture( slot,slot.arguments[slot.argumentCount++],first );
+    captureArguments(slot,rest...);
+  }
+
+  template<class T>
+  static typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type
+  capture(Slot&, Argument& a, const T& t) {
+    a.kind = Argument::SIGNED;
+    a.s = t;
+  }
+
+  template<class T>
+  static typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value>::type
+  capture(Slot&, Argument& a, const T& t) {
+    a.kind = Argument::UNSIGNED;
+    a.u = t;
+  }
+
+  template<class T>
+  static typename std::enable_if<std::is_enum<T>::value>::type
+  capture(Slot&, Argument& a, const T& t) {
+    a.kind = Argument::SIGNED;
+    a.s = (long long) t;
+  }
+
+  template<class T>
+  static typename std::enable_if<std::is_floating_point<T>::value>::type
+  capture(Slot&, Argument& a, const T& t) {
+    a.kind = Argument::FLOATING;
+    a.d = (double) t;
+  }
+
+  static void capture(Slot& slot, Argument& a, const char * text) {
+    captureString( slot,a,text,text != nullptr ? std::strlen(text) : 0 );
+  }
+
+  static void capture(Slot& slot, Argument& a, char * text) {
+    capture( slot,a,(const char *) text );
+  }
+
+  static void capture(Slot& slot, Argument& a, const unsigned char * text) {
+    //glGetString returns const GLubyte *.
+    capture( slot,a,(const char *) text );
+  }
+
+  static void capture(Slot& slot, Argument& a, const std::string& text) {
+    captureString( slot,a,text.c_str(),text.size() );
+  }
+
+  template<class T>
+  static void capture(Slot&, Argument& a, T * const& p) {
+    a.kind = Argument::POINTER;
+    a.p = (const void *) p;
+  }
+
+  static void captureString(Slot& slot, Argument& a, const char * text, size_t length) {
+    if(text == nullptr) {
+      text = "(null)";
+      length = 6;
+    }
+    a.kind = Argument::STRING;
+    if(slot.stringBytes >= MAX_STRING_BYTES) {
+      a.stringOffset = MAX_STRING_BYTES - 1; //The terminator of the last string.
+      return;
+    }
+    size_t available = MAX_STRING_BYTES - slot.stringBytes - 1;
+    if(length > available) {
+      length = available;
+    }
+    a.stringOffset = slot.stringBytes;
+    std::memcpy(&slot.strings[slot.stringBytes],text,length);
+    slot.strings[slot.stringBytes + length] = '\0';
+    slot.stringBytes = (unsigned short) (slot.stringBytes + length + 1);
+  }
+
+  static void format(const Slot& slot, std::string& output);
+};
+
+}
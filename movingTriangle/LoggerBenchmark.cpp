@@ -0,0 +1,70 @@
+#include "Logger.h"
+
+#include <cstdio> //For std::printf
+#include <iostream> //For std::cout
+#include <chrono>
+
+//Compares the time that the calling thread spends on std::printf, std::cout and the Logger. Run
+//it with stdout redirected to a file or to a slow pipe, for instance
+//  ./loggerBenchmark > /dev/null
+//, because the point of the Logger is that the caller does not wait for the terminal.
+//The messages are written in bursts of BURST messages, like a frame that logs a few lines: the
+//Logger drops messages when a burst is larger than its ring buffer, and the time spent waiting
+//for the background thread between bursts is not counted. The results are written to stderr.
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const int MESSAGES = 100000;
+const int BURST = 256;
+
+double toNanosecondsPerMessage(Clock::duration d) {
+  return std::chrono::duration<double,std::nano>(d).count()/MESSAGES;
+}
+
+}
+
+int main() {
+  double x = 1.14, y = 0.42;
+
+  Clock::time_point start = Clock::now();
+  for(int i = 0; i < MESSAGES; ++i) {
+    std::printf("message %d: (%.2f,%.2f)\n",i,x,y);
+  }
+  Clock::duration printfTime = Clock::now() - start;
+
+  start = Clock::now();
+  for(int i = 0; i < MESSAGES; ++i) {
+    std::cout << "message " << i << ": (" << x << "," << y << ")\n";
+  }
+  std::cout.flush();
+  Clock::duration coutTime = Clock::now() - start;
+
+  Clock::duration loggerTime{0}, flushTime{0};
+  for(int burstStart = 0; burstStart < MESSAGES; burstStart += BURST) {
+    start = Clock::now();
+    for(int i = burstStart; i < burstStart + BURST && i < MESSAGES; ++i) {
+      LOG_INFO("message %d: (%.2f,%.2f)\n",i,x,y);
+    }
+    loggerTime += Clock::now() - start;
+
+    start = Clock::now();
+    ProjectName::Logger::get().flush();
+    flushTime += Clock::now() - start;
+  }
+
+  std::fprintf(stderr,"std::printf : %8.1f ns per message\n",toNanosecondsPerMessage(printfTime));
+  std::fprintf(stderr,"std::cout   : %8.1f ns per message\n",toNanosecondsPerMessage(coutTime));
+  std::fprintf(stderr,"Logger      : %8.1f ns per message (caller only)\n",
+    toNanosecondsPerMessage(loggerTime)
+  );
+  std::fprintf(stderr,"Logger wait : %8.1f ns per message (background thread)\n",
+    toNanosecondsPerMessage(flushTime)
+  );
+  std::fprintf(stderr,"Logger dropped %lu of %d messages.\n",
+    ProjectName::Logger::get().getDroppedMessageCount(),MESSAGES
+  );
+
+  return 0;
+}
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace ProjectName {
+
+class AllocationSnapshot {
+ public:
+  size_t allocations{0}, deallocations{0};
+  size_t bytesAllocated{0}, bytesInUse{0}, peakBytesInUse{0};
+};
+
+class MemoryResource {
+  //A small version of std::pmr::memory_resource, which is only available since C++17.
+  //Containers refer to a resource through ResourceAllocator, so the same container type can
+  //allocate from the heap, from a frame arena or from a pool.
+ public:
+  virtual ~MemoryResource() {
+
+  }
+
+  void * allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+    void * p = doAllocate(bytes,alignment);
+    countAllocation(bytes);
+    return p;
+  }
+
+  void deallocate(void * p, size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+    doDeallocate(p,bytes,alignment);
+    countDeallocation(bytes);
+  }
+
+  AllocationSnapshot getStatistics() const {
+    AllocationSnapshot s;
+    s.allocations = allocations.load(std::memory_order_relaxed);
+    s.deallocations = deallocations.load(std::memory_order_relaxed);
+    s.bytesAllocated = bytesAllocated.load(std::memory_order_relaxed);
+    s.bytesInUse = bytesInUse.load(std::memory_order_relaxed);
+    s.peakBytesInUse = peakBytesInUse.load(std::memory_order_relaxed);
+    return s;
+  }
+
+ protected:
+  virtual void * doAllocate(size_t bytes, size_t alignment) = 0;
+  virtual void doDeallocate(void * p, size_t bytes, size_t alignment) = 0;
+
+  void releaseAllBytes() { //For resources that free everything at once, like arenas.
+    bytesInUse.store(0,std::memory_order_relaxed);
+  }
+
+ private:
+  //The counters are relaxed atomics, because a resource such as the heap resource can be used
+  //by the main thread and the render thread at the same time.
+  std::atomic<size_t> allocations{0}, deallocations{0};
+  std::atomic<size_t> bytesAllocated{0}, bytesInUse{0}, peakBytesInUse{0};
+
+  void countAllocation(size_t bytes) {
+    allocations.fetch_add(1,std::memory_order_relaxed);
+    bytesAllocated.fetch_add(bytes,std::memory_order_relaxed);
+    size_t inUse = bytesInUse.fetch_add(bytes,std::memory_order_relaxed) + bytes;
+
+    size_t peak = peakBytesInUse.load(std::memory_order_relaxed);
+    while( inUse > peak && !peakBytesInUse.compare_exchange_weak(peak,inUse) ) {
+
+    }
+  }
+
+  void countDeallocation(size_t bytes) {
+    deallocations.fetch_add(1,std::memory_order_relaxed);
+
+    size_t inUse = bytesInUse.load(std::memory_order_relaxed);
+    size_t remaining;
+    do {
+      remaining = inUse > bytes ? inUse - bytes : 0;
+      //An arena may already have released these bytes when it was reset.
+    } while( !bytesInUse.compare_exchange_weak(inUse,remaining) );
+  }
+};
+
+class HeapResource : public MemoryResource {
+ protected:
+  void * doAllocate(size_t bytes, size_t alignment) override {
+    if( alignment > alignof(std::max_align_t) ) {
+      throw std::runtime_error("HeapResource does not support over-aligned allocations");
+    }
+    return ::operator new(bytes);
+  }
+
+  void doDeallocate(void * p, size_t, size_t) override {
+    ::operator delete(p);
+  }
+};
+
+inline MemoryResource * getHeapResource() {
+  static HeapResource resource;
+  return &resource;
+}
+
+template<class T>
+class ResourceAllocator {
+  //Allocator that forwards to a MemoryResource, so it can be used with the standard containers.
+ public:
+  using value_type = T;
+
+  using propagate_on_container_copy_assignment = std::true_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  ResourceAllocator() : resource( getHeapResource() ) {
+
+  }
+
+  ResourceAllocator(MemoryResource * r) : resource(r) {
+
+  }
+
+  template<class U>
+  ResourceAllocator(const ResourceAllocator<U>& other) : resource( other.getResource() ) {
+
+  }
+
+  T * allocate(size_t n) {
+    return static_cast<T*>( resource->allocate(n*sizeof(T),alignof(T)) );
+  }
+
+  void deallocate(T * p, size_t n) {
+    resource->deallocate(p,n*sizeof(T),alignof(T));
+  }
+
+  MemoryResource * getResource() const {
+    return resource;
+  }
+
+ private:
+  MemoryResource * resource;
+};
+
+template<class T, class U>
+bool operator==(const ResourceAllocator<T>& a, const ResourceAllocator<U>& b) {
+  return a.getResource() == b.getResource();
+}
+
+template<class T, class U>
+bool operator!=(const ResourceAllocator<T>& a, const ResourceAllocator<U>& b) {
+  return a.getResource() != b.getResource();
+}
+
+template<class T>
+using ResourceVector = std::vector< T,ResourceAllocator<T> >;
+
+}
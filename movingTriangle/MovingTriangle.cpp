@@ -2,17 +2,39 @@
 
 #include "sleep.h"
 
-#include <cstdio>
 #include <string>
+#include <vector>
 #include <fstream>
 #include <atomic>
+#include <algorithm>
+#include <cmath>
 
 #include <SDL.h>
 #include <glad/glad.h>
 
 #include <ShaderProgram.h>
+#include <ShaderPermutations.h>
+#include <GLSLPreprocessor.h>
 #include <AttributeContainer.h>
 #include <IndexContainer.h>
+#include <BufferPool.h>
+#include <LinearArena.h>
+#include <VertexQuantization.h>
+#include <SpatialGrid.h>
+#include <EntityStore.h>
+#include <SceneComponents.h>
+#include <TransformHierarchy.h>
+#include <ParticleSystem.h>
+#include <ShapeTessellator.h>
+#include <StrokeBatch.h>
+#include <TextBatch.h>
+#include <TextRenderer.h>
+#include <RenderPass.h>
+#include <JobSystem.h>
+#include <Logger.h>
+#include <GLDebug.h>
+#include <FrameProfiler.h>
+#include <Profiler.h>
 
 namespace ProjectName {
 
@@ -25,12 +47,13 @@ class CircleProgram: public Renderer {
   }
 
   void start() {
-    std::printf("Hello, World!\n");
+    PROFILE_THREAD_NAME("main");
+    LOG_INFO("Hello, World!\n");
     SDL_Init(0);
     
     window.initialize();
 
-    std::printf("(Width,Height,Frequency) = (%d,%d,%d)\n",
+    LOG_INFO("(Width,Height,Frequency) = (%d,%d,%d)\n",
       window.getScreenWidth(),
       window.getScreenHeight(),
       window.getScreenFrequency()
@@ -38,6 +61,10 @@ class CircleProgram: public Renderer {
 
     fillAttributeContainer();
     fillIndexContainer();
+    prepareParticleVertices();
+    prepareShapes();
+    prepareStrokes();
+    prepareText();
 
 
     //indexContainer.printIndices();
@@ -49,6 +76,11 @@ class CircleProgram: public Renderer {
     processEvents();
     
     window.stop();
+    printShapeStatistics();
+    printTextStatistics();
+    printBufferStatistics();
+
+    PROFILE_WRITE_CHROME_TRACE("profile.json");
     
     SDL_Quit();
   }
@@ -56,67 +88,186 @@ class CircleProgram: public Renderer {
   void initializeRendering() override {
     printOpenGLInformation();
     
-    glClearColor(0.0f,0.0f,0.0f,1.0f);
+    //Everything is drawn into the cleared color; there is no depth or stencil test.
+    scenePass.setClearColor(0.0f,0.0f,0.0f,1.0f);
+    scenePass.setActions(RenderPass::COLOR,RenderPass::Load::CLEAR,RenderPass::Store::STORE);
+    scenePass.setActions(RenderPass::DEPTH,RenderPass::Load::DONT_CARE,RenderPass::Store::DISCARD);
+    scenePass.setActions(RenderPass::STENCIL,RenderPass::Load::DONT_CARE,
+      RenderPass::Store::DISCARD
+    );
 
     createShaderProgram();
 
-    glEnableVertexAttribArray(0);
-    glEnableVertexAttribArray(1);
-
-    attributeContainer.initialize();
-    indexContainer.initialize();
+    attributeContainer.initialize(vertexPool);
+    indexContainer.initialize(indexPool);
+    attributeContainer.setIndexContainer(indexContainer);
+    particleVertices.initializeStreaming();
+    shapeVertices.initializeStreaming();
+    strokeVertices.initializeStreaming();
+    textRenderer.initialize();
 
     
+    printOpenGLError();
+  }
+  
+  void beginFrame() override {
+    //Nothing moves while paused, so there is no damage, and GLWindow skips the frames. The
+    //boxes of the previous frame are left in the other arena of the frame arena.
+    damageBoxes = ResourceVector<BoundingBox2D>(
+      window.getFrameArena().getAllocator<BoundingBox2D>()
+    );
+    if(paused) {
+      return;
+    }
+    entities.forEach<Transform2D,Velocity2D,GridObject,TransformNode>(
+      [this](Transform2D& t, const Velocity2D& v, const GridObject& g, const TransformNode& n) {
+        damageBoxes.push_back( triangleBox.translated(t.x,t.y) );
+        t.x += v.x*FRAME_TIME;
+        if(t.x > 1.5f) {
+          t.x = -1.5f;
+        }
+        grid.move( g.handle,triangleBox.translated(t.x,t.y) );
+        damageBoxes.push_back( triangleBox.translated(t.x,t.y) );
+        transforms.setLocal(n.node,t);
+        emitter.x = t.x;
+        emitter.y = t.y + 0.2f;
+      }
+    );
 
-    shaderProgram.activate();
+    transforms.update( &JobSystem::get() );
 
-    
-    printOpenGLError();
-    
-    if( glGetError() ) {
-      std::printf( "There has been an OpenGL error.\n" );
+    particles.emit(emitter,PARTICLES_PER_FRAME);
+    particles.update( FRAME_TIME,&JobSystem::get() );
+    addMovingDamage( particleBounds,particles.getBounds() );
+    particleVertices.stream( particles.writeVertices( particleVertices,&JobSystem::get() ) );
+
+    tessellateShapes();
+    shapeVertices.stream( tessellator.writeVertices(shapeVertices) );
+
+    addPlots();
+    strokeVertices.stream( strokes.writeVertices( strokeVertices,&JobSystem::get() ) );
+
+    updateText();
+    const std::vector<BoundingBox2D>& text = textBatch.getChangedBounds();
+    damageBoxes.insert( damageBoxes.end(),text.begin(),text.end() );
+  }
+
+  void reportDamage(const RenderView& view, DamageRegion& damage) override {
+    (void) view;
+    for(const BoundingBox2D& b : damageBoxes) {
+      damage.addClipSpace(b,DAMAGE_MARGIN);
     }
   }
-  
+
   void render() override {
-    glClear(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT);
-    
-    
-    x += 0.0025;
-    if(x > 1.5) {
-      x = -1.5;
+    scenePass.begin();
+
+    //The triangle is off screen for a part of its way, and then it is not drawn.
+    grid.cull(clipSpace,visible);
+
+    FrameProfiler::Scope scope(window.getFrameProfiler(),"CircleProgram::draw");
+    ShaderProgram& shaderProgram = shaders.get(triangleFeatures);
+    shaderProgram.activate();
+    attributeContainer.bind();
+    for(SpatialGrid::Handle h : visible) {
+      const TransformNode * n = entities.get<TransformNode>(gridEntities[h]);
+      GLfloat matrix[9];
+      transforms.getWorldMatrix(n->node,matrix);
+
+      GLfloat transform[9];
+      positionQuantizer.foldIntoTransform(matrix,transform);
+
+      GL_CHECK( glUniformMatrix3fv(matrixUniform,1,true,transform) );
+      GL_CHECK( glDrawElements(GL_TRIANGLES,indexContainer.getIndexCount(),GL_UNSIGNED_SHORT,
+        indexContainer.getIndexOffset()
+      ) );
     }
-    
-    matrix[2] = (GLfloat) x;
-    
-    glUniformMatrix3fv(matrixUniform,1,true,matrix);
-    
-    glDrawElements(GL_TRIANGLES,3,GL_UNSIGNED_SHORT,0);
+
+    drawShapes();
+    drawStrokes();
+    drawParticles();
+    textRenderer.render(textBatch);
+    scenePass.end();
   }
 
  private:
   static constexpr unsigned char EVENT_SLEEP_TIME = 5;
+  static constexpr float FRAME_TIME = 1.0f/60; //Seconds; the animation advances per frame.
+  static constexpr size_t PARTICLE_CAPACITY = 65536;
+  static constexpr size_t PARTICLES_PER_FRAME = 400;
+  static constexpr GLfloat PARTICLE_SIZE = 4; //Pixels.
+  static constexpr size_t SHAPE_CAPACITY = 16384; //Vertices.
+  static constexpr size_t PLOTS = 4;
+  static constexpr size_t PLOT_POINTS = 512;
+  static constexpr float TEXT_SIZE = 12; //Pixels, the height of capitals.
+  //Around damage in pixels: half the largest point and stroke, and the smoothed edges.
+  static constexpr float DAMAGE_MARGIN = 4;
+
+  class GridObject {
+   public:
+    SpatialGrid::Handle handle;
+  };
+
+  class TransformNode {
+   public:
+    TransformHierarchy::Node node;
+  };
 
   std::string dataLocation{"."};
   GLWindow window;
   std::atomic<bool> stopBoolean{false};
+  std::atomic<bool> paused{false}; //Toggled with P.
+
+  ResourceVector<BoundingBox2D> damageBoxes; //In clip space, of the last beginFrame.
+  BoundingBox2D particleBounds, shapeBounds, plotBounds; //Of the previous frame.
 
-  ShaderProgram shaderProgram;
+  GLSLPreprocessor preprocessor;
+  ShaderPermutations shaders;
+  uint32_t triangleFeatures{0}, particleFeatures{0}; //Bitmasks of the variants of shaders.
+  //Static meshes share the buffer objects of these pools, which outlive the containers.
+  BufferPool vertexPool{GL_ARRAY_BUFFER}, indexPool{GL_ELEMENT_ARRAY_BUFFER};
   AttributeContainer attributeContainer;
   IndexContainer indexContainer;
 
-  double x{0.0};
-  GLfloat matrix[9] {  
-    1,0,0,
-    0,1,0,
-    0,0,1
-  };
+  TransformHierarchy transforms;
+  TransformHierarchy::Node sceneNode{ transforms.add() }; //The parent of every triangle.
   GLint matrixUniform;
 
+  PositionQuantizer positionQuantizer{ BoundingBox2D() };
+
+  const BoundingBox2D clipSpace{-1,-1,1,1};
+  EntityStore entities;
+  SpatialGrid grid{ BoundingBox2D(-2,-2,2,2),0.5f };
+  std::vector<Entity> gridEntities; //The entity of every handle of the grid.
+  BoundingBox2D triangleBox;
+  std::vector<SpatialGrid::Handle> visible;
+
+  GLint pointSizeUniform;
+  AttributeContainer particleVertices;
+  ParticleSystem particles{PARTICLE_CAPACITY};
+  ParticleSystem::Emitter emitter;
+
+  ShapeTessellator tessellator;
+  AttributeContainer shapeVertices;
+  BezierPath heart;
+  float shapeTime{0}; //Seconds.
+  size_t shapeFrames{0};
+
+  StrokeBatch strokes;
+  AttributeContainer strokeVertices;
+  std::vector<float> plotX, plotY;
+
+  GlyphCache glyphCache;
+  TextBatch textBatch{glyphCache};
+  TextRenderer textRenderer;
+  RenderPass scenePass{"scene"};
+  TextBatch::Label titleLabel, frameLabel, shapeLabel;
+  size_t textFrames{0};
+
   void printOpenGLInformation() {
-    std::printf( "OpenGL Version  : %s\n",glGetString(GL_VERSION) );
-    std::printf( "OpenGL Vendor   : %s\n",glGetString(GL_VENDOR) );
-    std::printf( "OpenGL Renderer : %s\n",glGetString(GL_RENDERER) );
+    LOG_INFO( "OpenGL Version  : %s\n",glGetString(GL_VERSION) );
+    LOG_INFO( "OpenGL Vendor   : %s\n",glGetString(GL_VENDOR) );
+    LOG_INFO( "OpenGL Renderer : %s\n",glGetString(GL_RENDERER) );
   }
 
 
@@ -124,15 +275,27 @@ class CircleProgram: public Renderer {
     using C = AttributeContainer;
     C& c = attributeContainer;
 
-    c.addAttributeType( C::FLOAT,false,C::TWO);
+    c.addAttributeType( C::SHORT,true,C::TWO); //Quantized, see positionQuantizer.
     c.addAttributeType( C::UNSIGNED_BYTE,true,C::FOUR);
 
     c.reserve(3);
 
     GLfloat f = 0.5;
-    c.addAttribute<GLfloat>(0, {-f,0} );
-    c.addAttribute<GLfloat>(0, { f,0} );
-    c.addAttribute<GLfloat>(0, { 0,f} );
+    GLfloat positions[3][2] = { {-f,0},{f,0},{0,f} };
+
+    BoundingBox2D box;
+    for(const auto& p : positions) {
+      box.add(p[0],p[1]);
+    }
+    positionQuantizer = PositionQuantizer(box);
+    triangleBox = box;
+    createTriangle();
+
+    for(const auto& p : positions) {
+      GLshort q[2];
+      positionQuantizer.quantize(p[0],p[1],q);
+      c.addAttribute<GLshort>(0, {q[0],q[1]} );
+    }
 
 
     GLubyte b = 255;
@@ -141,6 +304,212 @@ class CircleProgram: public Renderer {
     c.addAttribute<GLubyte>(1, {0,0,b,b} );
   }
 
+  void createTriangle() {
+    Velocity2D velocity;
+    velocity.x = 0.0025f/FRAME_TIME;
+    GridObject g{ grid.insert(triangleBox) };
+    TransformNode n{ transforms.add(sceneNode) };
+    Entity e = entities.create( Transform2D(),velocity,g,n );
+    gridEntities.resize(g.handle + 1);
+    gridEntities[g.handle] = e;
+  }
+
+  void prepareParticleVertices() {
+    using C = AttributeContainer;
+    particleVertices.addAttributeType(C::FLOAT,false,C::TWO);
+    particleVertices.addAttributeType(C::UNSIGNED_BYTE,true,C::FOUR);
+    particleVertices.reserve( particles.getCapacity() );
+
+    emitter.minimumSpeed = 0.05f;
+    emitter.maximumSpeed = 0.3f;
+    emitter.direction = 1.5707963f; //Upwards.
+    emitter.spread = 1.5f;
+    emitter.minimumLifetime = 0.5f;
+    emitter.maximumLifetime = 1.5f;
+    const GLubyte orange[4] = {255,160,40,255};
+    std::copy(orange,orange + 4,emitter.color);
+    particles.setGravity(0,-0.3f);
+  }
+
+  void drawParticles() {
+    if(particleVertices.getStreamedVertexCount() == 0) {
+      return;
+    }
+    shaders.get(particleFeatures).activate();
+    GL_CHECK( glUniform1f(pointSizeUniform,PARTICLE_SIZE) );
+    particleVertices.bind();
+    GL_CHECK( glEnable(GL_BLEND) );
+    GL_CHECK( glBlendFunc(GL_SRC_ALPHA,GL_ONE_MINUS_SRC_ALPHA) );
+    GL_CHECK( glDrawArrays(GL_POINTS,0,(GLsizei) particleVertices.getStreamedVertexCount()) );
+    GL_CHECK( glDisable(GL_BLEND) );
+  }
+
+  void prepareShapes() {
+    using C = AttributeContainer;
+    shapeVertices.addAttributeType(C::FLOAT,false,C::TWO);
+    shapeVertices.addAttributeType(C::UNSIGNED_BYTE,true,C::FOUR);
+    shapeVertices.reserve(SHAPE_CAPACITY);
+
+    //Clip space is stretched over the window, so the longer side decides the number of pixels.
+    int longerSide = std::max( window.getScreenWidth(),window.getScreenHeight() );
+    tessellator.setPixelsPerUnit(longerSide*0.5f);
+
+    heart.moveTo(0,-0.25f);
+    heart.cubicTo(-0.5f,0.05f,-0.25f,0.45f,0,0.2f);
+    heart.cubicTo(0.25f,0.45f,0.5f,0.05f,0,-0.25f);
+  }
+
+  void tessellateShapes() {
+    //The sizes change all the time, so that the number of segments follows them.
+    shapeTime += FRAME_TIME;
+    float pulse = 0.5f + 0.5f*std::sin(shapeTime);
+    tessellator.clear();
+    tessellator.addCircle( -0.6f,0.55f,0.01f + 0.3f*pulse,Color{60,120,255,255} );
+    tessellator.addArc( 0.6f,0.55f,0.2f,0,6.2831853f*pulse,Color{60,220,120,255} );
+    tessellator.addRoundedRectangle( -0.9f,-0.9f,-0.3f,-0.6f,0.02f + 0.1f*pulse,
+      Color{200,200,200,255}
+    );
+    tessellator.addPath( heart,0.6f,-0.55f,0.2f + 1.0f*pulse,Color{230,40,80,255} );
+    ++shapeFrames;
+
+    BoundingBox2D bounds;
+    for(const ShapeVertex& v : tessellator.getVertices()) {
+      bounds.add(v.x,v.y);
+    }
+    addMovingDamage(shapeBounds,bounds);
+  }
+
+  void drawShapes() {
+    if(shapeVertices.getStreamedVertexCount() == 0) {
+      return;
+    }
+    shaders.get(0).activate(); //The positions are in clip space already.
+    shapeVertices.bind();
+    GL_CHECK( glDrawArrays(GL_TRIANGLES,0,(GLsizei) shapeVertices.getStreamedVertexCount()) );
+  }
+
+  void printShapeStatistics() {
+    if(shapeFrames == 0) {
+      return;
+    }
+    const ShapeTessellator::Statistics& s = tessellator.getStatistics();
+    LOG_INFO("Shapes: %zu triangles per frame, %zu with %u segments per circle\n",
+      s.triangles/shapeFrames,s.fixedTriangles/shapeFrames,
+      (unsigned int) ShapeTessellator::FIXED_CIRCLE_SEGMENTS
+    );
+    LOG_INFO("Shapes: %zu of %zu paths from the cache\n",s.pathCacheHits,
+      s.pathCacheHits + s.pathCacheMisses
+    );
+  }
+
+  void prepareStrokes() {
+    using C = AttributeContainer;
+    strokeVertices.addAttributeType(C::FLOAT,false,C::TWO);
+    strokeVertices.addAttributeType(C::UNSIGNED_BYTE,true,C::FOUR);
+    strokeVertices.reserve( PLOTS*(7*PLOT_POINTS - 4) );
+    strokes.setViewportSize( window.getScreenWidth(),window.getScreenHeight() );
+
+    plotX.resize(PLOT_POINTS);
+    plotY.resize(PLOT_POINTS);
+    for(size_t i = 0; i < PLOT_POINTS; ++i) {
+      plotX[i] = -0.9f + 1.8f*i/(PLOT_POINTS - 1);
+    }
+  }
+
+  void addPlots() {
+    //Traces that scroll, in the band below the shapes at the top.
+    strokes.clear();
+    BoundingBox2D bounds;
+    for(size_t p = 0; p < PLOTS; ++p) {
+      float frequency = 6.0f + 5.0f*p;
+      for(size_t i = 0; i < PLOT_POINTS; ++i) {
+        plotY[i] = 0.1f*p - 0.15f + 0.04f*std::sin(frequency*plotX[i] - 3*shapeTime);
+        bounds.add(plotX[i],plotY[i]);
+      }
+      StrokeBatch::Style style;
+      style.width = 0.75f + 1.5f*p;
+      style.color = Color{ (uint8_t) (255 - 50*p),(uint8_t) (100 + 50*p),255,255 };
+      strokes.addPolyline(plotX.data(),plotY.data(),PLOT_POINTS,style);
+    }
+    addMovingDamage(plotBounds,bounds);
+  }
+
+  void addMovingDamage(BoundingBox2D& previous, const BoundingBox2D& current) {
+    //What moves is damaged where it was and where it is now.
+    damageBoxes.push_back(previous);
+    damageBoxes.push_back(current);
+    previous = current;
+  }
+
+  void drawStrokes() {
+    if(strokeVertices.getStreamedVertexCount() == 0) {
+      return;
+    }
+    shaders.get(0).activate();
+    strokeVertices.bind();
+    GL_CHECK( glEnable(GL_BLEND) );
+    GL_CHECK( glBlendFunc(GL_SRC_ALPHA,GL_ONE_MINUS_SRC_ALPHA) );
+    GL_CHECK( glDrawArrays(GL_TRIANGLE_STRIP,0,
+      (GLsizei) strokeVertices.getStreamedVertexCount()
+    ) );
+    GL_CHECK( glDisable(GL_BLEND) );
+  }
+
+  void prepareText() {
+    textBatch.setViewportSize( window.getScreenWidth(),window.getScreenHeight() );
+    titleLabel = textBatch.createLabel();
+    frameLabel = textBatch.createLabel();
+    shapeLabel = textBatch.createLabel();
+    textBatch.setText(titleLabel,"Moving Triangle",-0.97f,0.93f,TEXT_SIZE,Color());
+  }
+
+  void updateText() {
+    //The title keeps its vertices; the counters are laid out again only when they change.
+    Color gray{180,180,180,255};
+    ++textFrames;
+    textBatch.setText(frameLabel,"Frame " + std::to_string(textFrames),-0.97f,0.87f,TEXT_SIZE,
+      gray
+    );
+    size_t triangles = tessellator.getIndices().size()/3;
+    textBatch.setText(shapeLabel,"Shapes: " + std::to_string(triangles) + " triangles",-0.97f,
+      0.81f,TEXT_SIZE,gray
+    );
+    textBatch.update( &JobSystem::get() );
+  }
+
+  void printTextStatistics() {
+    if(textFrames == 0) {
+      return;
+    }
+    const TextBatch::Statistics& s = textBatch.getStatistics();
+    LOG_INFO("Text: %zu glyphs, %zu laid out per frame, %zu of %zu runs from the cache\n",
+      s.glyphs,s.regeneratedGlyphs/textFrames,s.runHits,s.runHits + s.runMisses
+    );
+    LOG_INFO("Text: %zu glyphs rasterized into %zu atlas pages, %zu bytes\n",
+      glyphCache.getRasterizedGlyphCount(),glyphCache.getPageCount(),
+      glyphCache.getMemoryBytes()
+    );
+  }
+
+  void logStatistics() override {
+    printBufferStatistics();
+  }
+
+  void printBufferStatistics() {
+    for(const BufferPool * pool : {&vertexPool,&indexPool}) {
+      BufferPoolStatistics s = pool->getStatistics();
+      LOG_INFO("Buffers: %s pool, %zu pages, %zu of %zu bytes used, %zu free ranges, "
+        "fragmentation %.2f\n",pool == &vertexPool ? "vertex" : "index",s.pages,s.bytesUsed,
+        s.capacity,s.freeRanges,s.fragmentation
+      );
+    }
+    unsigned long requested = BufferBindingCache::getRequestedBinds();
+    LOG_INFO("Buffers: %lu binds issued, %lu of %lu skipped by the binding cache\n",
+      BufferBindingCache::getIssuedBinds(),requested - BufferBindingCache::getIssuedBinds(),
+      requested
+    );
+  }
+
   void fillIndexContainer() {
     indexContainer.reserve(3);
     indexContainer.add({0,1,2});
@@ -148,9 +517,12 @@ class CircleProgram: public Renderer {
 
   void processEvents() {
     while(!stopBoolean) {
-      SDL_Event event;
-      while( SDL_PollEvent(&event) ) {
-        processEvent(event);
+      {
+        PROFILE_SCOPE("CircleProgram::processEvents");
+        SDL_Event event;
+        while( SDL_PollEvent(&event) ) {
+          processEvent(event);
+        }
       }
       sleep(EVENT_SLEEP_TIME);
     }
@@ -166,6 +538,9 @@ class CircleProgram: public Renderer {
     if( getKey(event) == SDLK_ESCAPE ) {
       stopBoolean = true;
     }
+    if( getKey(event) == SDLK_p ) {
+      paused = !paused;
+    }
   }
 
   SDL_Keycode getKey(const SDL_KeyboardEvent& event) {
@@ -197,36 +572,26 @@ class CircleProgram: public Renderer {
   }
 
   void createShaderProgram() {
-    shaderProgram.getName() = "TestProgram";
-    
-    auto vertexCode = readFile("TestVertex.glsl");
-    auto fragmentCode = readFile("TestFragment.glsl");
-
-    shaderProgram.compile(vertexCode,fragmentCode);
-
-    shaderProgram.bindAttributeLocation(0,"position");
-    shaderProgram.bindAttributeLocation(1,"color");
-    shaderProgram.link();
-
-    matrixUniform = shaderProgram.getUniformLocation("theMatrix");
+    //The triangle, the shapes and the particles are variants of the same sources. All are built
+    //here, so that the first frame does not wait for the compiler.
+    shaders.getName() = "TestProgram";
+    preprocessor.setIncludeDirectory(dataLocation);
+    shaders.setPreprocessor(&preprocessor);
+    shaders.setSources( readFile("TestVertex.glsl"),readFile("TestFragment.glsl") );
+    shaders.bindAttributeLocation(0,"position");
+    shaders.bindAttributeLocation(1,"color");
+    triangleFeatures = shaders.addFeature("TRANSFORM");
+    particleFeatures = shaders.addFeature("POINT_SPRITE");
+
+    matrixUniform = shaders.get(triangleFeatures).getUniformLocation("theMatrix");
+    pointSizeUniform = shaders.get(particleFeatures).getUniformLocation("pointSize");
+    shaders.build(0);
   }
 
   void printOpenGLError() {
-    GLenum error = glGetError();
-
-    if(error == GL_NO_ERROR) {
-      std::printf("No OpenGL error has occurred.\n");
-      return;
-    }
-    
-    std::printf("OpenGL error: ");
-    
-    switch(glGetError()) {
-      case GL_INVALID_ENUM: std::printf("Invalid enum\n"); break;
-      case GL_INVALID_VALUE: std::printf("Invalid value\n"); break;
-      case GL_INVALID_OPERATION: std::printf("Invalid operation\n"); break;
-      case GL_INVALID_FRAMEBUFFER_OPERATION: std::printf("Invalid frame operation\n"); break;
-      case GL_OUT_OF_MEMORY: std::printf("Out of memory\n"); break;
+    //One check after initialization is cheap, so it is also done in release builds.
+    if(GLDebug::logErrors("CircleProgram::initializeRendering",__FILE__,__LINE__) == 0) {
+      LOG_INFO("No OpenGL error has occurred.\n");
     }
   }
   
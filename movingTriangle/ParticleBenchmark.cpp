@@ -0,0 +1,92 @@
+#include "ParticleSystem.h"
+#include "AttributeContainer.h"
+#include "JobSystem.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+//Measures a frame of the ParticleSystem without a window: emitting the particles that replace
+//the dead ones, update() and writeVertices(), on one thread and with the JobSystem. The
+//system is filled first and then runs at a steady state of about the given number of
+//particles, which die after one to two seconds. The vertices are written to an
+//AttributeContainer, but not sent to a GPU.
+//
+//  particleBenchmark [particles] [frames]
+
+namespace {
+
+using namespace ProjectName;
+using Clock = std::chrono::steady_clock;
+
+const float FRAME_TIME = 1.0f/60;
+
+class Timing {
+ public:
+  double emit{0}, update{0}, write{0};
+};
+
+double toMilliseconds(Clock::duration d) {
+  return std::chrono::duration<double,std::milli>(d).count();
+}
+
+Timing run(size_t particles, int frames, JobSystem * jobs) {
+  ParticleSystem system(particles);
+  AttributeContainer vertices;
+  vertices.addAttributeType(AttributeContainer::FLOAT,false,AttributeContainer::TWO);
+  vertices.addAttributeType(AttributeContainer::UNSIGNED_BYTE,true,AttributeContainer::FOUR);
+  vertices.reserve( system.getCapacity() );
+
+  ParticleSystem::Emitter emitter;
+  emitter.minimumLifetime = 1;
+  emitter.maximumLifetime = 2;
+  system.emit(emitter,particles);
+
+  Timing t;
+  size_t written = 0;
+  for(int f = 0; f < frames; ++f) {
+    Clock::time_point start = Clock::now();
+    system.emit( emitter,particles - system.size() );
+    Clock::time_point emitted = Clock::now();
+    system.update(FRAME_TIME,jobs);
+    Clock::time_point updated = Clock::now();
+    written = system.writeVertices(vertices,jobs);
+    Clock::time_point end = Clock::now();
+
+    t.emit += toMilliseconds(emitted - start);
+    t.update += toMilliseconds(updated - emitted);
+    t.write += toMilliseconds(end - updated);
+  }
+  if(written != system.size()) {
+    std::fprintf(stderr,"Wrote %zu vertices for %zu particles.\n",written,system.size());
+    std::exit(1);
+  }
+
+  t.emit /= frames;
+  t.update /= frames;
+  t.write /= frames;
+  return t;
+}
+
+void print(const char * name, const Timing& t) {
+  std::printf("%-12s %8.2f %8.2f %8.2f %8.2f\n",name,t.emit,t.update,t.write,
+    t.emit + t.update + t.write
+  );
+}
+
+}
+
+int main(int n, char ** arguments) {
+  size_t particles = n > 1 ? (size_t) std::atol(arguments[1]) : 1000000;
+  int frames = n > 2 ? std::atoi(arguments[2]) : 120;
+  JobSystem jobs;
+
+  std::printf("%zu particles, milliseconds per frame; a frame at 60 Hz has 16.67 ms.\n",particles);
+  std::printf("%-12s %8s %8s %8s %8s\n","","emit","update","write","total");
+  print( "1 thread",run(particles,frames,nullptr) );
+  Timing parallel = run(particles,frames,&jobs);
+  char name[32];
+  std::snprintf(name,sizeof(name),"%u threads",jobs.getThreadCount() + 1);
+  print(name,parallel);
+  return 0;
+}
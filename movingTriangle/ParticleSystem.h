@@ -0,0 +1,214 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+
+#include "Float4.h"
+#include "JobSystem.h"
+#include "AttributeContainer.h"
+#include "BoundingBox2D.h"
+
+namespace ProjectName {
+
+class ParticleSystem {
+  //Particles with a position, a velocity, an age, a lifetime and a color, each in an array of its
+  //own. The arrays are divided in blocks of BLOCK_PARTICLES particles; the live particles of a
+  //block are at its start. update() moves the particles four at a time with Float4, and packs
+  //the survivors of every block in the same pass without branches: every particle is copied,
+  //and the position only advances when it is still alive. Blocks are independent, so they are
+  //updated in parallel on a JobSystem, and no particle ever moves to another block.
+  //writeVertices() writes the live particles directly into an AttributeContainer for one draw
+  //with GL_POINTS. The container needs a FLOAT TWO position and an UNSIGNED_BYTE FOUR
+  //normalized color, in that order, and room for capacity vertices. The color of a particle
+  //fades out over its lifetime.
+ public:
+  static constexpr size_t BLOCK_PARTICLES = 16384;
+
+  class Emitter {
+   public:
+    float x{0}, y{0};
+    float direction{0}; //Radians.
+    float spread{6.2831853f}; //The directions are within direction +- spread/2.
+    float minimumSpeed{0.1f}, maximumSpeed{0.5f};
+    float minimumLifetime{1}, maximumLifetime{2}; //Seconds.
+    uint8_t color[4]{255,255,255,255};
+  };
+
+  explicit ParticleSystem(size_t capacity) {
+    blocks = (capacity + BLOCK_PARTICLES - 1)/BLOCK_PARTICLES;
+    size_t n = blocks*BLOCK_PARTICLES;
+    for(std::vector<float> * a : {&x,&y,&velocityX,&velocityY,&age,&lifetime}) {
+      a->resize(n);
+    }
+    color.resize(n);
+    blockCounts.resize(blocks);
+    vertexOffsets.resize(blocks);
+  }
+
+  size_t getCapacity() const {
+    return blocks*BLOCK_PARTICLES;
+  }
+
+  size_t size() const {
+    return particleCount;
+  }
+
+  void setGravity(float gx, float gy) {
+    gravityX = gx;
+    gravityY = gy;
+  }
+
+  size_t emit(const Emitter& e, size_t count) {
+    //Returns the number of new particles, which is less than count when the system is full.
+    size_t emitted = 0;
+    for(size_t visited = 0; visited < blocks && emitted < count; ++visited) {
+      size_t b = emitBlock;
+      size_t begin = b*BLOCK_PARTICLES;
+      while(blockCounts[b] < BLOCK_PARTICLES && emitted < count) {
+        size_t i = begin + blockCounts[b]++;
+        float angle = e.direction + e.spread*(random() - 0.5f);
+        float speed = e.minimumSpeed + (e.maximumSpeed - e.minimumSpeed)*random();
+        x[i] = e.x;
+        y[i] = e.y;
+        velocityX[i] = speed*std::cos(angle);
+        velocityY[i] = speed*std::sin(angle);
+        age[i] = 0;
+        lifetime[i] = e.minimumLifetime + (e.maximumLifetime - e.minimumLifetime)*random();
+        std::memcpy(&color[i],e.color,4);
+        ++emitted;
+      }
+      if(blockCounts[b] == BLOCK_PARTICLES) {
+        emitBlock = (emitBlock + 1) % blocks;
+      }
+    }
+    particleCount += emitted;
+    return emitted;
+  }
+
+  void update(float seconds, JobSystem * jobs = nullptr) {
+    forEachBlock(jobs,[this,seconds](size_t b) {
+      updateBlock(b,seconds);
+    });
+    particleCount = 0;
+    for(size_t b = 0; b < blocks; ++b) {
+      particleCount += blockCounts[b];
+    }
+  }
+
+  BoundingBox2D getBounds() const {
+    //Of the positions of the live particles; empty when there are none.
+    BoundingBox2D box;
+    for(size_t b = 0; b < blocks; ++b) {
+      size_t begin = b*BLOCK_PARTICLES;
+      for(size_t i = begin; i < begin + blockCounts[b]; ++i) {
+        box.add(x[i],y[i]);
+      }
+    }
+    return box;
+  }
+
+  size_t writeVertices(AttributeContainer& container, JobSystem * jobs = nullptr) {
+    //Returns the number of vertices, which can be passed to AttributeContainer::stream.
+    if( container.getVertexSize() != VERTEX_SIZE || container.getAttributeOffset(1) != 8 ) {
+      throw std::runtime_error("ParticleSystem needs vertices of two floats and four bytes.");
+    }
+    size_t n = 0;
+    for(size_t b = 0; b < blocks; ++b) {
+      vertexOffsets[b] = n;
+      n += blockCounts[b];
+    }
+    char * vertices = container.getVertexData();
+    forEachBlock(jobs,[this,vertices](size_t b) {
+      writeBlock( b,vertices + vertexOffsets[b]*VERTEX_SIZE );
+    });
+    return n;
+  }
+
+ private:
+  static constexpr size_t VERTEX_SIZE = 12;
+  static constexpr size_t PARALLEL_BLOCKS = 2; //With fewer blocks, the threads are not worth it.
+
+  size_t blocks{0};
+  std::vector<float> x, y, velocityX, velocityY, age, lifetime;
+  std::vector<uint32_t> color; //The RGBA bytes of the vertex.
+  std::vector<size_t> blockCounts, vertexOffsets;
+  size_t particleCount{0};
+  size_t emitBlock{0};
+  float gravityX{0}, gravityY{-0.5f};
+  uint32_t randomState{0x9E3779B9u};
+
+  float random() {
+    //xorshift32, in [0,1).
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return (randomState >> 8)*(1.0f/16777216);
+  }
+
+  template<class F>
+  void forEachBlock(JobSystem * jobs, const F& function) {
+    if(jobs == nullptr || blocks < PARALLEL_BLOCKS) {
+      for(size_t b = 0; b < blocks; ++b) {
+        function(b);
+      }
+      return;
+    }
+    jobs->parallelFor(0,blocks,1,[&function](size_t begin, size_t end) {
+      for(size_t b = begin; b < end; ++b) {
+        function(b);
+      }
+    });
+  }
+
+  void updateBlock(size_t b, float seconds) {
+    //One pass over the block, because the arrays are larger than the caches and the time goes to
+    //memory traffic: four particles are moved in registers, and then copied back to the packed
+    //position. The blocks start at multiples of four, so the last group may read particles that
+    //are dead already, but never beyond the block.
+    const Float4 dt = Float4::broadcast(seconds);
+    const Float4 dvx = Float4::broadcast(gravityX*seconds);
+    const Float4 dvy = Float4::broadcast(gravityY*seconds);
+    size_t begin = b*BLOCK_PARTICLES, end = begin + blockCounts[b], n = begin;
+    for(size_t i = begin; i < end; i += 4) {
+      float nx[4], ny[4], nvx[4], nvy[4], nage[4];
+      Float4 vx = Float4::load(&velocityX[i]) + dvx;
+      Float4 vy = Float4::load(&velocityY[i]) + dvy;
+      vx.store(nvx);
+      vy.store(nvy);
+      (Float4::load(&x[i]) + vx*dt).store(nx);
+      (Float4::load(&y[i]) + vy*dt).store(ny);
+      (Float4::load(&age[i]) + dt).store(nage);
+
+      size_t count = end - i < 4 ? end - i : 4;
+      for(size_t k = 0; k < count; ++k) {
+        x[n] = nx[k];
+        y[n] = ny[k];
+        velocityX[n] = nvx[k];
+        velocityY[n] = nvy[k];
+        age[n] = nage[k];
+        lifetime[n] = lifetime[i + k];
+        color[n] = color[i + k];
+        n += nage[k] < lifetime[i + k];
+      }
+    }
+    blockCounts[b] = n - begin;
+  }
+
+  void writeBlock(size_t b, char * vertices) {
+    size_t begin = b*BLOCK_PARTICLES, end = begin + blockCounts[b];
+    for(size_t i = begin; i < end; ++i, vertices += VERTEX_SIZE) {
+      uint8_t rgba[4];
+      std::memcpy(rgba,&color[i],4);
+      rgba[3] = (uint8_t) ( rgba[3]*(1 - age[i]/lifetime[i]) );
+      std::memcpy(vertices,&x[i],4);
+      std::memcpy(vertices + 4,&y[i],4);
+      std::memcpy(vertices + 8,rgba,4);
+    }
+  }
+};
+
+}
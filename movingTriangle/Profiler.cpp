@@ -0,0 +1,150 @@
+#include "Profiler.h"
+#include "Logger.h"
+
+#include <mutex>
+#include <vector>
+#include <cstdio>
+
+namespace ProjectName {
+
+class Profiler::I {
+ public:
+  ~I() {
+    for(auto& t : threads) {
+      for(Block * b : t.buffer->blocks) {
+        delete b;
+      }
+    }
+  }
+
+  ThreadBuffer * registerThread() {
+    std::lock_guard<std::mutex> lock(mutex);
+    threads.emplace_back();
+    ThreadEntry& t = threads.back();
+    t.buffer = std::unique_ptr<ThreadBuffer>( new ThreadBuffer() );
+    t.buffer->threadNumber = (unsigned int) threads.size();
+    t.name = "thread " + std::to_string(t.buffer->threadNumber);
+    return t.buffer.get();
+  }
+
+  void setThreadName(ThreadBuffer * buffer, const char * name) {
+    std::lock_guard<std::mutex> lock(mutex);
+    threads[buffer->threadNumber - 1].name = name;
+  }
+
+  bool writeChromeTrace(const std::string& path) {
+    std::FILE * file = std::fopen(path.c_str(),"w");
+    if(file == nullptr) {
+      LOG_ERROR("Could not open %s for the Chrome trace.\n",path);
+      return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::fprintf(file,"{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    size_t events = 0;
+    for(const ThreadEntry& t : threads) {
+      writeSeparator(file,first);
+      std::fprintf(file,"{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,"
+        "\"args\":{\"name\":\"",t.buffer->threadNumber
+      );
+      writeEscaped(file,t.name.c_str());
+      std::fprintf(file,"\"}}");
+
+      size_t count = t.buffer->count.load(std::memory_order_acquire);
+      for(size_t i = 0; i < count; ++i) {
+        const Event& e = t.buffer->blocks[i/BLOCK_EVENTS]->events[i % BLOCK_EVENTS];
+        writeSeparator(file,first);
+        std::fprintf(file,"{\"name\":\"");
+        writeEscaped(file,e.name);
+        std::fprintf(file,"\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+          t.buffer->threadNumber,e.begin/1000.0,e.duration/1000.0
+        );
+      }
+      events += count;
+    }
+    std::fprintf(file,"\n]}\n");
+    bool success = std::ferror(file) == 0;
+    std::fclose(file);
+
+    if(success) {
+      LOG_INFO("Wrote %zu profile events to %s.\n",events,path);
+    }
+    else {
+      LOG_ERROR("Could not write the Chrome trace %s.\n",path);
+    }
+    return success;
+  }
+
+  unsigned long getDroppedEventCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    unsigned long result = 0;
+    for(const ThreadEntry& t : threads) {
+      result += t.buffer->dropped.load(std::memory_order_relaxed);
+    }
+    return result;
+  }
+
+ private:
+  class ThreadEntry {
+   public:
+    std::unique_ptr<ThreadBuffer> buffer; //Outlives the thread, so its events can be written.
+    std::string name;
+  };
+
+  std::mutex mutex;
+  std::vector<ThreadEntry> threads;
+
+  static void writeSeparator(std::FILE * file, bool& first) {
+    if(!first) {
+      std::fprintf(file,",\n");
+    }
+    first = false;
+  }
+
+  static void writeEscaped(std::FILE * file, const char * text) {
+    for(const char * c = text; *c != '\0'; ++c) {
+      if(*c == '"' || *c == '\\') {
+        std::fputc('\\',file);
+      }
+      std::fputc(*c,file);
+    }
+  }
+};
+
+constexpr size_t Profiler::BLOCK_EVENTS;
+constexpr size_t Profiler::MAX_BLOCKS;
+
+Profiler& Profiler::get() {
+  static Profiler profiler;
+  return profiler;
+}
+
+Profiler::Profiler() : epoch( now() ) {
+  imp = std::unique_ptr<I>( new I() );
+}
+
+Profiler::~Profiler() = default;
+
+void Profiler::setThreadName(const char * name) {
+  imp->setThreadName(getThreadBuffer(),name);
+}
+
+bool Profiler::writeChromeTrace(const std::string& path) {
+  return imp->writeChromeTrace(path);
+}
+
+unsigned long Profiler::getDroppedEventCount() {
+  return imp->getDroppedEventCount();
+}
+
+Profiler::ThreadBuffer * Profiler::registerThread() {
+  return imp->registerThread();
+}
+
+void Profiler::addBlock(ThreadBuffer& buffer, size_t block) {
+  //Only the owning thread adds blocks; the release store of the count publishes the pointer.
+  buffer.blocks[block] = new Block();
+}
+
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+//PROFILE_SCOPE("name") records the time from that line to the end of the enclosing block on the
+//calling thread. The events can be written as Chrome trace JSON, which chrome://tracing and
+//https://ui.perfetto.dev show as one timeline per thread. All macros compile to nothing unless
+//PROJECTNAME_PROFILE is defined; meson does that with -Dprofiling=true. The names must be string
+//literals.
+#ifdef PROJECTNAME_PROFILE
+  #define PROJECTNAME_PROFILE_CONCATENATE_(a, b) a##b
+  #define PROJECTNAME_PROFILE_CONCATENATE(a, b) PROJECTNAME_PROFILE_CONCATENATE_(a,b)
+  #define PROFILE_SCOPE(name) \
+    ProjectName::ProfileScope PROJECTNAME_PROFILE_CONCATENATE(profileScope,__LINE__)(name)
+  #define PROFILE_THREAD_NAME(name) ProjectName::Profiler::get().setThreadName(name)
+  #define PROFILE_WRITE_CHROME_TRACE(path) ProjectName::Profiler::get().writeChromeTrace(path)
+#else
+  #define PROFILE_SCOPE(name)
+  #define PROFILE_THREAD_NAME(name)
+  #define PROFILE_WRITE_CHROME_TRACE(path)
+#endif
+
+namespace ProjectName {
+
+class Profiler {
+  //Every thread writes its events into its own buffer, without locks: a begin time, a duration
+  //and the name pointer. A buffer grows in blocks of BLOCK_EVENTS events that are never moved,
+  //so writeChromeTrace can read the events that a thread has published while it keeps adding
+  //new ones. When a thread has filled MAX_BLOCKS blocks, its further events are counted as
+  //dropped.
+ public:
+  static constexpr size_t BLOCK_EVENTS = 4096;
+  static constexpr size_t MAX_BLOCKS = 256;
+
+  class Event {
+   public:
+    const char * name;
+    uint64_t begin; //Nanoseconds since the Profiler was created.
+    uint64_t duration;
+  };
+
+  class Block {
+   public:
+    Event events[BLOCK_EVENTS];
+  };
+
+  class ThreadBuffer {
+   public:
+    std::atomic<size_t> count{0};
+    std::atomic<unsigned long> dropped{0};
+    Block * blocks[MAX_BLOCKS]{};
+    unsigned int threadNumber{0};
+  };
+
+  static Profiler& get();
+
+  ~Profiler();
+
+  static uint64_t now() {
+    return (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+  }
+
+  void record(const char * name, uint64_t begin, uint64_t end) {
+    ThreadBuffer * buffer = getThreadBuffer();
+    size_t n = buffer->count.load(std::memory_order_relaxed);
+    size_t block = n/BLOCK_EVENTS;
+    if(block >= MAX_BLOCKS) {
+      buffer->dropped.fetch_add(1,std::memory_order_relaxed);
+      return;
+    }
+    if(buffer->blocks[block] == nullptr) {
+      addBlock(*buffer,block);
+    }
+    Event& e = buffer->blocks[block]->events[n % BLOCK_EVENTS];
+    e.name = name;
+    e.begin = begin - epoch;
+    e.duration = end - begin;
+    buffer->count.store(n + 1,std::memory_order_release);
+  }
+
+  void setThreadName(const char * name);
+
+  bool writeChromeTrace(const std::string& path);
+  //Writes the events that all threads have recorded so far.
+
+  unsigned long getDroppedEventCount();
+
+ private:
+  class I;
+  std::unique_ptr<I> imp;
+  uint64_t epoch;
+
+  Profiler();
+
+  static ThreadBuffer *& getThreadBufferPointer() {
+    static thread_local ThreadBuffer * buffer{nullptr};
+    return buffer;
+  }
+
+  ThreadBuffer * getThreadBuffer() {
+    ThreadBuffer *& buffer = getThreadBufferPointer();
+    if(buffer == nullptr) {
+      buffer = registerThread();
+    }
+    return buffer;
+  }
+
+  ThreadBuffer * registerThread();
+  void addBlock(ThreadBuffer& buffer, size_t block);
+};
+
+class ProfileScope {
+ public:
+  explicit ProfileScope(const char * name) : name(name), begin( Profiler::now() ) {
+
+  }
+
+  ~ProfileScope() {
+    Profiler::get().record( name,begin,Profiler::now() );
+  }
+
+  ProfileScope(const ProfileScope&) = delete;
+  ProfileScope& operator=(const ProfileScope&) = delete;
+
+ private:
+  const char * name;
+  uint64_t begin;
+};
+
+}
@@ -0,0 +1,231 @@
+#pragma once
+
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <stdexcept>
+
+namespace ProjectName {
+
+class RangeAllocator {
+  //Manages offsets inside one block of memory of a fixed size, for instance a large buffer
+  //object on the GPU. It never touches the memory itself, so it can be used without an OpenGL
+  //context. Free ranges are kept sorted by offset (to merge neighbours) and by size (for a
+  //best fit search). Allocations are referred to by handles, because defragment() can move them.
+ public:
+  using Handle = unsigned int;
+  static constexpr Handle INVALID_HANDLE = ~0u;
+
+  class Move {
+   public:
+    Handle handle;
+    size_t from, to, size;
+  };
+
+  explicit RangeAllocator(size_t capacity) : capacity(capacity) {
+    insertFreeRange(0,capacity);
+  }
+
+  Handle allocate(size_t size, size_t alignment = 4) {
+    //Returns INVALID_HANDLE if there is no free range that is large enough.
+    if(size == 0) {
+      throw std::runtime_error("RangeAllocator: allocations should not be empty");
+    }
+
+    for(auto it = freeBySize.lower_bound(size); it != freeBySize.end(); ++it) {
+      size_t blockOffset = it->second, blockSize = it->first;
+      size_t offset = alignUp(blockOffset,alignment);
+      if(offset + size > blockOffset + blockSize) {
+        continue; //The alignment padding does not fit; try a slightly larger range.
+      }
+
+      eraseFreeRange(blockOffset);
+      if(offset > blockOffset) {
+        insertFreeRange(blockOffset,offset - blockOffset);
+      }
+      if(offset + size < blockOffset + blockSize) {
+        insertFreeRange(offset + size,blockOffset + blockSize - offset - size);
+      }
+      bytesUsed += size;
+      return createHandle(offset,size,alignment);
+    }
+    return INVALID_HANDLE;
+  }
+
+  void free(Handle h) {
+    Allocation& a = getAllocation(h);
+    bytesUsed -= a.size;
+    insertAndMerge(a.offset,a.size);
+
+    a.used = false;
+    freeHandles.push_back(h);
+  }
+
+  size_t getOffset(Handle h) const {
+    return getAllocation(h).offset;
+  }
+
+  size_t getSize(Handle h) const {
+    return getAllocation(h).size;
+  }
+
+  size_t getCapacity() const {
+    return capacity;
+  }
+
+  size_t getBytesUsed() const {
+    return bytesUsed;
+  }
+
+  size_t getLargestFreeRange() const {
+    if( freeBySize.empty() ) {
+      return 0;
+    }
+    return freeBySize.rbegin()->first;
+  }
+
+  size_t getFreeRangeCount() const {
+    return freeByOffset.size();
+  }
+
+  double getFragmentation() const {
+    //0 when all free space is one contiguous range, approaching 1 when it is split into many
+    //small ranges.
+    size_t freeBytes = capacity - bytesUsed;
+    if(freeBytes == 0) {
+      return 0.0;
+    }
+    return 1.0 - (double) getLargestFreeRange()/(double) freeBytes;
+  }
+
+  std::vector<Move> defragment() {
+    //Moves all allocations towards offset 0 while keeping their order. The caller has to copy
+    //the contents of every returned move, in the returned order; a move never overwrites data
+    //of an allocation that still has to be moved.
+    std::vector<Handle> order;
+    for(Handle h = 0; h < allocations.size(); ++h) {
+      if(allocations[h].used) {
+        order.push_back(h);
+      }
+    }
+    std::sort(order.begin(),order.end(),[this](Handle a, Handle b) {
+      return allocations[a].offset < allocations[b].offset;
+    });
+
+    std::vector<Move> moves;
+    size_t next = 0;
+    for(Handle h : order) {
+      Allocation& a = allocations[h];
+      size_t target = alignUp(next,a.alignment);
+      if(target < a.offset) {
+        moves.push_back( Move{h,a.offset,target,a.size} );
+        a.offset = target;
+      }
+      next = a.offset + a.size;
+    }
+
+    freeByOffset.clear();
+    freeBySize.clear();
+    rebuildFreeRanges(order);
+    return moves;
+  }
+
+ private:
+  class Allocation {
+   public:
+    size_t offset{0}, size{0}, alignment{1};
+    bool used{false};
+  };
+
+  size_t capacity, bytesUsed{0};
+
+  std::map<size_t,size_t> freeByOffset;
+  std::multimap<size_t,size_t> freeBySize;
+
+  std::vector<Allocation> allocations;
+  std::vector<Handle> freeHandles;
+
+  static size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1)/alignment*alignment;
+  }
+
+  Allocation& getAllocation(Handle h) {
+    if(h >= allocations.size() || !allocations[h].used) {
+      throw std::runtime_error("RangeAllocator: invalid handle");
+    }
+    return allocations[h];
+  }
+
+  const Allocation& getAllocation(Handle h) const {
+    return const_cast<RangeAllocator*>(this)->getAllocation(h);
+  }
+
+  Handle createHandle(size_t offset, size_t size, size_t alignment) {
+    Handle h;
+    if( freeHandles.empty() ) {
+      h = (Handle) allocations.size();
+      allocations.emplace_back();
+    }
+    else {
+      h = freeHandles.back();
+      freeHandles.pop_back();
+    }
+    allocations[h].offset = offset;
+    allocations[h].size = size;
+    allocations[h].alignment = alignment;
+    allocations[h].used = true;
+    return h;
+  }
+
+  void insertFreeRange(size_t offset, size_t size) {
+    freeByOffset.emplace(offset,size);
+    freeBySize.emplace(size,offset);
+  }
+
+  void eraseFreeRange(size_t offset) {
+    auto it = freeByOffset.find(offset);
+    auto range = freeBySize.equal_range(it->second);
+    for(auto s = range.first; s != range.second; ++s) {
+      if(s->second == offset) {
+        freeBySize.erase(s);
+        break;
+      }
+    }
+    freeByOffset.erase(it);
+  }
+
+  void insertAndMerge(size_t offset, size_t size) {
+    auto next = freeByOffset.lower_bound(offset);
+    if(next != freeByOffset.end() && offset + size == next->first) {
+      size += next->second;
+      eraseFreeRange(next->first);
+    }
+
+    auto previous = freeByOffset.lower_bound(offset);
+    if( previous != freeByOffset.begin() ) {
+      --previous;
+      if(previous->first + previous->second == offset) {
+        offset = previous->first;
+        size += previous->second;
+        eraseFreeRange(offset);
+      }
+    }
+    insertFreeRange(offset,size);
+  }
+
+  void rebuildFreeRanges(const std::vector<Handle>& sortedHandles) {
+    size_t position = 0;
+    for(Handle h : sortedHandles) {
+      const Allocation& a = allocations[h];
+      if(a.offset > position) {
+        insertFreeRange(position,a.offset - position);
+      }
+      position = a.offset + a.size;
+    }
+    if(position < capacity) {
+      insertFreeRange(position,capacity - position);
+    }
+  }
+};
+
+}
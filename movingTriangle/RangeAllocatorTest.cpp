@@ -0,0 +1,178 @@
+#include "RangeAllocator.h"
+
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdio>
+#include <stdexcept>
+
+//Tests of RangeAllocator, the CPU side of BufferPool, without an OpenGL context. Every failed
+//check is printed; the exit status is the number of failures, so meson test reports them.
+
+namespace {
+
+using namespace ProjectName;
+using Handle = RangeAllocator::Handle;
+
+int failures = 0;
+
+void check(bool condition, const char * what, int line) {
+  if(!condition) {
+    std::printf("FAILED at line %d: %s\n",line,what);
+    ++failures;
+  }
+}
+
+#define CHECK(condition) check( (condition),#condition,__LINE__ )
+
+template<class Function>
+bool throwsRuntimeError(Function f) {
+  try {
+    f();
+  }
+  catch(const std::runtime_error&) {
+    return true;
+  }
+  return false;
+}
+
+void testAllocate() {
+  RangeAllocator a(1024);
+  Handle h0 = a.allocate(100);
+  Handle h1 = a.allocate(50,16);
+  CHECK(h0 != RangeAllocator::INVALID_HANDLE);
+  CHECK(h1 != RangeAllocator::INVALID_HANDLE);
+  CHECK(a.getOffset(h0) == 0);
+  CHECK(a.getSize(h0) == 100);
+  CHECK(a.getOffset(h1) == 112); //100 aligned up to 16.
+  CHECK(a.getBytesUsed() == 150);
+  //The padding before h1 is a free range of its own.
+  CHECK(a.getFreeRangeCount() == 2);
+
+  CHECK(a.allocate(2000) == RangeAllocator::INVALID_HANDLE);
+  CHECK( throwsRuntimeError([&]() { a.allocate(0); }) );
+
+  //Best fit: the 12 bytes of padding are used before the large range at the end.
+  Handle h2 = a.allocate(12);
+  CHECK(a.getOffset(h2) == 100);
+  CHECK(a.getFreeRangeCount() == 1);
+
+  RangeAllocator full(64);
+  Handle all = full.allocate(64);
+  CHECK(full.getOffset(all) == 0);
+  CHECK(full.allocate(4) == RangeAllocator::INVALID_HANDLE);
+  CHECK(full.getLargestFreeRange() == 0);
+  CHECK(full.getFragmentation() == 0.0);
+}
+
+void testFree() {
+  RangeAllocator a(256);
+  Handle h0 = a.allocate(64);
+  Handle h1 = a.allocate(64);
+  a.free(h0);
+  CHECK(a.getBytesUsed() == 64);
+  CHECK( throwsRuntimeError([&]() { a.free(h0); }) );
+  CHECK( throwsRuntimeError([&]() { a.getOffset(h0); }) );
+  CHECK( throwsRuntimeError([&]() { a.getOffset(12345); }) );
+
+  //The freed handle and range are used again.
+  Handle h2 = a.allocate(64);
+  CHECK(h2 == h0);
+  CHECK(a.getOffset(h2) == 0);
+  CHECK(a.getOffset(h1) == 64);
+}
+
+void testCoalescing() {
+  RangeAllocator a(400);
+  Handle h[4];
+  for(Handle& x : h) {
+    x = a.allocate(100);
+  }
+  CHECK(a.getFreeRangeCount() == 0);
+
+  a.free(h[1]);
+  a.free(h[3]);
+  CHECK(a.getFreeRangeCount() == 2);
+  a.free(h[2]); //Merges with the ranges before and after it.
+  CHECK(a.getFreeRangeCount() == 1);
+  CHECK(a.getLargestFreeRange() == 300);
+  a.free(h[0]);
+  CHECK(a.getFreeRangeCount() == 1);
+  CHECK(a.getLargestFreeRange() == 400);
+  CHECK(a.getBytesUsed() == 0);
+  CHECK(a.allocate(400) != RangeAllocator::INVALID_HANDLE);
+}
+
+void testFragmentation() {
+  RangeAllocator a(1000);
+  std::vector<Handle> h;
+  for(int i = 0; i < 10; ++i) {
+    h.push_back( a.allocate(100) );
+  }
+  CHECK(a.getFragmentation() == 0.0);
+  for(int i = 0; i < 10; i += 2) {
+    a.free(h[i]);
+  }
+  //500 free bytes in five ranges of 100.
+  CHECK(a.getFreeRangeCount() == 5);
+  CHECK(a.getLargestFreeRange() == 100);
+  CHECK(a.getFragmentation() > 0.79 && a.getFragmentation() < 0.81);
+  CHECK(a.allocate(200) == RangeAllocator::INVALID_HANDLE);
+}
+
+void testDefragmentation() {
+  //Every allocation is filled with its own byte in a simulated buffer, which follows the moves.
+  const size_t CAPACITY = 1024;
+  RangeAllocator a(CAPACITY);
+  std::vector<char> memory(CAPACITY,0);
+  std::vector<Handle> h;
+  const size_t sizes[] = {40,24,100,8,60,16,200,32};
+  for(size_t i = 0; i < sizeof(sizes)/sizeof(sizes[0]); ++i) {
+    h.push_back( a.allocate(sizes[i],i % 2 == 0 ? 4 : 16) );
+    std::memset(&memory[ a.getOffset(h.back()) ],'a' + (int) i,sizes[i]);
+  }
+  for(size_t i : {0,3,5}) {
+    a.free(h[i]);
+  }
+  CHECK(a.getFragmentation() > 0.0);
+  size_t used = a.getBytesUsed();
+
+  std::vector<RangeAllocator::Move> moves = a.defragment();
+  CHECK( !moves.empty() );
+  for(const RangeAllocator::Move& m : moves) {
+    CHECK(m.to < m.from);
+    std::memmove(&memory[m.to],&memory[m.from],m.size);
+  }
+
+  size_t end = 0;
+  for(size_t i : {1,2,4,6,7}) {
+    size_t offset = a.getOffset(h[i]);
+    CHECK(offset >= end); //The order is kept and nothing overlaps.
+    CHECK(offset % (i % 2 == 0 ? 4 : 16) == 0);
+    CHECK(offset - end < 16); //Only alignment padding between allocations.
+    std::string expected(sizes[i],(char) ('a' + (int) i));
+    CHECK(std::string(&memory[offset],sizes[i]) == expected);
+    end = offset + sizes[i];
+  }
+  CHECK(a.getBytesUsed() == used);
+  CHECK(a.getFreeRangeCount() <= 3); //The padding, and the rest of the block.
+  CHECK(a.getLargestFreeRange() == CAPACITY - end);
+
+  //A compacted allocator does not move anything again.
+  CHECK( a.defragment().empty() );
+  CHECK(a.allocate(CAPACITY - end) != RangeAllocator::INVALID_HANDLE);
+}
+
+}
+
+int main() {
+  testAllocate();
+  testFree();
+  testCoalescing();
+  testFragmentation();
+  testDefragmentation();
+  if(failures == 0) {
+    std::printf("All RangeAllocator tests passed.\n");
+  }
+  return failures;
+}
@@ -0,0 +1,525 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <functional>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+#include <cstddef>
+
+#include "RenderPass.h"
+
+namespace ProjectName {
+
+enum class TargetFormat : unsigned char {
+  RGBA8,  //A texture of GL_RGBA and GL_UNSIGNED_BYTE.
+  RGB565, //A texture of GL_RGB and GL_UNSIGNED_SHORT_5_6_5, half the memory.
+  DEPTH16 //A renderbuffer of GL_DEPTH_COMPONENT16, which passes can not read.
+};
+
+class TargetDescription {
+ public:
+  int width{0}, height{0};
+  TargetFormat format{TargetFormat::RGBA8};
+
+  bool isDepth() const {
+    return format == TargetFormat::DEPTH16;
+  }
+
+  size_t getBytes() const {
+    return (size_t) width*height*(format == TargetFormat::RGBA8 ? 4 : 2);
+  }
+
+  bool operator==(const TargetDescription& d) const {
+    return width == d.width && height == d.height && format == d.format;
+  }
+};
+
+class RenderGraph {
+  //The passes of a frame and the render targets they read and write, declared anew every frame.
+  //compile() culls the passes whose results reach no imported target, orders the others, and
+  //assigns the transient targets to physical targets: two transient targets with the same
+  //description share one when the last pass that uses the first runs before the first pass that
+  //uses the second. OpenGL ES 2.0 can not place two textures in the same memory, so aliasing
+  //means sharing the texture. compile() also chooses the load and store actions of every pass:
+  //the first write of a transient target does not load it, and a target that no later pass
+  //uses is discarded.
+  //Order: the passes that write a target run in the order they were added, and a pass that only
+  //reads a target runs after all passes that write it. A cycle throws std::runtime_error.
+  //Imported targets, such as the framebuffer of the window, belong to the caller and are never
+  //aliased or culled. A pass writes at most one color and one depth target, the attachments of
+  //an OpenGL ES 2.0 framebuffer, and the depth target can not go with an imported color target.
+ public:
+  using Resource = uint32_t;
+  using Pass = uint32_t;
+  static constexpr uint32_t NONE = 0xFFFFFFFF;
+
+  class Context {
+    //Given to a pass when it runs, with its framebuffer bound and the viewport set to it.
+   public:
+    Context(const RenderGraph& graph, Pass pass, const std::vector<unsigned int>& textures) :
+      graph(graph), pass(pass), textures(textures) {}
+
+    unsigned int getTexture(Resource r) const { //Of a target that the pass reads.
+      if( !graph.reads(pass,r) ) {
+        throw std::runtime_error("RenderGraph: a pass asked for a target it does not read.");
+      }
+      return textures[ graph.getPhysicalTarget(r) ];
+    }
+
+    const TargetDescription& getTarget() const { //What the pass draws into.
+      const PassData& p = graph.passes[pass];
+      return graph.getDescription(p.color != NONE ? p.color : p.depth);
+    }
+
+   private:
+    const RenderGraph& graph;
+    Pass pass;
+    const std::vector<unsigned int>& textures; //Per physical target.
+  };
+
+  using Execute = std::function<void(const Context& context)>;
+
+  class Attachment {
+    //A target that a pass writes, with its actions after compile().
+   public:
+    Resource resource{NONE};
+    RenderPass::Load load{RenderPass::Load::LOAD};
+    RenderPass::Store store{RenderPass::Store::STORE};
+  };
+
+  class MemoryReport {
+    //Of the transient targets of the passes that were not culled.
+   public:
+    size_t transientTargets{0}, physicalTargets{0};
+    size_t bytesWithoutAliasing{0}; //One texture per transient target.
+    size_t bytesWithAliasing{0}; //Of the physical targets.
+    size_t culledPasses{0};
+  };
+
+  Resource createTarget(const char * name, const TargetDescription& description) {
+    return addResource(name,description,false,false);
+  }
+
+  Resource importTarget(const char * name, const TargetDescription& description,
+    bool keepContent = true)
+  {
+    //A target of the caller, the framebuffer that is bound when the graph runs. Without
+    //keepContent, the first pass that writes it does not load it either, for a window that is
+    //drawn over completely.
+    return addResource(name,description,true,keepContent);
+  }
+
+  Pass addPass(const char * name, Execute execute) {
+    passes.push_back( PassData() );
+    passes.back().name = name;
+    passes.back().execute = std::move(execute);
+    compiled = false;
+    return (Pass) (passes.size() - 1);
+  }
+
+  void read(Pass pass, Resource r) {
+    //As a texture, so imported and depth targets can not be read.
+    if( getResource(r).imported || getResource(r).description.isDepth() ) {
+      throw std::runtime_error("RenderGraph: imported and depth targets can not be read.");
+    }
+    getPass(pass).reads.push_back(r);
+    compiled = false;
+  }
+
+  void write(Pass pass, Resource r, bool clear = false) {
+    //Without clear, the pass draws over what earlier passes have written, or over every pixel
+    //if it is the first.
+    PassData& p = getPass(pass);
+    const ResourceData& d = getResource(r);
+    Resource& slot = d.description.isDepth() ? p.depth : p.color;
+    if(slot != NONE) {
+      throw std::runtime_error("RenderGraph: a pass writes more than one color or depth target.");
+    }
+    slot = r;
+    (d.description.isDepth() ? p.clearDepth : p.clearColor) = clear;
+    compiled = false;
+  }
+
+  void clear() { //Removes all passes and targets and keeps the memory.
+    passes.clear();
+    resources.clear();
+    order.clear();
+    physicalTargets.clear();
+    compiled = false;
+  }
+
+  void compile() {
+    for(const PassData& p : passes) {
+      if(p.color != NONE && p.depth != NONE && resources[p.color].imported) {
+        throw std::runtime_error("RenderGraph: pass " + p.name + " has a depth target, and a "
+          "color target that is imported."
+        );
+      }
+      if( p.color != NONE && std::find(p.reads.begin(),p.reads.end(),p.color) != p.reads.end() ) {
+        throw std::runtime_error("RenderGraph: pass " + p.name + " reads its own target.");
+      }
+    }
+    findWriters();
+    cull();
+    sort();
+    assignPhysicalTargets();
+    chooseActions();
+    compiled = true;
+  }
+
+  const std::vector<Pass>& getOrder() const { //The passes that were not culled.
+    requireCompiled();
+    return order;
+  }
+
+  bool isCulled(Pass pass) const {
+    requireCompiled();
+    return !passes.at(pass).live;
+  }
+
+  const std::string& getPassName(Pass pass) const {
+    return passes.at(pass).name;
+  }
+
+  const Execute& getExecute(Pass pass) const {
+    return passes.at(pass).execute;
+  }
+
+  const Attachment& getColor(Pass pass) const { //resource is NONE if the pass writes none.
+    requireCompiled();
+    return passes.at(pass).colorAttachment;
+  }
+
+  const Attachment& getDepth(Pass pass) const {
+    requireCompiled();
+    return passes.at(pass).depthAttachment;
+  }
+
+  const std::vector<Resource>& getReads(Pass pass) const {
+    return passes.at(pass).reads;
+  }
+
+  bool reads(Pass pass, Resource r) const {
+    const std::vector<Resource>& list = getReads(pass);
+    return std::find(list.begin(),list.end(),r) != list.end();
+  }
+
+  const std::string& getTargetName(Resource r) const {
+    return resources.at(r).name;
+  }
+
+  const TargetDescription& getDescription(Resource r) const {
+    return resources.at(r).description;
+  }
+
+  bool isImported(Resource r) const {
+    return resources.at(r).imported;
+  }
+
+  size_t getPhysicalTarget(Resource r) const {
+    //An index into getPhysicalTargets(); NONE for imported and unused targets.
+    requireCompiled();
+    return resources.at(r).physical;
+  }
+
+  const std::vector<TargetDescription>& getPhysicalTargets() const {
+    requireCompiled();
+    return physicalTargets;
+  }
+
+  MemoryReport getMemoryReport() const {
+    requireCompiled();
+    MemoryReport report;
+    for(const ResourceData& r : resources) {
+      if(!r.imported && r.physical != NONE) {
+        ++report.transientTargets;
+        report.bytesWithoutAliasing += r.description.getBytes();
+      }
+    }
+    report.physicalTargets = physicalTargets.size();
+    for(const TargetDescription& d : physicalTargets) {
+      report.bytesWithAliasing += d.getBytes();
+    }
+    report.culledPasses = passes.size() - order.size();
+    return report;
+  }
+
+ private:
+  class ResourceData {
+   public:
+    std::string name;
+    TargetDescription description;
+    bool imported{false}, keepContent{false};
+    std::vector<Pass> writers; //In the order they were added.
+    uint32_t first{NONE}, last{NONE}; //Positions in the order of the passes that use it.
+    size_t physical{NONE};
+  };
+
+  class PassData {
+   public:
+    std::string name;
+    Execute execute;
+    std::vector<Resource> reads;
+    Resource color{NONE}, depth{NONE};
+    bool clearColor{false}, clearDepth{false};
+    bool live{false};
+    uint32_t position{NONE};
+    Attachment colorAttachment, depthAttachment;
+  };
+
+  std::vector<PassData> passes;
+  std::vector<ResourceData> resources;
+  std::vector<Pass> order;
+  std::vector<TargetDescription> physicalTargets;
+  bool compiled{false};
+
+  //Scratch memory of compile().
+  std::vector<Pass> work;
+  std::vector<std::vector<Pass>> successors;
+  std::vector<uint32_t> predecessorCounts;
+  std::vector<Resource> sortedResources;
+  std::vector<uint32_t> freeAfter; //Per physical target, the position of its last use.
+
+  Resource addResource(const char * name, const TargetDescription& description, bool imported,
+    bool keepContent)
+  {
+    if(description.width <= 0 || description.height <= 0) {
+      throw std::runtime_error( std::string("RenderGraph: target ") + name + " is empty." );
+    }
+    resources.push_back( ResourceData() );
+    resources.back().name = name;
+    resources.back().description = description;
+    resources.back().imported = imported;
+    resources.back().keepContent = keepContent;
+    compiled = false;
+    return (Resource) (resources.size() - 1);
+  }
+
+  PassData& getPass(Pass pass) {
+    if(pass >= passes.size()) {
+      throw std::runtime_error("RenderGraph: the pass does not exist.");
+    }
+    return passes[pass];
+  }
+
+  const ResourceData& getResource(Resource r) const {
+    if(r >= resources.size()) {
+      throw std::runtime_error("RenderGraph: the target does not exist.");
+    }
+    return resources[r];
+  }
+
+  void requireCompiled() const {
+    if(!compiled) {
+      throw std::runtime_error("RenderGraph: the graph has changed since compile().");
+    }
+  }
+
+  void findWriters() {
+    for(ResourceData& r : resources) {
+      r.writers.clear();
+      r.first = r.last = NONE;
+      r.physical = NONE;
+    }
+    for(Pass p = 0; p < passes.size(); ++p) {
+      for(Resource r : {passes[p].color,passes[p].depth}) {
+        if(r != NONE) {
+          resources[r].writers.push_back(p);
+        }
+      }
+    }
+  }
+
+  template<class Function>
+  void forEachDependency(Pass p, Function f) const {
+    //The passes whose results p uses: all writers of what it reads, and the earlier writers of
+    //what it writes without clearing.
+    const PassData& data = passes[p];
+    for(Resource r : data.reads) {
+      for(Pass w : resources[r].writers) {
+        f(w);
+      }
+    }
+    for(int a = 0; a < 2; ++a) {
+      Resource r = a == 0 ? data.color : data.depth;
+      if(r == NONE || (a == 0 ? data.clearColor : data.clearDepth)) {
+        continue;
+      }
+      for(Pass w : resources[r].writers) {
+        if(w < p) {
+          f(w);
+        }
+      }
+    }
+  }
+
+  void cull() {
+    //The passes that write imported targets are live, and so is everything they depend on.
+    work.clear();
+    for(PassData& p : passes) {
+      p.live = false;
+    }
+    for(const ResourceData& r : resources) {
+      if(r.imported) {
+        work.insert( work.end(),r.writers.begin(),r.writers.end() );
+      }
+    }
+    while( !work.empty() ) {
+      Pass p = work.back();
+      work.pop_back();
+      if(passes[p].live) {
+        continue;
+      }
+      passes[p].live = true;
+      forEachDependency(p,[this](Pass w) {
+        if(!passes[w].live) {
+          work.push_back(w);
+        }
+      });
+    }
+  }
+
+  void sort() {
+    //Kahn's algorithm on the live passes. Of the passes that are ready, the one added first
+    //runs first, so without constraints the order is the order of addPass().
+    size_t n = passes.size();
+    successors.resize(n);
+    for(size_t p = 0; p < n; ++p) {
+      successors[p].clear();
+    }
+    predecessorCounts.assign(n,0);
+    auto addEdge = [this](Pass from, Pass to) {
+      successors[from].push_back(to);
+      ++predecessorCounts[to];
+    };
+    for(Pass p = 0; p < n; ++p) {
+      if(!passes[p].live) {
+        continue;
+      }
+      forEachDependency(p,[&](Pass w) { addEdge(w,p); });
+    }
+    for(const ResourceData& r : resources) {
+      //Writers in the order they were added, also those that clear.
+      Pass previous = NONE;
+      for(Pass w : r.writers) {
+        if(!passes[w].live) {
+          continue;
+        }
+        if(previous != NONE) {
+          addEdge(previous,w);
+        }
+        previous = w;
+      }
+    }
+
+    order.clear();
+    work.clear();
+    for(Pass p = 0; p < n; ++p) {
+      if(passes[p].live && predecessorCounts[p] == 0) {
+        work.push_back(p);
+      }
+    }
+    std::greater<Pass> later;
+    std::make_heap(work.begin(),work.end(),later);
+    while( !work.empty() ) {
+      std::pop_heap(work.begin(),work.end(),later);
+      Pass p = work.back();
+      work.pop_back();
+      passes[p].position = (uint32_t) order.size();
+      order.push_back(p);
+      for(Pass s : successors[p]) {
+        if(--predecessorCounts[s] == 0) {
+          work.push_back(s);
+          std::push_heap(work.begin(),work.end(),later);
+        }
+      }
+    }
+    size_t live = 0;
+    for(const PassData& p : passes) {
+      live += p.live ? 1 : 0;
+    }
+    if(order.size() != live) {
+      throw std::runtime_error("RenderGraph: the passes depend on each other in a cycle.");
+    }
+  }
+
+  void use(Resource r, uint32_t position) {
+    ResourceData& d = resources[r];
+    d.first = d.first == NONE ? position : std::min(d.first,position);
+    d.last = d.last == NONE ? position : std::max(d.last,position);
+  }
+
+  void assignPhysicalTargets() {
+    //Interval allocation: the transient targets by their first use, each to a free physical
+    //target with the same description if there is one.
+    for(Pass p : order) {
+      const PassData& data = passes[p];
+      for(Resource r : data.reads) {
+        use(r,data.position);
+      }
+      for(Resource r : {data.color,data.depth}) {
+        if(r != NONE) {
+          use(r,data.position);
+        }
+      }
+    }
+    sortedResources.clear();
+    for(Resource r = 0; r < resources.size(); ++r) {
+      if(!resources[r].imported && resources[r].first != NONE) {
+        sortedResources.push_back(r);
+      }
+    }
+    std::sort(sortedResources.begin(),sortedResources.end(),[this](Resource a, Resource b) {
+      return resources[a].first < resources[b].first;
+    });
+
+    physicalTargets.clear();
+    freeAfter.clear();
+    for(Resource r : sortedResources) {
+      ResourceData& d = resources[r];
+      for(size_t t = 0; t < physicalTargets.size(); ++t) {
+        if(physicalTargets[t] == d.description && freeAfter[t] < d.first) {
+          d.physical = t;
+          break;
+        }
+      }
+      if(d.physical == NONE) {
+        d.physical = physicalTargets.size();
+        physicalTargets.push_back(d.description);
+        freeAfter.push_back(0);
+      }
+      freeAfter[d.physical] = d.last;
+    }
+  }
+
+  void chooseActions() {
+    for(Pass p : order) {
+      PassData& data = passes[p];
+      data.colorAttachment = chooseActions(data,data.color,data.clearColor);
+      data.depthAttachment = chooseActions(data,data.depth,data.clearDepth);
+    }
+  }
+
+  Attachment chooseActions(const PassData& data, Resource r, bool clear) const {
+    Attachment a;
+    a.resource = r;
+    if(r == NONE) {
+      return a;
+    }
+    const ResourceData& d = resources[r];
+    if(clear) {
+      a.load = RenderPass::Load::CLEAR;
+    }
+    else if(!d.keepContent && d.first == data.position) {
+      a.load = RenderPass::Load::DONT_CARE;
+    }
+    if(!d.imported && d.last == data.position) {
+      a.store = RenderPass::Store::DISCARD;
+    }
+    return a;
+  }
+};
+
+}
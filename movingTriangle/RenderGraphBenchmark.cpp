@@ -0,0 +1,159 @@
+#include "RenderGraph.h"
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+//Compiles the RenderGraph of a post-processing chain without a window: a scene with depth, a
+//bright pass and two iterations of a separable blur at half the size, a composite, and a final
+//pass into the imported window framebuffer, plus a debug view that nothing reads. Prints the
+//order of the passes, the physical target of every transient target, the GPU memory of the
+//targets with and without aliasing, and the time of building and compiling the graph, which
+//RenderGraphRenderer does every frame.
+//
+//  renderGraphBenchmark [width] [height] [frames]
+
+namespace {
+
+using namespace ProjectName;
+using Clock = std::chrono::steady_clock;
+using Resource = RenderGraph::Resource;
+using Pass = RenderGraph::Pass;
+
+class Chain {
+ public:
+  std::vector<Resource> targets;
+};
+
+Chain build(RenderGraph& graph, int width, int height) {
+  //The passes do nothing; only their targets matter here.
+  RenderGraph::Execute nothing = [](const RenderGraph::Context&) {};
+  TargetDescription full{width,height,TargetFormat::RGBA8};
+  TargetDescription half{std::max(1,width/2),std::max(1,height/2),TargetFormat::RGB565};
+  TargetDescription depth{width,height,TargetFormat::DEPTH16};
+
+  Chain c;
+  Resource window = graph.importTarget("window",full);
+  Resource sceneColor = graph.createTarget("scene color",full);
+  Resource sceneDepth = graph.createTarget("scene depth",depth);
+  Resource bright = graph.createTarget("bright",half);
+  Resource resolved = graph.createTarget("resolved",full);
+  Resource debugView = graph.createTarget("debug view",full);
+  c.targets = {sceneColor,sceneDepth,bright};
+
+  Pass scene = graph.addPass("scene",nothing);
+  graph.write(scene,sceneColor,true);
+  graph.write(scene,sceneDepth,true);
+
+  Pass brightPass = graph.addPass("bright",nothing);
+  graph.read(brightPass,sceneColor);
+  graph.write(brightPass,bright);
+
+  Resource blurred = bright;
+  for(int i = 0; i < 2; ++i) {
+    for(const char * direction : {"horizontal","vertical"}) {
+      std::string name = std::string("blur ") + direction + " " + std::to_string(i + 1);
+      Resource next = graph.createTarget(name.c_str(),half);
+      Pass blur = graph.addPass(name.c_str(),nothing);
+      graph.read(blur,blurred);
+      graph.write(blur,next);
+      c.targets.push_back(next);
+      blurred = next;
+    }
+  }
+
+  Pass composite = graph.addPass("composite",nothing);
+  graph.read(composite,sceneColor);
+  graph.read(composite,blurred);
+  graph.write(composite,resolved);
+  c.targets.push_back(resolved);
+
+  Pass debug = graph.addPass("debug view",nothing);
+  graph.read(debug,sceneColor);
+  graph.write(debug,debugView);
+  c.targets.push_back(debugView);
+
+  Pass finalPass = graph.addPass("final",nothing);
+  graph.read(finalPass,resolved);
+  graph.write(finalPass,window);
+  return c;
+}
+
+const char * toString(RenderPass::Load load) {
+  switch(load) {
+    case RenderPass::Load::CLEAR : return "clear";
+    case RenderPass::Load::LOAD : return "load";
+    default : return "don't care";
+  }
+}
+
+const char * toString(RenderPass::Store store) {
+  return store == RenderPass::Store::STORE ? "store" : "discard";
+}
+
+double toMegabytes(size_t bytes) {
+  return bytes/(1024.0*1024.0);
+}
+
+}
+
+int main(int n, char ** arguments) {
+  int width = n > 1 ? std::atoi(arguments[1]) : 1920;
+  int height = n > 2 ? std::atoi(arguments[2]) : 1080;
+  int frames = n > 3 ? std::atoi(arguments[3]) : 10000;
+  if(width < 1 || height < 1 || frames < 1) {
+    std::fprintf(stderr,"Needs a size of at least one pixel and one frame.\n");
+    return 2;
+  }
+
+  RenderGraph graph;
+  Chain chain = build(graph,width,height);
+  graph.compile();
+
+  std::printf("Passes in order:\n");
+  for(Pass p : graph.getOrder()) {
+    const RenderGraph::Attachment& color = graph.getColor(p);
+    std::printf("  %-22s color %s/%s",graph.getPassName(p).c_str(),toString(color.load),
+      toString(color.store)
+    );
+    const RenderGraph::Attachment& depth = graph.getDepth(p);
+    if(depth.resource != RenderGraph::NONE) {
+      std::printf(", depth %s/%s",toString(depth.load),toString(depth.store));
+    }
+    std::printf("\n");
+  }
+
+  std::printf("Transient targets:\n");
+  for(Resource r : chain.targets) {
+    const TargetDescription& d = graph.getDescription(r);
+    size_t physical = graph.getPhysicalTarget(r);
+    std::printf("  %-22s %4dx%-4d ",graph.getTargetName(r).c_str(),d.width,d.height);
+    if(physical == RenderGraph::NONE) {
+      std::printf(" unused\n");
+    }
+    else {
+      std::printf(" physical target %zu\n",physical);
+    }
+  }
+
+  RenderGraph::MemoryReport report = graph.getMemoryReport();
+  std::printf("%zu culled passes; %zu transient targets on %zu physical targets.\n",
+    report.culledPasses,report.transientTargets,report.physicalTargets
+  );
+  std::printf("Peak GPU memory: %.1f MiB without aliasing, %.1f MiB with aliasing.\n",
+    toMegabytes(report.bytesWithoutAliasing),toMegabytes(report.bytesWithAliasing)
+  );
+
+  Clock::time_point start = Clock::now();
+  for(int f = 0; f < frames; ++f) {
+    graph.clear();
+    build(graph,width,height);
+    graph.compile();
+  }
+  double microseconds = std::chrono::duration<double,std::micro>(Clock::now() - start).count();
+  std::printf("Building and compiling: %.2f us per frame.\n",microseconds/frames);
+  return 0;
+}
@@ -0,0 +1,266 @@
+#include "RenderGraphRenderer.h"
+#include "GLResource.h"
+#include "GLDebug.h"
+#include "Logger.h"
+#include "Profiler.h"
+
+#include <glad/glad.h>
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <stdexcept>
+
+namespace ProjectName {
+
+class RenderGraphExecutor::I {
+ public:
+  void execute(const RenderGraph& graph) {
+    PROFILE_SCOPE("RenderGraphExecutor::execute");
+    ++execution;
+    frame = DeletionQueue::get().getFrameNumber(); //Advances once per frame, for all views.
+    RenderPass::BoundState previous = RenderPass::getBoundState();
+    assignTargets(graph);
+
+    for(RenderGraph::Pass p : graph.getOrder()) {
+      const RenderGraph::Attachment& color = graph.getColor(p);
+      const RenderGraph::Attachment& depth = graph.getDepth(p);
+      bool imported = (color.resource != RenderGraph::NONE && graph.isImported(color.resource))
+        || (depth.resource != RenderGraph::NONE && graph.isImported(depth.resource));
+      if(imported) {
+        RenderPass::bind(previous);
+      }
+      else {
+        RenderPass::BoundState target;
+        target.framebuffer = getFramebuffer(graph,color,depth);
+        target.depth = depth.resource != RenderGraph::NONE;
+        const RenderGraph::Attachment& a = color.resource != RenderGraph::NONE ? color : depth;
+        const TargetDescription& d = graph.getDescription(a.resource);
+        target.viewport[2] = d.width;
+        target.viewport[3] = d.height;
+        RenderPass::bind(target);
+      }
+      markSampled(graph,p);
+
+      RenderPass& pass = getRenderPass( graph.getPassName(p) );
+      setActions(pass,RenderPass::COLOR,color);
+      setActions(pass,RenderPass::DEPTH,depth);
+      pass.begin();
+      graph.getExecute(p)( RenderGraph::Context(graph,p,textures) );
+      pass.end();
+    }
+
+    RenderPass::bind(previous);
+    releaseUnused();
+  }
+
+  void releaseGPUResources() {
+    framebuffers.clear();
+    targets.clear();
+  }
+
+  size_t getAllocatedBytes() const {
+    size_t bytes = 0;
+    for(const Target& t : targets) {
+      bytes += t.description.getBytes();
+    }
+    return bytes;
+  }
+
+ private:
+  class Target {
+   public:
+    TargetDescription description;
+    TextureHandle texture;
+    RenderbufferHandle renderbuffer;
+    unsigned long lastFrame{0}, lastExecution{0};
+  };
+
+  class Framebuffer {
+   public:
+    GLuint color{0}, depth{0};
+    FramebufferHandle handle;
+    unsigned long lastFrame{0};
+  };
+
+  class NamedPass {
+   public:
+    std::string name;
+    std::unique_ptr<RenderPass> pass;
+  };
+
+  unsigned long frame{0}, execution{0};
+  std::vector<Target> targets;
+  std::vector<Framebuffer> framebuffers;
+  std::vector<NamedPass> passes;
+  std::vector<size_t> assigned; //Per physical target of the graph, an index into targets.
+  std::vector<unsigned int> textures; //Per physical target of the graph; 0 for depth.
+
+  void assignTargets(const RenderGraph& graph) {
+    //The same description in the same order finds the same targets as in the frame before.
+    //Views run one after the other, so those of a frame share their targets.
+    const std::vector<TargetDescription>& physical = graph.getPhysicalTargets();
+    assigned.clear();
+    textures.clear();
+    for(const TargetDescription& d : physical) {
+      size_t t = 0;
+      while( t < targets.size() && !isFree(targets[t],d) ) {
+        ++t;
+      }
+      if( t == targets.size() ) {
+        targets.push_back( Target() );
+        allocate(targets.back(),d);
+      }
+      targets[t].lastFrame = frame;
+      targets[t].lastExecution = execution;
+      assigned.push_back(t);
+      textures.push_back( targets[t].texture.get() );
+    }
+  }
+
+  bool isFree(const Target& t, const TargetDescription& d) const {
+    return t.lastExecution != execution && t.description == d;
+  }
+
+  static void allocate(Target& t, const TargetDescription& d) {
+    t.description = d;
+    if( d.isDepth() ) {
+      t.renderbuffer.create();
+      GL_CHECK( glBindRenderbuffer(GL_RENDERBUFFER,t.renderbuffer.get()) );
+      GL_CHECK( glRenderbufferStorage(GL_RENDERBUFFER,GL_DEPTH_COMPONENT16,d.width,d.height) );
+      GL_CHECK( glBindRenderbuffer(GL_RENDERBUFFER,0) );
+      t.renderbuffer.setSize( d.getBytes() );
+      return;
+    }
+    GLint previousTexture = 0;
+    GL_CHECK( glGetIntegerv(GL_TEXTURE_BINDING_2D,&previousTexture) );
+    t.texture.create();
+    GL_CHECK( glBindTexture(GL_TEXTURE_2D,t.texture.get()) );
+    GL_CHECK( glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_LINEAR) );
+    GL_CHECK( glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_LINEAR) );
+    GL_CHECK( glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S,GL_CLAMP_TO_EDGE) );
+    GL_CHECK( glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_T,GL_CLAMP_TO_EDGE) );
+    bool rgba = d.format == TargetFormat::RGBA8;
+    GLenum format = rgba ? GL_RGBA : GL_RGB;
+    GL_CHECK( glTexImage2D(GL_TEXTURE_2D,0,format,d.width,d.height,0,format,
+      rgba ? GL_UNSIGNED_BYTE : GL_UNSIGNED_SHORT_5_6_5,nullptr
+    ) );
+    GL_CHECK( glBindTexture(GL_TEXTURE_2D,(GLuint) previousTexture) );
+    t.texture.setSize( d.getBytes() );
+  }
+
+  GLuint getFramebuffer(const RenderGraph& graph, const RenderGraph::Attachment& color,
+    const RenderGraph::Attachment& depth)
+  {
+    GLuint colorName = 0, depthName = 0;
+    if(color.resource != RenderGraph::NONE) {
+      colorName = targets[ assigned[ graph.getPhysicalTarget(color.resource) ] ].texture.get();
+    }
+    if(depth.resource != RenderGraph::NONE) {
+      Target& t = targets[ assigned[ graph.getPhysicalTarget(depth.resource) ] ];
+      depthName = t.renderbuffer.get();
+    }
+    for(Framebuffer& f : framebuffers) {
+      if(f.color == colorName && f.depth == depthName) {
+        f.lastFrame = frame;
+        return f.handle.get();
+      }
+    }
+
+    framebuffers.push_back( Framebuffer() );
+    Framebuffer& f = framebuffers.back();
+    f.color = colorName;
+    f.depth = depthName;
+    f.lastFrame = frame;
+    f.handle.create();
+    RenderPass::BoundState creating = RenderPass::getBoundState();
+    creating.framebuffer = f.handle.get();
+    creating.depth = depthName != 0;
+    RenderPass::bind(creating);
+    if(colorName != 0) {
+      GL_CHECK( glFramebufferTexture2D(GL_FRAMEBUFFER,GL_COLOR_ATTACHMENT0,GL_TEXTURE_2D,
+        colorName,0
+      ) );
+    }
+    if(depthName != 0) {
+      GL_CHECK( glFramebufferRenderbuffer(GL_FRAMEBUFFER,GL_DEPTH_ATTACHMENT,GL_RENDERBUFFER,
+        depthName
+      ) );
+    }
+    GLenum status = GL_CHECK( glCheckFramebufferStatus(GL_FRAMEBUFFER) );
+    if(status != GL_FRAMEBUFFER_COMPLETE) {
+      LOG_ERROR("A framebuffer of the render graph is incomplete: 0x%x\n",status);
+      throw std::runtime_error("Incomplete framebuffer");
+    }
+    return f.handle.get();
+  }
+
+  void markSampled(const RenderGraph& graph, RenderGraph::Pass p) {
+    //For the validation of RenderPass: a texture that is read was stored for a reason.
+    for(RenderGraph::Resource r : graph.getReads(p)) {
+      GLuint texture = textures[ graph.getPhysicalTarget(r) ];
+      for(const Framebuffer& f : framebuffers) {
+        if(f.color == texture) {
+          RenderPass::markSampled( f.handle.get() );
+        }
+      }
+    }
+  }
+
+  RenderPass& getRenderPass(const std::string& name) {
+    for(NamedPass& n : passes) {
+      if(n.name == name) {
+        return *n.pass;
+      }
+    }
+    passes.push_back( NamedPass() );
+    passes.back().name = name;
+    passes.back().pass = std::unique_ptr<RenderPass>( new RenderPass( name.c_str() ) );
+    return *passes.back().pass;
+  }
+
+  static void setActions(RenderPass& pass, RenderPass::Attachment attachment,
+    const RenderGraph::Attachment& a)
+  {
+    //Attachments that the pass does not write are left alone.
+    if(a.resource == RenderGraph::NONE) {
+      pass.setActions(attachment,RenderPass::Load::LOAD,RenderPass::Store::STORE);
+    }
+    else {
+      pass.setActions(attachment,a.load,a.store);
+    }
+  }
+
+  void releaseUnused() {
+    auto unused = [this](unsigned long lastFrame) {
+      return lastFrame + UNUSED_FRAMES < frame;
+    };
+    //A framebuffer is used whenever its targets are, so it is released with them at the latest.
+    framebuffers.erase( std::remove_if( framebuffers.begin(),framebuffers.end(),
+      [&](const Framebuffer& f) { return unused(f.lastFrame); }
+    ),framebuffers.end() );
+    targets.erase( std::remove_if( targets.begin(),targets.end(),
+      [&](const Target& t) { return unused(t.lastFrame); }
+    ),targets.end() );
+  }
+};
+
+RenderGraphExecutor::RenderGraphExecutor() {
+  imp = std::unique_ptr<I>( new I() );
+}
+
+RenderGraphExecutor::~RenderGraphExecutor() = default;
+
+void RenderGraphExecutor::execute(const RenderGraph& graph) {
+  imp->execute(graph);
+}
+
+void RenderGraphExecutor::releaseGPUResources() {
+  imp->releaseGPUResources();
+}
+
+size_t RenderGraphExecutor::getAllocatedBytes() const {
+  return imp->getAllocatedBytes();
+}
+
+}
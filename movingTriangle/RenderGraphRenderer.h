@@ -0,0 +1,66 @@
+#pragma once
+
+#include <memory>
+#include <cstddef>
+
+#include "Renderer.h"
+#include "RenderGraph.h"
+
+namespace ProjectName {
+
+class RenderGraphExecutor {
+  //Runs the passes of a compiled RenderGraph with a RenderPass each. The physical targets become
+  //textures, or renderbuffers for depth, and every combination of targets that a pass draws into
+  //gets a framebuffer. Both are kept for the next frames, so a graph that is built the same way
+  //every frame allocates nothing after the first; what has not been used for UNUSED_FRAMES
+  //frames is released; the frames are those of DeletionQueue, which counts every rendered frame
+  //once, however many views it has. Imported targets are the framebuffer that RenderPass::bind()
+  //has bound when execute() is called, with its viewport and scissor; transient targets are
+  //drawn without the scissor. The binding, the viewport and the scissor test are restored
+  //afterwards.
+  //All methods need the render thread with a current context.
+ public:
+  static constexpr unsigned long UNUSED_FRAMES = 60;
+
+  RenderGraphExecutor();
+  ~RenderGraphExecutor();
+
+  void execute(const RenderGraph& graph);
+  void releaseGPUResources();
+
+  size_t getAllocatedBytes() const; //Of the textures and renderbuffers it holds.
+
+ private:
+  class I;
+  std::unique_ptr<I> imp;
+};
+
+class RenderGraphRenderer : public Renderer {
+  //A Renderer that describes every view as a RenderGraph, which is built, compiled and executed
+  //anew in every renderView().
+ public:
+  void renderView(const RenderView& view) override {
+    graph.clear();
+    buildGraph(graph,view);
+    graph.compile();
+    executor.execute(graph);
+  }
+
+ protected:
+  virtual void buildGraph(RenderGraph& graph, const RenderView& view) = 0;
+  //Imports the framebuffer of the view with view.width and view.height, and adds the passes.
+
+  const RenderGraph& getGraph() const { //As compiled in the last renderView().
+    return graph;
+  }
+
+  RenderGraphExecutor& getExecutor() {
+    return executor;
+  }
+
+ private:
+  RenderGraph graph;
+  RenderGraphExecutor executor;
+};
+
+}
@@ -0,0 +1,251 @@
+#include "RenderGraph.h"
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+
+//Tests of the compilation of RenderGraph without an OpenGL context: culling, the order of the
+//passes, cycles, aliasing and the load and store actions. Every failed check is printed; the
+//exit status is the number of failures, so meson test reports them.
+
+namespace {
+
+using namespace ProjectName;
+using Resource = RenderGraph::Resource;
+using Pass = RenderGraph::Pass;
+using Load = RenderPass::Load;
+using Store = RenderPass::Store;
+
+int failures = 0;
+
+void check(bool condition, const char * what, int line) {
+  if(!condition) {
+    std::printf("FAILED at line %d: %s\n",line,what);
+    ++failures;
+  }
+}
+
+#define CHECK(condition) check( (condition),#condition,__LINE__ )
+
+const TargetDescription FULL{64,64,TargetFormat::RGBA8};
+const TargetDescription HALF{32,32,TargetFormat::RGB565};
+const TargetDescription DEPTH{64,64,TargetFormat::DEPTH16};
+
+void nothing(const RenderGraph::Context&) {
+
+}
+
+size_t positionOf(const RenderGraph& graph, Pass p) {
+  const std::vector<Pass>& order = graph.getOrder();
+  return std::find(order.begin(),order.end(),p) - order.begin();
+}
+
+void testCulling() {
+  RenderGraph graph;
+  Resource window = graph.importTarget("window",FULL);
+  Resource scene = graph.createTarget("scene",FULL);
+  Resource debugView = graph.createTarget("debug view",FULL);
+
+  Pass scenePass = graph.addPass("scene",nothing);
+  graph.write(scenePass,scene,true);
+  Pass debug = graph.addPass("debug view",nothing); //Nothing reads what it writes.
+  graph.read(debug,scene);
+  graph.write(debug,debugView);
+  Pass finalPass = graph.addPass("final",nothing);
+  graph.read(finalPass,scene);
+  graph.write(finalPass,window);
+  graph.compile();
+
+  CHECK( graph.isCulled(debug) );
+  CHECK( !graph.isCulled(scenePass) );
+  CHECK( !graph.isCulled(finalPass) );
+  CHECK(graph.getOrder().size() == 2);
+  CHECK(positionOf(graph,debug) == graph.getOrder().size());
+  CHECK(graph.getPhysicalTarget(debugView) == RenderGraph::NONE);
+  CHECK(graph.getMemoryReport().culledPasses == 1);
+}
+
+void testOrder() {
+  //The reader is added first, and still runs after the writer; writers keep their order.
+  RenderGraph graph;
+  Resource window = graph.importTarget("window",FULL);
+  Resource image = graph.createTarget("image",FULL);
+
+  Pass reader = graph.addPass("reader",nothing);
+  graph.read(reader,image);
+  graph.write(reader,window);
+  Pass first = graph.addPass("first writer",nothing);
+  graph.write(first,image,true);
+  Pass second = graph.addPass("second writer",nothing);
+  graph.write(second,image);
+  graph.compile();
+
+  CHECK(graph.getOrder().size() == 3);
+  CHECK( positionOf(graph,first) < positionOf(graph,second) );
+  CHECK( positionOf(graph,second) < positionOf(graph,reader) );
+}
+
+void testCycle() {
+  RenderGraph graph;
+  Resource window = graph.importTarget("window",FULL);
+  Resource a = graph.createTarget("a",FULL);
+  Resource b = graph.createTarget("b",FULL);
+
+  Pass makeA = graph.addPass("a from b",nothing);
+  graph.read(makeA,b);
+  graph.write(makeA,a);
+  Pass makeB = graph.addPass("b from a",nothing);
+  graph.read(makeB,a);
+  graph.write(makeB,b);
+  Pass finalPass = graph.addPass("final",nothing);
+  graph.read(finalPass,a);
+  graph.write(finalPass,window);
+
+  bool threw = false;
+  try {
+    graph.compile();
+  }
+  catch(const std::runtime_error&) {
+    threw = true;
+  }
+  CHECK(threw);
+}
+
+class Lifetime {
+ public:
+  size_t first{0}, last{0};
+};
+
+void testAliasing() {
+  //A scene with depth, a bright pass and a separable blur at half the size, and a composite into
+  //the window, as in renderGraphBenchmark.
+  RenderGraph graph;
+  Resource window = graph.importTarget("window",FULL);
+  Resource sceneColor = graph.createTarget("scene color",FULL);
+  Resource sceneDepth = graph.createTarget("scene depth",DEPTH);
+  Resource bright = graph.createTarget("bright",HALF);
+  std::vector<Resource> transient = {sceneColor,sceneDepth,bright};
+
+  Pass scene = graph.addPass("scene",nothing);
+  graph.write(scene,sceneColor,true);
+  graph.write(scene,sceneDepth,true);
+  Pass brightPass = graph.addPass("bright",nothing);
+  graph.read(brightPass,sceneColor);
+  graph.write(brightPass,bright);
+  Resource blurred = bright;
+  for(int i = 0; i < 4; ++i) {
+    std::string name = "blur " + std::to_string(i);
+    Resource next = graph.createTarget(name.c_str(),HALF);
+    Pass blur = graph.addPass(name.c_str(),nothing);
+    graph.read(blur,blurred);
+    graph.write(blur,next);
+    transient.push_back(next);
+    blurred = next;
+  }
+  Pass composite = graph.addPass("composite",nothing);
+  graph.read(composite,sceneColor);
+  graph.read(composite,blurred);
+  graph.write(composite,window);
+  graph.compile();
+
+  //The positions of the first and last pass that use every transient target.
+  std::vector<Lifetime> lifetimes(transient.size());
+  for(size_t t = 0; t < transient.size(); ++t) {
+    bool used = false;
+    for(Pass p : graph.getOrder()) {
+      bool uses = graph.reads(p,transient[t]) || graph.getColor(p).resource == transient[t] ||
+        graph.getDepth(p).resource == transient[t];
+      if(uses) {
+        size_t position = positionOf(graph,p);
+        lifetimes[t].first = used ? lifetimes[t].first : position;
+        lifetimes[t].last = position;
+        used = true;
+      }
+    }
+    CHECK(used);
+  }
+
+  bool shared = false;
+  for(size_t a = 0; a < transient.size(); ++a) {
+    size_t physical = graph.getPhysicalTarget(transient[a]);
+    CHECK(physical != RenderGraph::NONE);
+    CHECK(graph.getPhysicalTargets()[physical] == graph.getDescription(transient[a]));
+    for(size_t b = a + 1; b < transient.size(); ++b) {
+      if(graph.getPhysicalTarget(transient[b]) != physical) {
+        continue;
+      }
+      shared = true;
+      bool disjoint = lifetimes[a].last < lifetimes[b].first ||
+        lifetimes[b].last < lifetimes[a].first;
+      if(!disjoint) {
+        std::printf("  %s and %s overlap and share physical target %zu\n",
+          graph.getTargetName(transient[a]).c_str(),graph.getTargetName(transient[b]).c_str(),
+          physical
+        );
+      }
+      CHECK(disjoint);
+    }
+  }
+  CHECK(shared); //The blur ping-pongs between two targets of the half size.
+  RenderGraph::MemoryReport report = graph.getMemoryReport();
+  CHECK(report.bytesWithAliasing < report.bytesWithoutAliasing);
+}
+
+void testActions() {
+  RenderGraph graph;
+  Resource window = graph.importTarget("window",FULL);
+  Resource overlay = graph.importTarget("overlay",FULL,false);
+  Resource image = graph.createTarget("image",FULL);
+  Resource cleared = graph.createTarget("cleared",FULL);
+  Resource depth = graph.createTarget("depth",DEPTH);
+
+  Pass draw = graph.addPass("draw",nothing);
+  graph.write(draw,image);
+  graph.write(draw,depth);
+  Pass drawMore = graph.addPass("draw more",nothing);
+  graph.write(drawMore,image);
+  graph.write(drawMore,depth);
+  Pass clear = graph.addPass("clear",nothing);
+  graph.write(clear,cleared,true);
+  Pass finalPass = graph.addPass("final",nothing);
+  graph.read(finalPass,image);
+  graph.read(finalPass,cleared);
+  graph.write(finalPass,window);
+  Pass overlayPass = graph.addPass("overlay",nothing);
+  graph.write(overlayPass,overlay);
+  graph.compile();
+
+  //The first write of a transient target does not load it; the last use discards it.
+  CHECK(graph.getColor(draw).load == Load::DONT_CARE);
+  CHECK(graph.getColor(draw).store == Store::STORE);
+  CHECK(graph.getDepth(draw).load == Load::DONT_CARE);
+  CHECK(graph.getColor(drawMore).load == Load::LOAD);
+  CHECK(graph.getColor(drawMore).store == Store::STORE);
+  CHECK(graph.getDepth(drawMore).load == Load::LOAD);
+  CHECK(graph.getDepth(drawMore).store == Store::DISCARD); //Nothing reads the depth.
+  CHECK(graph.getColor(clear).load == Load::CLEAR);
+  CHECK(graph.getColor(clear).store == Store::STORE);
+
+  //Imported targets are stored, and only loaded if their content is kept.
+  CHECK(graph.getColor(finalPass).load == Load::LOAD);
+  CHECK(graph.getColor(finalPass).store == Store::STORE);
+  CHECK(graph.getColor(overlayPass).load == Load::DONT_CARE);
+  CHECK(graph.getColor(overlayPass).store == Store::STORE);
+  CHECK(graph.getDepth(finalPass).resource == RenderGraph::NONE);
+}
+
+}
+
+int main() {
+  testCulling();
+  testOrder();
+  testCycle();
+  testAliasing();
+  testActions();
+  if(failures == 0) {
+    std::printf("All RenderGraph tests passed.\n");
+  }
+  return failures;
+}
@@ -0,0 +1,395 @@
+#include "RenderPass.h"
+#include "GLExtensions.h"
+#include "GLDebug.h"
+#include "Logger.h"
+
+#include <glad/glad.h>
+
+#include <string>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+
+namespace ProjectName {
+
+namespace {
+
+//The attachments of the default framebuffer: GL_COLOR, GL_DEPTH and GL_STENCIL, which glad
+//does not define for OpenGL ES 2.0.
+const GLenum DEFAULT_ATTACHMENTS[RenderPass::ATTACHMENT_COUNT] = {0x1800,0x1801,0x1802};
+const GLenum OBJECT_ATTACHMENTS[RenderPass::ATTACHMENT_COUNT] = {
+  GL_COLOR_ATTACHMENT0,GL_DEPTH_ATTACHMENT,GL_STENCIL_ATTACHMENT
+};
+const GLbitfield CLEAR_BITS[RenderPass::ATTACHMENT_COUNT] = {
+  GL_COLOR_BUFFER_BIT,GL_DEPTH_BUFFER_BIT,GL_STENCIL_BUFFER_BIT
+};
+const GLenum DEPTH_BITS = 0x0D56; //GL_DEPTH_BITS
+const GLenum STENCIL_BITS = 0x0D57; //GL_STENCIL_BITS
+
+RenderPass::BoundState& getBound() {
+  //What RenderPass::bind() and setScissorTest() have set on the render thread.
+  static RenderPass::BoundState bound;
+  return bound;
+}
+
+class ClearValues {
+  //The values that begin() has given to glClearColor, glClearDepthf and glClearStencil.
+ public:
+  float color[4]{0,0,0,0};
+  float depth{1};
+  int stencil{0};
+};
+
+ClearValues& getClearValues() {
+  static ClearValues values;
+  return values;
+}
+
+#ifdef PROJECTNAME_GL_DEBUG
+const char * const ATTACHMENT_NAMES[RenderPass::ATTACHMENT_COUNT] = {"color","depth","stencil"};
+
+enum class Content {UNKNOWN, STORED, DISCARDED};
+
+class FramebufferHistory {
+  //What the passes of the current frame have left in the attachments of a framebuffer.
+ public:
+  GLint framebuffer{0};
+  Content contents[RenderPass::ATTACHMENT_COUNT]{};
+  std::string passes[RenderPass::ATTACHMENT_COUNT]; //That have left the contents.
+};
+
+std::vector<FramebufferHistory>& getHistories() {
+  static std::vector<FramebufferHistory> histories;
+  return histories;
+}
+
+FramebufferHistory& getHistory(GLint framebuffer) {
+  std::vector<FramebufferHistory>& histories = getHistories();
+  for(FramebufferHistory& h : histories) {
+    if(h.framebuffer == framebuffer) {
+      return h;
+    }
+  }
+  histories.push_back( FramebufferHistory() );
+  histories.back().framebuffer = framebuffer;
+  return histories.back();
+}
+#endif
+
+}
+
+class RenderPass::I {
+ public:
+  explicit I(const char * name) : name(name) {}
+
+  void setActions(Attachment attachment, Load load, Store store) {
+    loads[attachment] = load;
+    stores[attachment] = store;
+  }
+
+  void setClearColor(float red, float green, float blue, float alpha) {
+    clearColor[0] = red;
+    clearColor[1] = green;
+    clearColor[2] = blue;
+    clearColor[3] = alpha;
+  }
+
+  void setClearDepth(float depth) {
+    clearDepth = depth;
+  }
+
+  void setClearStencil(int stencil) {
+    clearStencil = stencil;
+  }
+
+  void begin() {
+    const BoundState& bound = getBound();
+    validateBoundState(bound);
+    framebuffer = (GLint) bound.framebuffer;
+    scissor = bound.scissorTest;
+    present[COLOR] = true;
+    present[DEPTH] = bound.depth;
+    present[STENCIL] = bound.stencil;
+    InvalidateFramebuffer invalidate = GLExtensions::getInvalidateFramebuffer();
+
+    GLbitfield clearMask = 0;
+    attachments.clear();
+    for(int a = 0; a < ATTACHMENT_COUNT; ++a) {
+      Load load = loads[a];
+      if(load == Load::DONT_CARE && a == COLOR && scissor) {
+        load = Load::LOAD; //The pixels outside the scissor are still needed.
+      }
+      validateLoad(a,load);
+      if(!present[a] || load == Load::LOAD) {
+        continue;
+      }
+      if(load == Load::CLEAR || invalidate == nullptr) {
+        clearMask |= CLEAR_BITS[a];
+      }
+      else {
+        attachments.push_back( getAttachmentName(a) );
+      }
+    }
+
+    if( !attachments.empty() ) {
+      GL_CHECK( invalidate(GL_FRAMEBUFFER,(GLsizei) attachments.size(),attachments.data()) );
+    }
+    if(clearMask == 0) {
+      return;
+    }
+    //The clear values of attachments that are only cleared for DONT_CARE do not matter.
+    ClearValues& v = getClearValues();
+    if( loads[COLOR] == Load::CLEAR && std::memcmp( v.color,clearColor,sizeof(clearColor) ) ) {
+      std::memcpy( v.color,clearColor,sizeof(clearColor) );
+      GL_CHECK( glClearColor(clearColor[0],clearColor[1],clearColor[2],clearColor[3]) );
+    }
+    if(loads[DEPTH] == Load::CLEAR && present[DEPTH] && v.depth != clearDepth) {
+      v.depth = clearDepth;
+      GL_CHECK( glClearDepthf(clearDepth) );
+    }
+    if(loads[STENCIL] == Load::CLEAR && present[STENCIL] && v.stencil != clearStencil) {
+      v.stencil = clearStencil;
+      GL_CHECK( glClearStencil(clearStencil) );
+    }
+    GL_CHECK( glClear(clearMask) );
+  }
+
+  void end() {
+    InvalidateFramebuffer invalidate = GLExtensions::getInvalidateFramebuffer();
+    attachments.clear();
+    for(int a = 0; a < ATTACHMENT_COUNT; ++a) {
+      validateStore(a);
+      if(present[a] && stores[a] == Store::DISCARD) {
+        attachments.push_back( getAttachmentName(a) );
+      }
+    }
+    if(invalidate != nullptr && !attachments.empty()) {
+      GL_CHECK( invalidate(GL_FRAMEBUFFER,(GLsizei) attachments.size(),attachments.data()) );
+    }
+  }
+
+  static void initialize() {
+    BoundState& bound = getBound();
+    bound = BoundState();
+    GL_CHECK( glGetIntegerv(GL_VIEWPORT,bound.viewport) );
+    bound.depth = getInteger(DEPTH_BITS) > 0;
+    bound.stencil = getInteger(STENCIL_BITS) > 0;
+    getClearValues() = ClearValues();
+  }
+
+  static void bind(const BoundState& state) {
+    BoundState& bound = getBound();
+    if(state.framebuffer != bound.framebuffer) {
+      GL_CHECK( glBindFramebuffer(GL_FRAMEBUFFER,state.framebuffer) );
+    }
+    setViewport(state.viewport[0],state.viewport[1],state.viewport[2],state.viewport[3]);
+    setScissorTest(state.scissorTest);
+    bound = state;
+  }
+
+  static void setViewport(int x, int y, int width, int height) {
+    int * viewport = getBound().viewport;
+    if(x != viewport[0] || y != viewport[1] || width != viewport[2] || height != viewport[3]) {
+      GL_CHECK( glViewport(x,y,width,height) );
+      viewport[0] = x;
+      viewport[1] = y;
+      viewport[2] = width;
+      viewport[3] = height;
+    }
+  }
+
+  static void setScissorTest(bool enabled) {
+    BoundState& bound = getBound();
+    if(enabled != bound.scissorTest) {
+      if(enabled) {
+        GL_CHECK( glEnable(GL_SCISSOR_TEST) );
+      }
+      else {
+        GL_CHECK( glDisable(GL_SCISSOR_TEST) );
+      }
+      bound.scissorTest = enabled;
+    }
+  }
+
+  static void endFrame() {
+#ifdef PROJECTNAME_GL_DEBUG
+    getHistories().clear();
+#endif
+  }
+
+  static void markSampled(unsigned int framebuffer) {
+#ifdef PROJECTNAME_GL_DEBUG
+    FramebufferHistory& h = getHistory( (GLint) framebuffer );
+    if(h.contents[COLOR] == Content::STORED) {
+      h.contents[COLOR] = Content::UNKNOWN;
+    }
+#else
+    (void) framebuffer;
+#endif
+  }
+
+ private:
+  enum Mistake {MISSING_ATTACHMENT, CLEAR_AFTER_STORE, LOAD_AFTER_DISCARD, DISCARD_IN_SCISSOR,
+    STALE_BOUND_STATE, MISTAKE_COUNT
+  };
+
+  std::string name;
+  Load loads[ATTACHMENT_COUNT]{Load::LOAD,Load::LOAD,Load::LOAD};
+  Store stores[ATTACHMENT_COUNT]{Store::STORE,Store::STORE,Store::STORE};
+  float clearColor[4]{0,0,0,1};
+  float clearDepth{1};
+  int clearStencil{0};
+
+  //Of the framebuffer at begin().
+  GLint framebuffer{0};
+  bool scissor{false};
+  bool present[ATTACHMENT_COUNT]{};
+
+  std::vector<GLenum> attachments;
+  bool warned[MISTAKE_COUNT]{};
+
+  static GLint getInteger(GLenum name) {
+    GLint value = 0;
+    GL_CHECK( glGetIntegerv(name,&value) );
+    return value;
+  }
+
+  GLenum getAttachmentName(int a) const {
+    return framebuffer == 0 ? DEFAULT_ATTACHMENTS[a] : OBJECT_ATTACHMENTS[a];
+  }
+
+  bool isFirst(Mistake mistake) {
+    //Every kind of mistake is reported once per pass.
+    bool first = !warned[mistake];
+    warned[mistake] = true;
+    return first;
+  }
+
+  void validateBoundState(const BoundState& bound) {
+#ifdef PROJECTNAME_GL_DEBUG
+    //GL_CHECK waits for the driver after every call in these builds anyway.
+    GLint binding = getInteger(GL_FRAMEBUFFER_BINDING);
+    GLint viewport[4]{};
+    GL_CHECK( glGetIntegerv(GL_VIEWPORT,viewport) );
+    bool scissorTest = GL_CHECK( glIsEnabled(GL_SCISSOR_TEST) ) != GL_FALSE;
+    bool sameViewport = std::equal(viewport,viewport + 4,bound.viewport);
+    if( ( (GLuint) binding != bound.framebuffer || !sameViewport ||
+      scissorTest != bound.scissorTest ) && isFirst(STALE_BOUND_STATE) )
+    {
+      LOG_WARNING("Render pass %s: framebuffer %d, viewport %dx%d at %d,%d and scissor test %d "
+        "were set without RenderPass::bind(), setViewport() or setScissorTest().\n",
+        name.c_str(),binding,viewport[2],viewport[3],viewport[0],viewport[1],(int) scissorTest
+      );
+    }
+#else
+    (void) bound;
+#endif
+  }
+
+  void validateLoad(int a, Load load) {
+#ifdef PROJECTNAME_GL_DEBUG
+    if(load == Load::CLEAR && !present[a]) {
+      if( isFirst(MISSING_ATTACHMENT) ) {
+        LOG_WARNING("Render pass %s clears the %s attachment, which the framebuffer does not "
+          "have.\n",name.c_str(),ATTACHMENT_NAMES[a]
+        );
+      }
+      return;
+    }
+    const FramebufferHistory& h = getHistory(framebuffer);
+    if(load == Load::CLEAR && h.contents[a] == Content::STORED && isFirst(CLEAR_AFTER_STORE)) {
+      LOG_WARNING("Render pass %s clears the %s attachment, which render pass %s has stored; "
+        "unless it is sampled in between, discard it there or merge the passes.\n",name.c_str(),
+        ATTACHMENT_NAMES[a],h.passes[a].c_str()
+      );
+    }
+    if(load == Load::LOAD && present[a] && h.contents[a] == Content::DISCARDED &&
+      isFirst(LOAD_AFTER_DISCARD))
+    {
+      LOG_WARNING("Render pass %s loads the %s attachment, which render pass %s has "
+        "discarded.\n",name.c_str(),ATTACHMENT_NAMES[a],h.passes[a].c_str()
+      );
+    }
+#else
+    (void) a;
+    (void) load;
+#endif
+  }
+
+  void validateStore(int a) {
+#ifdef PROJECTNAME_GL_DEBUG
+    if(a == COLOR && stores[a] == Store::DISCARD && scissor && isFirst(DISCARD_IN_SCISSOR)) {
+      LOG_WARNING("Render pass %s discards the color attachment with the scissor test enabled, "
+        "which loses the pixels outside the scissor as well.\n",name.c_str()
+      );
+    }
+    if(present[a]) {
+      FramebufferHistory& h = getHistory(framebuffer);
+      h.contents[a] = stores[a] == Store::STORE ? Content::STORED : Content::DISCARDED;
+      h.passes[a] = name;
+    }
+#else
+    (void) a;
+#endif
+  }
+};
+
+RenderPass::RenderPass(const char * name) {
+  imp = std::unique_ptr<I>( new I(name) );
+}
+
+RenderPass::~RenderPass() = default;
+
+void RenderPass::setActions(Attachment attachment, Load load, Store store) {
+  imp->setActions(attachment,load,store);
+}
+
+void RenderPass::setClearColor(float red, float green, float blue, float alpha) {
+  imp->setClearColor(red,green,blue,alpha);
+}
+
+void RenderPass::setClearDepth(float depth) {
+  imp->setClearDepth(depth);
+}
+
+void RenderPass::setClearStencil(int stencil) {
+  imp->setClearStencil(stencil);
+}
+
+void RenderPass::begin() {
+  imp->begin();
+}
+
+void RenderPass::end() {
+  imp->end();
+}
+
+void RenderPass::initialize() {
+  I::initialize();
+}
+
+void RenderPass::bind(const BoundState& state) {
+  I::bind(state);
+}
+
+void RenderPass::setViewport(int x, int y, int width, int height) {
+  I::setViewport(x,y,width,height);
+}
+
+void RenderPass::setScissorTest(bool enabled) {
+  I::setScissorTest(enabled);
+}
+
+const RenderPass::BoundState& RenderPass::getBoundState() {
+  return getBound();
+}
+
+void RenderPass::endFrame() {
+  I::endFrame();
+}
+
+void RenderPass::markSampled(unsigned int framebuffer) {
+  I::markSampled(framebuffer);
+}
+
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <memory>
+
+namespace ProjectName {
+
+class RenderPass {
+  //Declares what a sequence of draws does with the attachments of the framebuffer that is bound
+  //at begin(). A tiling GPU keeps a tile of the framebuffer in on-chip memory while it draws;
+  //reading the old content into the tile and writing the tile back to memory are its main
+  //bandwidth cost, and the load and store actions tell the driver which of them it can skip:
+  //  Load::CLEAR      glClear with the clear value of the pass, no read.
+  //  Load::LOAD       the old content is needed.
+  //  Load::DONT_CARE  every pixel will be drawn; invalidated at begin(), or cleared where
+  //                   glInvalidateFramebuffer and glDiscardFramebufferEXT are not available,
+  //                   which tiling drivers also take as the start of a new frame.
+  //  Store::STORE     the content is needed after end().
+  //  Store::DISCARD   invalidated at end(), so it is never written to memory.
+  //Attachments the framebuffer does not have are skipped. Invalidation ignores the scissor, so
+  //with the scissor test enabled the color attachment is loaded instead of being invalidated.
+  //Which framebuffer is bound, its attachments, the viewport and the scissor test are not asked
+  //from the driver, because many drivers wait for all earlier commands to answer glGetIntegerv
+  //and glIsEnabled. They are set with bind(), setViewport() and setScissorTest() instead.
+  //With PROJECTNAME_GL_DEBUG, begin() and end() warn once per pass and kind of mistake: a clear
+  //of an attachment that does not exist, a clear of an attachment that an earlier pass of the
+  //frame has stored, a load of one that an earlier pass has discarded, a discard of the color
+  //in the scissor, and a framebuffer, viewport or scissor test that was changed without bind(),
+  //setViewport() or setScissorTest(). All methods except the setters need the render thread
+  //with a current context.
+ public:
+  enum class Load {CLEAR, LOAD, DONT_CARE};
+  enum class Store {STORE, DISCARD};
+  enum Attachment {COLOR, DEPTH, STENCIL, ATTACHMENT_COUNT};
+
+  class BoundState {
+   public:
+    unsigned int framebuffer{0};
+    bool depth{false}, stencil{false}; //Whether the framebuffer has these attachments.
+    int viewport[4]{0,0,0,0}; //x, y, width and height.
+    bool scissorTest{false};
+  };
+
+  explicit RenderPass(const char * name); //For the warnings.
+  ~RenderPass();
+
+  void setActions(Attachment attachment, Load load, Store store); //LOAD and STORE by default.
+  void setClearColor(float red, float green, float blue, float alpha);
+  void setClearDepth(float depth);
+  void setClearStencil(int stencil);
+
+  void begin();
+  void end();
+
+  static void initialize();
+  //Once per context, with the default framebuffer bound: asks for its depth and stencil bits.
+
+  static void bind(const BoundState& state);
+  //Binds the framebuffer, sets the viewport and enables or disables the scissor test, where they
+  //differ.
+  static void setViewport(int x, int y, int width, int height);
+  static void setScissorTest(bool enabled);
+  static const BoundState& getBoundState();
+
+  static void endFrame();
+  //After the default framebuffer has been swapped; the validation starts a new frame.
+
+  static void markSampled(unsigned int framebuffer);
+  //The color texture of the framebuffer has been read, so a clear after the pass that stored it
+  //is not redundant.
+
+ private:
+  class I;
+  std::unique_ptr<I> imp;
+};
+
+}
@@ -1,19 +1,56 @@
 #pragma once
 
+#include "DamageRegion.h"
+
 namespace ProjectName {
 
+class RenderView {
+  //One window of GLWindow. All windows share the OpenGL context, so buffers, textures and
+  //programs created in initializeRendering can be used in every view.
+ public:
+  unsigned int windowNumber; //0 for the first window.
+  int displayNumber;
+  int width;  //Of the drawable, in pixels. The viewport is already set to it.
+  int height;
+};
+
 class Renderer {
  public:
   virtual ~Renderer() {
-    
+
   }
-  
+
   virtual void initializeRendering() {
-    
+
+  }
+
+  virtual void beginFrame() {
+    //Called once per frame, before the views of that frame are rendered. Animation belongs
+    //here, so that it does not run faster when there are more windows.
+  }
+
+  virtual void reportDamage(const RenderView& view, DamageRegion& damage) {
+    //Called every frame for every view after beginFrame, with an empty region of the size of
+    //the view. The renderer adds what has changed since the previous frame; the default is the
+    //whole view. Views without damage are neither rendered nor swapped, and when no view has
+    //damage the frame is skipped. Rendering is then limited to the damage with the scissor
+    //test, so renderView has to draw everything that overlaps it, clears included.
+    (void) view;
+    damage.addAll();
+  }
+
+  virtual void logStatistics() {
+    //Called now and then on the render thread, after GLWindow has logged the frame times and its
+    //memory, for what the renderer itself keeps, such as its buffers.
+  }
+
+  virtual void renderView(const RenderView& view) {
+    (void) view;
+    render();
   }
 
   virtual void render() {
-    
+
   }
 };
 
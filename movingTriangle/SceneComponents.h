@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+
+namespace ProjectName {
+
+//Components of the entities of an EntityStore that the renderers share.
+
+class Transform2D {
+ public:
+  float x{0}, y{0};
+  float rotation{0}; //Radians, counterclockwise.
+  float scale{1};
+};
+
+class Velocity2D {
+ public:
+  float x{0}, y{0};
+  float angular{0}; //Radians per second.
+};
+
+class Color {
+ public:
+  uint8_t r{255}, g{255}, b{255}, a{255};
+};
+
+}
@@ -0,0 +1,135 @@
+#include "GLSLPreprocessor.h"
+#include "HiddenContext.h"
+
+#include <glad/glad.h>
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+
+//Measures how long the driver takes to compile and link the variants of TestVertex.glsl and
+//TestFragment.glsl as they are, with the defines of the variant inserted, against the same
+//variants after GLSLPreprocessor. Every repetition appends a different unused constant to the
+//sources, so that a shader cache of the driver cannot return an earlier result. The window is
+//hidden; see GLReplay.cpp for running it without a display.
+//
+//  shaderCompileBenchmark [data directory] [repetitions]
+
+namespace {
+
+using namespace ProjectName;
+using Clock = std::chrono::steady_clock;
+
+const char * const FEATURES[] = {"TRANSFORM","POINT_SPRITE"};
+const unsigned int FEATURE_COUNT = 2;
+
+std::string readFile(const std::string& path) {
+  std::ifstream stream(path);
+  if( !stream.good() ) {
+    throw std::runtime_error("Cannot read " + path);
+  }
+  std::stringstream s;
+  s << stream.rdbuf();
+  return s.str();
+}
+
+std::string addDefines(const std::string& source, unsigned int mask) {
+  //After the #version line, as ShaderPermutations does.
+  size_t line = source.find('\n') + 1;
+  std::string defines;
+  for(unsigned int f = 0; f < FEATURE_COUNT; ++f) {
+    if(mask >> f & 1) {
+      defines += std::string("#define ") + FEATURES[f] + " 1\n";
+    }
+  }
+  return source.substr(0,line) + defines + source.substr(line);
+}
+
+GLuint compile(GLenum type, const std::string& source) {
+  GLuint shader = glCreateShader(type);
+  const GLchar * text = source.c_str();
+  GLint length = (GLint) source.size();
+  glShaderSource(shader,1,&text,&length);
+  glCompileShader(shader);
+  GLint status = GL_FALSE;
+  glGetShaderiv(shader,GL_COMPILE_STATUS,&status);
+  if(status != GL_TRUE) {
+    throw std::runtime_error("Compilation failed:\n" + source);
+  }
+  return shader;
+}
+
+double build(const std::string& vertex, const std::string& fragment) {
+  //Milliseconds for compiling and linking. Drivers may defer work until the link status is read.
+  Clock::time_point start = Clock::now();
+  GLuint v = compile(GL_VERTEX_SHADER,vertex);
+  GLuint f = compile(GL_FRAGMENT_SHADER,fragment);
+  GLuint program = glCreateProgram();
+  glAttachShader(program,v);
+  glAttachShader(program,f);
+  glBindAttribLocation(program,0,"position");
+  glBindAttribLocation(program,1,"color");
+  glLinkProgram(program);
+  GLint status = GL_FALSE;
+  glGetProgramiv(program,GL_LINK_STATUS,&status);
+  double milliseconds = std::chrono::duration<double,std::milli>(Clock::now() - start).count();
+  if(status != GL_TRUE) {
+    throw std::runtime_error("Linking failed");
+  }
+  glDeleteShader(v);
+  glDeleteShader(f);
+  glDeleteProgram(program);
+  return milliseconds;
+}
+
+}
+
+int main(int n, char ** arguments) {
+  std::string directory = n > 1 ? arguments[1] : ".";
+  int repetitions = n > 2 ? std::atoi(arguments[2]) : 20;
+
+  try {
+    HiddenContext context("shaderCompileBenchmark");
+    std::printf("OpenGL Renderer: %s\n",(const char *) glGetString(GL_RENDERER));
+    std::string vertexSource = readFile(directory + "/TestVertex.glsl");
+    std::string fragmentSource = readFile(directory + "/TestFragment.glsl");
+    GLSLPreprocessor preprocessor;
+    preprocessor.setIncludeDirectory(directory);
+
+    std::printf("%-8s %10s %10s %12s %12s %12s\n","variant","raw bytes","bytes","preprocess",
+      "raw ms","processed ms"
+    );
+    for(unsigned int mask = 0; mask < (1u << FEATURE_COUNT); ++mask) {
+      std::string rawVertex = addDefines(vertexSource,mask);
+      std::string rawFragment = addDefines(fragmentSource,mask);
+
+      Clock::time_point start = Clock::now();
+      using Stage = GLSLPreprocessor::Stage;
+      std::string vertex = preprocessor.process(rawVertex,Stage::VERTEX,"TestVertex.glsl");
+      std::string fragment = preprocessor.process(rawFragment,Stage::FRAGMENT,"TestFragment.glsl");
+      double preprocess = std::chrono::duration<double,std::milli>(Clock::now() - start).count();
+
+      double raw = 0, processed = 0;
+      for(int r = 0; r < repetitions; ++r) {
+        std::string unique = "const float benchmarkRepetition" + std::to_string(mask) + "_" +
+          std::to_string(r) + " = 0.0;\n";
+        raw += build(rawVertex + unique,rawFragment + unique);
+        processed += build(vertex + unique,fragment + unique);
+      }
+      std::printf("%-8u %10zu %10zu %12.3f %12.3f %12.3f\n",mask,
+        rawVertex.size() + rawFragment.size(),vertex.size() + fragment.size(),preprocess,
+        raw/repetitions,processed/repetitions
+      );
+    }
+  }
+  catch(const std::exception& e) {
+    std::fprintf(stderr,"%s\n",e.what());
+    return 1;
+  }
+  return 0;
+}
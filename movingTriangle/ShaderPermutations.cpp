@@ -0,0 +1,220 @@
+#include "ShaderPermutations.h"
+#include "Profiler.h"
+
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+
+namespace ProjectName {
+
+class ShaderPermutations::I {
+ public:
+  I() : variants(1,nullptr) {
+
+  }
+
+  String& getName() {
+    return name;
+  }
+
+  void setSources(const String& vertexCode, const String& fragmentCode) {
+    if( !programs.empty() ) {
+      throw std::runtime_error("ShaderPermutations: the sources cannot change after get()");
+    }
+    vertexSource = vertexCode;
+    fragmentSource = fragmentCode;
+  }
+
+  uint32_t addFeature(const String& macroName) {
+    if( !programs.empty() ) {
+      throw std::runtime_error("ShaderPermutations: features have to be added before get()");
+    }
+    if(features.size() == MAX_FEATURES) {
+      throw std::length_error("ShaderPermutations: too many features");
+    }
+    features.push_back(macroName);
+    variants.assign(size_t(1) << features.size(),nullptr);
+    return uint32_t(1) << (features.size() - 1);
+  }
+
+  void bindAttributeLocation(GLuint index, const String& attributeName) {
+    attributes.emplace_back(index,attributeName);
+  }
+
+  void setPreprocessor(GLSLPreprocessor * p) {
+    preprocessor = p;
+  }
+
+  ShaderProgram& get(uint32_t mask) {
+    if( mask >= variants.size() ) {
+      throw std::out_of_range("ShaderPermutations: unknown feature bits");
+    }
+    ShaderProgram * p = variants[mask];
+    if(p == nullptr) {
+      p = variants[mask] = &findOrBuild(mask);
+    }
+    return *p;
+  }
+
+  void destroyPrograms() {
+    programs.clear();
+    programsByHash.clear();
+    std::fill(variants.begin(),variants.end(),nullptr);
+  }
+
+  size_t getProgramCount() const {
+    return programs.size();
+  }
+
+ private:
+  class Attribute {
+   public:
+    GLuint index;
+    String name;
+    Attribute(GLuint ind, String na) : index(ind), name( std::move(na) ) {}
+  };
+
+  class Program {
+   public:
+    String vertexSource, fragmentSource;
+    ShaderProgram program;
+  };
+
+  String name;
+  String vertexSource, fragmentSource;
+  std::vector<String> features;
+  std::vector<Attribute> attributes;
+  GLSLPreprocessor * preprocessor{nullptr};
+
+  std::vector<ShaderProgram *> variants; //By bitmask.
+  std::vector< std::unique_ptr<Program> > programs;
+  std::unordered_multimap<uint64_t,Program *> programsByHash;
+
+  ShaderProgram& findOrBuild(uint32_t mask) {
+    String vertex = specialize(vertexSource,mask);
+    String fragment = specialize(fragmentSource,mask);
+    if(preprocessor != nullptr) {
+      using Stage = GLSLPreprocessor::Stage;
+      vertex = preprocessor->process(vertex,Stage::VERTEX,name + " vertex shader");
+      fragment = preprocessor->process(fragment,Stage::FRAGMENT,name + " fragment shader");
+    }
+    uint64_t hash = GLSLPreprocessor::hash(vertex)*31 ^ GLSLPreprocessor::hash(fragment);
+
+    auto range = programsByHash.equal_range(hash);
+    for(auto it = range.first; it != range.second; ++it) {
+      Program& p = *it->second;
+      if(p.vertexSource == vertex && p.fragmentSource == fragment) {
+        return p.program;
+      }
+    }
+
+    PROFILE_SCOPE("ShaderPermutations::build");
+    std::unique_ptr<Program> p(new Program);
+    p->program.getName() = name + " #" + std::to_string(mask);
+    p->program.compile(vertex,fragment);
+    for(const auto& a : attributes) {
+      p->program.bindAttributeLocation(a.index,a.name);
+    }
+    p->program.link();
+    p->vertexSource = std::move(vertex);
+    p->fragmentSource = std::move(fragment);
+    programsByHash.emplace( hash,p.get() );
+    programs.push_back( std::move(p) );
+    return programs.back()->program;
+  }
+
+  String specialize(const String& source, uint32_t mask) const {
+    //The defines go after #version, which has to come first. A #line directive afterwards
+    //keeps the line numbers of compiler messages those of the file.
+    String defines;
+    for(size_t i = 0; i < features.size(); ++i) {
+      if( (mask >> i & 1) && mentions(source,features[i]) ) {
+        defines += "#define " + features[i] + " 1\n";
+      }
+    }
+    if( defines.empty() ) {
+      return source;
+    }
+    size_t insert = 0, line = 1;
+    size_t version = source.find("#version");
+    if(version != String::npos && source.find_first_not_of(" \t\r\n") == version) {
+      insert = source.find('\n',version);
+      insert = insert == String::npos ? source.size() : insert + 1;
+      for(size_t i = 0; i < insert; ++i) {
+        line += source[i] == '\n';
+      }
+    }
+    String result = source.substr(0,insert);
+    if( insert > 0 && result.back() != '\n' ) {
+      result += '\n';
+    }
+    result += defines;
+    result += "#line " + std::to_string(line) + "\n";
+    result.append(source,insert,String::npos);
+    return result;
+  }
+
+  static bool mentions(const String& source, const String& word) {
+    //As a whole identifier, so that COLOR is not found in VERTEX_COLOR.
+    auto isIdentifier = [](char c) {
+      return std::isalnum( (unsigned char) c ) || c == '_';
+    };
+    for(size_t p = source.find(word); p != String::npos; p = source.find(word,p + 1)) {
+      size_t end = p + word.size();
+      if( (p == 0 || !isIdentifier(source[p-1])) &&
+        (end == source.size() || !isIdentifier(source[end])) )
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+};
+
+constexpr unsigned int ShaderPermutations::MAX_FEATURES;
+
+ShaderPermutations::ShaderPermutations() {
+  imp = std::unique_ptr<I>( new I() );
+}
+
+ShaderPermutations::~ShaderPermutations() = default;
+
+std::string& ShaderPermutations::getName() {
+  return imp->getName();
+}
+
+void ShaderPermutations::setSources(const String& vertexCode, const String& fragmentCode) {
+  imp->setSources(vertexCode,fragmentCode);
+}
+
+uint32_t ShaderPermutations::addFeature(const String& macroName) {
+  return imp->addFeature(macroName);
+}
+
+void ShaderPermutations::bindAttributeLocation(GLuint index, const String& attributeName) {
+  imp->bindAttributeLocation(index,attributeName);
+}
+
+void ShaderPermutations::setPreprocessor(GLSLPreprocessor * preprocessor) {
+  imp->setPreprocessor(preprocessor);
+}
+
+ShaderProgram& ShaderPermutations::get(uint32_t features) {
+  return imp->get(features);
+}
+
+void ShaderPermutations::build(uint32_t features) {
+  imp->get(features);
+}
+
+void ShaderPermutations::destroyPrograms() {
+  imp->destroyPrograms();
+}
+
+size_t ShaderPermutations::getProgramCount() const {
+  return imp->getProgramCount();
+}
+
+}
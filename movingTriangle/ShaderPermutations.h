@@ -0,0 +1,53 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <memory>
+#include <string>
+#include <cstdint>
+
+#include "ShaderProgram.h"
+#include "GLSLPreprocessor.h"
+
+namespace ProjectName {
+
+class ShaderPermutations {
+  //The variants of one pair of GLSL sources, specialized by features instead of branches at run
+  //time, which weak GPUs execute slowly. Every feature is a macro name: a variant is compiled
+  //with "#define NAME 1" for every feature of its bitmask, inserted after the #version line,
+  //and the sources select code with #ifdef NAME. Feature i has bit 1 << i, in the order of
+  //addFeature.
+  //Only the features that a source mentions are defined in it, so variants that differ in
+  //features a shader pair does not use have identical sources; those share one ShaderProgram,
+  //found by the hash of the sources. get() finds the program of a bitmask in a table, and builds
+  //it on the first use; build() does that ahead of time, for instance in initializeRendering,
+  //so that no frame has to wait for the compiler.
+  //With a GLSLPreprocessor the specialized sources are preprocessed before they are hashed and
+  //compiled, so that variants whose features only differ in dead code share a program, too.
+ public:
+  using String = std::string;
+  static constexpr unsigned int MAX_FEATURES = 8;
+
+  ShaderPermutations();
+  ~ShaderPermutations();
+
+  String& getName(); //The variants are named after it, with their bitmask.
+
+  void setSources(const String& vertexCode, const String& fragmentCode);
+  uint32_t addFeature(const String& macroName); //Returns the bit of the feature.
+  void bindAttributeLocation(GLuint index, const String& attributeName); //For every variant.
+  void setPreprocessor(GLSLPreprocessor * preprocessor); //Null by default; has to outlive this.
+
+  //The following methods require an OpenGL context.
+  ShaderProgram& get(uint32_t features);
+  void build(uint32_t features);
+  void destroyPrograms();
+
+  size_t getProgramCount() const; //The number of distinct programs that have been built.
+
+ private:
+  class I;
+  std::unique_ptr<I> imp;
+};
+
+}
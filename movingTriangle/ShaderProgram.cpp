@@ -1,6 +1,11 @@
 #include "ShaderProgram.h"
+#include "GLResource.h"
+#include "Logger.h"
+#include "GLDebug.h"
+#include "Profiler.h"
+
 #include <vector>
-#include <cstdio>
+#include <string>
 #include <stdexcept>
 
 namespace ProjectName {
@@ -17,37 +22,39 @@ class ShaderProgram::I {
   }
 
   void compile(const String& vertexCode, const String& fragmentCode) {
-    vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+    PROFILE_SCOPE("ShaderProgram::compile");
+    vertexShader = GL_CHECK( glCreateShader(GL_VERTEX_SHADER) );
+    fragmentShader = GL_CHECK( glCreateShader(GL_FRAGMENT_SHADER) );
     
-    std::printf( "Trying to compile shader program %s\n",name.c_str() );
+    LOG_INFO( "Trying to compile shader program %s\n",name );
     fillShader(vertexShader,vertexCode,true);
     fillShader(fragmentShader,fragmentCode,false);
     
-    if(programNumber == 0) {
-      programNumber = glCreateProgram();
+    if(!program) {
+      program.create();
     }
-    glAttachShader(programNumber,vertexShader);
-    glAttachShader(programNumber,fragmentShader);
+    GL_CHECK( glAttachShader(program.get(),vertexShader) );
+    GL_CHECK( glAttachShader(program.get(),fragmentShader) );
   }
   
 
   void bindAttributeLocation(GLuint index,String text) {
-    glBindAttribLocation( programNumber,index,text.c_str() );
+    GL_CHECK( glBindAttribLocation( program.get(),index,text.c_str() ) );
     attributes.emplace_back(index, std::move(text) );
   }
   
   void link() {
-    glLinkProgram(programNumber);
+    PROFILE_SCOPE("ShaderProgram::link");
+    GL_CHECK( glLinkProgram(program.get()) );
 
     GLint linkStatus = GL_FALSE;
-    glGetProgramiv(programNumber,GL_LINK_STATUS,&linkStatus);
+    GL_CHECK( glGetProgramiv(program.get(),GL_LINK_STATUS,&linkStatus) );
     if(linkStatus == GL_TRUE) {
-      std::printf("Linking shader program %s was successful.\n",name.c_str());
+      LOG_INFO("Linking shader program %s was successful.\n",name);
       deleteShaderObjects();
     }
     else {
-      std::printf( "Linking shader program %s failed.\n",name.c_str() );
+      LOG_ERROR( "Linking shader program %s failed.\n",name );
       printLinkLog();
       throw std::runtime_error("GLSL Linking error");
     }
@@ -57,10 +64,10 @@ class ShaderProgram::I {
 
 
   GLint getUniformLocation(const String& uniformName) { 
-    GLint result = glGetUniformLocation( programNumber,uniformName.c_str() );
+    GLint result = GL_CHECK( glGetUniformLocation( program.get(),uniformName.c_str() ) );
     
     if(result == -1) {
-      std::printf( "Could not obtain uniform location \"%s\".\n",uniformName.c_str() );
+      LOG_ERROR( "Could not obtain uniform location \"%s\".\n",uniformName );
       throw std::runtime_error("glGetUniformLocation error");
     }
 
@@ -68,19 +75,20 @@ class ShaderProgram::I {
   }
   
   void activate() {
-    glUseProgram(programNumber);
+    GL_CHECK( glUseProgram(program.get()) );
   }
 
   void destroyProgram() {
-    glDeleteProgram(programNumber);
-    programNumber = 0;
+    //The program is deleted by the render thread after the frames that may use it are finished.
+    program.reset();
   }
 
 
  private:
   static constexpr unsigned char NUMBER_OF_ATTRIBUTES_RESERVED = 10;
   
-  GLuint programNumber{0}, vertexShader{0},fragmentShader{0};
+  ProgramHandle program;
+  GLuint vertexShader{0},fragmentShader{0};
   String name;
   
 
@@ -95,9 +103,9 @@ class ShaderProgram::I {
   void fillShader(const GLuint& shader,const String& code, bool isVertex) {
     GLint length = code.length();
     const GLchar * source = (const GLchar *) code.c_str();
-    glShaderSource(shader,1,&source,&length);
+    GL_CHECK( glShaderSource(shader,1,&source,&length) );
 
-    glCompileShader(shader);
+    GL_CHECK( glCompileShader(shader) );
 
     checkCompilation(shader,isVertex);
   }
@@ -112,12 +120,12 @@ class ShaderProgram::I {
     }
     
     GLint isCompiled = GL_FALSE;
-    glGetShaderiv(shader,GL_COMPILE_STATUS,&isCompiled);
+    GL_CHECK( glGetShaderiv(shader,GL_COMPILE_STATUS,&isCompiled) );
     if(isCompiled == GL_TRUE) {
-      std::printf("  compilation of %s shader was successful.\n",text);
+      LOG_INFO("  compilation of %s shader was successful.\n",text);
     }
     else {
-      std::printf("  Could not compile the %s shader.\n",text);
+      LOG_ERROR("  Could not compile the %s shader.\n",text);
       std::string error = "Could not compile ";
       error += name;
       printCompileLog(shader);
@@ -127,12 +135,36 @@ class ShaderProgram::I {
 
   void printCompileLog(const GLuint& shader) {
     GLint length; 
-    glGetShaderiv(shader,GL_INFO_LOG_LENGTH,&length);
+    GL_CHECK( glGetShaderiv(shader,GL_INFO_LOG_LENGTH,&length) );
     auto container = createInfoLogContainer(length);
     char * infoLog = container.data();
     
-    glGetShaderInfoLog(shader,(GLsizei) length,NULL,infoLog); 
-    std::printf("Compile Info Log: %s\n",infoLog);
+    GL_CHECK( glGetShaderInfoLog(shader,(GLsizei) length,NULL,infoLog) ); 
+    logInfoLog("Compile Info Log:",infoLog);
+  }
+
+  void logInfoLog(const char * title, const char * infoLog) {
+    //Info logs can be longer than the string limit of a log message, so they are written line by
+    //line, and long lines in pieces.
+    const size_t PIECE_LENGTH = Logger::MAX_STRING_BYTES - 1;
+    LOG_ERROR("%s\n",title);
+
+    std::string line;
+    for(const char * c = infoLog; ; ++c) {
+      if(*c == '\n' || *c == '\0' || line.size() == PIECE_LENGTH) {
+        if( !line.empty() ) {
+          LOG_ERROR("  %s\n",line);
+          line.clear();
+        }
+        if(*c == '\0') {
+          return;
+        }
+        if(*c == '\n') {
+          continue;
+        }
+      }
+      line += *c;
+    }
   }
 
   std::vector<char> createInfoLogContainer(size_t length) {
@@ -142,10 +174,10 @@ class ShaderProgram::I {
   }
 
   void deleteShaderObjects() {
-    glDetachShader(programNumber,vertexShader);
-    glDetachShader(programNumber,fragmentShader);
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+    GL_CHECK( glDetachShader(program.get(),vertexShader) );
+    GL_CHECK( glDetachShader(program.get(),fragmentShader) );
+    GL_CHECK( glDeleteShader(vertexShader) );
+    GL_CHECK( glDeleteShader(fragmentShader) );
 
     vertexShader = 0;
     fragmentShader = 0;
@@ -154,12 +186,12 @@ class ShaderProgram::I {
 
   void printLinkLog() {
     GLint length; 
-    glGetProgramiv(programNumber,GL_INFO_LOG_LENGTH,&length);
+    GL_CHECK( glGetProgramiv(program.get(),GL_INFO_LOG_LENGTH,&length) );
     auto container = createInfoLogContainer(length);
     char * infoLog = container.data();
 
-    glGetProgramInfoLog(programNumber,(GLsizei) length,NULL,infoLog); 
-    std::printf("Link Info Log: %s\n",infoLog);
+    GL_CHECK( glGetProgramInfoLog(program.get(),(GLsizei) length,NULL,infoLog) ); 
+    logInfoLog("Link Info Log:",infoLog);
   }
 
   void checkAttributeBindings() {
@@ -168,13 +200,13 @@ class ShaderProgram::I {
     }
   }
   void checkAttributeBinding(const Attribute& a) {
-    GLint i =  glGetAttribLocation(programNumber,a.name.c_str());
+    GLint i = GL_CHECK( glGetAttribLocation( program.get(),a.name.c_str() ) );
     if(i == -1) {
       //This can happen if an attribute is declared in the .glsl file, but not used.
-      std::printf( "WARNING: Could not bind vertex attribute %s.\n",a.name.c_str() );
+      LOG_WARNING( "Could not bind vertex attribute %s.\n",a.name );
     }
     else if(a.index != (GLuint) i ) {
-      std::printf("Vertex attribute %s was bound to %d instead of %u",a.name.c_str(),i,a.index);
+      LOG_ERROR("Vertex attribute %s was bound to %d instead of %u\n",a.name,i,a.index);
       throw std::runtime_error("ShaderProgram: vertex attribute binding error");
     }
   }
@@ -21,7 +21,7 @@ class ShaderProgram {
   void link();
   GLint getUniformLocation(const String& uniformName);
   void activate();
-  void destroyProgram();
+  void destroyProgram(); //Optional, the destructor also releases the program.
 
  private:
   
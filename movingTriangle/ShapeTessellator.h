@@ -0,0 +1,469 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <vector>
+#include <unordered_map>
+#include <atomic>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#include "AttributeContainer.h"
+#include "IndexContainer.h"
+#include "SceneComponents.h"
+
+namespace ProjectName {
+
+class BezierPath {
+  //A closed outline of cubic Bézier segments; the end of the last segment is connected to the
+  //start by a straight line. Every change gives the path a new id, which ShapeTessellator uses
+  //as the key of its cached triangles, so a changed path is never drawn from a stale entry.
+ public:
+  class Point {
+   public:
+    float x, y;
+  };
+
+  BezierPath() : id( newId() ) {
+
+  }
+
+  void moveTo(float x, float y) {
+    points.clear();
+    points.push_back({x,y});
+    id = newId();
+  }
+
+  void cubicTo(float c1x, float c1y, float c2x, float c2y, float x, float y) {
+    if( points.empty() ) {
+      throw std::runtime_error("BezierPath::cubicTo() before moveTo().");
+    }
+    points.push_back({c1x,c1y});
+    points.push_back({c2x,c2y});
+    points.push_back({x,y});
+    id = newId();
+  }
+
+  size_t getSegmentCount() const {
+    return points.empty() ? 0 : (points.size() - 1)/3;
+  }
+
+  const Point * getSegment(size_t i) const { //The start, the two control points and the end.
+    return &points[i*3];
+  }
+
+  uint64_t getId() const {
+    return id;
+  }
+
+ private:
+  std::vector<Point> points;
+  uint64_t id;
+
+  static uint64_t newId() {
+    static std::atomic<uint64_t> next{1};
+    return next++;
+  }
+};
+
+class ShapeVertex {
+  //The layout of an AttributeContainer with a FLOAT TWO position and an UNSIGNED_BYTE FOUR
+  //normalized color, like the one of ParticleSystem.
+ public:
+  float x, y;
+  Color color;
+};
+
+static_assert(sizeof(ShapeVertex) == 12,"ShapeVertex has to match the attributes.");
+
+class ShapeTessellator {
+  //Fills circles, pie slices, rounded rectangles and BezierPaths with triangles, as many as their
+  //size on screen needs. Every curve is replaced by chords that are at most the tolerance in
+  //pixels away from it: a chord of angle a on a circle of r pixels is r*(1 - cos(a/2)) away, so a
+  //circle needs pi/acos(1 - tolerance/r) segments, and a cubic Bézier segment needs
+  //sqrt( 0.75*L/tolerance ) by Wang's formula, with L the longest second difference of its
+  //points in pixels. A fixed number of segments is too coarse for large shapes and wasted on
+  //small ones; getStatistics() counts the triangles of both.
+  //The shapes are appended to one list of indexed triangles until clear(). write() puts it into
+  //an AttributeContainer and an IndexContainer for static geometry, writeVertices() into a
+  //streaming AttributeContainer as GL_TRIANGLES without indices.
+  //The unit circles are cached per segment count, and the triangles of a path per id and size.
+  //The size is rounded up to a quarter octave, so a path that is animated in size is mostly
+  //drawn from the cache, with at most 19% more triangles than it needs.
+ public:
+  static constexpr unsigned int FIXED_CIRCLE_SEGMENTS = 64; //The fixed tessellation.
+  static constexpr unsigned int FIXED_CURVE_SEGMENTS = 16; //Per Bézier segment.
+  static constexpr unsigned int MIN_CIRCLE_SEGMENTS = 8;
+  static constexpr unsigned int MAX_CIRCLE_SEGMENTS = 1024;
+  static constexpr unsigned int MAX_CURVE_SEGMENTS = 256;
+  static constexpr size_t MAX_CACHED_PATHS = 256; //The cache is emptied when it is full.
+
+  class Statistics {
+   public:
+    size_t triangles{0};
+    size_t fixedTriangles{0}; //With FIXED_CIRCLE_SEGMENTS and FIXED_CURVE_SEGMENTS instead.
+    size_t pathCacheHits{0}, pathCacheMisses{0};
+  };
+
+  void setTolerance(float pixels) { //0.25 by default.
+    if( !(pixels > 0) ) {
+      throw std::runtime_error("ShapeTessellator::setTolerance() requires a positive tolerance.");
+    }
+    tolerance = pixels;
+  }
+
+  void setPixelsPerUnit(float pixels) { //From the coordinates of the shapes to the screen.
+    pixelsPerUnit = pixels;
+  }
+
+  unsigned int getCircleSegments(float radius) const {
+    //A multiple of 4, so that the corners of rounded rectangles are quarters of it.
+    float a = getMaxChordAngle(radius);
+    unsigned int n = a > 0 ? (unsigned int) std::ceil(TWO_PI/a) : MIN_CIRCLE_SEGMENTS;
+    n = std::min( std::max(n,(unsigned int) MIN_CIRCLE_SEGMENTS),
+      (unsigned int) MAX_CIRCLE_SEGMENTS
+    );
+    return (n + 3) & ~3u;
+  }
+
+  void addCircle(float x, float y, float radius, Color color) {
+    unsigned int n = getCircleSegments(radius);
+    const std::vector<float>& unit = getUnitCircle(n);
+    uint16_t center = addVertex(x,y,color);
+    for(unsigned int i = 0; i < n; ++i) {
+      addVertex(x + radius*unit[i*2],y + radius*unit[i*2 + 1],color);
+    }
+    addFan(center,n,true);
+    statistics.fixedTriangles += FIXED_CIRCLE_SEGMENTS;
+  }
+
+  void addArc(float x, float y, float radius, float startAngle, float sweep, Color color) {
+    //A pie slice from startAngle counterclockwise by sweep radians; negative is clockwise.
+    float a = getMaxChordAngle(radius);
+    float absoluteSweep = std::min( std::fabs(sweep),(float) TWO_PI );
+    unsigned int n = a > 0 ? (unsigned int) std::ceil(absoluteSweep/a) : 1;
+    n = std::min( std::max(n,1u),(unsigned int) MAX_CIRCLE_SEGMENTS );
+
+    uint16_t center = addVertex(x,y,color);
+    //The directions are rotated by one step at a time, in double so that the error does not add
+    //up over many steps.
+    double step = (double) sweep/n;
+    double c = std::cos(startAngle), s = std::sin(startAngle);
+    double stepC = std::cos(step), stepS = std::sin(step);
+    for(unsigned int i = 0; i <= n; ++i) {
+      addVertex( x + radius*(float) c,y + radius*(float) s,color );
+      double nextC = c*stepC - s*stepS;
+      s = c*stepS + s*stepC;
+      c = nextC;
+    }
+    addFan(center,n + 1,false);
+    statistics.fixedTriangles += std::max( (size_t) std::ceil(FIXED_CIRCLE_SEGMENTS*
+      absoluteSweep/TWO_PI),(size_t) 1
+    );
+  }
+
+  void addRoundedRectangle(float x0, float y0, float x1, float y1, float radius, Color color) {
+    //Between the corners (x0,y0) and (x1,y1). The radius is limited to half the shorter side.
+    if(x0 > x1) {
+      std::swap(x0,x1);
+    }
+    if(y0 > y1) {
+      std::swap(y0,y1);
+    }
+    radius = std::min( std::max(radius,0.0f),std::min(x1 - x0,y1 - y0)*0.5f );
+    unsigned int n = radius > 0 ? getCircleSegments(radius) : 0;
+    unsigned int quarter = n/4;
+    const float centers[4][2] = {
+      {x1 - radius,y1 - radius},{x0 + radius,y1 - radius},
+      {x0 + radius,y0 + radius},{x1 - radius,y0 + radius}
+    };
+
+    uint16_t center = addVertex( (x0 + x1)*0.5f,(y0 + y1)*0.5f,color );
+    for(unsigned int corner = 0; corner < 4; ++corner) {
+      float cx = centers[corner][0], cy = centers[corner][1];
+      if(n == 0) {
+        addVertex(cx,cy,color);
+        continue;
+      }
+      const std::vector<float>& unit = getUnitCircle(n);
+      for(unsigned int j = 0; j <= quarter; ++j) {
+        unsigned int i = (corner*quarter + j) % n;
+        addVertex(cx + radius*unit[i*2],cy + radius*unit[i*2 + 1],color);
+      }
+    }
+    addFan(center,n == 0 ? 4 : 4*(quarter + 1),true);
+    statistics.fixedTriangles += radius > 0 ? 4*(FIXED_CIRCLE_SEGMENTS/4 + 1) : 4;
+  }
+
+  void addPath(const BezierPath& path, float x, float y, float scale, Color color) {
+    //The path is scaled by scale and then moved by (x,y). It has to be a simple polygon after
+    //flattening; self-intersecting outlines are filled, but not exactly.
+    if(path.getSegmentCount() == 0) {
+      return;
+    }
+    int level = getScaleLevel( std::fabs(scale)*pixelsPerUnit );
+    const CachedPath& cached = getPath(path,level);
+    uint16_t first = (uint16_t) vertices.size();
+    for(const BezierPath::Point& p : cached.points) {
+      addVertex(x + p.x*scale,y + p.y*scale,color);
+    }
+    for(uint16_t i : cached.indices) {
+      indices.push_back(first + i);
+    }
+    statistics.triangles += cached.indices.size()/3;
+    //A polygon of n points is n - 2 triangles.
+    statistics.fixedTriangles += path.getSegmentCount()*FIXED_CURVE_SEGMENTS - 2;
+  }
+
+  void clear() { //Starts a new list of triangles; the caches and the statistics are kept.
+    vertices.clear();
+    indices.clear();
+  }
+
+  const std::vector<ShapeVertex>& getVertices() const {
+    return vertices;
+  }
+
+  const std::vector<uint16_t>& getIndices() const {
+    return indices;
+  }
+
+  void write(AttributeContainer& attributes, IndexContainer& indices) const {
+    //Into empty containers with a FLOAT TWO position and an UNSIGNED_BYTE FOUR color, before
+    //they are initialized.
+    attributes.reserve( vertices.size() );
+    for(const ShapeVertex& v : vertices) {
+      attributes.addAttribute<GLfloat>(0,{v.x,v.y});
+      attributes.addAttribute<GLubyte>(1,{v.color.r,v.color.g,v.color.b,v.color.a});
+    }
+    indices.reserve( this->indices.size() );
+    for(size_t i = 0; i < this->indices.size(); i += 3) {
+      const uint16_t * t = &this->indices[i];
+      indices.add({t[0],t[1],t[2]});
+    }
+  }
+
+  size_t writeVertices(AttributeContainer& container) const {
+    //Returns the number of vertices, which can be passed to AttributeContainer::stream.
+    if( container.getVertexSize() != sizeof(ShapeVertex) ||
+      container.getAttributeOffset(1) != offsetof(ShapeVertex,color) )
+    {
+      throw std::runtime_error("ShapeTessellator needs vertices of two floats and four bytes.");
+    }
+    if( indices.size() > container.getCapacity() ) {
+      throw std::runtime_error("ShapeTessellator::writeVertices() needs a larger container.");
+    }
+    char * data = container.getVertexData();
+    for(uint16_t i : indices) {
+      std::memcpy( data,&vertices[i],sizeof(ShapeVertex) );
+      data += sizeof(ShapeVertex);
+    }
+    return indices.size();
+  }
+
+  const Statistics& getStatistics() const {
+    return statistics;
+  }
+
+  void resetStatistics() {
+    statistics = Statistics();
+  }
+
+ private:
+  static constexpr float TWO_PI = 6.2831853f;
+  static constexpr int LEVELS_PER_OCTAVE = 4;
+  static constexpr int MIN_LEVEL = -128, MAX_LEVEL = 127;
+
+  class CachedPath {
+   public:
+    std::vector<BezierPath::Point> points; //In the coordinates of the path.
+    std::vector<uint16_t> indices;
+  };
+
+  float tolerance{0.25f};
+  float pixelsPerUnit{1};
+  std::vector<ShapeVertex> vertices;
+  std::vector<uint16_t> indices;
+  std::unordered_map<unsigned int,std::vector<float>> unitCircles; //Cosine and sine pairs.
+  std::unordered_map<uint64_t,CachedPath> paths; //By id and level, see getPath.
+  Statistics statistics;
+
+  float getMaxChordAngle(float radius) const {
+    //0 if any chord is close enough, which is the case for circles smaller than a pixel.
+    float pixels = std::fabs(radius)*pixelsPerUnit;
+    if(pixels <= tolerance) {
+      return 0;
+    }
+    return 2*std::acos(1 - tolerance/pixels);
+  }
+
+  uint16_t addVertex(float x, float y, Color color) {
+    if(vertices.size() > UINT16_MAX) {
+      throw std::runtime_error("ShapeTessellator: more vertices than 16-bit indices can address.");
+    }
+    vertices.push_back({x,y,color});
+    return (uint16_t) (vertices.size() - 1);
+  }
+
+  void addFan(uint16_t center, unsigned int ringVertices, bool closed) {
+    //The ring follows the center.
+    unsigned int triangles = closed ? ringVertices : ringVertices - 1;
+    for(unsigned int i = 0; i < triangles; ++i) {
+      indices.push_back(center);
+      indices.push_back( (uint16_t) (center + 1 + i) );
+      indices.push_back( (uint16_t) (center + 1 + (i + 1) % ringVertices) );
+    }
+    statistics.triangles += triangles;
+  }
+
+  const std::vector<float>& getUnitCircle(unsigned int segments) {
+    std::vector<float>& unit = unitCircles[segments];
+    if( unit.empty() ) {
+      unit.resize(segments*2);
+      for(unsigned int i = 0; i < segments; ++i) {
+        double a = 6.283185307179586*i/segments;
+        unit[i*2] = (float) std::cos(a);
+        unit[i*2 + 1] = (float) std::sin(a);
+      }
+    }
+    return unit;
+  }
+
+  static int getScaleLevel(float pixelsPerPathUnit) {
+    //The scale rounded up to the next of LEVELS_PER_OCTAVE steps per octave.
+    if( !(pixelsPerPathUnit > 0) ) {
+      return MIN_LEVEL;
+    }
+    float level = std::ceil( std::log2(pixelsPerPathUnit)*LEVELS_PER_OCTAVE );
+    return (int) std::min( std::max(level,(float) MIN_LEVEL),(float) MAX_LEVEL );
+  }
+
+  const CachedPath& getPath(const BezierPath& path, int level) {
+    uint64_t key = path.getId()*(MAX_LEVEL - MIN_LEVEL + 1) + (uint64_t) (level - MIN_LEVEL);
+    auto found = paths.find(key);
+    if( found != paths.end() ) {
+      ++statistics.pathCacheHits;
+      return found->second;
+    }
+    ++statistics.pathCacheMisses;
+    if(paths.size() >= MAX_CACHED_PATHS) {
+      paths.clear();
+    }
+    CachedPath& cached = paths[key];
+    float scale = std::exp2( (float) level/LEVELS_PER_OCTAVE );
+    flatten(path,tolerance/scale,cached.points);
+    triangulate(cached.points,cached.indices);
+    return cached;
+  }
+
+  static void flatten(const BezierPath& path, float localTolerance,
+    std::vector<BezierPath::Point>& result)
+  {
+    using Point = BezierPath::Point;
+    result.clear();
+    for(size_t s = 0; s < path.getSegmentCount(); ++s) {
+      const Point * p = path.getSegment(s);
+      float l = 0;
+      for(int i = 0; i < 2; ++i) {
+        float dx = p[i].x - 2*p[i + 1].x + p[i + 2].x;
+        float dy = p[i].y - 2*p[i + 1].y + p[i + 2].y;
+        l = std::max( l,std::sqrt(dx*dx + dy*dy) );
+      }
+      float segments = std::ceil( std::sqrt(0.75f*l/localTolerance) );
+      unsigned int n = (unsigned int) std::min( std::max(segments,1.0f),
+        (float) MAX_CURVE_SEGMENTS
+      );
+      for(unsigned int i = s == 0 ? 0 : 1; i <= n; ++i) {
+        float t = (float) i/n, u = 1 - t;
+        float b0 = u*u*u, b1 = 3*u*u*t, b2 = 3*u*t*t, b3 = t*t*t;
+        Point q{
+          b0*p[0].x + b1*p[1].x + b2*p[2].x + b3*p[3].x,
+          b0*p[0].y + b1*p[1].y + b2*p[2].y + b3*p[3].y
+        };
+        if( result.empty() || q.x != result.back().x || q.y != result.back().y ) {
+          result.push_back(q);
+        }
+      }
+    }
+    if( result.size() > 1 && result.front().x == result.back().x &&
+      result.front().y == result.back().y )
+    {
+      result.pop_back();
+    }
+    if(result.size() > UINT16_MAX) {
+      throw std::runtime_error("ShapeTessellator: a path has too many points.");
+    }
+  }
+
+  static float cross(const BezierPath::Point& a, const BezierPath::Point& b,
+    const BezierPath::Point& c)
+  {
+    return (b.x - a.x)*(c.y - a.y) - (b.y - a.y)*(c.x - a.x);
+  }
+
+  static void triangulate(const std::vector<BezierPath::Point>& points,
+    std::vector<uint16_t>& result)
+  {
+    //Ear clipping, which is quadratic in the number of points; the result is cached.
+    result.clear();
+    if(points.size() < 3) {
+      return;
+    }
+    float area = 0;
+    for(size_t i = 0, j = points.size() - 1; i < points.size(); j = i++) {
+      area += points[j].x*points[i].y - points[i].x*points[j].y;
+    }
+    float orientation = area < 0 ? -1.0f : 1.0f;
+
+    std::vector<uint16_t> remaining( points.size() );
+    for(size_t i = 0; i < remaining.size(); ++i) {
+      remaining[i] = (uint16_t) i;
+    }
+    size_t i = 0, failures = 0;
+    while(remaining.size() > 3) {
+      size_t m = remaining.size();
+      i %= m;
+      uint16_t a = remaining[(i + m - 1) % m], b = remaining[i], c = remaining[(i + 1) % m];
+      //After a whole round without an ear the outline intersects itself, and a vertex is clipped
+      //anyway so that the loop ends.
+      if( failures >= m || isEar(points,remaining,a,b,c,orientation) ) {
+        result.insert( result.end(),{a,b,c} );
+        remaining.erase(remaining.begin() + i);
+        failures = 0;
+      }
+      else {
+        ++i;
+        ++failures;
+      }
+    }
+    result.insert( result.end(),{remaining[0],remaining[1],remaining[2]} );
+  }
+
+  static bool isEar(const std::vector<BezierPath::Point>& points,
+    const std::vector<uint16_t>& remaining, uint16_t a, uint16_t b, uint16_t c,
+    float orientation)
+  {
+    const BezierPath::Point &pa = points[a], &pb = points[b], &pc = points[c];
+    if(cross(pa,pb,pc)*orientation <= 0) {
+      return false; //Reflex or degenerate.
+    }
+    for(uint16_t r : remaining) {
+      if(r == a || r == b || r == c) {
+        continue;
+      }
+      const BezierPath::Point& p = points[r];
+      if( cross(pa,pb,p)*orientation >= 0 && cross(pb,pc,p)*orientation >= 0 &&
+        cross(pc,pa,p)*orientation >= 0 )
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+}
@@ -0,0 +1,347 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+#include <cstddef>
+
+#if defined(__SSE2__) || defined(_M_X64)
+  #include <emmintrin.h>
+  #define PROJECTNAME_CULLING_SSE
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  #include <arm_neon.h>
+  #define PROJECTNAME_CULLING_NEON
+#endif
+
+#include "BoundingBox2D.h"
+#include "JobSystem.h"
+
+namespace ProjectName {
+
+class BoxCuller {
+  //Tests boxes stored as four arrays (structure of arrays) against a viewport, four boxes per
+  //instruction with SSE2 or NEON, and writes the handles of the visible ones. The output is
+  //written without branches: every handle is stored, and the position only advances when the
+  //box is visible, so out needs room for count handles.
+ public:
+  static size_t cull(const BoundingBox2D& viewport, const float * minX, const float * minY,
+    const float * maxX, const float * maxY, const uint32_t * handles, size_t count,
+    uint32_t * out
+  ) {
+    size_t i = 0, n = 0;
+#if defined(PROJECTNAME_CULLING_SSE)
+    const __m128 viewMinX = _mm_set1_ps(viewport.minX), viewMaxX = _mm_set1_ps(viewport.maxX);
+    const __m128 viewMinY = _mm_set1_ps(viewport.minY), viewMaxY = _mm_set1_ps(viewport.maxY);
+    for(; i + 4 <= count; i += 4) {
+      __m128 x = _mm_and_ps(
+        _mm_cmpge_ps(_mm_loadu_ps(maxX + i),viewMinX),_mm_cmple_ps(_mm_loadu_ps(minX + i),viewMaxX)
+      );
+      __m128 y = _mm_and_ps(
+        _mm_cmpge_ps(_mm_loadu_ps(maxY + i),viewMinY),_mm_cmple_ps(_mm_loadu_ps(minY + i),viewMaxY)
+      );
+      unsigned int visible = (unsigned int) _mm_movemask_ps( _mm_and_ps(x,y) );
+      n = compact(visible,handles + i,out,n);
+    }
+#elif defined(PROJECTNAME_CULLING_NEON)
+    const float32x4_t viewMinX = vdupq_n_f32(viewport.minX), viewMaxX = vdupq_n_f32(viewport.maxX);
+    const float32x4_t viewMinY = vdupq_n_f32(viewport.minY), viewMaxY = vdupq_n_f32(viewport.maxY);
+    const uint32x4_t bits = {1,2,4,8};
+    for(; i + 4 <= count; i += 4) {
+      uint32x4_t x = vandq_u32(
+        vcgeq_f32(vld1q_f32(maxX + i),viewMinX),vcleq_f32(vld1q_f32(minX + i),viewMaxX)
+      );
+      uint32x4_t y = vandq_u32(
+        vcgeq_f32(vld1q_f32(maxY + i),viewMinY),vcleq_f32(vld1q_f32(minY + i),viewMaxY)
+      );
+      uint32x4_t m = vandq_u32(vandq_u32(x,y),bits);
+      uint32x2_t pairs = vorr_u32( vget_low_u32(m),vget_high_u32(m) );
+      unsigned int visible = vget_lane_u32(pairs,0) | vget_lane_u32(pairs,1);
+      n = compact(visible,handles + i,out,n);
+    }
+#endif
+    for(; i < count; ++i) {
+      out[n] = handles[i];
+      n += maxX[i] >= viewport.minX && minX[i] <= viewport.maxX &&
+        maxY[i] >= viewport.minY && minY[i] <= viewport.maxY;
+    }
+    return n;
+  }
+
+ private:
+  static size_t compact(unsigned int visible, const uint32_t * handles, uint32_t * out, size_t n) {
+    for(unsigned int j = 0; j < 4; ++j) {
+      out[n] = handles[j];
+      n += (visible >> j) & 1;
+    }
+    return n;
+  }
+};
+
+class SpatialGrid {
+  //A loose uniform grid for view culling of many moving 2D objects. An object belongs to the cell
+  //that contains the center of its box, so moving it costs a few stores, and only when the center
+  //crosses into another cell, a swap with the last object of the old cell. A cell stores the boxes
+  //of its objects as four float arrays, which BoxCuller tests four at a time.
+  //Because boxes stick out of their cell, cull() visits the cells under the viewport grown by the
+  //largest half size that an object has had. Cells whose whole loose area lies inside the
+  //viewport are accepted without tests. Positions outside of the world box are kept in the border
+  //cells, which is slower but still correct. The cell size should be about the size of the
+  //typical object, or a bit larger.
+ public:
+  using Handle = uint32_t;
+
+  SpatialGrid(const BoundingBox2D& world, float cellSize) : world(world), cellSize(cellSize) {
+    if( world.isEmpty() || !(cellSize > 0) ) {
+      throw std::invalid_argument("SpatialGrid needs a world box and a positive cell size");
+    }
+    columns = std::max( 1,(int) ( (world.maxX - world.minX)/cellSize ) + 1 );
+    rows = std::max( 1,(int) ( (world.maxY - world.minY)/cellSize ) + 1 );
+    cells.resize( (size_t) columns*rows );
+  }
+
+  Handle insert(const BoundingBox2D& box) {
+    Handle h;
+    if( freeHandles.empty() ) {
+      h = (Handle) locations.size();
+      locations.emplace_back();
+    }
+    else {
+      h = freeHandles.back();
+      freeHandles.pop_back();
+    }
+    growMargins(box);
+    add(h,getCellIndex(box),box);
+    ++objectCount;
+    return h;
+  }
+
+  void remove(Handle h) {
+    removeFromCell( getLocation(h) );
+    locations[h].cell = FREE;
+    freeHandles.push_back(h);
+    --objectCount;
+  }
+
+  void move(Handle h, const BoundingBox2D& box) {
+    Location& l = getLocation(h);
+    growMargins(box);
+    uint32_t cell = getCellIndex(box);
+    if(cell == l.cell) {
+      cells[cell].set(l.slot,box);
+      return;
+    }
+    removeFromCell(l);
+    add(h,cell,box);
+  }
+
+  size_t size() const {
+    return objectCount;
+  }
+
+  void cull(const BoundingBox2D& viewport, std::vector<Handle>& visible,
+    JobSystem * jobs = nullptr
+  ) {
+    //Writes the handles of the objects whose boxes intersect the viewport, in the order of the
+    //cells. With a JobSystem the cells are split between its threads; the result is the same.
+    visible.clear();
+    collectCells(viewport);
+    if( visitedCells.empty() ) {
+      return;
+    }
+
+    size_t pieces = 1;
+    if(jobs != nullptr && objectsInVisitedCells >= PARALLEL_OBJECTS) {
+      pieces = std::min( visitedCells.size(),(size_t) jobs->getThreadCount()*PIECES_PER_THREAD );
+    }
+    if( pieceResults.size() < pieces ) {
+      pieceResults.resize(pieces);
+    }
+
+    if(pieces == 1) {
+      cullCells(viewport,0,visitedCells.size(),visible);
+      return;
+    }
+    jobs->parallelFor(0,pieces,1,[&](size_t begin, size_t end) {
+      for(size_t p = begin; p < end; ++p) {
+        size_t first = visitedCells.size()*p/pieces, last = visitedCells.size()*(p+1)/pieces;
+        cullCells(viewport,first,last,pieceResults[p]);
+      }
+    });
+    for(size_t p = 0; p < pieces; ++p) {
+      visible.insert( visible.end(),pieceResults[p].begin(),pieceResults[p].end() );
+    }
+  }
+
+ private:
+  static constexpr uint32_t FREE = ~0u;
+  static constexpr size_t PARALLEL_OBJECTS = 16384; //Fewer objects are culled on one thread.
+  static constexpr size_t PIECES_PER_THREAD = 4;
+
+  class Location {
+   public:
+    uint32_t cell{FREE};
+    uint32_t slot{0};
+  };
+
+  class Cell {
+   public:
+    std::vector<float> minX, minY, maxX, maxY;
+    std::vector<Handle> handles;
+
+    void push(Handle h, const BoundingBox2D& b) {
+      minX.push_back(b.minX);
+      minY.push_back(b.minY);
+      maxX.push_back(b.maxX);
+      maxY.push_back(b.maxY);
+      handles.push_back(h);
+    }
+
+    void set(uint32_t slot, const BoundingBox2D& b) {
+      minX[slot] = b.minX;
+      minY[slot] = b.minY;
+      maxX[slot] = b.maxX;
+      maxY[slot] = b.maxY;
+    }
+
+    Handle swapRemove(uint32_t slot) {
+      //Returns the handle that now occupies slot, or FREE if slot was the last one.
+      size_t last = handles.size() - 1;
+      Handle moved = FREE;
+      if(slot != last) {
+        minX[slot] = minX[last];
+        minY[slot] = minY[last];
+        maxX[slot] = maxX[last];
+        maxY[slot] = maxY[last];
+        handles[slot] = handles[last];
+        moved = handles[slot];
+      }
+      minX.pop_back();
+      minY.pop_back();
+      maxX.pop_back();
+      maxY.pop_back();
+      handles.pop_back();
+      return moved;
+    }
+
+    size_t size() const {
+      return handles.size();
+    }
+  };
+
+  class VisitedCell {
+   public:
+    uint32_t cell;
+    bool inside; //All of its objects are visible.
+  };
+
+  BoundingBox2D world;
+  float cellSize;
+  int columns{1}, rows{1};
+  std::vector<Cell> cells;
+  std::vector<Location> locations;
+  std::vector<Handle> freeHandles;
+  size_t objectCount{0};
+  float marginX{0}, marginY{0}; //The largest half size of an object so far.
+
+  std::vector<VisitedCell> visitedCells;
+  size_t objectsInVisitedCells{0};
+  std::vector< std::vector<Handle> > pieceResults;
+
+  Location& getLocation(Handle h) {
+    if(h >= locations.size() || locations[h].cell == FREE) {
+      throw std::out_of_range("SpatialGrid: unknown handle");
+    }
+    return locations[h];
+  }
+
+  void growMargins(const BoundingBox2D& b) {
+    marginX = std::max( marginX,(b.maxX - b.minX)*0.5f );
+    marginY = std::max( marginY,(b.maxY - b.minY)*0.5f );
+  }
+
+  int getColumn(float x) const {
+    int c = (int) ( (x - world.minX)/cellSize );
+    return std::max( 0,std::min(c,columns - 1) );
+  }
+
+  int getRow(float y) const {
+    int r = (int) ( (y - world.minY)/cellSize );
+    return std::max( 0,std::min(r,rows - 1) );
+  }
+
+  uint32_t getCellIndex(const BoundingBox2D& b) const {
+    float x = (b.minX + b.maxX)*0.5f, y = (b.minY + b.maxY)*0.5f;
+    return (uint32_t) ( getRow(y)*columns + getColumn(x) );
+  }
+
+  void add(Handle h, uint32_t cell, const BoundingBox2D& box) {
+    Location& l = locations[h];
+    l.cell = cell;
+    l.slot = (uint32_t) cells[cell].size();
+    cells[cell].push(h,box);
+  }
+
+  void removeFromCell(const Location& l) {
+    Handle moved = cells[l.cell].swapRemove(l.slot);
+    if(moved != FREE) {
+      locations[moved].slot = l.slot;
+    }
+  }
+
+  void collectCells(const BoundingBox2D& viewport) {
+    visitedCells.clear();
+    objectsInVisitedCells = 0;
+    //A center farther than the margin from the viewport belongs to an invisible box.
+    int firstColumn = getColumn(viewport.minX - marginX);
+    int lastColumn = getColumn(viewport.maxX + marginX);
+    int firstRow = getRow(viewport.minY - marginY);
+    int lastRow = getRow(viewport.maxY + marginY);
+    for(int r = firstRow; r <= lastRow; ++r) {
+      for(int c = firstColumn; c <= lastColumn; ++c) {
+        uint32_t index = (uint32_t) (r*columns + c);
+        if(cells[index].size() == 0) {
+          continue;
+        }
+        visitedCells.push_back( VisitedCell{index,isInside(viewport,r,c)} );
+        objectsInVisitedCells += cells[index].size();
+      }
+    }
+  }
+
+  bool isInside(const BoundingBox2D& viewport, int r, int c) const {
+    //Border cells also hold the objects outside of the world, so they are always tested.
+    if(r == 0 || c == 0 || r == rows - 1 || c == columns - 1) {
+      return false;
+    }
+    float x = world.minX + c*cellSize, y = world.minY + r*cellSize;
+    BoundingBox2D loose(x - marginX,y - marginY,x + cellSize + marginX,y + cellSize + marginY);
+    return viewport.contains(loose);
+  }
+
+  void cullCells(const BoundingBox2D& viewport, size_t begin, size_t end,
+    std::vector<Handle>& out
+  ) {
+    size_t n = 0;
+    for(size_t i = begin; i < end; ++i) {
+      n += cells[visitedCells[i].cell].size();
+    }
+    out.resize(n);
+    n = 0;
+    for(size_t i = begin; i < end; ++i) {
+      const Cell& cell = cells[visitedCells[i].cell];
+      if(visitedCells[i].inside) {
+        std::copy( cell.handles.begin(),cell.handles.end(),out.begin() + n );
+        n += cell.size();
+      }
+      else {
+        n += BoxCuller::cull(viewport,cell.minX.data(),cell.minY.data(),cell.maxX.data(),
+          cell.maxY.data(),cell.handles.data(),cell.size(),out.data() + n
+        );
+      }
+    }
+    out.resize(n);
+  }
+};
+
+}
@@ -0,0 +1,311 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+
+#include "Float4.h"
+#include "JobSystem.h"
+#include "AttributeContainer.h"
+#include "SceneComponents.h"
+#include "Profiler.h"
+
+namespace ProjectName {
+
+class StrokeBatch {
+  //Polylines in clip space, such as plots and traces that change every frame, drawn as lines of
+  //a width in pixels with one GL_TRIANGLE_STRIP for the whole batch. The anti-aliasing needs no
+  //multisampling: every point has four vertices across the line, and the outer two are
+  //FEATHER pixels further out with an alpha of 0, so the edges fade out when the strip is drawn
+  //with blending. The strip crosses the line in a zigzag, one segment left to right and the next
+  //right to left, so that a segment takes 7 vertices; the triangles that turn around at the
+  //edges have an alpha of 0 everywhere. The polylines are joined by two repeated vertices.
+  //The joins are miters, shortened to the miter limit at sharp corners, and the caps are butt or
+  //square. The ends are not feathered.
+  //writeVertices() works on the points four at a time with Float4, in parallel on a JobSystem:
+  //the directions of the segments in one pass, the miters in the next, and then the vertices,
+  //which go directly into an AttributeContainer with a FLOAT TWO position and an UNSIGNED_BYTE
+  //FOUR normalized color, like the one of ParticleSystem.
+ public:
+  static constexpr float FEATHER = 1; //Pixels.
+  static constexpr size_t GRAIN_POINTS = 16384; //Per piece of work on a JobSystem.
+
+  enum class Cap {
+    BUTT,
+    SQUARE //Extended by half the width.
+  };
+
+  class Style {
+   public:
+    float width{1}; //Pixels; thinner lines are drawn one pixel wide, but fainter.
+    Color color;
+    Cap cap{Cap::BUTT};
+  };
+
+  StrokeBatch() {
+    clear();
+  }
+
+  void setViewportSize(int width, int height) { //In pixels; 2x2 by default.
+    pixelsPerUnitX = width*0.5f;
+    pixelsPerUnitY = height*0.5f;
+  }
+
+  void setMiterLimit(float limit) { //In half widths, at least 1; 4 by default.
+    miterLimit = std::max(limit,1.0f);
+  }
+
+  void clear() {
+    for(std::vector<float> * a : {&x,&y}) {
+      a->assign(PADDING,0);
+    }
+    polylines.clear();
+    vertexCount = 0;
+  }
+
+  void addPolyline(const float * px, const float * py, size_t count, const Style& style) {
+    //Lines of less than two points are not drawn.
+    if(count < 2) {
+      return;
+    }
+    Polyline p;
+    p.firstPoint = getPointCount();
+    p.pointCount = count;
+    p.firstVertex = vertexCount;
+    p.style = style;
+    x.insert(x.end(),px,px + count);
+    y.insert(y.end(),py,py + count);
+    vertexCount += getStripVertexCount(count) + ( polylines.empty() ? 0 : 2 );
+    polylines.push_back(p);
+  }
+
+  size_t getPointCount() const {
+    return x.size() - PADDING;
+  }
+
+  size_t getVertexCount() const {
+    return vertexCount;
+  }
+
+  size_t writeVertices(AttributeContainer& container, JobSystem * jobs = nullptr) {
+    //Returns the number of vertices, which can be passed to AttributeContainer::stream.
+    if( container.getVertexSize() != VERTEX_SIZE || container.getAttributeOffset(1) != 8 ) {
+      throw std::runtime_error("StrokeBatch needs vertices of two floats and four bytes.");
+    }
+    if( vertexCount > container.getCapacity() ) {
+      throw std::runtime_error("StrokeBatch::writeVertices() needs a larger container.");
+    }
+    if( polylines.empty() ) {
+      return 0;
+    }
+    PROFILE_SCOPE("StrokeBatch::writeVertices");
+    size_t n = getPointCount();
+    //The last group of four reads up to three points beyond the end.
+    x.resize(PADDING + n + PADDING,x.back());
+    y.resize(PADDING + n + PADDING,y.back());
+    for(std::vector<float> * a : {&ux,&uy,&mx,&my}) {
+      a->assign(PADDING + n + PADDING,0);
+    }
+
+    size_t groups = (n + 3)/4;
+    forEachRange(jobs,groups,GRAIN_POINTS/4,[this](size_t begin, size_t end) {
+      computeDirections(begin*4,end*4);
+    });
+    for(const Polyline& p : polylines) {
+      //The last point has no segment of its own, and uses the one before.
+      size_t last = PADDING + p.firstPoint + p.pointCount - 1;
+      ux[last] = ux[last - 1];
+      uy[last] = uy[last - 1];
+    }
+    forEachRange(jobs,groups,GRAIN_POINTS/4,[this](size_t begin, size_t end) {
+      computeMiters(begin*4,end*4);
+    });
+    for(const Polyline& p : polylines) {
+      //The first point has no segment before it.
+      size_t first = PADDING + p.firstPoint;
+      mx[first] = -uy[first];
+      my[first] = ux[first];
+    }
+
+    char * vertices = container.getVertexData();
+    forEachRange(jobs,n,GRAIN_POINTS,[this,vertices](size_t begin, size_t end) {
+      writeSegments(begin,end,vertices);
+    });
+    for(size_t i = 1; i < polylines.size(); ++i) {
+      const Polyline& previous = polylines[i - 1];
+      size_t first = polylines[i].firstVertex;
+      size_t previousLast = previous.firstVertex + (i == 1 ? 0 : 2) +
+        getStripVertexCount(previous.pointCount) - 1;
+      std::memcpy(vertices + first*VERTEX_SIZE,vertices + previousLast*VERTEX_SIZE,VERTEX_SIZE);
+      std::memcpy(vertices + (first + 1)*VERTEX_SIZE,vertices + (first + 2)*VERTEX_SIZE,
+        VERTEX_SIZE
+      );
+    }
+
+    x.resize(PADDING + n);
+    y.resize(PADDING + n);
+    return vertexCount;
+  }
+
+ private:
+  static constexpr size_t VERTEX_SIZE = 12;
+  static constexpr size_t PADDING = 4; //Points before and after the arrays, see writeVertices.
+  static constexpr float MINIMUM_SQUARED_LENGTH = 1e-12f;
+
+  class Polyline {
+   public:
+    size_t firstPoint, pointCount;
+    size_t firstVertex;
+    Style style;
+  };
+
+  class CrossSection {
+   public:
+    float x[4], y[4]; //Left outer, left inner, right inner, right outer.
+  };
+
+  float pixelsPerUnitX{1}, pixelsPerUnitY{1};
+  float miterLimit{4};
+  //The points and, per point, the direction of the segment that starts there in pixels, and the
+  //miter for a half width of one pixel. Index i is point i - PADDING.
+  std::vector<float> x, y, ux, uy, mx, my;
+  std::vector<Polyline> polylines;
+  size_t vertexCount{0};
+
+  static size_t getStripVertexCount(size_t points) {
+    return 8 + 7*(points - 2);
+  }
+
+  template<class F>
+  static void forEachRange(JobSystem * jobs, size_t count, size_t grain, const F& function) {
+    if(jobs == nullptr || count <= grain) {
+      function(0,count);
+      return;
+    }
+    jobs->parallelFor(0,count,grain,[&function](size_t begin, size_t end) {
+      function(begin,end);
+    });
+  }
+
+  void computeDirections(size_t begin, size_t end) {
+    //The segments between the last point of a polyline and the first of the next are computed
+    //too, and replaced afterwards.
+    const Float4 sx = Float4::broadcast(pixelsPerUnitX), sy = Float4::broadcast(pixelsPerUnitY);
+    const Float4 minimum = Float4::broadcast(MINIMUM_SQUARED_LENGTH);
+    for(size_t i = PADDING + begin; i < PADDING + end; i += 4) {
+      Float4 dx = ( Float4::load(&x[i + 1]) - Float4::load(&x[i]) )*sx;
+      Float4 dy = ( Float4::load(&y[i + 1]) - Float4::load(&y[i]) )*sy;
+      Float4 inverseLength = Float4::max(dx*dx + dy*dy,minimum).reciprocalSqrt();
+      (dx*inverseLength).store(&ux[i]);
+      (dy*inverseLength).store(&uy[i]);
+    }
+  }
+
+  void computeMiters(size_t begin, size_t end) {
+    //The miter points along the sum of the left normals of the two segments, and is 1/cos of
+    //half the angle between them long. The normal of the second segment is weighted a little
+    //more, so that a line that turns back has a miter, too; if one of the segments has no
+    //length, the other one decides.
+    const Float4 weight = Float4::broadcast(1.001f);
+    const Float4 minimum = Float4::broadcast(MINIMUM_SQUARED_LENGTH);
+    const Float4 minimumCosine = Float4::broadcast(1/miterLimit);
+    for(size_t i = PADDING + begin; i < PADDING + end; i += 4) {
+      Float4 ax = Float4::load(&ux[i - 1]), ay = Float4::load(&uy[i - 1]);
+      Float4 bx = Float4::load(&ux[i]), by = Float4::load(&uy[i]);
+      Float4 nx = Float4::broadcast(0) - ay - by*weight;
+      Float4 ny = ax + bx*weight;
+      Float4 inverseLength = Float4::max(nx*nx + ny*ny,minimum).reciprocalSqrt();
+      nx = nx*inverseLength;
+      ny = ny*inverseLength;
+      Float4 cosine = Float4::max(ny*ax - nx*ay,ny*bx - nx*by);
+      Float4 length = Float4::max(cosine,minimumCosine).reciprocal();
+      (nx*length).store(&mx[i]);
+      (ny*length).store(&my[i]);
+    }
+  }
+
+  CrossSection getCrossSection(size_t point, const Polyline& p) const {
+    size_t i = PADDING + point;
+    float h = p.style.width*0.5f;
+    float inner = std::max(h - FEATHER*0.5f,0.0f), outer = std::max(h,FEATHER*0.5f) + FEATHER*0.5f;
+    float px = x[i], py = y[i];
+    if(p.style.cap == Cap::SQUARE) {
+      float extension = 0;
+      if(point == p.firstPoint) {
+        extension = -h;
+      }
+      else if(point == p.firstPoint + p.pointCount - 1) {
+        extension = h;
+      }
+      px += ux[i]*extension/pixelsPerUnitX;
+      py += uy[i]*extension/pixelsPerUnitY;
+    }
+    float offsetX = mx[i]/pixelsPerUnitX, offsetY = my[i]/pixelsPerUnitY;
+    const float distances[4] = {outer,inner,-inner,-outer};
+    CrossSection c;
+    for(int k = 0; k < 4; ++k) {
+      c.x[k] = px + offsetX*distances[k];
+      c.y[k] = py + offsetY*distances[k];
+    }
+    return c;
+  }
+
+  void writeSegments(size_t begin, size_t end, char * vertices) const {
+    //The segments that start at points [begin,end).
+    auto found = std::upper_bound(polylines.begin(),polylines.end(),begin,
+      [](size_t point, const Polyline& p) {
+        return point < p.firstPoint;
+      }
+    );
+    size_t p = (size_t) (found - polylines.begin()) - 1;
+    size_t point = begin;
+    while(point < end) {
+      const Polyline& line = polylines[p];
+      size_t last = line.firstPoint + line.pointCount - 1;
+      uint8_t colors[2][4];
+      const Color& c = line.style.color;
+      float coverage = std::min(line.style.width/FEATHER,1.0f);
+      uint8_t alpha = (uint8_t) (c.a*coverage);
+      const uint8_t edge[4] = {c.r,c.g,c.b,0}, core[4] = {c.r,c.g,c.b,alpha};
+      std::memcpy(colors[0],edge,4);
+      std::memcpy(colors[1],core,4);
+
+      CrossSection a = getCrossSection(point,line);
+      for(; point < end && point < last; ++point) {
+        size_t k = point - line.firstPoint;
+        size_t v = line.firstVertex + (p == 0 ? 0 : 2) + (k == 0 ? 0 : 8 + 7*(k - 1));
+        char * out = vertices + v*VERTEX_SIZE;
+        CrossSection b = getCrossSection(point + 1,line);
+        auto write = [&out,&colors](const CrossSection& s, int side) {
+          std::memcpy(out,&s.x[side],4);
+          std::memcpy(out + 4,&s.y[side],4);
+          std::memcpy(out + 8,colors[side == 1 || side == 2],4);
+          out += VERTEX_SIZE;
+        };
+        if(k == 0) {
+          for(int side = 0; side < 4; ++side) {
+            write(a,side);
+            write(b,side);
+          }
+        }
+        else {
+          //Continues from the side where the previous segment ended.
+          int from = k % 2 == 1 ? 3 : 0, step = k % 2 == 1 ? -1 : 1;
+          write(b,from);
+          for(int side = from + step; side >= 0 && side < 4; side += step) {
+            write(a,side);
+            write(b,side);
+          }
+        }
+        a = b;
+      }
+      point = std::max(point,last + 1);
+      ++p;
+    }
+  }
+};
+
+}
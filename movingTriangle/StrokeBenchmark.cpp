@@ -0,0 +1,94 @@
+#include "StrokeBatch.h"
+#include "AttributeContainer.h"
+#include "JobSystem.h"
+
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+//Measures StrokeBatch without a window: adding polylines that change every frame, like plots
+//that scroll, and writeVertices(), on one thread and with the JobSystem. The vertices are
+//written to an AttributeContainer, but not sent to a GPU.
+//
+//  strokeBenchmark [polylines] [points per polyline] [frames]
+
+namespace {
+
+using namespace ProjectName;
+using Clock = std::chrono::steady_clock;
+
+class Timing {
+ public:
+  double add{0}, write{0};
+};
+
+double toMilliseconds(Clock::duration d) {
+  return std::chrono::duration<double,std::milli>(d).count();
+}
+
+Timing run(size_t polylines, size_t points, int frames, JobSystem * jobs) {
+  std::vector<float> x(points), y(points);
+  for(size_t i = 0; i < points; ++i) {
+    x[i] = -1 + 2.0f*i/(points - 1);
+  }
+  StrokeBatch batch;
+  batch.setViewportSize(1920,1080);
+  StrokeBatch::Style style;
+  style.width = 2;
+  AttributeContainer vertices;
+  vertices.addAttributeType(AttributeContainer::FLOAT,false,AttributeContainer::TWO);
+  vertices.addAttributeType(AttributeContainer::UNSIGNED_BYTE,true,AttributeContainer::FOUR);
+  vertices.reserve( polylines*(7*points - 4) );
+
+  Timing t;
+  for(int f = 0; f < frames; ++f) {
+    Clock::time_point start = Clock::now();
+    batch.clear();
+    for(size_t p = 0; p < polylines; ++p) {
+      float phase = 0.1f*f + 0.5f*p;
+      for(size_t i = 0; i < points; ++i) {
+        y[i] = 0.8f*std::sin(phase + 0.05f*i);
+      }
+      batch.addPolyline(x.data(),y.data(),points,style);
+    }
+    Clock::time_point added = Clock::now();
+    size_t written = batch.writeVertices(vertices,jobs);
+    Clock::time_point end = Clock::now();
+    if( written != batch.getVertexCount() ) {
+      std::fprintf(stderr,"Wrote %zu of %zu vertices.\n",written,batch.getVertexCount());
+      std::exit(1);
+    }
+    t.add += toMilliseconds(added - start);
+    t.write += toMilliseconds(end - added);
+  }
+  t.add /= frames;
+  t.write /= frames;
+  return t;
+}
+
+void print(const char * name, const Timing& t, size_t points) {
+  std::printf("%-12s %8.2f %8.2f %14.0f\n",name,t.add,t.write,points/t.write);
+}
+
+}
+
+int main(int n, char ** arguments) {
+  size_t polylines = n > 1 ? (size_t) std::atol(arguments[1]) : 1000;
+  size_t points = n > 2 ? (size_t) std::atol(arguments[2]) : 1000;
+  int frames = n > 3 ? std::atoi(arguments[3]) : 60;
+  if(points < 2) {
+    std::fprintf(stderr,"A polyline needs at least two points.\n");
+    return 2;
+  }
+  JobSystem jobs;
+
+  std::printf("%zu polylines of %zu points, milliseconds per frame.\n",polylines,points);
+  std::printf("%-12s %8s %8s %14s\n","","add","write","points per ms");
+  print( "1 thread",run(polylines,points,frames,nullptr),polylines*points );
+  char name[32];
+  std::snprintf(name,sizeof(name),"%u threads",jobs.getThreadCount() + 1);
+  print( name,run(polylines,points,frames,&jobs),polylines*points );
+  return 0;
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstdint>
+
+namespace ProjectName {
+
+class StrokeFont {
+  //A built-in font of printable ASCII, drawn as strokes on a grid, so that text needs no font
+  //file. The grid is WIDTH units wide; the baseline is at y = BASELINE, lower case letters reach
+  //X_HEIGHT, capitals and digits CAP_HEIGHT, and descenders go down to 0. A glyph is a string
+  //of polylines separated by spaces, and every point is two digits, x and y, so "0248" is a
+  //line from (0,2) to (4,8). A polyline of one point is a dot. The strokes are STROKE_WIDTH
+  //units wide, and round at their ends and corners.
+ public:
+  static constexpr int WIDTH = 4;
+  static constexpr int BASELINE = 2;
+  static constexpr int X_HEIGHT = 6;
+  static constexpr int CAP_HEIGHT = 8;
+  static constexpr int ADVANCE = 6;
+  static constexpr int LINE_HEIGHT = 10;
+  static constexpr float STROKE_WIDTH = 1;
+
+  static const char * getStrokes(uint32_t codepoint) {
+    //Null for characters that the font does not have.
+    static const char * const GLYPHS[95] = {
+      "", //Space
+      "2824 22",
+      "1817 3837",
+      "1812 3832 0646 0444",
+      "473818070615354443321203 2822",
+      "0248 17 33",
+      "4216172837360403122244",
+      "2827",
+      "38272332",
+      "18272312",
+      "2723 0644 0446",
+      "2723 1535",
+      "232211",
+      "1535",
+      "22",
+      "0248",
+      "180703123243473818 0347", //0
+      "172822 1232",
+      "07183847460242",
+      "07183847463515 354443321203",
+      "32380444",
+      "4808053544433202",
+      "4738180703123243443505",
+      "084812",
+      "15060718384746351504031232434435",
+      "0312324347381807061545", //9
+      "26 23",
+      "26 232211",
+      "480542",
+      "0646 0444",
+      "084502",
+      "07183847462524 22",
+      "3425142334334347381807031242",
+      "022842 1535", //A
+      "02083847463505 3544433202",
+      "4738180703123243",
+      "02082846442202",
+      "48080242 0535",
+      "480802 0535",
+      "47381807031232434525",
+      "0208 4248 0545",
+      "1838 2822 1232",
+      "4843321203",
+      "0208 4804 1542",
+      "080242",
+      "0208254842",
+      "02084248",
+      "180703123243473818",
+      "02083847463505",
+      "180703123243473818 2442",
+      "02083847463505 2542",
+      "473818070615354443321203",
+      "0848 2822",
+      "080312324348",
+      "082248",
+      "0812253248",
+      "0842 0248",
+      "082548 2522",
+      "08480242", //Z
+      "38282232",
+      "0842",
+      "18282212",
+      "162836",
+      "0141",
+      "1827",
+      "16364542 4414031242", //a
+      "08023243453606",
+      "461605031242",
+      "48421203051646",
+      "044445361605031242",
+      "4738281712 0636",
+      "46413000 461605041343",
+      "0802 06364542",
+      "2622 28",
+      "36312010 38",
+      "0802 3603 1432",
+      "18282332",
+      "0602 05162522 25364542",
+      "0602 0516364542",
+      "160503123243453616",
+      "0600 063645433202",
+      "4640 461605031242",
+      "0602 042646",
+      "4616051434433202",
+      "18132232 0636",
+      "0603123243 4642",
+      "062246",
+      "0612243246",
+      "0642 0246",
+      "06031242 46413000",
+      "06460242", //z
+      "38272615242332",
+      "2821",
+      "18272635242312",
+      "05163445"
+    };
+    if(codepoint < 32 || codepoint > 126) {
+      return nullptr;
+    }
+    return GLYPHS[codepoint - 32];
+  }
+};
+
+}
@@ -5,5 +5,11 @@ precision mediump float;
 varying vec4 fragmentColor;
 
 void main() {
+#ifdef POINT_SPRITE
+  //Round points that fade out towards their edge.
+  float d = length(gl_PointCoord - vec2(0.5));
+  gl_FragColor = vec4(fragmentColor.rgb,fragmentColor.a*clamp(1.0 - 2.0*d,0.0,1.0));
+#else
   gl_FragColor=fragmentColor;
+#endif
 }
@@ -1,15 +1,30 @@
 #version 100
 
+//Variants, see ShaderPermutations:
+//  TRANSFORM     the position is transformed by theMatrix.
+//  POINT_SPRITE  for GL_POINTS of pointSize pixels.
+
 attribute vec2 position;
 attribute vec4 color;
 
 varying  vec4 fragmentColor;
 
+#ifdef TRANSFORM
 uniform mat3 theMatrix;
+#endif
+#ifdef POINT_SPRITE
+uniform float pointSize;
+#endif
 
 void main() {
+#ifdef TRANSFORM
   vec3 temp = theMatrix*vec3(position,1.0);
   gl_Position = vec4(temp.xy,0.0,1.0);
-  //gl_Position = vec4(position,0.0,1.0);
+#else
+  gl_Position = vec4(position,0.0,1.0);
+#endif
+#ifdef POINT_SPRITE
+  gl_PointSize = pointSize;
+#endif
   fragmentColor = color;
 }
@@ -0,0 +1,323 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+
+#include "GlyphCache.h"
+#include "SceneComponents.h"
+#include "BoundingBox2D.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+
+namespace ProjectName {
+
+class TextVertex {
+  //The layout of the vertices of TextRenderer: a FLOAT TWO position, an UNSIGNED_SHORT FOUR
+  //normalized texture coordinate and smoothing, see GlyphCache::getSmoothing, and an
+  //UNSIGNED_BYTE FOUR normalized color.
+ public:
+  float x, y;
+  uint16_t u, v, smoothing, unused;
+  Color color;
+};
+
+static_assert(sizeof(TextVertex) == 20,"TextVertex has to match the attributes.");
+
+class TextBatch {
+  //All text of a frame, as labels that keep their vertices until their text, position, size or
+  //color changes. update() lays out only the changed labels, and then concatenates the vertices
+  //of every atlas page that one of them uses, so that TextRenderer draws each page with one call
+  //and sends nothing when no label has changed.
+  //A label is laid out from a run: the characters and pen positions of its text in units of
+  //StrokeFont, which do not depend on the position, size or color. Runs are cached by the hash
+  //of their text, so labels that show the same strings again, such as counters, skip the
+  //layout. Positions are in clip space, at the baseline of the first line; the size is the
+  //height of capitals in pixels.
+ public:
+  using Label = uint32_t;
+  static constexpr size_t MAX_RUNS = 4096; //The cache is emptied when it is full.
+
+  class Statistics {
+   public:
+    size_t glyphs{0}; //In the vertices after the last update().
+    size_t regeneratedGlyphs{0};
+    size_t changedLabels{0};
+    size_t runHits{0}, runMisses{0};
+  };
+
+  explicit TextBatch(GlyphCache& cache) : cache(cache) {
+
+  }
+
+  TextBatch(const TextBatch&) = delete;
+  TextBatch& operator=(const TextBatch&) = delete;
+
+  void setViewportSize(int width, int height) { //In pixels; changes every label.
+    pixelsPerUnitX = width*0.5f;
+    pixelsPerUnitY = height*0.5f;
+    for(LabelState& l : labels) {
+      markChanged(l);
+    }
+  }
+
+  Label createLabel() {
+    Label label;
+    if( freeLabels.empty() ) {
+      label = (Label) labels.size();
+      labels.emplace_back();
+    }
+    else {
+      label = freeLabels.back();
+      freeLabels.pop_back();
+    }
+    //A reused label keeps its old vertices until update(), which rebuilds their pages.
+    LabelState& l = labels[label];
+    l.alive = true;
+    l.text.clear();
+    l.x = l.y = l.size = 0;
+    l.color = Color();
+    return label;
+  }
+
+  void destroyLabel(Label label) {
+    LabelState& l = labels[label];
+    l.alive = false;
+    markChanged(l);
+    freeLabels.push_back(label);
+  }
+
+  void setText(Label label, const std::string& text, float x, float y, float size,
+    Color color)
+  {
+    LabelState& l = labels[label];
+    if( l.text == text && l.x == x && l.y == y && l.size == size &&
+      l.color.r == color.r && l.color.g == color.g && l.color.b == color.b &&
+      l.color.a == color.a )
+    {
+      return;
+    }
+    l.text = text;
+    l.x = x;
+    l.y = y;
+    l.size = size;
+    l.color = color;
+    markChanged(l);
+  }
+
+  void update(JobSystem * jobs = nullptr) {
+    //Rasterizes the new glyphs of the changed labels on jobs, and rebuilds their vertices.
+    PROFILE_SCOPE("TextBatch::update");
+    changedBounds.clear();
+    if( changed.empty() ) {
+      return;
+    }
+    std::string newText;
+    for(Label c : changed) {
+      newText += labels[c].text;
+    }
+    cache.prepare(newText,jobs);
+    pages.resize( cache.getPageCount() );
+
+    std::vector<bool> pagesToBuild(pages.size(),false);
+    for(Label c : changed) {
+      LabelState& l = labels[c];
+      for(size_t p = 0; p < l.pageVertices.size(); ++p) {
+        if( !l.pageVertices[p].empty() ) {
+          pagesToBuild[p] = true;
+        }
+      }
+      changedBounds.push_back(l.bounds);
+      l.bounds = BoundingBox2D();
+      if(l.alive) {
+        layout(l);
+        changedBounds.push_back(l.bounds);
+        for(size_t p = 0; p < l.pageVertices.size(); ++p) {
+          if( !l.pageVertices[p].empty() ) {
+            pagesToBuild[p] = true;
+          }
+        }
+      }
+      else {
+        l.pageVertices.clear();
+      }
+      l.wasChanged = false;
+    }
+    statistics.changedLabels += changed.size();
+    changed.clear();
+
+    for(size_t p = 0; p < pages.size(); ++p) {
+      if(!pagesToBuild[p]) {
+        continue;
+      }
+      Page& page = pages[p];
+      page.vertices.clear();
+      for(const LabelState& l : labels) {
+        if( p < l.pageVertices.size() ) {
+          const std::vector<TextVertex>& v = l.pageVertices[p];
+          page.vertices.insert(page.vertices.end(),v.begin(),v.end());
+        }
+      }
+      ++page.version;
+    }
+    statistics.glyphs = 0;
+    for(const Page& page : pages) {
+      statistics.glyphs += page.vertices.size()/4;
+    }
+  }
+
+  size_t getPageCount() const {
+    return pages.size();
+  }
+
+  const std::vector<TextVertex>& getVertices(size_t page) const {
+    //Four per glyph: bottom left, bottom right, top left, top right.
+    return pages[page].vertices;
+  }
+
+  uint64_t getVersion(size_t page) const { //Changes when the vertices of the page change.
+    return pages[page].version;
+  }
+
+  const std::vector<BoundingBox2D>& getChangedBounds() const {
+    //In clip space, of the labels that the last update() has changed, before and after; for
+    //the damage of a frame.
+    return changedBounds;
+  }
+
+  GlyphCache& getGlyphCache() {
+    return cache;
+  }
+
+  const Statistics& getStatistics() const {
+    return statistics;
+  }
+
+  void resetStatistics() {
+    size_t glyphs = statistics.glyphs;
+    statistics = Statistics();
+    statistics.glyphs = glyphs;
+  }
+
+ private:
+  class RunGlyph {
+   public:
+    uint32_t character;
+    float x, y; //The pen position.
+  };
+
+  class Run {
+   public:
+    std::string text;
+    std::vector<RunGlyph> glyphs;
+  };
+
+  class LabelState {
+   public:
+    bool alive{false}, wasChanged{false};
+    std::string text;
+    float x{0}, y{0}, size{0};
+    Color color;
+    std::vector<std::vector<TextVertex>> pageVertices;
+    BoundingBox2D bounds; //Of the quads.
+  };
+
+  class Page {
+   public:
+    std::vector<TextVertex> vertices;
+    uint64_t version{0};
+  };
+
+  GlyphCache& cache;
+  float pixelsPerUnitX{1}, pixelsPerUnitY{1};
+  std::vector<LabelState> labels;
+  std::vector<Label> freeLabels;
+  std::vector<Label> changed;
+  std::unordered_map<uint64_t,Run> runs;
+  std::vector<Page> pages;
+  std::vector<BoundingBox2D> changedBounds;
+  Statistics statistics;
+
+  void markChanged(LabelState& l) {
+    if(!l.wasChanged) {
+      l.wasChanged = true;
+      changed.push_back( (Label) (&l - labels.data()) );
+    }
+  }
+
+  static uint64_t hash(const std::string& text) {
+    //64-bit FNV-1a.
+    uint64_t h = 14695981039346656037ull;
+    for(char c : text) {
+      h = (h ^ (unsigned char) c)*1099511628211ull;
+    }
+    return h;
+  }
+
+  const Run& getRun(const std::string& text) {
+    uint64_t key = hash(text);
+    auto found = runs.find(key);
+    if(found != runs.end() && found->second.text == text) {
+      ++statistics.runHits;
+      return found->second;
+    }
+    ++statistics.runMisses;
+    if(found == runs.end() && runs.size() >= MAX_RUNS) {
+      runs.clear();
+    }
+    Run& run = runs[key]; //A colliding text replaces the old one.
+    run.text = text;
+    run.glyphs.clear();
+    float penX = 0, penY = 0;
+    for(size_t i = 0; i < text.size(); ) {
+      uint32_t c = GlyphCache::decodeUTF8(text,i);
+      if(c == '\n') {
+        penX = 0;
+        penY -= StrokeFont::LINE_HEIGHT;
+        continue;
+      }
+      run.glyphs.push_back( RunGlyph{c,penX,penY} );
+      penX += StrokeFont::ADVANCE;
+    }
+    return run;
+  }
+
+  void layout(LabelState& l) {
+    const Run& run = getRun(l.text);
+    for(std::vector<TextVertex>& v : l.pageVertices) {
+      v.clear();
+    }
+    l.pageVertices.resize( pages.size() );
+
+    float scale = l.size/(StrokeFont::CAP_HEIGHT - StrokeFont::BASELINE); //Pixels per unit.
+    float sx = scale/pixelsPerUnitX, sy = scale/pixelsPerUnitY;
+    uint16_t smoothing = toUnorm16( GlyphCache::getSmoothing(scale) );
+    for(const RunGlyph& r : run.glyphs) {
+      const SDFGlyph * g = cache.find(r.character);
+      if(g == nullptr || g->empty) {
+        continue;
+      }
+      float x0 = l.x + (r.x + g->left)*sx, x1 = l.x + (r.x + g->right)*sx;
+      float y0 = l.y + (r.y + g->bottom)*sy, y1 = l.y + (r.y + g->top)*sy;
+      uint16_t u0 = toUnorm16(g->u0), u1 = toUnorm16(g->u1);
+      uint16_t v0 = toUnorm16(g->v0), v1 = toUnorm16(g->v1);
+      l.bounds.add(x0,y0);
+      l.bounds.add(x1,y1);
+      std::vector<TextVertex>& out = l.pageVertices[g->page];
+      out.push_back( TextVertex{x0,y0,u0,v1,smoothing,0,l.color} );
+      out.push_back( TextVertex{x1,y0,u1,v1,smoothing,0,l.color} );
+      out.push_back( TextVertex{x0,y1,u0,v0,smoothing,0,l.color} );
+      out.push_back( TextVertex{x1,y1,u1,v0,smoothing,0,l.color} );
+      ++statistics.regeneratedGlyphs;
+    }
+  }
+
+  static uint16_t toUnorm16(float f) {
+    return (uint16_t) ( std::min( std::max(f,0.0f),1.0f )*65535 + 0.5f );
+  }
+};
+
+}
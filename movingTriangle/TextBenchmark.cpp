@@ -0,0 +1,118 @@
+#include "TextBatch.h"
+#include "GlyphCache.h"
+#include "JobSystem.h"
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+//Measures the text of TextRenderer without a window: rasterizing every glyph of StrokeFont into
+//the atlas, on one thread and with the JobSystem, and then TextBatch::update() for frames of
+//labels of which some change every frame, like counters next to static captions. Reports the
+//glyphs per millisecond that are laid out again, the hit rate of the runs and the memory of the
+//atlas, which is also its size on the GPU.
+//
+//  textBenchmark [labels] [changed labels per frame] [frames]
+
+namespace {
+
+using namespace ProjectName;
+using Clock = std::chrono::steady_clock;
+
+double toMilliseconds(Clock::duration d) {
+  return std::chrono::duration<double,std::milli>(d).count();
+}
+
+std::string printableASCII() {
+  std::string text;
+  for(char c = 32; c < 127; ++c) {
+    text += c;
+  }
+  return text;
+}
+
+double rasterize(JobSystem * jobs, int repetitions) {
+  //Milliseconds for the whole font.
+  std::string text = printableASCII();
+  double total = 0;
+  for(int r = 0; r < repetitions; ++r) {
+    GlyphCache cache;
+    Clock::time_point start = Clock::now();
+    cache.prepare(text,jobs);
+    total += toMilliseconds(Clock::now() - start);
+  }
+  return total/repetitions;
+}
+
+void printRasterization(const char * name, double milliseconds, size_t glyphs) {
+  std::printf("%-12s %8.2f %14.1f\n",name,milliseconds,glyphs/milliseconds);
+}
+
+}
+
+int main(int n, char ** arguments) {
+  size_t labelCount = n > 1 ? (size_t) std::atol(arguments[1]) : 200;
+  size_t changedPerFrame = n > 2 ? (size_t) std::atol(arguments[2]) : 20;
+  int frames = n > 3 ? std::atoi(arguments[3]) : 600;
+  if(labelCount == 0 || frames <= 0) {
+    std::fprintf(stderr,"Needs at least one label and one frame.\n");
+    return 2;
+  }
+  changedPerFrame = std::min(changedPerFrame,labelCount);
+  JobSystem jobs;
+
+  const int REPETITIONS = 10;
+  size_t fontGlyphs = 0;
+  {
+    GlyphCache cache;
+    fontGlyphs = cache.prepare( printableASCII() );
+  }
+  std::printf("Rasterizing %zu glyphs, milliseconds.\n",fontGlyphs);
+  std::printf("%-12s %8s %14s\n","","time","glyphs per ms");
+  printRasterization( "1 thread",rasterize(nullptr,REPETITIONS),fontGlyphs );
+  char name[32];
+  std::snprintf(name,sizeof(name),"%u threads",jobs.getThreadCount() + 1);
+  printRasterization( name,rasterize(&jobs,REPETITIONS),fontGlyphs );
+
+  GlyphCache cache;
+  TextBatch batch(cache);
+  batch.setViewportSize(1920,1080);
+  std::vector<TextBatch::Label> labels;
+  for(size_t i = 0; i < labelCount; ++i) {
+    labels.push_back( batch.createLabel() );
+    float y = 0.95f - 1.9f*i/labelCount;
+    batch.setText(labels.back(),"Label " + std::to_string(i) + ": 0",-0.95f,y,12,Color());
+  }
+  batch.update(&jobs);
+  batch.resetStatistics();
+
+  double total = 0;
+  for(int f = 0; f < frames; ++f) {
+    for(size_t c = 0; c < changedPerFrame; ++c) {
+      //The changed labels rotate, and their counters repeat every 60 frames.
+      size_t i = (f*changedPerFrame + c) % labelCount;
+      float y = 0.95f - 1.9f*i/labelCount;
+      std::string text = "Label " + std::to_string(i) + ": " + std::to_string(f % 60);
+      batch.setText(labels[i],text,-0.95f,y,12,Color());
+    }
+    Clock::time_point start = Clock::now();
+    batch.update(&jobs);
+    total += toMilliseconds(Clock::now() - start);
+  }
+
+  const TextBatch::Statistics& s = batch.getStatistics();
+  size_t runs = s.runHits + s.runMisses;
+  std::printf("\n%zu labels, %zu changed per frame, %d frames.\n",labelCount,changedPerFrame,
+    frames
+  );
+  std::printf("Glyphs per frame:            %zu\n",s.glyphs);
+  std::printf("Laid out glyphs per frame:   %.1f\n",(double) s.regeneratedGlyphs/frames);
+  std::printf("update() per frame:          %.3f ms\n",total/frames);
+  std::printf("Laid out glyphs per ms:      %.0f\n",s.regeneratedGlyphs/total);
+  std::printf("Run cache hits:              %.1f %%\n",runs > 0 ? 100.0*s.runHits/runs : 0.0);
+  std::printf("Atlas: %zu pages, %zu bytes\n",cache.getPageCount(),cache.getMemoryBytes());
+  return 0;
+}
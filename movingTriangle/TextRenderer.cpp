@@ -0,0 +1,203 @@
+#include "TextRenderer.h"
+#include "ShaderProgram.h"
+#include "AttributeContainer.h"
+#include "IndexContainer.h"
+#include "GLResource.h"
+#include "GLDebug.h"
+#include "Logger.h"
+
+#include <glad/glad.h>
+
+#include <vector>
+#include <cstring>
+#include <algorithm>
+
+namespace ProjectName {
+
+namespace {
+
+const char * const TEXT_VERTEX_SHADER =
+  "attribute vec2 position;\n"
+  "attribute vec4 glyph;\n"
+  "attribute vec4 color;\n"
+  "varying vec2 textureCoordinate;\n"
+  "varying float smoothing;\n"
+  "varying vec4 fragmentColor;\n"
+  "void main() {\n"
+  "  textureCoordinate = glyph.xy;\n"
+  "  smoothing = glyph.z;\n"
+  "  fragmentColor = color;\n"
+  "  gl_Position = vec4(position,0.0,1.0);\n"
+  "}\n";
+
+const char * const TEXT_FRAGMENT_SHADER =
+  "precision mediump float;\n"
+  "uniform sampler2D atlas;\n"
+  "varying vec2 textureCoordinate;\n"
+  "varying float smoothing;\n"
+  "varying vec4 fragmentColor;\n"
+  "void main() {\n"
+  "  float distance = texture2D(atlas,textureCoordinate).a;\n"
+  "  float coverage = smoothstep(0.5 - smoothing,0.5 + smoothing,distance);\n"
+  "  gl_FragColor = vec4(fragmentColor.rgb,fragmentColor.a*coverage);\n"
+  "}\n";
+
+}
+
+class TextRenderer::I {
+ public:
+  size_t drawCount{0};
+
+  void initialize() {
+    program.getName() = "TextRenderer";
+    program.compile(TEXT_VERTEX_SHADER,TEXT_FRAGMENT_SHADER);
+    program.bindAttributeLocation(0,"position");
+    program.bindAttributeLocation(1,"glyph");
+    program.bindAttributeLocation(2,"color");
+    program.link();
+    GLint atlasUniform = program.getUniformLocation("atlas");
+    program.activate();
+    GL_CHECK( glUniform1i(atlasUniform,0) );
+
+    //The same two triangles for every quad of four vertices.
+    quadIndices = std::unique_ptr<IndexContainer>( new IndexContainer() );
+    quadIndices->reserve(MAX_GLYPHS_PER_PAGE*6);
+    for(size_t q = 0; q < MAX_GLYPHS_PER_PAGE; ++q) {
+      GLushort v = (GLushort) (q*4);
+      quadIndices->add({v,(GLushort) (v + 1),(GLushort) (v + 2),(GLushort) (v + 2),
+        (GLushort) (v + 1),(GLushort) (v + 3)
+      });
+    }
+    quadIndices->initialize();
+  }
+
+  void releaseGPUResources() {
+    program.destroyProgram();
+    pages.clear();
+    quadIndices.reset();
+  }
+
+  void render(TextBatch& batch) {
+    GlyphCache& cache = batch.getGlyphCache();
+    while( pages.size() < cache.getPageCount() ) {
+      pages.emplace_back( createPage( cache.getPageSize() ) );
+    }
+
+    drawCount = 0;
+    program.activate();
+    GL_CHECK( glActiveTexture(GL_TEXTURE0) );
+    GL_CHECK( glEnable(GL_BLEND) );
+    GL_CHECK( glBlendFunc(GL_SRC_ALPHA,GL_ONE_MINUS_SRC_ALPHA) );
+    for(size_t p = 0; p < pages.size(); ++p) {
+      Page& page = *pages[p];
+      GL_CHECK( glBindTexture(GL_TEXTURE_2D,page.texture.get()) );
+      uploadRows( cache.getPage(p),cache.getPageSize() );
+      if( p < batch.getPageCount() && batch.getVersion(p) != page.version ) {
+        streamVertices(batch,p,page);
+      }
+      if(page.glyphs == 0) {
+        continue;
+      }
+      page.vertices.bind();
+      GL_CHECK( glDrawElements(GL_TRIANGLES,(GLsizei) (page.glyphs*6),GL_UNSIGNED_SHORT,
+        quadIndices->getIndexOffset()
+      ) );
+      ++drawCount;
+    }
+    GL_CHECK( glDisable(GL_BLEND) );
+  }
+
+ private:
+  class Page {
+   public:
+    TextureHandle texture;
+    AttributeContainer vertices;
+    uint64_t version{0};
+    size_t glyphs{0};
+  };
+
+  ShaderProgram program;
+  std::unique_ptr<IndexContainer> quadIndices;
+  std::vector<std::unique_ptr<Page>> pages;
+
+  std::unique_ptr<Page> createPage(int size) {
+    std::unique_ptr<Page> page( new Page() );
+    page->texture.create();
+    GL_CHECK( glBindTexture(GL_TEXTURE_2D,page->texture.get()) );
+    GL_CHECK( glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_LINEAR) );
+    GL_CHECK( glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_LINEAR) );
+    GL_CHECK( glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S,GL_CLAMP_TO_EDGE) );
+    GL_CHECK( glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_T,GL_CLAMP_TO_EDGE) );
+    GL_CHECK( glTexImage2D(GL_TEXTURE_2D,0,GL_ALPHA,size,size,0,GL_ALPHA,GL_UNSIGNED_BYTE,
+      nullptr
+    ) );
+    page->texture.setSize( (size_t) size*size );
+
+    using C = AttributeContainer;
+    C& c = page->vertices;
+    c.addAttributeType(C::FLOAT,false,C::TWO);
+    c.addAttributeType(C::UNSIGNED_SHORT,true,C::FOUR);
+    c.addAttributeType(C::UNSIGNED_BYTE,true,C::FOUR);
+    c.reserve(MAX_GLYPHS_PER_PAGE*4);
+    c.initializeStreaming();
+    c.setIndexContainer(*quadIndices);
+    page->version = 0;
+    return page;
+  }
+
+  static void uploadRows(GlyphPage& source, int size) {
+    //The texture of the page is bound. Rows of one byte per texel are not 4-byte aligned.
+    if( !source.isDirty() ) {
+      return;
+    }
+    GL_CHECK( glPixelStorei(GL_UNPACK_ALIGNMENT,1) );
+    GL_CHECK( glTexSubImage2D(GL_TEXTURE_2D,0,0,source.dirtyTop,size,
+      source.dirtyBottom - source.dirtyTop,GL_ALPHA,GL_UNSIGNED_BYTE,
+      &source.pixels[ (size_t) source.dirtyTop*size ]
+    ) );
+    GL_CHECK( glPixelStorei(GL_UNPACK_ALIGNMENT,4) );
+    source.dirtyTop = size;
+    source.dirtyBottom = 0;
+  }
+
+  static void streamVertices(const TextBatch& batch, size_t p, Page& page) {
+    const std::vector<TextVertex>& vertices = batch.getVertices(p);
+    size_t glyphs = vertices.size()/4;
+    if(glyphs > MAX_GLYPHS_PER_PAGE) {
+      LOG_WARNING("TextRenderer: %zu glyphs on page %zu, only %zu are drawn\n",glyphs,p,
+        (size_t) MAX_GLYPHS_PER_PAGE
+      );
+      glyphs = MAX_GLYPHS_PER_PAGE;
+    }
+    if(glyphs > 0) {
+      std::memcpy( page.vertices.getVertexData(),vertices.data(),glyphs*4*sizeof(TextVertex) );
+    }
+    page.vertices.stream(glyphs*4);
+    page.glyphs = glyphs;
+    page.version = batch.getVersion(p);
+  }
+};
+
+TextRenderer::TextRenderer() {
+  imp = std::unique_ptr<I>( new I() );
+}
+
+TextRenderer::~TextRenderer() = default;
+
+void TextRenderer::initialize() {
+  imp->initialize();
+}
+
+void TextRenderer::releaseGPUResources() {
+  imp->releaseGPUResources();
+}
+
+void TextRenderer::render(TextBatch& batch) {
+  imp->render(batch);
+}
+
+size_t TextRenderer::getDrawCount() const {
+  return imp->drawCount;
+}
+
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <memory>
+#include <cstddef>
+
+#include "TextBatch.h"
+
+namespace ProjectName {
+
+class TextRenderer {
+  //Draws a TextBatch with one glDrawElements per page of its GlyphCache. The pages are GL_ALPHA
+  //textures, a quarter of the memory of RGBA, and only the rows that have changed are uploaded.
+  //The vertices of a page are streamed only when their version in the batch has changed, so a
+  //frame with the same text as the one before sends nothing. Text is drawn with blending, and
+  //leaves blending disabled. All methods need the render thread with a current context.
+ public:
+  static constexpr size_t MAX_GLYPHS_PER_PAGE = 4096;
+  //4 vertices per glyph: 16384 vertices, within the 65536 that 16-bit indices address.
+
+  TextRenderer();
+  ~TextRenderer();
+
+  void initialize();
+  void releaseGPUResources();
+
+  void render(TextBatch& batch);
+
+  size_t getDrawCount() const; //Of the last render().
+
+ private:
+  class I;
+  std::unique_ptr<I> imp;
+};
+
+}
@@ -0,0 +1,256 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <mutex>
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <chrono>
+#include <stdexcept>
+
+#include "Image.h"
+#include "AtlasPacker.h"
+#include "GLResource.h"
+#include "GLDebug.h"
+
+namespace ProjectName {
+
+class AtlasRegion {
+ public:
+  int x{0}, y{0}, width{0}, height{0}; //In pixels of the base level.
+  GLfloat u0{0}, v0{0}, u1{0}, v1{0};
+};
+
+class TextureUploadStatistics {
+ public:
+  size_t pendingBytes{0}, uploadedBytes{0}, uploadCalls{0};
+  double uploadSeconds{0.0};
+  double occupancy{0.0};
+};
+
+class TextureAtlas {
+  //Combines many small images into one RGBA texture, so everything that uses the atlas can be
+  //drawn with one texture binding. add() only packs the image and prepares the mipmaps on the
+  //calling thread, which can be a worker thread. The render thread copies the pixels to the GPU
+  //with processUploads(), which stops after a number of bytes, so loading many images is spread
+  //over several frames instead of causing one long frame.
+ public:
+  TextureAtlas(int width, int height, int mipLevels = 1) :
+    width(width), height(height), mipLevels(mipLevels),
+    alignment( 1 << (mipLevels - 1) ),
+    packer(width/alignment,height/alignment)
+  {
+    if( !isPowerOfTwo(width) || !isPowerOfTwo(height) ) {
+      //OpenGL ES 2.0 only supports mipmaps and repeating for power of two sizes.
+      throw std::runtime_error("TextureAtlas: the width and height should be powers of two");
+    }
+  }
+
+  TextureAtlas(const TextureAtlas&) = delete;
+  TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+  bool add(const Image& image, AtlasRegion& region) {
+    //Returns false if the atlas is full. Thread safe.
+    int gutter = alignment; //Becomes one pixel in the smallest mipmap level.
+    Image padded = extrude(image,gutter);
+    int unitsWide = (padded.width + alignment - 1)/alignment;
+    int unitsHigh = (padded.height + alignment - 1)/alignment;
+
+    AtlasRectangle r;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if( !packer.pack(unitsWide,unitsHigh,r) ) {
+        return false;
+      }
+    }
+
+    region.x = r.x*alignment + gutter;
+    region.y = r.y*alignment + gutter;
+    region.width = image.width;
+    region.height = image.height;
+    region.u0 = (GLfloat) region.x/width;
+    region.v0 = (GLfloat) region.y/height;
+    region.u1 = (GLfloat) (region.x + region.width)/width;
+    region.v1 = (GLfloat) (region.y + region.height)/height;
+
+    auto levels = generateMipmaps(std::move(padded),mipLevels);
+    std::lock_guard<std::mutex> lock(mutex);
+    if(mipLevels > 1) {
+      copyToTail(levels.back(),r.x,r.y);
+    }
+    for(int level = 0; level < (int) levels.size(); ++level) {
+      pendingBytes += levels[level].getByteSize();
+      pending.push_back( PendingUpload{level,(r.x*alignment) >> level,(r.y*alignment) >> level,
+        std::move(levels[level]),0} );
+    }
+    return true;
+  }
+
+  size_t processUploads(size_t byteBudget) { //Requires an OpenGL context.
+    //Uploads at most (about) byteBudget bytes and returns the number of uploaded bytes.
+    createTexture();
+    auto start = std::chrono::steady_clock::now();
+    size_t uploaded = 0;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while( !pending.empty() && uploaded < byteBudget ) {
+      PendingUpload& u = pending.front();
+      size_t rowBytes = (size_t) u.image.width*Image::CHANNELS;
+      int rows = (int) ( (byteBudget - uploaded)/rowBytes );
+      if(rows < 1) {
+        rows = 1; //Always make progress, even with a tiny budget.
+      }
+      if(rows > u.image.height - u.rowsDone) {
+        rows = u.image.height - u.rowsDone;
+      }
+
+      GL_CHECK( glBindTexture( GL_TEXTURE_2D,texture.get() ) );
+      GL_CHECK( glTexSubImage2D(GL_TEXTURE_2D,u.level,u.x,u.y + u.rowsDone,u.image.width,rows,
+        GL_RGBA,GL_UNSIGNED_BYTE,u.image.getPixel(0,u.rowsDone) ) );
+      ++statistics.uploadCalls;
+
+      u.rowsDone += rows;
+      uploaded += rowBytes*rows;
+      if(u.rowsDone == u.image.height) {
+        pending.pop_front();
+      }
+    }
+    if( pending.empty() && tailChanged && uploaded < byteBudget ) {
+      uploaded += uploadTail();
+    }
+    pendingBytes -= uploaded < pendingBytes ? uploaded : pendingBytes;
+    statistics.uploadedBytes += uploaded;
+    statistics.uploadSeconds += std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start
+    ).count();
+    return uploaded;
+  }
+
+  void bind(GLenum textureUnit) { //Requires an OpenGL context.
+    createTexture();
+    GL_CHECK( glActiveTexture(textureUnit) );
+    GL_CHECK( glBindTexture( GL_TEXTURE_2D,texture.get() ) );
+  }
+
+  TextureUploadStatistics getStatistics() {
+    std::lock_guard<std::mutex> lock(mutex);
+    TextureUploadStatistics s = statistics;
+    s.pendingBytes = pendingBytes;
+    s.occupancy = packer.getOccupancy();
+    return s;
+  }
+
+  int getWidth() const {
+    return width;
+  }
+
+  int getHeight() const {
+    return height;
+  }
+
+ private:
+  class PendingUpload {
+   public:
+    int level, x, y;
+    Image image;
+    int rowsDone;
+  };
+
+  int width, height, mipLevels, alignment;
+  AtlasPacker packer;
+  TextureHandle texture;
+
+  std::mutex mutex;
+  std::deque<PendingUpload> pending;
+  size_t pendingBytes{0};
+  Image tail; //A copy of the smallest level of mipLevels, from which the levels below are made.
+  bool tailChanged{false};
+  TextureUploadStatistics statistics;
+
+  static bool isPowerOfTwo(int n) {
+    return n > 0 && (n & (n-1)) == 0;
+  }
+
+  static Image extrude(const Image& image, int gutter) {
+    //Surrounds the image with copies of its border pixels, so that filtering and mipmapping do
+    //not mix in pixels of neighbouring images.
+    Image result(image.width + 2*gutter,image.height + 2*gutter);
+    for(int y = 0; y < result.height; ++y) {
+      int sy = clamp(y - gutter,0,image.height - 1);
+      for(int x = 0; x < result.width; ++x) {
+        int sx = clamp(x - gutter,0,image.width - 1);
+        std::memcpy( result.getPixel(x,y),image.getPixel(sx,sy),Image::CHANNELS );
+      }
+    }
+    return result;
+  }
+
+  void copyToTail(const Image& level, int x, int y) {
+    //The smallest level of an image goes to (x,y) in units of alignment, which are its pixels.
+    if(tail.width == 0) {
+      tail = Image(width >> (mipLevels - 1),height >> (mipLevels - 1));
+    }
+    int w = std::min(level.width,tail.width - x), h = std::min(level.height,tail.height - y);
+    for(int row = 0; row < h; ++row) {
+      std::memcpy( tail.getPixel(x,y + row),level.getPixel(0,row),(size_t) w*Image::CHANNELS );
+    }
+    tailChanged = true;
+  }
+
+  size_t uploadTail() {
+    //OpenGL ES 2.0 has no GL_TEXTURE_MAX_LEVEL, so GL_LINEAR_MIPMAP_LINEAR also samples the levels
+    //below mipLevels. They are made from the tail, once all images in it have been uploaded, and
+    //are small: together at most a third of the tail.
+    GL_CHECK( glBindTexture( GL_TEXTURE_2D,texture.get() ) );
+    size_t bytes = 0;
+    Image level;
+    const Image * previous = &tail;
+    for(int l = mipLevels; previous->width > 1 || previous->height > 1; ++l) {
+      level = halveImage(*previous);
+      previous = &level;
+      GL_CHECK( glTexSubImage2D(GL_TEXTURE_2D,l,0,0,level.width,level.height,GL_RGBA,
+        GL_UNSIGNED_BYTE,level.pixels.data() ) );
+      ++statistics.uploadCalls;
+      bytes += level.getByteSize();
+    }
+    tailChanged = false;
+    return bytes;
+  }
+
+  static int clamp(int v, int low, int high) {
+    return v < low ? low : (v > high ? high : v);
+  }
+
+  void createTexture() {
+    if(texture) {
+      return;
+    }
+    texture.create();
+    GL_CHECK( glBindTexture( GL_TEXTURE_2D,texture.get() ) );
+
+    //OpenGL ES 2.0 has no GL_TEXTURE_MAX_LEVEL, so a mipmapped texture needs all levels down
+    //to 1x1 to be complete. The levels beyond mipLevels are filled by uploadTail().
+    size_t bytes = 0;
+    int w = width, h = height, level = 0;
+    while(true) {
+      GL_CHECK( glTexImage2D(GL_TEXTURE_2D,level,GL_RGBA,w,h,0,GL_RGBA,GL_UNSIGNED_BYTE,nullptr) );
+      bytes += (size_t) w*h*Image::CHANNELS;
+      if( mipLevels == 1 || (w == 1 && h == 1) ) {
+        break;
+      }
+      w = w > 1 ? w/2 : 1;
+      h = h > 1 ? h/2 : 1;
+      ++level;
+    }
+    texture.setSize(bytes);
+
+    GLint minFilter = mipLevels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR;
+    GL_CHECK( glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,minFilter) );
+    GL_CHECK( glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_LINEAR) );
+    GL_CHECK( glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S,GL_CLAMP_TO_EDGE) );
+    GL_CHECK( glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_T,GL_CLAMP_TO_EDGE) );
+  }
+};
+
+}
@@ -0,0 +1,117 @@
+#include "TextureAtlas.h"
+#include "HiddenContext.h"
+
+#include <glad/glad.h>
+
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+
+//Measures TextureAtlas: how much of the atlas is covered when images of random sizes are added
+//until it is full, with the gutters and the alignment that mipmaps require, and how fast
+//processUploads() moves the pixels to the GPU with a budget of bytes per frame, as the render
+//thread does. glFinish() is included in the upload time, so the copy by the driver is counted.
+//The window is hidden; see GLReplay.cpp for running it without a display.
+//
+//  textureAtlasBenchmark [atlas size] [mipmap levels] [budget in KiB per frame]
+
+namespace {
+
+using namespace ProjectName;
+using Clock = std::chrono::steady_clock;
+
+Image randomImage(std::mt19937& random) {
+  //Between 8x8 and 128x128 pixels, like icons and sprites, with a gradient as content.
+  std::uniform_int_distribution<int> size(8,128);
+  Image image( size(random),size(random) );
+  for(int y = 0; y < image.height; ++y) {
+    for(int x = 0; x < image.width; ++x) {
+      unsigned char * p = image.getPixel(x,y);
+      p[0] = (unsigned char) (x*255/image.width);
+      p[1] = (unsigned char) (y*255/image.height);
+      p[2] = 128;
+      p[3] = 255;
+    }
+  }
+  return image;
+}
+
+double toMilliseconds(Clock::duration d) {
+  return std::chrono::duration<double,std::milli>(d).count();
+}
+
+}
+
+int main(int n, char ** arguments) {
+  int size = n > 1 ? std::atoi(arguments[1]) : 2048;
+  int mipLevels = n > 2 ? std::atoi(arguments[2]) : 4;
+  size_t budget = (size_t) (n > 3 ? std::atoi(arguments[3]) : 256)*1024;
+  if(mipLevels < 1 || budget == 0) {
+    std::fprintf(stderr,"Needs at least one mipmap level and a budget of at least 1 KiB.\n");
+    return 2;
+  }
+
+  try {
+    HiddenContext context("textureAtlasBenchmark");
+    std::printf("OpenGL Renderer: %s\n",(const char *) glGetString(GL_RENDERER));
+    TextureAtlas atlas(size,size,mipLevels);
+
+    std::mt19937 random(1);
+    size_t images = 0, imagePixels = 0;
+    Clock::duration adding{0};
+    while(true) {
+      Image image = randomImage(random);
+      AtlasRegion region;
+      Clock::time_point start = Clock::now();
+      bool added = atlas.add(image,region);
+      adding += Clock::now() - start;
+      if(!added) {
+        break;
+      }
+      ++images;
+      imagePixels += (size_t) image.width*image.height;
+    }
+    TextureUploadStatistics s = atlas.getStatistics();
+    std::printf("Packed %zu images into %dx%d with %d mipmap levels.\n",images,size,size,
+      mipLevels
+    );
+    std::printf("Occupancy %.1f%%; the images cover %.1f%%, the rest are gutters and "
+      "alignment.\n",s.occupancy*100.0,100.0*imagePixels/( (double) size*size )
+    );
+    std::printf("Adding, with the mipmaps: %.3f ms per image.\n",
+      toMilliseconds(adding)/(images > 0 ? images : 1)
+    );
+
+    size_t pending = s.pendingBytes;
+    int frames = 0;
+    Clock::duration longest{0};
+    Clock::time_point start = Clock::now();
+    while(true) {
+      Clock::time_point frameStart = Clock::now();
+      if(atlas.processUploads(budget) == 0) {
+        break;
+      }
+      glFinish();
+      longest = std::max(longest,Clock::now() - frameStart);
+      ++frames;
+    }
+    double milliseconds = toMilliseconds(Clock::now() - start);
+    s = atlas.getStatistics();
+    std::printf("Uploaded %.1f MiB of %.1f MiB in %d frames and %zu calls.\n",
+      s.uploadedBytes/(1024.0*1024.0),pending/(1024.0*1024.0),frames,s.uploadCalls
+    );
+    std::printf("Upload: %.1f ms in total, %.1f MiB/s, at most %.3f ms per frame.\n",
+      milliseconds,s.uploadedBytes/(1024.0*1024.0)/(milliseconds/1000.0),toMilliseconds(longest)
+    );
+  }
+  catch(const std::exception& e) {
+    std::fprintf(stderr,"%s\n",e.what());
+    return 1;
+  }
+  return 0;
+}
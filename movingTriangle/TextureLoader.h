@@ -0,0 +1,74 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iterator>
+#include <functional>
+#include <atomic>
+
+#include "Image.h"
+#include "TextureAtlas.h"
+#include "JobSystem.h"
+#include "Logger.h"
+
+namespace ProjectName {
+
+class TextureLoader {
+  //Reads and decodes image files on the worker threads of a JobSystem and adds them to an atlas.
+  //The callback runs on the worker thread as soon as the image has a place in the atlas; the
+  //pixels reach the GPU later, when the render thread calls TextureAtlas::processUploads.
+ public:
+  using Callback = std::function<void(bool success, const AtlasRegion& region)>;
+
+  TextureLoader(TextureAtlas& atlas, JobSystem& jobs) : atlas(atlas), jobs(jobs) {
+
+  }
+
+  void load(const std::string& path, Callback callback) {
+    ++loadsInProgress;
+    jobs.submit( [this,path,callback]() {
+      AtlasRegion region;
+      bool success = loadNow(path,region);
+      if(callback) {
+        callback(success,region);
+      }
+      --loadsInProgress;
+    });
+  }
+
+  unsigned int getLoadsInProgress() const {
+    return loadsInProgress.load();
+  }
+
+ private:
+  TextureAtlas& atlas;
+  JobSystem& jobs;
+  std::atomic<unsigned int> loadsInProgress{0};
+
+  bool loadNow(const std::string& path, AtlasRegion& region) {
+    try {
+      Image image = ImageDecoder::decode( readFile(path) );
+      if( !atlas.add(image,region) ) {
+        LOG_WARNING("The texture atlas is full; could not add %s.\n",path);
+        return false;
+      }
+      return true;
+    }
+    catch(const std::exception& e) {
+      LOG_WARNING("Could not load image %s: %s\n",path,e.what());
+      return false;
+    }
+  }
+
+  static std::vector<char> readFile(const std::string& path) {
+    std::ifstream stream(path,std::ios::binary);
+    if(!stream) {
+      throw std::runtime_error("the file could not be opened");
+    }
+    return std::vector<char>( std::istreambuf_iterator<char>(stream),
+      std::istreambuf_iterator<char>() );
+  }
+};
+
+}
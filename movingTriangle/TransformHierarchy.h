@@ -0,0 +1,336 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+
+#include "Float4.h"
+#include "JobSystem.h"
+#include "SceneComponents.h"
+#include "Profiler.h"
+
+namespace ProjectName {
+
+class Affine2D {
+  //A 2D affine transform: the first two rows of a row major 3x3 matrix, whose third row is
+  //0 0 1. Every row has a fourth element of padding, so that it is one Float4.
+ public:
+  float row0[4]{1,0,0,0};
+  float row1[4]{0,1,0,0};
+
+  static Affine2D fromTransform(const Transform2D& t) {
+    //Scales, then rotates, then translates.
+    float c = t.scale*std::cos(t.rotation), s = t.scale*std::sin(t.rotation);
+    Affine2D a;
+    a.row0[0] = c;
+    a.row0[1] = -s;
+    a.row0[2] = t.x;
+    a.row1[0] = s;
+    a.row1[1] = c;
+    a.row1[2] = t.y;
+    return a;
+  }
+
+  static void multiply(const Affine2D& a, const Affine2D& b, Affine2D& result) {
+    //result = a*b. A row of the result is a combination of the rows of b and of 0 0 1, with the
+    //elements of the row of a as weights.
+    static const float UNIT_Z[4] = {0,0,1,0};
+    Float4 b0 = Float4::load(b.row0), b1 = Float4::load(b.row1), z = Float4::load(UNIT_Z);
+    Float4 r0 = Float4::broadcast(a.row0[0])*b0 + Float4::broadcast(a.row0[1])*b1 +
+      Float4::broadcast(a.row0[2])*z;
+    Float4 r1 = Float4::broadcast(a.row1[0])*b0 + Float4::broadcast(a.row1[1])*b1 +
+      Float4::broadcast(a.row1[2])*z;
+    r0.store(result.row0);
+    r1.store(result.row1);
+  }
+
+  void toMatrix(float m[9]) const {
+    //Row major, for glUniformMatrix3fv with transpose.
+    std::copy(row0,row0 + 3,m);
+    std::copy(row1,row1 + 3,m + 3);
+    m[6] = 0;
+    m[7] = 0;
+    m[8] = 1;
+  }
+};
+
+class TransformHierarchy {
+  //Nodes with a local transform relative to their parent, and a world transform that update()
+  //computes. The nodes are stored in depth-first order, so a parent is always before its
+  //children and every subtree is a contiguous range [i,ends[i]) of the arrays. A node keeps
+  //its handle when it moves in the arrays.
+  //setLocal() only marks a node. update() sorts the marked nodes and merges them into disjoint
+  //subtree ranges, and recomputes the world transforms of these ranges only, in order, so the
+  //parent of every node is already up to date. Once more than a sixteenth of the nodes are
+  //marked, it scans the flags instead of sorting. Ranges are independent, so they are updated
+  //in parallel on a JobSystem; a range larger than GRAIN_NODES is split at the subtrees of its
+  //root first, so that one changed root does not serialize the whole tree.
+  //Adding a node moves all nodes after the subtree of its parent; build a scene in depth-first
+  //order, and adding is amortized constant.
+ public:
+  using Node = uint32_t;
+  static constexpr Node NONE = 0xFFFFFFFF;
+  static constexpr size_t GRAIN_NODES = 4096;
+
+  class Statistics {
+   public:
+    size_t updatedNodes{0};
+    size_t ranges{0}; //Subtrees with a marked root.
+    size_t updates{0}; //Calls of update() that had marked nodes.
+  };
+
+  Node add(Node parent = NONE, const Transform2D& local = Transform2D()) {
+    uint32_t parentIndex = NONE, i = (uint32_t) parents.size();
+    if(parent != NONE) {
+      parentIndex = indexOf(parent);
+      i = ends[parentIndex];
+    }
+    if(parents.size() >= NONE - 1) {
+      throw std::runtime_error("TransformHierarchy: too many nodes.");
+    }
+
+    Node node;
+    if( freeNodes.empty() ) {
+      node = (Node) indices.size();
+      indices.push_back(i);
+    }
+    else {
+      node = freeNodes.back();
+      freeNodes.pop_back();
+      indices[node] = i;
+    }
+    parents.insert(parents.begin() + i,parentIndex);
+    ends.insert(ends.begin() + i,i + 1);
+    locals.insert( locals.begin() + i,Affine2D::fromTransform(local) );
+    worlds.insert( worlds.begin() + i,Affine2D() );
+    nodes.insert(nodes.begin() + i,node);
+    dirty.insert(dirty.begin() + i,1);
+    dirtyNodes.push_back(node);
+
+    for(uint32_t a = parentIndex; a != NONE; a = parents[a]) {
+      ++ends[a];
+    }
+    shift(i + 1,i,1);
+    return node;
+  }
+
+  void remove(Node node) {
+    //Removes the node and all of its descendants, whose handles become invalid.
+    uint32_t i = indexOf(node), end = ends[i], count = end - i;
+    for(uint32_t a = parents[i]; a != NONE; a = parents[a]) {
+      ends[a] -= count;
+    }
+    for(uint32_t j = i; j < end; ++j) {
+      indices[ nodes[j] ] = NONE;
+      freeNodes.push_back(nodes[j]);
+    }
+    parents.erase(parents.begin() + i,parents.begin() + end);
+    ends.erase(ends.begin() + i,ends.begin() + end);
+    locals.erase(locals.begin() + i,locals.begin() + end);
+    worlds.erase(worlds.begin() + i,worlds.begin() + end);
+    nodes.erase(nodes.begin() + i,nodes.begin() + end);
+    dirty.erase(dirty.begin() + i,dirty.begin() + end);
+    shift(i,end,-(int64_t) count);
+  }
+
+  void setLocal(Node node, const Transform2D& local) {
+    uint32_t i = indexOf(node);
+    locals[i] = Affine2D::fromTransform(local);
+    if(dirty[i] == 0) {
+      dirty[i] = 1;
+      dirtyNodes.push_back(node);
+    }
+  }
+
+  const Affine2D& getWorld(Node node) const { //As of the last update().
+    return worlds[ indexOf(node) ];
+  }
+
+  void getWorldMatrix(Node node, float m[9]) const {
+    getWorld(node).toMatrix(m);
+  }
+
+  Node getParent(Node node) const {
+    uint32_t p = parents[ indexOf(node) ];
+    if(p == NONE) {
+      return NONE;
+    }
+    return nodes[p];
+  }
+
+  size_t size() const {
+    return parents.size();
+  }
+
+  void update(JobSystem * jobs = nullptr) {
+    PROFILE_SCOPE("TransformHierarchy::update");
+    if( dirtyNodes.empty() ) {
+      return;
+    }
+    findRoots();
+    ++statistics.updates;
+    statistics.ranges += roots.size();
+
+    tasks.clear();
+    size_t nodeCount = 0;
+    for(uint32_t r : roots) {
+      nodeCount += ends[r] - r;
+      if(jobs == nullptr) {
+        tasks.push_back( Range{r,ends[r]} );
+      }
+      else {
+        split(r);
+      }
+    }
+    statistics.updatedNodes += nodeCount;
+
+    if(jobs == nullptr || nodeCount <= GRAIN_NODES) {
+      for(const Range& t : tasks) {
+        composeRange(t.begin,t.end);
+      }
+      return;
+    }
+    //Consecutive tasks in batches of about GRAIN_NODES nodes.
+    batches.clear();
+    size_t batchNodes = 0;
+    for(size_t t = 0; t < tasks.size(); ++t) {
+      if(batchNodes == 0) {
+        batches.push_back(t);
+      }
+      batchNodes += tasks[t].end - tasks[t].begin;
+      if(batchNodes >= GRAIN_NODES) {
+        batchNodes = 0;
+      }
+    }
+    batches.push_back( tasks.size() );
+    jobs->parallelFor(0,batches.size() - 1,1,[this](size_t begin, size_t end) {
+      for(size_t t = batches[begin]; t < batches[end]; ++t) {
+        composeRange(tasks[t].begin,tasks[t].end);
+      }
+    });
+  }
+
+  const Statistics& getStatistics() const {
+    return statistics;
+  }
+
+  void resetStatistics() {
+    statistics = Statistics();
+  }
+
+ private:
+  class Range {
+   public:
+    uint32_t begin, end;
+  };
+
+  //Per position in depth-first order.
+  std::vector<uint32_t> parents; //Positions; NONE for roots.
+  std::vector<uint32_t> ends; //One past the last descendant.
+  std::vector<Affine2D> locals, worlds;
+  std::vector<Node> nodes;
+  std::vector<uint8_t> dirty;
+
+  std::vector<uint32_t> indices; //The position of every node; NONE for free handles.
+  std::vector<Node> freeNodes;
+  std::vector<Node> dirtyNodes; //May contain removed nodes.
+
+  std::vector<uint32_t> roots;
+  std::vector<Range> tasks, stack;
+  std::vector<size_t> batches; //The first task of every batch, and the end.
+  Statistics statistics;
+
+  uint32_t indexOf(Node node) const {
+    if(node >= indices.size() || indices[node] == NONE) {
+      throw std::runtime_error("TransformHierarchy: the node does not exist.");
+    }
+    return indices[node];
+  }
+
+  void shift(uint32_t from, uint32_t moved, int64_t offset) {
+    //The nodes from from on have moved by offset; parents at moved or later have moved too.
+    for(uint32_t j = from; j < parents.size(); ++j) {
+      ends[j] = (uint32_t) (ends[j] + offset);
+      if(parents[j] != NONE && parents[j] >= moved) {
+        parents[j] = (uint32_t) (parents[j] + offset);
+      }
+      indices[ nodes[j] ] = j;
+    }
+  }
+
+  void findRoots() {
+    //The marked nodes that have no marked ancestor, in order; clears the marks.
+    roots.clear();
+    if(dirtyNodes.size()*16 > parents.size()) {
+      for(uint32_t i = 0; i < parents.size(); ) {
+        if(dirty[i] != 0) {
+          roots.push_back(i);
+          i = ends[i];
+        }
+        else {
+          ++i;
+        }
+      }
+      std::fill(dirty.begin(),dirty.end(),0);
+      dirtyNodes.clear();
+      return;
+    }
+    for(Node n : dirtyNodes) {
+      if(n < indices.size() && indices[n] != NONE && dirty[ indices[n] ] != 0) {
+        dirty[ indices[n] ] = 0;
+        roots.push_back(indices[n]);
+      }
+    }
+    dirtyNodes.clear();
+    std::sort( roots.begin(),roots.end() );
+    uint32_t end = 0;
+    size_t kept = 0;
+    for(uint32_t r : roots) {
+      if(r >= end) {
+        roots[kept++] = r;
+        end = ends[r];
+      }
+    }
+    roots.resize(kept);
+  }
+
+  void split(uint32_t root) {
+    //Composes the roots of ranges larger than GRAIN_NODES here, and adds the subtrees of their
+    //children as tasks instead.
+    stack.clear();
+    stack.push_back( Range{root,ends[root]} );
+    while( !stack.empty() ) {
+      Range r = stack.back();
+      stack.pop_back();
+      if(r.end - r.begin <= GRAIN_NODES) {
+        tasks.push_back(r);
+        continue;
+      }
+      compose(r.begin);
+      for(uint32_t c = r.begin + 1; c < r.end; c = ends[c]) {
+        stack.push_back( Range{c,ends[c]} );
+      }
+    }
+  }
+
+  void composeRange(uint32_t begin, uint32_t end) {
+    for(uint32_t i = begin; i < end; ++i) {
+      compose(i);
+    }
+  }
+
+  void compose(uint32_t i) {
+    uint32_t p = parents[i];
+    if(p == NONE) {
+      worlds[i] = locals[i];
+    }
+    else {
+      Affine2D::multiply(worlds[p],locals[i],worlds[i]);
+    }
+  }
+};
+
+}
@@ -0,0 +1,233 @@
+#include "TransformHierarchy.h"
+#include "JobSystem.h"
+
+#include <vector>
+#include <random>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+
+//Tests of TransformHierarchy: after random add(), remove() and setLocal() calls, the world
+//transforms of update() must be those of a composition from scratch, on one thread and with a
+//JobSystem. The tree is large enough that update() splits ranges and runs them in batches.
+//Every failed check is printed; the exit status is the number of failures, so meson test
+//reports them.
+
+namespace {
+
+using namespace ProjectName;
+using Node = TransformHierarchy::Node;
+
+int failures = 0;
+
+void check(bool condition, const char * what, int line) {
+  if(!condition) {
+    std::printf("FAILED at line %d: %s\n",line,what);
+    ++failures;
+  }
+}
+
+#define CHECK(condition) check( (condition),#condition,__LINE__ )
+
+class Model {
+  //What the hierarchy should contain, per handle.
+ public:
+  class Entry {
+   public:
+    bool alive{false};
+    Node parent{TransformHierarchy::NONE};
+    Transform2D local;
+  };
+
+  std::vector<Entry> entries;
+  std::vector<Node> alive;
+
+  void add(Node node, Node parent, const Transform2D& local) {
+    if( node >= entries.size() ) {
+      entries.resize(node + 1);
+    }
+    entries[node].alive = true;
+    entries[node].parent = parent;
+    entries[node].local = local;
+  }
+
+  bool isInSubtree(Node node, Node root) const {
+    for(Node n = node; n != TransformHierarchy::NONE; n = entries[n].parent) {
+      if(n == root) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void remove(Node root) {
+    std::vector<Node> removed;
+    for(Node n : alive) {
+      if( isInSubtree(n,root) ) {
+        removed.push_back(n);
+      }
+    }
+    for(Node n : removed) {
+      entries[n].alive = false;
+    }
+    collectAlive();
+  }
+
+  void collectAlive() {
+    alive.clear();
+    for(size_t n = 0; n < entries.size(); ++n) {
+      if(entries[n].alive) {
+        alive.push_back( (Node) n );
+      }
+    }
+  }
+
+  Affine2D getWorld(Node node) const {
+    const Entry& e = entries[node];
+    Affine2D local = Affine2D::fromTransform(e.local);
+    if(e.parent == TransformHierarchy::NONE) {
+      return local;
+    }
+    Affine2D world;
+    Affine2D::multiply(getWorld(e.parent),local,world);
+    return world;
+  }
+};
+
+Transform2D randomTransform(std::mt19937& random) {
+  std::uniform_real_distribution<float> u(-1,1);
+  Transform2D t;
+  t.x = u(random);
+  t.y = u(random);
+  t.rotation = u(random);
+  t.scale = 1 + 0.1f*u(random);
+  return t;
+}
+
+bool isClose(const float * a, const float * b) {
+  for(int i = 0; i < 3; ++i) {
+    if(std::fabs(a[i] - b[i]) > 1e-3f*(1 + std::fabs(b[i])) ) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void compare(const TransformHierarchy& h, const Model& m, const char * when) {
+  size_t wrong = 0;
+  for(Node n : m.alive) {
+    Affine2D expected = m.getWorld(n);
+    const Affine2D& world = h.getWorld(n);
+    if( !isClose(world.row0,expected.row0) || !isClose(world.row1,expected.row1) ) {
+      ++wrong;
+    }
+    if(h.getParent(n) != m.entries[n].parent) {
+      ++wrong;
+    }
+  }
+  if(wrong > 0) {
+    std::printf("  %zu wrong nodes %s\n",wrong,when);
+  }
+  CHECK(wrong == 0);
+  CHECK( h.size() == m.alive.size() );
+}
+
+void build(TransformHierarchy& h, Model& m, std::mt19937& random, Node parent, int depth,
+  int children)
+{
+  for(int c = 0; c < children; ++c) {
+    Transform2D t = randomTransform(random);
+    Node n = h.add(parent,t);
+    m.add(n,parent,t);
+    if(depth > 1) {
+      build(h,m,random,n,depth - 1,children);
+    }
+  }
+}
+
+void testRandomChanges(JobSystem * jobs) {
+  //Two roots with 3 levels of 24 children: 2*(24 + 576 + 13824) nodes.
+  std::mt19937 random(jobs == nullptr ? 1 : 2);
+  TransformHierarchy h;
+  Model m;
+  for(int r = 0; r < 2; ++r) {
+    Transform2D t = randomTransform(random);
+    Node root = h.add(TransformHierarchy::NONE,t);
+    m.add(root,TransformHierarchy::NONE,t);
+    build(h,m,random,root,3,24);
+  }
+  m.collectAlive();
+  h.update(jobs);
+  compare(h,m,"after building");
+
+  for(int frame = 0; frame < 40; ++frame) {
+    //A few nodes in most frames, so update() sorts them; many in some, so it scans the flags.
+    size_t changes = frame % 8 == 7 ? m.alive.size()/4 : 1 + random() % 50;
+    for(size_t c = 0; c < changes; ++c) {
+      Node n = m.alive[ random() % m.alive.size() ];
+      unsigned int action = random() % 20;
+      if(action == 0) {
+        Transform2D t = randomTransform(random);
+        Node child = h.add(n,t);
+        m.add(child,n,t);
+        m.collectAlive();
+      }
+      else if(action == 1 && m.entries[n].parent != TransformHierarchy::NONE) {
+        h.remove(n);
+        m.remove(n);
+      }
+      else {
+        Transform2D t = randomTransform(random);
+        h.setLocal(n,t);
+        m.entries[n].local = t;
+      }
+    }
+    if(frame % 5 == 0) {
+      //A changed root: its whole tree is one range, which update() splits.
+      Node root = m.alive.front();
+      Transform2D t = randomTransform(random);
+      h.setLocal(root,t);
+      m.entries[root].local = t;
+    }
+    h.update(jobs);
+    char when[32];
+    std::snprintf(when,sizeof(when),"in frame %d",frame);
+    compare(h,m,when);
+  }
+  CHECK(h.getStatistics().updates > 0);
+}
+
+void testRemovedHandles() {
+  TransformHierarchy h;
+  Node root = h.add();
+  Node child = h.add(root);
+  Node grandchild = h.add(child);
+  h.setLocal(grandchild,Transform2D());
+  h.remove(child); //A marked node that is removed is skipped by update().
+  h.update();
+  CHECK(h.size() == 1);
+  bool threw = false;
+  try {
+    h.getWorld(grandchild);
+  }
+  catch(const std::runtime_error&) {
+    threw = true;
+  }
+  CHECK(threw);
+  Node reused = h.add(root);
+  CHECK(reused == child || reused == grandchild);
+  CHECK(h.getParent(reused) == root);
+}
+
+}
+
+int main() {
+  testRandomChanges(nullptr);
+  JobSystem jobs(3);
+  testRandomChanges(&jobs);
+  testRemovedHandles();
+  if(failures == 0) {
+    std::printf("All TransformHierarchy tests passed.\n");
+  }
+  return failures;
+}
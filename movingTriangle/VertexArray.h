@@ -0,0 +1,237 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <stdexcept>
+
+#include "BufferBindingCache.h"
+#include "GLResource.h"
+#include "GLExtensions.h"
+#include "GLDebug.h"
+
+namespace ProjectName {
+
+class VertexAttributePointer {
+  //The arguments of glVertexAttribPointer, with the buffer that is bound to GL_ARRAY_BUFFER.
+ public:
+  GLuint buffer{0};
+  GLint size{0};
+  GLenum type{GL_FLOAT};
+  GLboolean normalized{GL_FALSE};
+  GLsizei stride{0};
+  GLsizeiptr offset{0};
+
+  bool operator==(const VertexAttributePointer& p) const {
+    return buffer == p.buffer && size == p.size && type == p.type &&
+      normalized == p.normalized && stride == p.stride && offset == p.offset;
+  }
+
+  bool operator!=(const VertexAttributePointer& p) const {
+    return !(*this == p);
+  }
+};
+
+class VertexArray {
+  //Everything a draw call reads vertices with: the enabled attribute arrays, their pointers and
+  //the index buffer. With OpenGL ES 3.0 or GL_OES_vertex_array_object the state is recorded in a
+  //vertex array object, so switching meshes is one glBindVertexArray. Without them it is
+  //emulated: the state of the attribute arrays is cached, and bind() only issues the calls for
+  //the locations that differ from the previously bound VertexArray.
+  //Every attribute array in this program should be set up through this class, otherwise the
+  //cache gets out of date, and GL_ELEMENT_ARRAY_BUFFER should only be bound with no vertex array
+  //object bound (see unbind()), otherwise the index buffer of a mesh changes. The state belongs
+  //to the (single) render thread.
+ public:
+  static constexpr GLuint MAX_ATTRIBUTES = 8; //The least GL_MAX_VERTEX_ATTRIBS of OpenGL ES 2.0.
+
+  VertexArray() {
+
+  }
+
+  VertexArray(const VertexArray&) = delete;
+  VertexArray& operator=(const VertexArray&) = delete;
+
+  ~VertexArray() {
+    if(vertexArrayName && getBoundVertexArray() == vertexArrayName.get()) {
+      //The name can be reused by a new object, which then would not be bound.
+      getBoundVertexArray() = INVALID;
+    }
+  }
+
+  void setAttribute(GLuint location, const VertexAttributePointer& p) {
+    if(location >= MAX_ATTRIBUTES) {
+      throw std::runtime_error("VertexArray: attribute location out of range");
+    }
+    if( (enabledMask >> location & 1) && attributes[location] == p ) {
+      return;
+    }
+    attributes[location] = p;
+    enabledMask |= uint32_t(1) << location;
+    recorded = false;
+  }
+
+  void removeAttribute(GLuint location) {
+    if( location < MAX_ATTRIBUTES && (enabledMask >> location & 1) ) {
+      enabledMask &= ~(uint32_t(1) << location);
+      recorded = false;
+    }
+  }
+
+  void setIndexBuffer(GLuint buffer) {
+    if(buffer != indexBuffer) {
+      indexBuffer = buffer;
+      recorded = false;
+    }
+  }
+
+  void bind() { //Requires an OpenGL context.
+    if( !isEmulated() ) {
+      if(!vertexArrayName) {
+        vertexArrayName.create();
+      }
+      bindVertexArray( vertexArrayName.get() );
+      if(!recorded) {
+        record();
+      }
+      return;
+    }
+    EmulatedState& s = getEmulatedState();
+    uint32_t differs = (enabledMask ^ s.enabledMask) | s.unknownMask;
+    for(uint32_t m = enabledMask; m != 0; m &= m - 1) {
+      GLuint location = lowestBit(m);
+      if(s.attributes[location] != attributes[location]) {
+        setPointer(location);
+        s.attributes[location] = attributes[location];
+      }
+    }
+    for(uint32_t m = differs; m != 0; m &= m - 1) {
+      GLuint location = lowestBit(m);
+      if(enabledMask >> location & 1) {
+        GL_CHECK( glEnableVertexAttribArray(location) );
+      }
+      else {
+        GL_CHECK( glDisableVertexAttribArray(location) );
+      }
+    }
+    s.enabledMask = enabledMask;
+    s.unknownMask = 0;
+    if(indexBuffer != 0) {
+      BufferBindingCache::bind(GL_ELEMENT_ARRAY_BUFFER,indexBuffer);
+    }
+  }
+
+  void releaseGPUResources() {
+    //The object is recorded again by the next bind().
+    if(vertexArrayName && getBoundVertexArray() == vertexArrayName.get()) {
+      getBoundVertexArray() = INVALID;
+    }
+    vertexArrayName.reset();
+    recordedMask = 0;
+    recordedIndexBuffer = 0;
+    recorded = false;
+  }
+
+  static void unbind() { //Requires an OpenGL context.
+    //Binds no vertex array object, before GL_ELEMENT_ARRAY_BUFFER is bound for an upload.
+    //Emulated vertex arrays have no binding of their own, so then nothing happens.
+    if( !isEmulated() ) {
+      bindVertexArrayName(0);
+    }
+  }
+
+  static void invalidate() {
+    //For when other code may have changed the attribute arrays or the vertex array binding.
+    getBoundVertexArray() = INVALID;
+    //Every array is then enabled or disabled explicitly by the next bind(), and the default
+    //pointers have size 0, which no attribute has.
+    getEmulatedState() = EmulatedState();
+    getEmulatedState().unknownMask = (uint32_t(1) << MAX_ATTRIBUTES) - 1;
+  }
+
+  static bool isEmulated() {
+    return GLExtensions::getVertexArrayFunctions().bindVertexArray == nullptr;
+  }
+
+ private:
+  static constexpr GLuint INVALID = ~0u;
+
+  class EmulatedState {
+   public:
+    VertexAttributePointer attributes[MAX_ATTRIBUTES];
+    uint32_t enabledMask{0};
+    uint32_t unknownMask{0};
+  };
+
+  VertexAttributePointer attributes[MAX_ATTRIBUTES];
+  uint32_t enabledMask{0};
+  GLuint indexBuffer{0};
+  VertexArrayHandle vertexArrayName;
+  uint32_t recordedMask{0};
+  GLuint recordedIndexBuffer{0};
+  bool recorded{false};
+
+  void record() {
+    //With the object bound. A new object has every array disabled, and after a change only the
+    //arrays that are no longer used have to be disabled.
+    for(uint32_t m = recordedMask & ~enabledMask; m != 0; m &= m - 1) {
+      GL_CHECK( glDisableVertexAttribArray( lowestBit(m) ) );
+    }
+    for(uint32_t m = enabledMask; m != 0; m &= m - 1) {
+      GLuint location = lowestBit(m);
+      setPointer(location);
+      GL_CHECK( glEnableVertexAttribArray(location) );
+    }
+    BufferBindingCache::bind(GL_ELEMENT_ARRAY_BUFFER,indexBuffer);
+    recordedMask = enabledMask;
+    recordedIndexBuffer = indexBuffer;
+    recorded = true;
+  }
+
+  void setPointer(GLuint location) {
+    const VertexAttributePointer& p = attributes[location];
+    BufferBindingCache::bind(GL_ARRAY_BUFFER,p.buffer);
+    GL_CHECK( glVertexAttribPointer(
+      location,p.size,p.type,p.normalized,p.stride,(const GLvoid *) p.offset
+    ) );
+  }
+
+  void bindVertexArray(GLuint name) {
+    bindVertexArrayName(name);
+    BufferBindingCache::assume(GL_ELEMENT_ARRAY_BUFFER,recordedIndexBuffer);
+  }
+
+  static void bindVertexArrayName(GLuint name) {
+    GLuint& bound = getBoundVertexArray();
+    if(bound == name) {
+      return;
+    }
+    GL_CHECK( GLExtensions::getVertexArrayFunctions().bindVertexArray(name) );
+    bound = name;
+    if(name == 0) {
+      //The default object keeps the index buffer that was bound to it before.
+      BufferBindingCache::invalidate(GL_ELEMENT_ARRAY_BUFFER);
+    }
+  }
+
+  static GLuint lowestBit(uint32_t m) {
+    GLuint i = 0;
+    while( (m & 1) == 0 ) {
+      m >>= 1;
+      ++i;
+    }
+    return i;
+  }
+
+  static GLuint& getBoundVertexArray() {
+    static GLuint bound{INVALID};
+    return bound;
+  }
+
+  static EmulatedState& getEmulatedState() {
+    static EmulatedState state;
+    return state;
+  }
+};
+
+}
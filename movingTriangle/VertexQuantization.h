@@ -0,0 +1,239 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <limits>
+
+#include "GLExtensions.h"
+#include "BoundingBox2D.h"
+
+namespace ProjectName {
+
+class PositionQuantizer {
+  //Stores 2D positions as two normalized SHORTs relative to the bounding box of a mesh, which is
+  //4 bytes per position instead of 8. The vertex shader does not need to change: the scale and
+  //translation that undo the quantization are multiplied into the transformation matrix.
+ public:
+  explicit PositionQuantizer(const BoundingBox2D& box) {
+    centerX = (box.minX + box.maxX)*0.5f;
+    centerY = (box.minY + box.maxY)*0.5f;
+    halfWidth = nonZero( (box.maxX - box.minX)*0.5f );
+    halfHeight = nonZero( (box.maxY - box.minY)*0.5f );
+  }
+
+  void quantize(GLfloat x, GLfloat y, GLshort result[2]) const {
+    result[0] = toSnorm16( (x - centerX)/halfWidth );
+    result[1] = toSnorm16( (y - centerY)/halfHeight );
+  }
+
+  void dequantize(const GLshort q[2], GLfloat result[2]) const {
+    result[0] = centerX + halfWidth*( (GLfloat) q[0]/MAX_VALUE );
+    result[1] = centerY + halfHeight*( (GLfloat) q[1]/MAX_VALUE );
+  }
+
+  void getDequantizationMatrix(GLfloat result[9]) const {
+    //Row major, like the matrices that are passed to glUniformMatrix3fv with transpose true.
+    GLfloat m[9] = {
+      halfWidth,0,centerX,
+      0,halfHeight,centerY,
+      0,0,1
+    };
+    std::memcpy( result,m,sizeof(m) );
+  }
+
+  void foldIntoTransform(const GLfloat transform[9], GLfloat result[9]) const {
+    //result = transform*dequantization, both row major.
+    GLfloat d[9];
+    getDequantizationMatrix(d);
+    for(int row = 0; row < 3; ++row) {
+      for(int column = 0; column < 3; ++column) {
+        result[row*3 + column] = transform[row*3]*d[column] + transform[row*3 + 1]*d[3 + column]
+          + transform[row*3 + 2]*d[6 + column];
+      }
+    }
+  }
+
+  GLfloat getMaxError() const {
+    //Rounding costs half a step. OpenGL ES 2.0 converts a normalized SHORT c to (2c+1)/65535
+    //instead of c/32767, which adds at most one more step; together this stays below one step.
+    GLfloat step = 1.0f/MAX_VALUE;
+    return ( halfWidth > halfHeight ? halfWidth : halfHeight )*step;
+  }
+
+ private:
+  static constexpr GLfloat MAX_VALUE = 32767.0f;
+
+  GLfloat centerX, centerY, halfWidth, halfHeight;
+
+  static GLfloat nonZero(GLfloat f) {
+    return f > 0 ? f : 1.0f; //A mesh that is flat in one direction.
+  }
+
+  static GLshort toSnorm16(GLfloat f) {
+    f = f < -1.0f ? -1.0f : (f > 1.0f ? 1.0f : f);
+    return (GLshort) std::lround(f*MAX_VALUE);
+  }
+};
+
+class OctahedralNormal {
+  //Encodes a unit vector in two signed bytes by projecting it on an octahedron and unfolding the
+  //octahedron into a square. Use BYTE, normalized, length TWO. The maximum angular error is
+  //just below 1 degree, which is fine for lighting on small meshes.
+ public:
+  static void encode(GLfloat x, GLfloat y, GLfloat z, GLbyte result[2]) {
+    GLfloat l1 = std::fabs(x) + std::fabs(y) + std::fabs(z);
+    if(l1 == 0) {
+      result[0] = result[1] = 0;
+      return;
+    }
+    GLfloat u = x/l1, v = y/l1;
+    if(z < 0) {
+      GLfloat foldedU = (1.0f - std::fabs(v))*signNotZero(u);
+      GLfloat foldedV = (1.0f - std::fabs(u))*signNotZero(v);
+      u = foldedU;
+      v = foldedV;
+    }
+    result[0] = toSnorm8(u);
+    result[1] = toSnorm8(v);
+  }
+
+  static void decode(const GLbyte e[2], GLfloat result[3]) {
+    //The same computation as the vertex shader has to do.
+    GLfloat u = (GLfloat) e[0]/127.0f, v = (GLfloat) e[1]/127.0f;
+    GLfloat z = 1.0f - std::fabs(u) - std::fabs(v);
+    if(z < 0) {
+      GLfloat unfoldedU = (1.0f - std::fabs(v))*signNotZero(u);
+      GLfloat unfoldedV = (1.0f - std::fabs(u))*signNotZero(v);
+      u = unfoldedU;
+      v = unfoldedV;
+    }
+    GLfloat length = std::sqrt(u*u + v*v + z*z);
+    result[0] = u/length;
+    result[1] = v/length;
+    result[2] = z/length;
+  }
+
+  static constexpr GLfloat MAX_ANGULAR_ERROR_DEGREES = 1.0f;
+
+ private:
+  static GLfloat signNotZero(GLfloat f) {
+    return f < 0 ? -1.0f : 1.0f;
+  }
+
+  static GLbyte toSnorm8(GLfloat f) {
+    f = f < -1.0f ? -1.0f : (f > 1.0f ? 1.0f : f);
+    return (GLbyte) std::lround(f*127.0f);
+  }
+};
+
+class HalfFloat {
+  //IEEE 754 binary16, as used by GL_OES_vertex_half_float. The relative error is at most 2^-11
+  //for normal numbers; texture coordinates in [0,1] are accurate to about 0.0005.
+ public:
+  static GLushort fromFloat(GLfloat f) {
+    uint32_t bits;
+    std::memcpy( &bits,&f,sizeof(bits) );
+
+    uint32_t sign = (bits >> 16) & 0x8000u;
+    int32_t exponent = (int32_t) ( (bits >> 23) & 0xFF ) - 127 + 15;
+    uint32_t mantissa = bits & 0x7FFFFFu;
+
+    if( ( (bits >> 23) & 0xFF ) == 0xFF ) { //Infinity or NaN.
+      return (GLushort) ( sign | 0x7C00u | (mantissa ? 0x200u : 0) );
+    }
+    if(exponent >= 31) { //Too large: infinity.
+      return (GLushort) (sign | 0x7C00u);
+    }
+    if(exponent <= 0) { //Subnormal half or zero.
+      if(exponent < -10) {
+        return (GLushort) sign;
+      }
+      mantissa |= 0x800000u;
+      uint32_t shift = (uint32_t) (14 - exponent);
+      uint32_t half = mantissa >> shift;
+      uint32_t remainder = mantissa & ( (1u << shift) - 1 );
+      uint32_t halfway = 1u << (shift - 1);
+      if( remainder > halfway || (remainder == halfway && (half & 1u)) ) {
+        ++half;
+      }
+      return (GLushort) (sign | half);
+    }
+
+    uint32_t half = ( (uint32_t) exponent << 10 ) | (mantissa >> 13);
+    uint32_t remainder = mantissa & 0x1FFFu;
+    if( remainder > 0x1000u || (remainder == 0x1000u && (half & 1u)) ) {
+      ++half; //A carry into the exponent is the correct result, up to infinity.
+    }
+    return (GLushort) (sign | half);
+  }
+
+  static GLfloat toFloat(GLushort h) {
+    uint32_t sign = (uint32_t) (h & 0x8000u) << 16;
+    uint32_t exponent = (h >> 10) & 0x1Fu;
+    uint32_t mantissa = h & 0x3FFu;
+    uint32_t bits;
+
+    if(exponent == 0) {
+      if(mantissa == 0) {
+        bits = sign;
+      }
+      else { //Subnormal: normalize it.
+        exponent = 127 - 15 + 1;
+        while( (mantissa & 0x400u) == 0 ) {
+          mantissa <<= 1;
+          --exponent;
+        }
+        mantissa &= 0x3FFu;
+        bits = sign | (exponent << 23) | (mantissa << 13);
+      }
+    }
+    else if(exponent == 31) {
+      bits = sign | 0x7F800000u | (mantissa << 13);
+    }
+    else {
+      bits = sign | ( (exponent - 15 + 127) << 23 ) | (mantissa << 13);
+    }
+
+    GLfloat f;
+    std::memcpy( &f,&bits,sizeof(f) );
+    return f;
+  }
+};
+
+class TexCoordEncoding {
+  //Chooses the smallest texture coordinate format the driver supports: half floats if
+  //GL_OES_vertex_half_float is present, and otherwise normalized UNSIGNED_SHORT, which is just as
+  //small but only covers [0,1]. Both use 2 bytes per component. Requires an OpenGL context.
+ public:
+  TexCoordEncoding() : halfFloat( GLExtensions::has("GL_OES_vertex_half_float") ) {
+
+  }
+
+  bool usesHalfFloat() const {
+    return halfFloat;
+  }
+
+  GLenum getType() const {
+    return halfFloat ? 0x8D61 : GL_UNSIGNED_SHORT; //GL_HALF_FLOAT_OES
+  }
+
+  bool isNormalized() const {
+    return !halfFloat;
+  }
+
+  GLushort encode(GLfloat f) const {
+    if(halfFloat) {
+      return HalfFloat::fromFloat(f);
+    }
+    f = f < 0.0f ? 0.0f : (f > 1.0f ? 1.0f : f);
+    return (GLushort) std::lround(f*65535.0f);
+  }
+
+ private:
+  bool halfFloat;
+};
+
+}